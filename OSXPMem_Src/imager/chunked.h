@@ -0,0 +1,71 @@
+// Copyright 2012 Google Inc. All Rights Reserved.
+// Author: Johannes Stüttgen (johannes.stuettgen@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Layout of the chunked image format. All fields are little endian.
+//
+// The file starts with a chunked_header_t, followed by one chunked_segment_t
+// for each entry in the physical memory map. Then come the chunk data and at
+// the end of the file the chunk index, an array of chunked_entry_t sorted by
+// physical address. Each accessible segment is split into chunks of at most
+// chunk_size bytes. Chunks that contain only zeros have no data in the file,
+// all others are stored zlib compressed, or verbatim if that is smaller.
+// To read an address, find the chunk containing it with a binary search in the
+// index and decompress only that chunk.
+
+#ifndef _REKALL_CHUNKED_H_
+#define _REKALL_CHUNKED_H_
+
+#include <stdint.h>
+
+#define CHUNKED_MAGIC       "PMEMCHNK"  // Magic at the beginning of the file
+#define CHUNKED_VERSION     1           // Version of the format
+#define CHUNKED_CHUNK_SIZE  (64 * 1024) // Default uncompressed chunk size
+
+#define CHUNK_ZERO          0           // All zero, no data in the file
+#define CHUNK_STORED        1           // Stored uncompressed
+#define CHUNK_ZLIB          2           // Compressed with zlib
+
+// File header
+typedef struct chunked_header_ {
+  char     magic[8];          // CHUNKED_MAGIC, not zero terminated
+  uint32_t version;           // CHUNKED_VERSION
+  uint32_t chunk_size;        // Maximum uncompressed size of a chunk
+  uint32_t num_segments;      // Entries in the segment table
+  uint32_t reserved;
+  uint64_t segments_offset;   // File offset of the segment table
+  uint64_t index_offset;      // File offset of the chunk index
+  uint64_t num_chunks;        // Entries in the chunk index
+  uint64_t phys_as_size;      // Size of the physical address space
+} chunked_header_t;
+
+// Physical memory map entry
+typedef struct chunked_segment_ {
+  uint64_t phys_start;        // Physical start address
+  uint64_t size;              // Size in bytes
+  uint32_t type;              // EFI memory type
+  uint32_t accessible;        // 1 if the segment was imaged
+} chunked_segment_t;
+
+// Chunk index entry
+typedef struct chunked_entry_ {
+  uint64_t phys_addr;         // Physical address of the chunk
+  uint64_t file_offset;       // File offset of the data, 0 for zero chunks
+  uint32_t size;              // Uncompressed size
+  uint32_t stored_size;       // Size of the data in the file
+  uint32_t type;              // CHUNK_ZERO, CHUNK_STORED or CHUNK_ZLIB
+  uint32_t reserved;
+} chunked_entry_t;
+
+#endif  // _REKALL_CHUNKED_H_
@@ -25,7 +25,7 @@
 static const char * const device_path= "/dev/pmem";
 
 // Command line options for getopt_long().
-static const char *opt_string = "vhludrm:f:";
+static const char *opt_string = "vhludrm:f:t:b:HB:";
 static const struct option long_opts[] = {
   {"verbose",           no_argument, NULL, 'v'},
   {"help",              no_argument, NULL, 'h'},
@@ -34,6 +34,11 @@ static const struct option long_opts[] = {
   {"display-mmap",      no_argument, NULL, 'd'},
   {"mmap-method", required_argument, NULL, 'm'},
   {"format",      required_argument, NULL, 'f'},
+  {"threads",     required_argument, NULL, 't'},
+  {"block-size",  required_argument, NULL, 'b'},
+  {"hash",              no_argument, NULL, 'H'},
+  {"baseline",    required_argument, NULL, 'B'},
+  {NULL,                          0, NULL,  0 },
 };
 
 // Default loglevel.
@@ -45,6 +50,20 @@ static dumpformat_t dumpformat = ELF;
 // doesn't (such as on some 10.9 systems) and is also harder to fool by a
 // rootkit.
 static int pmem_mmap_method = PMEM_MMAP_PTE;
+// Number of threads reading from the memory device and the size of each read
+// and write when copying a segment.
+static unsigned int copy_threads = PMEM_DEFAULT_THREADS;
+static uint64_t copy_block_size = PMEM_DEFAULT_BLOCK_SIZE;
+// Bytes copied by write_segment(), for the throughput report.
+static uint64_t bytes_copied = 0;
+// Whether to write a manifest of page hashes next to the image, and the
+// manifest of an earlier acquisition to write a delta image against.
+static bool manifest_enabled = false;
+static const char *baseline_path = NULL;
+// Manifest the pages copied by write_segment() are hashed into and the
+// baseline they are compared with, see set_page_manifest().
+static page_manifest_t *page_manifest = NULL;
+static const page_manifest_t *page_baseline = NULL;
 
 // Prints debug messages to stdout.
 //
@@ -91,6 +110,17 @@ void display_usage(const char *image_name) {
       "                         This is experimental but quite stable,\n"
       "                         and much harder for rootkits to circumvent.\n"
       "\n"
+      "  -t, --threads N        read memory with N threads (default is 4)\n"
+      "  -b, --block-size SIZE  copy memory in blocks of SIZE bytes, a\n"
+      "                         multiple of the page size. A k, m or g\n"
+      "                         suffix may be used (default is 4m).\n"
+      "  -H, --hash             hash every page and write the hashes to\n"
+      "                         FILE.manifest\n"
+      "  -B, --baseline FILE    only write pages whose hash differs from\n"
+      "                         the manifest FILE of an earlier image,\n"
+      "                         the others are left as holes. Implies\n"
+      "                         --hash, not supported for chunked images.\n"
+      "\n"
       "  -f, --format [FORMAT]  set the output format (default is elf)\n"
       "\n"
       " Output formats:\n"
@@ -105,7 +135,13 @@ void display_usage(const char *image_name) {
       "                         are written to their corresponding\n"
       "                         offset in the file. Memory holes and\n"
       "                         gaps in physical address space are\n"
-      "                         zero-padded.\n",
+      "                         zero-padded.\n"
+      "\n"
+      "  chunked                Image split into 64 KiB chunks, which are\n"
+      "                         zlib compressed in parallel. Zero chunks\n"
+      "                         and memory holes take no space. An index\n"
+      "                         at the end maps physical addresses to\n"
+      "                         chunks.\n",
       image_name);
 }
 
@@ -207,64 +243,311 @@ error_malloc:
   return status;
 }
 
-// Write a segment of physical memory into a binary file. This segment must be
-// accessible, otherwise the function will return 0.
+// Read exactly nbytes from a file at the given offset.
+//
+// args: fd is an open filehandle to read from.
+//       buf is the buffer to read into, at least nbytes large.
+//       nbytes is the number of bytes to read.
+//       offset is the position in the file to read from.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE.
+//
+unsigned int read_fully(int fd, uint8_t *buf, uint64_t nbytes,
+                        uint64_t offset) {
+  while (nbytes > 0) {
+    ssize_t n = pread(fd, buf, nbytes, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return EXIT_FAILURE;
+    }
+    buf += n;
+    nbytes -= n;
+    offset += n;
+  }
+  return EXIT_SUCCESS;
+}
+
+// Write exactly nbytes to a file at the given offset.
+//
+// args: fd is an open filehandle to write to.
+//       buf is the buffer holding the data.
+//       nbytes is the number of bytes to write.
+//       offset is the position in the file to write to.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE.
+//
+unsigned int write_fully(int fd, const uint8_t *buf, uint64_t nbytes,
+                         uint64_t offset) {
+  while (nbytes > 0) {
+    ssize_t n = pwrite(fd, buf, nbytes, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return EXIT_FAILURE;
+    }
+    buf += n;
+    nbytes -= n;
+    offset += n;
+  }
+  return EXIT_SUCCESS;
+}
+
+// Reader thread of the segment copy pipeline. Claims blocks in ascending order
+// and reads each one into its ring slot, until all blocks are claimed or the
+// copy has failed. Pages are also hashed and chunked images compressed here,
+// so this runs in parallel as well.
+//
+// args: arg is a pointer to the copy_pipeline_t of the segment.
+//
+// return: NULL, errors are reported through the failed flag.
+//
+void *read_blocks(void *arg) {
+  copy_pipeline_t *pipe = (copy_pipeline_t *)arg;
+
+  pthread_mutex_lock(&pipe->lock);
+  while (!pipe->failed && pipe->next_block < pipe->num_blocks) {
+    // Wait until the writer has freed the slot of the next block.
+    if (pipe->next_block >= pipe->blocks_written + pipe->num_slots) {
+      pthread_cond_wait(&pipe->cond, &pipe->lock);
+      continue;
+    }
+    uint64_t block = pipe->next_block++;
+    unsigned int slot = block % pipe->num_slots;
+    uint64_t offset = block * pipe->block_size;
+    uint64_t len = pipe->size - offset;
+    if (len > pipe->block_size) {
+      len = pipe->block_size;
+    }
+    pthread_mutex_unlock(&pipe->lock);
+    unsigned int status = read_fully(pipe->mem_dev, pipe->slots[slot], len,
+                                     pipe->phys_start + offset);
+    if (status == EXIT_FAILURE) {
+      PMEM_ERROR_LOG("Failed to read %lld bytes at %#016llx", len,
+                     pipe->phys_start + offset);
+    } else {
+      if (pipe->manifest != NULL) {
+        hash_pages(pipe, slot, offset, len);
+      }
+      if (pipe->index != NULL) {
+        pack_block(pipe, slot, pipe->phys_start + offset, len);
+      }
+    }
+    pthread_mutex_lock(&pipe->lock);
+    if (status == EXIT_FAILURE) {
+      pipe->failed = true;
+    } else {
+      pipe->slot_full[slot] = true;
+    }
+    pthread_cond_broadcast(&pipe->cond);
+  }
+  pthread_mutex_unlock(&pipe->lock);
+  return NULL;
+}
+
+// Copy a segment of physical memory into an image file. This segment must be
+// accessible, otherwise the function will fail.
+//
+// The segment is copied in blocks of copy_block_size bytes. Up to copy_threads
+// threads read blocks from the memory device into a ring of buffers, while the
+// calling thread writes them to the image in order. If a page manifest is set,
+// the pages are hashed into it, and with a baseline only changed pages are
+// written.
 //
 // args: segment is a struct describing the position and size of the segment.
 //       mem_dev is an open filehandle to the /dev/pmem device.
 //       dump_file is an open filehandle to the image file.
+//       file_offset points to the offset in the image file to write the
+//       segment to. It is advanced past the data written.
+//       index is NULL to copy the segment verbatim. Otherwise the segment is
+//       written as compressed chunks, which are added to the index.
 //
-// return: the number of bytes written.
+// return: EXIT_SUCCESS or EXIT_FAILURE.
 //
-unsigned int write_segment(EfiMemoryRange *segment, int mem_dev,
-                           int dump_file, uint64_t file_offset) {
+unsigned int copy_segment(EfiMemoryRange *segment, int mem_dev, int dump_file,
+                          uint64_t *file_offset, chunked_index_t *index) {
   unsigned int status = EXIT_FAILURE;
-  uint64_t segment_size = segment->NumberOfPages * PAGE_SIZE;
-  uint64_t page = segment->PhysicalStart;
-  uint64_t end = segment->PhysicalStart + segment_size;
-  uint8_t *page_buf = NULL;
+  copy_pipeline_t pipe;
+  pthread_t threads[PMEM_MAX_THREADS];
+  unsigned int num_threads = 0;
+  uint64_t buf_size = 0;
+  unsigned int chunks_per_block = 0;
+  unsigned int written = EXIT_FAILURE;
 
-  page_buf = (uint8_t *)malloc(PAGE_SIZE);
-  if (page_buf == NULL) {
-    print_msg(STD, "Could not allocate memory for page buffer\n");
+  if (!segment_accessible(segment)) {
+    // This segment cannot be imaged, you shouldn't have called this function.
+    PMEM_ERROR_LOG("Illegal segment type, unable to copy");
+    goto error_segment;
+  }
+  bzero(&pipe, sizeof(copy_pipeline_t));
+  pipe.mem_dev = mem_dev;
+  pipe.phys_start = segment->PhysicalStart;
+  pipe.size = segment->NumberOfPages * PAGE_SIZE;
+  pipe.block_size = copy_block_size;
+  pipe.num_blocks = (pipe.size + copy_block_size - 1) / copy_block_size;
+  if (pipe.num_blocks == 0) {
+    return EXIT_SUCCESS;
+  }
+  // Two buffers per reader keep the readers busy while the writer is flushing.
+  pipe.num_slots = 2 * copy_threads;
+  if (pipe.num_slots > pipe.num_blocks) {
+    pipe.num_slots = pipe.num_blocks;
+  }
+  buf_size = pipe.size < copy_block_size ? pipe.size : copy_block_size;
+  pipe.slots = (uint8_t **)calloc(pipe.num_slots, sizeof(uint8_t *));
+  pipe.slot_full = (bool *)calloc(pipe.num_slots, sizeof(bool));
+  if (pipe.slots == NULL || pipe.slot_full == NULL) {
+    PMEM_ERROR_LOG("Could not allocate memory for the copy buffers");
     goto error_malloc;
   }
-  if (segment_accessible(segment)) {
-    // Dump contiguous segments one page at a time
-    while (page < end) {
-      if (lseek(mem_dev, page, SEEK_SET) != page) {
-        PMEM_ERROR_LOG("Could not seek to page in memory device");
-        goto error;
-      }
-      if (read(mem_dev, page_buf, PAGE_SIZE) != PAGE_SIZE) {
-        PMEM_ERROR_LOG("Failed to read page");
-        goto error;
+  for (unsigned int slot = 0; slot < pipe.num_slots; slot++) {
+    if ((pipe.slots[slot] = (uint8_t *)malloc(buf_size)) == NULL) {
+      PMEM_ERROR_LOG("Could not allocate memory for the copy buffers");
+      goto error_malloc;
+    }
+  }
+  if (index != NULL) {
+    // Compressed chunks can be slightly larger than the original data.
+    chunks_per_block = (buf_size + CHUNKED_CHUNK_SIZE - 1) / CHUNKED_CHUNK_SIZE;
+    pipe.index = index;
+    pipe.packed = (uint8_t **)calloc(pipe.num_slots, sizeof(uint8_t *));
+    pipe.packed_size = (uint64_t *)calloc(pipe.num_slots, sizeof(uint64_t));
+    pipe.chunks = (chunked_entry_t **)calloc(pipe.num_slots,
+                                             sizeof(chunked_entry_t *));
+    pipe.num_chunks = (unsigned int *)calloc(pipe.num_slots,
+                                             sizeof(unsigned int));
+    if (pipe.packed == NULL || pipe.packed_size == NULL ||
+        pipe.chunks == NULL || pipe.num_chunks == NULL) {
+      PMEM_ERROR_LOG("Could not allocate memory for the chunk buffers");
+      goto error_malloc;
+    }
+    for (unsigned int slot = 0; slot < pipe.num_slots; slot++) {
+      pipe.packed[slot] = (uint8_t *)malloc(
+          chunks_per_block * compressBound(CHUNKED_CHUNK_SIZE));
+      pipe.chunks[slot] = (chunked_entry_t *)calloc(chunks_per_block,
+                                                    sizeof(chunked_entry_t));
+      if (pipe.packed[slot] == NULL || pipe.chunks[slot] == NULL) {
+        PMEM_ERROR_LOG("Could not allocate memory for the chunk buffers");
+        goto error_malloc;
       }
-      // Copy the page to the indicated offset in the mach-o file
-      if (lseek(dump_file, file_offset, SEEK_SET) != file_offset) {
-        PMEM_ERROR_LOG("Could not seek to segment in dump file");
-        goto error;
+    }
+  }
+  if (page_manifest != NULL) {
+    if (manifest_add_segment(page_manifest, pipe.phys_start,
+                             pipe.size / PAGE_SIZE,
+                             &pipe.first_page) == EXIT_FAILURE) {
+      PMEM_ERROR_LOG("Could not allocate memory for the page hashes");
+      goto error_malloc;
+    }
+    pipe.manifest = page_manifest;
+    pipe.baseline = page_baseline;
+  }
+  pthread_mutex_init(&pipe.lock, NULL);
+  pthread_cond_init(&pipe.cond, NULL);
+  // Start the readers, there is no point in having more than blocks.
+  while (num_threads < copy_threads && num_threads < pipe.num_blocks) {
+    if (pthread_create(&threads[num_threads], NULL, read_blocks, &pipe) != 0) {
+      PMEM_ERROR_LOG("Could not start reader thread");
+      if (num_threads == 0) {
+        goto error_threads;
       }
-      if (write(dump_file, page_buf, PAGE_SIZE) != PAGE_SIZE) {
-        PMEM_ERROR_LOG("Failed to write page");
-        goto error;
-     }
-      // Advance the read and write pointers
-      page += PAGE_SIZE;
-      file_offset += PAGE_SIZE;
+      break;
     }
-  } else {
-    // This segment cannot be imaged, you shouldn't have called this function.
-    PMEM_ERROR_LOG("Illegal segment type, unable to copy");
-    goto error;
+    num_threads++;
+  }
+  // Write the blocks in order as they come in.
+  for (uint64_t block = 0; block < pipe.num_blocks; block++) {
+    unsigned int slot = block % pipe.num_slots;
+    uint64_t offset = block * copy_block_size;
+    uint64_t len = pipe.size - offset;
+    if (len > copy_block_size) {
+      len = copy_block_size;
+    }
+    pthread_mutex_lock(&pipe.lock);
+    while (!pipe.slot_full[slot] && !pipe.failed) {
+      pthread_cond_wait(&pipe.cond, &pipe.lock);
+    }
+    bool failed = pipe.failed;
+    pthread_mutex_unlock(&pipe.lock);
+    if (failed) {
+      goto error;
+    }
+    if (pipe.manifest != NULL) {
+      diff_pages(&pipe, offset, len);
+    }
+    if (index != NULL) {
+      written = write_chunks(&pipe, slot, dump_file, file_offset);
+    } else if (pipe.manifest != NULL) {
+      written = write_changed_pages(&pipe, slot, dump_file,
+                                    *file_offset + offset, offset, len);
+    } else {
+      written = write_fully(dump_file, pipe.slots[slot], len,
+                            *file_offset + offset);
+    }
+    if (written == EXIT_FAILURE) {
+      PMEM_ERROR_LOG("Failed to write block at %#016llx to the image",
+                     pipe.phys_start + offset);
+      pthread_mutex_lock(&pipe.lock);
+      pipe.failed = true;
+      pthread_cond_broadcast(&pipe.cond);
+      pthread_mutex_unlock(&pipe.lock);
+      goto error;
+    }
+    bytes_copied += len;
+    pthread_mutex_lock(&pipe.lock);
+    pipe.slot_full[slot] = false;
+    pipe.blocks_written++;
+    pthread_cond_broadcast(&pipe.cond);
+    pthread_mutex_unlock(&pipe.lock);
+  }
+  if (index == NULL) {
+    *file_offset += pipe.size;
   }
   status = EXIT_SUCCESS;
 error:
-  free(page_buf);
+  while (num_threads > 0) {
+    pthread_join(threads[--num_threads], NULL);
+  }
+error_threads:
+  pthread_cond_destroy(&pipe.cond);
+  pthread_mutex_destroy(&pipe.lock);
 error_malloc:
+  for (unsigned int slot = 0; pipe.slots && slot < pipe.num_slots; slot++) {
+    free(pipe.slots[slot]);
+  }
+  free(pipe.slots);
+  free(pipe.slot_full);
+  for (unsigned int slot = 0; pipe.packed && slot < pipe.num_slots; slot++) {
+    free(pipe.packed[slot]);
+  }
+  for (unsigned int slot = 0; pipe.chunks && slot < pipe.num_slots; slot++) {
+    free(pipe.chunks[slot]);
+  }
+  free(pipe.packed);
+  free(pipe.packed_size);
+  free(pipe.chunks);
+  free(pipe.num_chunks);
+error_segment:
   return status;
 }
 
+// Write a segment of physical memory into a binary file. This segment must be
+// accessible, otherwise the function will fail.
+//
+// args: segment is a struct describing the position and size of the segment.
+//       mem_dev is an open filehandle to the /dev/pmem device.
+//       dump_file is an open filehandle to the image file.
+//       file_offset is the offset in the image file to write the segment to.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE.
+//
+unsigned int write_segment(EfiMemoryRange *segment, int mem_dev,
+                           int dump_file, uint64_t file_offset) {
+  return copy_segment(segment, mem_dev, dump_file, &file_offset, NULL);
+}
+
 // Write a prepared mach-o header to the beginning of a file.
 //
 // args: file is an open filehandle to the output file.
@@ -591,6 +874,806 @@ void prepare_elf_program_header(elf64_phdr *program_header,
   }
 }
 
+// Checks if a buffer contains only zero bytes.
+//
+// args: buf is the buffer to check, it must be 8 byte aligned.
+//       len is the size of the buffer, a multiple of 8.
+//
+// return: true if all bytes are zero.
+//
+bool buffer_is_zero(const uint8_t *buf, uint64_t len) {
+  const uint64_t *word = (const uint64_t *)buf;
+
+  for (uint64_t i = 0; i < len / sizeof(uint64_t); i++) {
+    if (word[i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Split a block that was read into a ring slot into chunks and compress them
+// into the packed buffer of the slot. Zero chunks are only recorded, chunks
+// that don't compress are stored verbatim. The file offsets of the chunks are
+// relative to the start of the packed buffer.
+//
+// args: pipe is the pipeline the block belongs to.
+//       slot is the ring slot holding the block.
+//       phys_addr is the physical address of the block.
+//       len is the size of the block in bytes.
+//
+void pack_block(copy_pipeline_t *pipe, unsigned int slot, uint64_t phys_addr,
+                uint64_t len) {
+  uint8_t *data = pipe->slots[slot];
+  uint8_t *packed = pipe->packed[slot];
+  chunked_entry_t *chunk = pipe->chunks[slot];
+  uint64_t packed_size = 0;
+
+  for (uint64_t offset = 0; offset < len;
+       offset += CHUNKED_CHUNK_SIZE, chunk++) {
+    uint32_t size = CHUNKED_CHUNK_SIZE;
+    uLongf stored_size = compressBound(CHUNKED_CHUNK_SIZE);
+    if (len - offset < size) {
+      size = len - offset;
+    }
+    bzero(chunk, sizeof(chunked_entry_t));
+    chunk->phys_addr = phys_addr + offset;
+    chunk->size = size;
+    if (buffer_is_zero(data + offset, size)) {
+      chunk->type = CHUNK_ZERO;
+      continue;
+    }
+    if (compress2(packed + packed_size, &stored_size, data + offset, size,
+                  Z_BEST_SPEED) == Z_OK && stored_size < size) {
+      chunk->type = CHUNK_ZLIB;
+    } else {
+      memcpy(packed + packed_size, data + offset, size);
+      stored_size = size;
+      chunk->type = CHUNK_STORED;
+    }
+    chunk->file_offset = packed_size;
+    chunk->stored_size = stored_size;
+    packed_size += stored_size;
+  }
+  pipe->num_chunks[slot] = chunk - pipe->chunks[slot];
+  pipe->packed_size[slot] = packed_size;
+}
+
+// Add entries to the index of a chunked image, growing it as needed.
+//
+// args: index is the index to add the entries to.
+//       chunks is an array of the entries to add.
+//       num_chunks is the number of entries in chunks.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE.
+//
+unsigned int append_chunks(chunked_index_t *index, chunked_entry_t *chunks,
+                           unsigned int num_chunks) {
+  if (index->num_entries + num_chunks > index->capacity) {
+    uint64_t capacity = index->capacity ? index->capacity : 1024;
+    while (capacity < index->num_entries + num_chunks) {
+      capacity *= 2;
+    }
+    chunked_entry_t *entries = (chunked_entry_t *)realloc(
+        index->entries, capacity * sizeof(chunked_entry_t));
+    if (entries == NULL) {
+      PMEM_ERROR_LOG("Could not allocate memory for the chunk index");
+      return EXIT_FAILURE;
+    }
+    index->entries = entries;
+    index->capacity = capacity;
+  }
+  memcpy(index->entries + index->num_entries, chunks,
+         num_chunks * sizeof(chunked_entry_t));
+  index->num_entries += num_chunks;
+  return EXIT_SUCCESS;
+}
+
+// Append the packed chunks of a ring slot to a chunked image and add them to
+// the index of the pipeline.
+//
+// args: pipe is the pipeline the slot belongs to.
+//       slot is the ring slot holding the packed block.
+//       dump_file is an open filehandle to the image file.
+//       file_offset points to the end of the image, it is advanced past the
+//       data written.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE.
+//
+unsigned int write_chunks(copy_pipeline_t *pipe, unsigned int slot,
+                          int dump_file, uint64_t *file_offset) {
+  chunked_entry_t *chunks = pipe->chunks[slot];
+
+  if (write_fully(dump_file, pipe->packed[slot], pipe->packed_size[slot],
+                  *file_offset) == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  for (unsigned int i = 0; i < pipe->num_chunks[slot]; i++) {
+    if (chunks[i].type != CHUNK_ZERO) {
+      chunks[i].file_offset += *file_offset;
+    }
+  }
+  *file_offset += pipe->packed_size[slot];
+  return append_chunks(pipe->index, chunks, pipe->num_chunks[slot]);
+}
+
+// Orders chunk index entries by physical address for qsort().
+static int compare_chunks(const void *a, const void *b) {
+  const chunked_entry_t *chunk_a = (const chunked_entry_t *)a;
+  const chunked_entry_t *chunk_b = (const chunked_entry_t *)b;
+
+  if (chunk_a->phys_addr < chunk_b->phys_addr) {
+    return -1;
+  }
+  return chunk_a->phys_addr > chunk_b->phys_addr;
+}
+
+// Parse the mmap and dump each accessible section into a chunked image (see
+// chunked.h). Zero chunks take no space in the image and all other chunks are
+// compressed by the reader threads. The chunk index is written to the end of
+// the file, so any physical address can be found without decompressing the
+// whole image.
+//
+// args: mem_dev is an open filehandle to the pmem device file (/dev/pmem).
+//       dump_file is an open filehandle to which the image will be written.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE.
+//
+unsigned int dump_memory_chunked(int mem_dev, int dump_file) {
+  unsigned int status = EXIT_FAILURE;
+  uint64_t section = 0;
+  uint64_t file_offset = 0;
+  uint64_t phys_as_size = 0;
+  uint64_t bytes_imaged = 0;
+  uint64_t zero_chunks = 0;
+  int num_segments = 0;
+  unsigned int headers_bufsize = 0;
+  uint8_t *headers_buf = NULL;
+  chunked_header_t *header = NULL;
+  chunked_segment_t *segment_table = NULL;
+  chunked_index_t index = {NULL, 0, 0};
+  uint8_t *mmap = NULL;
+  unsigned int mmap_size = 0;
+  unsigned int mmap_desc_size = 0;
+
+  if (get_mmap(&mmap, &mmap_size, &mmap_desc_size, mem_dev) == EXIT_FAILURE) {
+    PMEM_ERROR_LOG("Failed to obtain memory map");
+    goto error_mmap;
+  }
+  if (mmap_size < mmap_desc_size || mmap_size % mmap_desc_size ||
+      mmap_desc_size == 0) {
+    PMEM_ERROR_LOG("Memory map corrupted, could not dump memory");
+    goto error_mmap_corrupt;
+  }
+  num_segments = mmap_size / mmap_desc_size;
+  headers_bufsize = (
+      sizeof(chunked_header_t) + num_segments * sizeof(chunked_segment_t));
+  if ((headers_buf = (uint8_t *)calloc(1, headers_bufsize)) == NULL) {
+    PMEM_ERROR_LOG("Could not allocate memory for chunked image headers");
+    goto error_headers;
+  }
+  header = (chunked_header_t *)headers_buf;
+  segment_table = (chunked_segment_t *)(headers_buf + sizeof(chunked_header_t));
+  // Chunk data is written right after the header and segment table
+  file_offset = headers_bufsize;
+  for (section = 0; section < num_segments; section++) {
+    EfiMemoryRange *segment = (EfiMemoryRange *)(
+        mmap + (section * mmap_desc_size));
+    uint64_t segment_size = segment->NumberOfPages * PAGE_SIZE;
+    segment_table[section].phys_start = segment->PhysicalStart;
+    segment_table[section].size = segment_size;
+    segment_table[section].type = segment->Type;
+    segment_table[section].accessible = segment_accessible(segment);
+    print_msg(STD, "[%016llx - %016llx] %s ", segment->PhysicalStart,
+              segment->PhysicalStart + segment_size,
+              physmem_type_tostring(segment->Type));
+    if (segment_accessible(segment)) {
+      if (copy_segment(segment, mem_dev, dump_file, &file_offset,
+                       &index) == EXIT_FAILURE) {
+        print_msg(STD, "Failed to dump segment %d\n", section);
+        goto error;
+      }
+      bytes_imaged += segment_size;
+      print_msg(STD, "[WRITTEN]\n");
+    } else {
+      print_msg(STD, "[SKIPPED]\n");
+    }
+    if (segment->PhysicalStart + segment_size > phys_as_size) {
+      phys_as_size = segment->PhysicalStart + segment_size;
+    }
+  }
+  // The memory map is not necessarily sorted, but the index has to be.
+  qsort(index.entries, index.num_entries, sizeof(chunked_entry_t),
+        compare_chunks);
+  for (uint64_t i = 0; i < index.num_entries; i++) {
+    zero_chunks += index.entries[i].type == CHUNK_ZERO;
+  }
+  if (index.num_entries > 0 &&
+      write_fully(dump_file, (uint8_t *)index.entries,
+                  index.num_entries * sizeof(chunked_entry_t),
+                  file_offset) == EXIT_FAILURE) {
+    PMEM_ERROR_LOG("Failed to write chunk index");
+    goto error;
+  }
+  memcpy(header->magic, CHUNKED_MAGIC, sizeof(header->magic));
+  header->version = CHUNKED_VERSION;
+  header->chunk_size = CHUNKED_CHUNK_SIZE;
+  header->num_segments = num_segments;
+  header->segments_offset = sizeof(chunked_header_t);
+  header->index_offset = file_offset;
+  header->num_chunks = index.num_entries;
+  header->phys_as_size = phys_as_size;
+  if (write_header(dump_file, headers_buf, headers_bufsize) == EXIT_FAILURE) {
+    goto error;
+  }
+  print_msg(STD, "Acquired %lld pages (%lld bytes)\n",
+            bytes_imaged / PAGE_SIZE, bytes_imaged);
+  print_msg(STD, "Size of physical address space: %lld bytes (%lld segments)\n",
+            phys_as_size, section);
+  print_msg(STD, "Wrote %lld chunks (%lld zero), image size %lld bytes\n",
+            index.num_entries, zero_chunks,
+            file_offset + index.num_entries * sizeof(chunked_entry_t));
+  status = EXIT_SUCCESS;
+error:
+  free(index.entries);
+  free(headers_buf);
+error_headers:
+error_mmap_corrupt:
+  free(mmap);
+error_mmap:
+  return status;
+}
+
+// Read the header and chunk index of a chunked image. This function will
+// allocate memory for the index, make sure you free it.
+//
+// args: image is an open filehandle to the chunked image.
+//       header is a pointer to the struct that will recieve the header.
+//       index is a pointer to a pointer that will recieve the chunk index.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE.
+//
+unsigned int load_chunked_index(int image, chunked_header_t *header,
+                                chunked_entry_t **index) {
+  if (read_fully(image, (uint8_t *)header, sizeof(chunked_header_t),
+                 0) == EXIT_FAILURE) {
+    PMEM_ERROR_LOG("Failed to read chunked image header");
+    return EXIT_FAILURE;
+  }
+  if (memcmp(header->magic, CHUNKED_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != CHUNKED_VERSION || header->chunk_size == 0) {
+    print_msg(STD, "Not a chunked image or unsupported version\n");
+    return EXIT_FAILURE;
+  }
+  *index = (chunked_entry_t *)malloc(
+      header->num_chunks * sizeof(chunked_entry_t) + 1);
+  if (*index == NULL) {
+    PMEM_ERROR_LOG("Could not allocate memory for the chunk index");
+    return EXIT_FAILURE;
+  }
+  if (read_fully(image, (uint8_t *)*index,
+                 header->num_chunks * sizeof(chunked_entry_t),
+                 header->index_offset) == EXIT_FAILURE) {
+    PMEM_ERROR_LOG("Failed to read chunk index");
+    free(*index);
+    *index = NULL;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+// Look up the chunk containing a physical address with a binary search.
+//
+// args: header is the header of the chunked image.
+//       index is the chunk index of the image.
+//       phys_addr is the physical address to look for.
+//
+// return: the index entry of the chunk, or NULL if the address is not in the
+//         image.
+//
+chunked_entry_t *find_chunk(const chunked_header_t *header,
+                            chunked_entry_t *index, uint64_t phys_addr) {
+  uint64_t low = 0;
+  uint64_t high = header->num_chunks;
+
+  // Find the first chunk starting after phys_addr, the one before it is the
+  // only candidate.
+  while (low < high) {
+    uint64_t mid = low + (high - low) / 2;
+    if (index[mid].phys_addr <= phys_addr) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == 0 || phys_addr - index[low - 1].phys_addr >= index[low - 1].size) {
+    return NULL;
+  }
+  return &index[low - 1];
+}
+
+// Read physical memory from a chunked image. Only the chunks overlapping the
+// requested range are read and decompressed.
+//
+// args: image is an open filehandle to the chunked image.
+//       header and index are the header and chunk index of the image, as
+//       returned by load_chunked_index().
+//       phys_addr is the physical address to start reading at.
+//       buf is the buffer to read into, at least len bytes large.
+//       len is the number of bytes to read.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE if part of the range is not in the
+//         image or the image is corrupted.
+//
+unsigned int read_chunked(int image, const chunked_header_t *header,
+                          chunked_entry_t *index, uint64_t phys_addr,
+                          uint8_t *buf, uint64_t len) {
+  unsigned int status = EXIT_FAILURE;
+  uint8_t *chunk_buf = NULL;
+  uint8_t *stored_buf = NULL;
+
+  chunk_buf = (uint8_t *)malloc(header->chunk_size);
+  stored_buf = (uint8_t *)malloc(header->chunk_size);
+  if (chunk_buf == NULL || stored_buf == NULL) {
+    PMEM_ERROR_LOG("Could not allocate memory for chunk buffers");
+    goto error;
+  }
+  while (len > 0) {
+    chunked_entry_t *chunk = find_chunk(header, index, phys_addr);
+    if (chunk == NULL) {
+      print_msg(STD, "Address %#016llx is not in the image\n", phys_addr);
+      goto error;
+    }
+    if (chunk->size > header->chunk_size ||
+        chunk->stored_size > chunk->size) {
+      print_msg(STD, "Chunk at %#016llx is corrupted\n", chunk->phys_addr);
+      goto error;
+    }
+    uint64_t offset = phys_addr - chunk->phys_addr;
+    uint64_t n = chunk->size - offset;
+    if (n > len) {
+      n = len;
+    }
+    switch (chunk->type) {
+      case CHUNK_ZERO:
+        bzero(buf, n);
+        break;
+
+      case CHUNK_STORED:
+        if (read_fully(image, buf, n,
+                       chunk->file_offset + offset) == EXIT_FAILURE) {
+          PMEM_ERROR_LOG("Failed to read chunk at %#016llx", chunk->phys_addr);
+          goto error;
+        }
+        break;
+
+      case CHUNK_ZLIB: {
+        uLongf size = header->chunk_size;
+        if (read_fully(image, stored_buf, chunk->stored_size,
+                       chunk->file_offset) == EXIT_FAILURE) {
+          PMEM_ERROR_LOG("Failed to read chunk at %#016llx", chunk->phys_addr);
+          goto error;
+        }
+        if (uncompress(chunk_buf, &size, stored_buf,
+                       chunk->stored_size) != Z_OK || size != chunk->size) {
+          print_msg(STD, "Failed to decompress chunk at %#016llx\n",
+                    chunk->phys_addr);
+          goto error;
+        }
+        memcpy(buf, chunk_buf + offset, n);
+        break;
+      }
+
+      default:
+        print_msg(STD, "Unknown type of chunk at %#016llx\n",
+                  chunk->phys_addr);
+        goto error;
+    }
+    buf += n;
+    phys_addr += n;
+    len -= n;
+  }
+  status = EXIT_SUCCESS;
+error:
+  free(chunk_buf);
+  free(stored_buf);
+  return status;
+}
+
+// Constants of the XXH64 hash function.
+static const uint64_t kXXH64Prime1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t kXXH64Prime2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t kXXH64Prime3 = 0x165667B19E3779F9ULL;
+static const uint64_t kXXH64Prime4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t kXXH64Prime5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t xxh64_rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t xxh64_read64(const uint8_t *p) {
+  uint64_t value;
+
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static inline uint32_t xxh64_read32(const uint8_t *p) {
+  uint32_t value;
+
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static inline uint64_t xxh64_round(uint64_t acc, uint64_t input) {
+  acc += input * kXXH64Prime2;
+  acc = xxh64_rotl(acc, 31);
+  return acc * kXXH64Prime1;
+}
+
+static inline uint64_t xxh64_merge(uint64_t acc, uint64_t value) {
+  acc ^= xxh64_round(0, value);
+  return acc * kXXH64Prime1 + kXXH64Prime4;
+}
+
+// Compute the XXH64 hash of a buffer. The four independent lanes of the main
+// loop keep the multipliers of the CPU busy, so hashing a page costs much less
+// than reading it from the memory device.
+//
+// args: buf is the data to hash.
+//       len is the size of the data in bytes.
+//       seed is the seed of the hash, the manifest uses 0.
+//
+// return: the hash value.
+//
+uint64_t xxhash64(const uint8_t *buf, uint64_t len, uint64_t seed) {
+  const uint8_t *p = buf;
+  const uint8_t *end = buf + len;
+  uint64_t hash = 0;
+
+  if (len >= 32) {
+    uint64_t v1 = seed + kXXH64Prime1 + kXXH64Prime2;
+    uint64_t v2 = seed + kXXH64Prime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - kXXH64Prime1;
+    do {
+      v1 = xxh64_round(v1, xxh64_read64(p));
+      v2 = xxh64_round(v2, xxh64_read64(p + 8));
+      v3 = xxh64_round(v3, xxh64_read64(p + 16));
+      v4 = xxh64_round(v4, xxh64_read64(p + 24));
+      p += 32;
+    } while (p + 32 <= end);
+    hash = xxh64_rotl(v1, 1) + xxh64_rotl(v2, 7) + xxh64_rotl(v3, 12) +
+           xxh64_rotl(v4, 18);
+    hash = xxh64_merge(hash, v1);
+    hash = xxh64_merge(hash, v2);
+    hash = xxh64_merge(hash, v3);
+    hash = xxh64_merge(hash, v4);
+  } else {
+    hash = seed + kXXH64Prime5;
+  }
+  hash += len;
+  for (; p + 8 <= end; p += 8) {
+    hash ^= xxh64_round(0, xxh64_read64(p));
+    hash = xxh64_rotl(hash, 27) * kXXH64Prime1 + kXXH64Prime4;
+  }
+  if (p + 4 <= end) {
+    hash ^= (uint64_t)xxh64_read32(p) * kXXH64Prime1;
+    hash = xxh64_rotl(hash, 23) * kXXH64Prime2 + kXXH64Prime3;
+    p += 4;
+  }
+  for (; p < end; p++) {
+    hash ^= *p * kXXH64Prime5;
+    hash = xxh64_rotl(hash, 11) * kXXH64Prime1;
+  }
+  hash ^= hash >> 33;
+  hash *= kXXH64Prime2;
+  hash ^= hash >> 29;
+  hash *= kXXH64Prime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+// Hash each page of a block that was read into a ring slot into the manifest
+// of the pipeline. Every block has its own pages, so the readers can do this
+// without taking the lock.
+//
+// args: pipe is the pipeline the block belongs to.
+//       slot is the ring slot holding the block.
+//       offset is the offset of the block in the segment.
+//       len is the size of the block in bytes.
+//
+void hash_pages(copy_pipeline_t *pipe, unsigned int slot, uint64_t offset,
+                uint64_t len) {
+  uint64_t *hashes = (pipe->manifest->hashes + pipe->first_page +
+                      offset / PAGE_SIZE);
+
+  for (uint64_t page = 0; page < len / PAGE_SIZE; page++) {
+    hashes[page] = xxhash64(pipe->slots[slot] + page * PAGE_SIZE, PAGE_SIZE,
+                            0);
+  }
+}
+
+// Add a segment to a manifest and make room for the hashes of its pages.
+//
+// args: manifest is the manifest to add the segment to.
+//       phys_start is the physical address of the segment.
+//       num_pages is the size of the segment in pages, at least 1.
+//       first_page will be set to the index of the first page of the segment
+//       in the hash array.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE.
+//
+unsigned int manifest_add_segment(page_manifest_t *manifest,
+                                  uint64_t phys_start, uint64_t num_pages,
+                                  uint64_t *first_page) {
+  uint64_t total_pages = manifest->num_pages + num_pages;
+  uint64_t old_bitmap_size = (manifest->num_pages + 7) / 8;
+  uint64_t bitmap_size = (total_pages + 7) / 8;
+
+  manifest_segment_t *segments = (manifest_segment_t *)realloc(
+      manifest->segments,
+      (manifest->num_segments + 1) * sizeof(manifest_segment_t));
+  if (segments == NULL) {
+    return EXIT_FAILURE;
+  }
+  manifest->segments = segments;
+  uint64_t *hashes = (uint64_t *)realloc(manifest->hashes,
+                                         total_pages * sizeof(uint64_t));
+  if (hashes == NULL) {
+    return EXIT_FAILURE;
+  }
+  manifest->hashes = hashes;
+  uint8_t *changed = (uint8_t *)realloc(manifest->changed, bitmap_size);
+  if (changed == NULL) {
+    return EXIT_FAILURE;
+  }
+  bzero(changed + old_bitmap_size, bitmap_size - old_bitmap_size);
+  manifest->changed = changed;
+  segments[manifest->num_segments].phys_start = phys_start;
+  segments[manifest->num_segments].num_pages = num_pages;
+  segments[manifest->num_segments].first_page = manifest->num_pages;
+  *first_page = manifest->num_pages;
+  manifest->num_segments++;
+  manifest->num_pages = total_pages;
+  return EXIT_SUCCESS;
+}
+
+// Look up the hash of a page in a loaded manifest with a binary search.
+//
+// args: manifest is a manifest with segments sorted by physical address.
+//       phys_addr is the physical address of the page.
+//       hash will be set to the hash of the page.
+//
+// return: true if the page is in the manifest.
+//
+bool manifest_find_page(const page_manifest_t *manifest, uint64_t phys_addr,
+                        uint64_t *hash) {
+  uint32_t low = 0;
+  uint32_t high = manifest->num_segments;
+
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2;
+    const manifest_segment_t *segment = &manifest->segments[mid];
+    if (phys_addr < segment->phys_start) {
+      high = mid;
+    } else if (phys_addr - segment->phys_start >=
+               segment->num_pages * PAGE_SIZE) {
+      low = mid + 1;
+    } else {
+      *hash = manifest->hashes[segment->first_page +
+                               (phys_addr - segment->phys_start) / PAGE_SIZE];
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if page number page of a manifest was written to the image.
+static inline bool page_changed(const page_manifest_t *manifest,
+                                uint64_t page) {
+  return (manifest->changed[page / 8] >> (page % 8)) & 1;
+}
+
+// Compare the hashes of the pages of a block with the baseline of the
+// pipeline and mark the pages that changed, or all pages if there is no
+// baseline. Only the writer calls this, so the bitmap needs no lock.
+//
+// args: pipe is the pipeline the block belongs to.
+//       offset is the offset of the block in the segment.
+//       len is the size of the block in bytes.
+//
+// return: the number of pages that changed.
+//
+uint64_t diff_pages(copy_pipeline_t *pipe, uint64_t offset, uint64_t len) {
+  page_manifest_t *manifest = pipe->manifest;
+  uint64_t first = pipe->first_page + offset / PAGE_SIZE;
+  uint64_t changed = 0;
+
+  for (uint64_t page = 0; page < len / PAGE_SIZE; page++) {
+    uint64_t hash = 0;
+    if (pipe->baseline != NULL &&
+        manifest_find_page(pipe->baseline,
+                           pipe->phys_start + offset + page * PAGE_SIZE,
+                           &hash) &&
+        hash == manifest->hashes[first + page]) {
+      continue;
+    }
+    manifest->changed[(first + page) / 8] |= 1 << ((first + page) % 8);
+    changed++;
+  }
+  manifest->num_changed += changed;
+  return changed;
+}
+
+// Write the pages of a block that diff_pages() marked as changed to the image.
+// Runs of changed pages are written at once, unchanged pages are skipped and
+// leave a hole in the image.
+//
+// args: pipe is the pipeline the block belongs to.
+//       slot is the ring slot holding the block.
+//       dump_file is an open filehandle to the image file.
+//       file_offset is the offset in the image file to write the block to.
+//       offset is the offset of the block in the segment.
+//       len is the size of the block in bytes.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE.
+//
+unsigned int write_changed_pages(copy_pipeline_t *pipe, unsigned int slot,
+                                 int dump_file, uint64_t file_offset,
+                                 uint64_t offset, uint64_t len) {
+  uint64_t first = pipe->first_page + offset / PAGE_SIZE;
+  uint64_t num_pages = len / PAGE_SIZE;
+  uint64_t page = 0;
+
+  while (page < num_pages) {
+    if (!page_changed(pipe->manifest, first + page)) {
+      page++;
+      continue;
+    }
+    uint64_t run_start = page;
+    while (page < num_pages && page_changed(pipe->manifest, first + page)) {
+      page++;
+    }
+    if (write_fully(dump_file, pipe->slots[slot] + run_start * PAGE_SIZE,
+                    (page - run_start) * PAGE_SIZE,
+                    file_offset + run_start * PAGE_SIZE) == EXIT_FAILURE) {
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+// Write a manifest to a file (see manifest.h).
+//
+// args: file is an open filehandle to the manifest file.
+//       manifest is the manifest to write.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE.
+//
+unsigned int write_manifest(int file, const page_manifest_t *manifest) {
+  manifest_header_t header;
+
+  bzero(&header, sizeof(manifest_header_t));
+  memcpy(header.magic, MANIFEST_MAGIC, sizeof(header.magic));
+  header.version = MANIFEST_VERSION;
+  header.hash_type = MANIFEST_HASH_XXH64;
+  header.page_size = PAGE_SIZE;
+  header.num_segments = manifest->num_segments;
+  header.num_pages = manifest->num_pages;
+  header.num_changed = manifest->num_changed;
+  header.segments_offset = sizeof(manifest_header_t);
+  header.hashes_offset = (header.segments_offset + header.num_segments *
+                          sizeof(manifest_segment_t));
+  header.changed_offset = (header.hashes_offset +
+                           header.num_pages * sizeof(uint64_t));
+  if (write_fully(file, (uint8_t *)&header, sizeof(manifest_header_t),
+                  0) == EXIT_FAILURE ||
+      write_fully(file, (uint8_t *)manifest->segments,
+                  header.num_segments * sizeof(manifest_segment_t),
+                  header.segments_offset) == EXIT_FAILURE ||
+      write_fully(file, (uint8_t *)manifest->hashes,
+                  header.num_pages * sizeof(uint64_t),
+                  header.hashes_offset) == EXIT_FAILURE ||
+      write_fully(file, manifest->changed, (header.num_pages + 7) / 8,
+                  header.changed_offset) == EXIT_FAILURE) {
+    PMEM_ERROR_LOG("Failed to write manifest");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+// Orders manifest segments by physical address for qsort().
+static int compare_segments(const void *a, const void *b) {
+  const manifest_segment_t *segment_a = (const manifest_segment_t *)a;
+  const manifest_segment_t *segment_b = (const manifest_segment_t *)b;
+
+  if (segment_a->phys_start < segment_b->phys_start) {
+    return -1;
+  }
+  return segment_a->phys_start > segment_b->phys_start;
+}
+
+// Load a manifest written by write_manifest() and sort its segments, so pages
+// can be looked up with manifest_find_page(). Call free_manifest() when done.
+//
+// args: file is an open filehandle to the manifest file.
+//       manifest is the manifest to load into, it must be empty.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE.
+//
+unsigned int load_manifest(int file, page_manifest_t *manifest) {
+  manifest_header_t header;
+
+  bzero(manifest, sizeof(page_manifest_t));
+  if (read_fully(file, (uint8_t *)&header, sizeof(manifest_header_t),
+                 0) == EXIT_FAILURE) {
+    PMEM_ERROR_LOG("Failed to read manifest header");
+    return EXIT_FAILURE;
+  }
+  if (memcmp(header.magic, MANIFEST_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != MANIFEST_VERSION ||
+      header.hash_type != MANIFEST_HASH_XXH64 ||
+      header.page_size != PAGE_SIZE) {
+    print_msg(STD, "Not a manifest or unsupported version\n");
+    return EXIT_FAILURE;
+  }
+  manifest->segments = (manifest_segment_t *)malloc(
+      header.num_segments * sizeof(manifest_segment_t) + 1);
+  manifest->hashes = (uint64_t *)malloc(
+      header.num_pages * sizeof(uint64_t) + 1);
+  manifest->changed = (uint8_t *)malloc((header.num_pages + 7) / 8 + 1);
+  if (manifest->segments == NULL || manifest->hashes == NULL ||
+      manifest->changed == NULL) {
+    PMEM_ERROR_LOG("Could not allocate memory for the manifest");
+    goto error;
+  }
+  if (read_fully(file, (uint8_t *)manifest->segments,
+                 header.num_segments * sizeof(manifest_segment_t),
+                 header.segments_offset) == EXIT_FAILURE ||
+      read_fully(file, (uint8_t *)manifest->hashes,
+                 header.num_pages * sizeof(uint64_t),
+                 header.hashes_offset) == EXIT_FAILURE ||
+      read_fully(file, manifest->changed, (header.num_pages + 7) / 8,
+                 header.changed_offset) == EXIT_FAILURE) {
+    PMEM_ERROR_LOG("Failed to read manifest");
+    goto error;
+  }
+  manifest->num_segments = header.num_segments;
+  manifest->num_pages = header.num_pages;
+  manifest->num_changed = header.num_changed;
+  for (uint32_t i = 0; i < manifest->num_segments; i++) {
+    if (manifest->segments[i].first_page > manifest->num_pages ||
+        manifest->segments[i].num_pages >
+        manifest->num_pages - manifest->segments[i].first_page) {
+      print_msg(STD, "Manifest segment %d is corrupted\n", i);
+      goto error;
+    }
+  }
+  qsort(manifest->segments, manifest->num_segments,
+        sizeof(manifest_segment_t), compare_segments);
+  return EXIT_SUCCESS;
+error:
+  free_manifest(manifest);
+  return EXIT_FAILURE;
+}
+
+// Free the memory of a manifest and reset it to an empty one.
+void free_manifest(page_manifest_t *manifest) {
+  free(manifest->segments);
+  free(manifest->hashes);
+  free(manifest->changed);
+  bzero(manifest, sizeof(page_manifest_t));
+}
+
+// Set the manifest the pages copied by write_segment() are hashed into, and
+// the baseline they are compared with. Pages with the same hash as in the
+// baseline are not written. Both may be NULL to turn this off.
+void set_page_manifest(page_manifest_t *manifest, page_manifest_t *baseline) {
+  page_manifest = manifest;
+  page_baseline = baseline;
+}
+
 // Send an ioctl to the driver to get the physical memory map.
 // Will also retrieve the size of the map and its descriptors.
 // This function will allocate memory for mmap, make sure you free it.
@@ -860,6 +1943,100 @@ unsigned int unload_kext(void) {
   return status;
 }
 
+// Set the number of threads reading from the memory device.
+//
+// args: threads is the number of reader threads, 1 to PMEM_MAX_THREADS.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE if the number is out of range.
+//
+unsigned int set_copy_threads(unsigned int threads) {
+  if (threads < 1 || threads > PMEM_MAX_THREADS) {
+    print_msg(STD, "Number of threads must be between 1 and %d\n",
+              PMEM_MAX_THREADS);
+    return EXIT_FAILURE;
+  }
+  copy_threads = threads;
+  return EXIT_SUCCESS;
+}
+
+// Set the size of the blocks segments are copied in.
+//
+// args: size is the block size in bytes, a multiple of the page size up to
+//       PMEM_MAX_BLOCK_SIZE.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE if the size is invalid.
+//
+unsigned int set_copy_block_size(uint64_t size) {
+  if (size == 0 || size % PAGE_SIZE || size > PMEM_MAX_BLOCK_SIZE) {
+    print_msg(STD, "Block size must be a multiple of %d bytes up to %d\n",
+              PAGE_SIZE, PMEM_MAX_BLOCK_SIZE);
+    return EXIT_FAILURE;
+  }
+  copy_block_size = size;
+  return EXIT_SUCCESS;
+}
+
+// Parse a size given on the command line. The number may be followed by a k, m
+// or g suffix to give it in KiB, MiB or GiB.
+//
+// args: arg is the string to parse.
+//       size is a pointer to the uint64_t that will recieve the size in bytes.
+//
+// return: EXIT_SUCCESS or EXIT_FAILURE if arg is not a size.
+//
+unsigned int parse_size(const char *arg, uint64_t *size) {
+  char *end = NULL;
+  unsigned long long value = 0;
+  uint64_t mult = 1;
+
+  errno = 0;
+  value = strtoull(arg, &end, 0);
+  if (errno != 0 || end == arg) {
+    return EXIT_FAILURE;
+  }
+  switch (*end) {
+    case 'g':
+    case 'G':
+      mult <<= 10;
+    case 'm':
+    case 'M':
+      mult <<= 10;
+    case 'k':
+    case 'K':
+      mult <<= 10;
+      end++;
+    case '\0':
+      break;
+    default:
+      return EXIT_FAILURE;
+  }
+  if (*end != '\0' || value > UINT64_MAX / mult) {
+    return EXIT_FAILURE;
+  }
+  *size = value * mult;
+  return EXIT_SUCCESS;
+}
+
+// Print how long the acquisition took and how fast memory was copied.
+//
+// args: start is the time the acquisition started at.
+//
+void report_throughput(const struct timeval *start) {
+  struct timeval now;
+  double seconds = 0;
+  double mib = bytes_copied / (1024.0 * 1024.0);
+
+  gettimeofday(&now, NULL);
+  seconds = (now.tv_sec - start->tv_sec) +
+            (now.tv_usec - start->tv_usec) / 1000000.0;
+  print_msg(STD, "Copied %.1f MiB in %.2f seconds", mib, seconds);
+  if (seconds > 0) {
+    print_msg(STD, " (%.1f MiB/s)", mib / seconds);
+  }
+  print_msg(STD, " using %u threads and %lld KiB blocks\n", copy_threads,
+            copy_block_size / 1024);
+}
+
 // Main dispatch function for memory dumps. Will load the driver, acquire the
 // memory map and invoke the correct imaging function. Also cleans up after
 // itself, so it returns void.
@@ -871,6 +2048,37 @@ unsigned int dump_memory(const char *dump_file_path,
   int dump_file = -1;
   uint64_t kernel_dtb = 0;
   int status = EXIT_FAILURE;
+  struct timeval start;
+  page_manifest_t manifest;
+  page_manifest_t baseline;
+  char *manifest_path = NULL;
+  int manifest_file = -1;
+
+  bzero(&manifest, sizeof(page_manifest_t));
+  bzero(&baseline, sizeof(page_manifest_t));
+  if (baseline_path != NULL) {
+    if ((manifest_file = open(baseline_path, O_RDONLY)) == -1) {
+      PMEM_ERROR_LOG("Error opening baseline manifest %s", baseline_path);
+      goto error_kext;
+    }
+    status = load_manifest(manifest_file, &baseline);
+    close(manifest_file);
+    if (status == EXIT_FAILURE) {
+      print_msg(STD, "Failed to load baseline manifest %s\n", baseline_path);
+      goto error_kext;
+    }
+    status = EXIT_FAILURE;
+  }
+  if (manifest_enabled) {
+    manifest_path = (char *)malloc(strlen(dump_file_path) +
+                                   sizeof(".manifest"));
+    if (manifest_path == NULL) {
+      PMEM_ERROR_LOG("Could not allocate memory for the manifest path");
+      goto error_kext;
+    }
+    sprintf(manifest_path, "%s.manifest", dump_file_path);
+    set_page_manifest(&manifest, baseline_path ? &baseline : NULL);
+  }
 
   if (load_kext()) {
     PMEM_ERROR_LOG("Failed to load kext");
@@ -889,6 +2097,8 @@ unsigned int dump_memory(const char *dump_file_path,
   if (set_mmap_method(mem_dev, pmem_mmap_method) == EXIT_FAILURE) {
     PMEM_ERROR_LOG("Error setting mmap method, will continue with default");
   }
+  bytes_copied = 0;
+  gettimeofday(&start, NULL);
   // Now dump the memory in the preferred format
   switch (dumpformat) {
     case RAW_PADDED:
@@ -917,6 +2127,35 @@ unsigned int dump_memory(const char *dump_file_path,
       print_msg(STD, "Successfully wrote elf image of memory to %s\n",
                 dump_file_path);
       break;
+
+    case CHUNKED:
+      if (dump_memory_chunked(mem_dev, dump_file)) {
+        print_msg(STD, "Error dumping chunked image of memory\n");
+        goto error;
+      }
+      print_msg(STD, "Successfully wrote chunked image of memory to %s\n",
+                dump_file_path);
+      break;
+  }
+  report_throughput(&start);
+  if (manifest_enabled) {
+    if ((manifest_file = open(manifest_path, O_RDWR | O_CREAT | O_TRUNC,
+                              0440)) == -1) {
+      PMEM_ERROR_LOG("Error opening manifest file");
+      goto error;
+    }
+    if (write_manifest(manifest_file, &manifest) == EXIT_FAILURE) {
+      close(manifest_file);
+      goto error;
+    }
+    close(manifest_file);
+    print_msg(STD, "Wrote hashes of %lld pages to %s", manifest.num_pages,
+              manifest_path);
+    if (baseline_path != NULL) {
+      print_msg(STD, ", %lld pages changed since the baseline",
+                manifest.num_changed);
+    }
+    print_msg(STD, "\n");
   }
   if (get_dtb(mem_dev, &kernel_dtb) == EXIT_FAILURE) {
     print_msg(STD, "Error, could not get dtb from driver\n");
@@ -934,6 +2173,10 @@ error_memdev:
     status = EXIT_FAILURE;
   }
 error_kext:
+  set_page_manifest(NULL, NULL);
+  free_manifest(&manifest);
+  free_manifest(&baseline);
+  free(manifest_path);
   return status;
 }
 
@@ -942,6 +2185,7 @@ error_kext:
 int main(int argc, char **argv) {
   int opt = 0;
   int long_index = 0;
+  uint64_t size = 0;
   unsigned int status = EXIT_SUCCESS;
 
   while ((opt =
@@ -978,11 +2222,42 @@ int main(int argc, char **argv) {
           dumpformat = RAW_PADDED;
           break;
         }
+        if (strcmp(optarg, "chunked") == 0) {
+          dumpformat = CHUNKED;
+          break;
+        }
         print_msg(STD, "Output format %s not supported!\n", optarg);
         display_usage(argv[0]);
         status = EXIT_FAILURE;
         break;
 
+      case 't': // Set number of reader threads
+        if (set_copy_threads(atoi(optarg)) == EXIT_FAILURE) {
+          display_usage(argv[0]);
+          status = EXIT_FAILURE;
+          goto end;
+        }
+        break;
+
+      case 'b': // Set copy block size
+        if (parse_size(optarg, &size) == EXIT_FAILURE ||
+            set_copy_block_size(size) == EXIT_FAILURE) {
+          print_msg(STD, "Invalid block size %s\n", optarg);
+          display_usage(argv[0]);
+          status = EXIT_FAILURE;
+          goto end;
+        }
+        break;
+
+      case 'H': // Write a manifest of page hashes
+        manifest_enabled = true;
+        break;
+
+      case 'B': // Only write pages that changed since a baseline manifest
+        baseline_path = optarg;
+        manifest_enabled = true;
+        break;
+
       case 'h': // Display help and exit
         display_usage(argv[0]);
         goto end;
@@ -1011,6 +2286,12 @@ int main(int argc, char **argv) {
     status = EXIT_FAILURE;
     goto end;
   }
+  if (baseline_path != NULL && dumpformat == CHUNKED) {
+    print_msg(STD, "A baseline can't be used with the chunked format\n");
+    display_usage(argv[0]);
+    status = EXIT_FAILURE;
+    goto end;
+  }
   // the last remaining argument is the name of the dumpfile.
   status = dump_memory(argv[optind], device_path);
 end:
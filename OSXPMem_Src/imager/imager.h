@@ -23,6 +23,7 @@
 #include <mach/vm_param.h>
 #include <mach-o/loader.h>
 #include <pexpert/i386/boot.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -31,7 +32,9 @@
 #include <strings.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <unistd.h>
+#include <zlib.h>
 
 // This interface is available only since Snow Leopard (10.6).
 #define MAX_OS_X_VERSION_MIN_REQUIRED 1060
@@ -39,6 +42,10 @@
 
 // GNU C Library ELF Headers
 #include "elf.h"
+// Chunked image format
+#include "chunked.h"
+// Page hash manifest
+#include "manifest.h"
 // IOCTL numbers for the pmem kext.
 #include "../pmem/pmem_ioctls.h"
 
@@ -48,6 +55,12 @@
 #define PMEM_KEXT_PATH "./pmem.kext"
 #define PMEM_KEXT_IDENTIFIER "com.rekall.driver"
 
+// Defaults and limits for the segment copy pipeline (see write_segment()).
+#define PMEM_DEFAULT_THREADS 4
+#define PMEM_MAX_THREADS 64
+#define PMEM_DEFAULT_BLOCK_SIZE (4 * 1024 * 1024)
+#define PMEM_MAX_BLOCK_SIZE (1024 * 1024 * 1024)
+
 // This is externalized to simplify modifying the error output.
 #define PMEM_ERROR_LOG(...) do { print_msg(ERR, "%s(%d): ", \
                                                 __func__, __LINE__); \
@@ -72,9 +85,63 @@ extern loglevel_t loglevel;
 typedef enum {
   RAW_PADDED,
   MACH_O,
-  ELF
+  ELF,
+  CHUNKED
 } dumpformat_t;
 
+// Growing array of the chunks written to a chunked image.
+typedef struct {
+  chunked_entry_t *entries;
+  uint64_t num_entries;
+  uint64_t capacity;
+} chunked_index_t;
+
+// Page hashes of an acquisition, see manifest.h. The segments of a loaded
+// manifest are sorted by physical address.
+typedef struct {
+  manifest_segment_t *segments;
+  uint32_t num_segments;
+  uint64_t *hashes;
+  uint8_t *changed;
+  uint64_t num_pages;
+  uint64_t num_changed;
+} page_manifest_t;
+
+// State shared by the reader threads and the writer while copying a segment.
+// Block n of the segment goes through ring slot n % num_slots. A reader only
+// claims a block after the writer has flushed the block that used the slot
+// before, so at most num_slots blocks are buffered at any time.
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int mem_dev;
+  uint64_t phys_start;      // Physical address of the first block
+  uint64_t size;            // Size of the segment in bytes
+  uint64_t block_size;
+  uint64_t num_blocks;
+  uint64_t next_block;      // Next block a reader will claim
+  uint64_t blocks_written;  // Blocks the writer has flushed so far
+  unsigned int num_slots;
+  uint8_t **slots;
+  bool *slot_full;
+  bool failed;
+  // Only used for chunked images, NULL otherwise. The readers compress each
+  // block into the packed buffer of its slot and describe its chunks in the
+  // chunks array of the slot.
+  chunked_index_t *index;
+  uint8_t **packed;
+  uint64_t *packed_size;
+  chunked_entry_t **chunks;
+  unsigned int *num_chunks;
+  // Only used when hashing pages, NULL otherwise. The readers hash each page
+  // of their block into the manifest, starting at page first_page for the
+  // first page of the segment. The writer compares the hashes with the
+  // baseline, if there is one, and skips the pages that did not change.
+  page_manifest_t *manifest;
+  const page_manifest_t *baseline;
+  uint64_t first_page;
+} copy_pipeline_t;
+
 // Get the physical memory map from the driver.
 unsigned int get_mmap(uint8_t **mmap, unsigned int *mmap_size,
                       unsigned int *mmap_desc_size, int device_file);
@@ -101,10 +168,62 @@ void prepare_macho_segment(segment_command_t *load_command,
                            EfiMemoryRange *segment, uint64_t file_offset);
 unsigned int dump_memory_macho(int mem_dev, int dump_file);
 
+// Functions for writing and reading chunked images.
+bool buffer_is_zero(const uint8_t *buf, uint64_t len);
+void pack_block(copy_pipeline_t *pipe, unsigned int slot, uint64_t phys_addr,
+                uint64_t len);
+unsigned int append_chunks(chunked_index_t *index, chunked_entry_t *chunks,
+                           unsigned int num_chunks);
+unsigned int write_chunks(copy_pipeline_t *pipe, unsigned int slot,
+                          int dump_file, uint64_t *file_offset);
+unsigned int dump_memory_chunked(int mem_dev, int dump_file);
+unsigned int load_chunked_index(int image, chunked_header_t *header,
+                                chunked_entry_t **index);
+chunked_entry_t *find_chunk(const chunked_header_t *header,
+                            chunked_entry_t *index, uint64_t phys_addr);
+unsigned int read_chunked(int image, const chunked_header_t *header,
+                          chunked_entry_t *index, uint64_t phys_addr,
+                          uint8_t *buf, uint64_t len);
+
+// Functions for hashing pages and comparing them to a baseline.
+uint64_t xxhash64(const uint8_t *buf, uint64_t len, uint64_t seed);
+void hash_pages(copy_pipeline_t *pipe, unsigned int slot, uint64_t offset,
+                uint64_t len);
+unsigned int manifest_add_segment(page_manifest_t *manifest,
+                                  uint64_t phys_start, uint64_t num_pages,
+                                  uint64_t *first_page);
+bool manifest_find_page(const page_manifest_t *manifest, uint64_t phys_addr,
+                        uint64_t *hash);
+uint64_t diff_pages(copy_pipeline_t *pipe, uint64_t offset, uint64_t len);
+unsigned int write_changed_pages(copy_pipeline_t *pipe, unsigned int slot,
+                                 int dump_file, uint64_t file_offset,
+                                 uint64_t offset, uint64_t len);
+unsigned int write_manifest(int file, const page_manifest_t *manifest);
+unsigned int load_manifest(int file, page_manifest_t *manifest);
+void free_manifest(page_manifest_t *manifest);
+// Hash pages into manifest while copying, and only write pages that changed
+// since baseline. Either may be NULL.
+void set_page_manifest(page_manifest_t *manifest, page_manifest_t *baseline);
+
 // Generic acquisition functions.
 unsigned int write_header(int file, uint8_t *header, unsigned int header_size);
+unsigned int copy_segment(EfiMemoryRange *segment, int mem_dev, int dump_file,
+                          uint64_t *file_offset, chunked_index_t *index);
 unsigned int write_segment(EfiMemoryRange *segment, int mem_dev,
                                   int dump_file, uint64_t file_offset);
+// Transfer exactly nbytes at offset, retrying short reads and writes.
+unsigned int read_fully(int fd, uint8_t *buf, uint64_t nbytes, uint64_t offset);
+unsigned int write_fully(int fd, const uint8_t *buf, uint64_t nbytes,
+                         uint64_t offset);
+// Reader thread of the segment copy pipeline.
+void *read_blocks(void *arg);
+// Set the number of reader threads and the size of a single read or write.
+unsigned int set_copy_threads(unsigned int threads);
+unsigned int set_copy_block_size(uint64_t size);
+// Parse a size argument with an optional k, m or g suffix.
+unsigned int parse_size(const char *arg, uint64_t *size);
+// Print the throughput of the acquisition started at start.
+void report_throughput(const struct timeval *start);
 // Dump physical memory to a file.
 unsigned int dump_memory(char const *dump_file_path,
                          char const *device_file_path);
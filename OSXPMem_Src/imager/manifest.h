@@ -0,0 +1,58 @@
+// Copyright 2012 Google Inc. All Rights Reserved.
+// Author: Johannes Stüttgen (johannes.stuettgen@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Layout of the page manifest written next to an image. All fields are little
+// endian.
+//
+// The file starts with a manifest_header_t, followed by one manifest_segment_t
+// for each accessible segment of the physical memory map, an array of one 64
+// bit XXH64 hash (seed 0) per page and a bitmap with one bit per page. Page i
+// of the manifest is page (i - first_page) of the segment containing it. Bit
+// (i % 8) of byte (i / 8) of the bitmap is set if page i was written to the
+// image. When imaging against a baseline manifest, pages whose hash did not
+// change are not written and have their bit cleared, their contents must be
+// taken from the baseline image.
+
+#ifndef _REKALL_MANIFEST_H_
+#define _REKALL_MANIFEST_H_
+
+#include <stdint.h>
+
+#define MANIFEST_MAGIC      "PMEMHASH"  // Magic at the beginning of the file
+#define MANIFEST_VERSION    1           // Version of the format
+#define MANIFEST_HASH_XXH64 1           // Hash function used for the pages
+
+// File header
+typedef struct manifest_header_ {
+  char     magic[8];          // MANIFEST_MAGIC, not zero terminated
+  uint32_t version;           // MANIFEST_VERSION
+  uint32_t hash_type;         // MANIFEST_HASH_XXH64
+  uint32_t page_size;         // Size of a hashed page
+  uint32_t num_segments;      // Entries in the segment table
+  uint64_t num_pages;         // Entries in the hash array
+  uint64_t num_changed;       // Pages written to the image
+  uint64_t segments_offset;   // File offset of the segment table
+  uint64_t hashes_offset;     // File offset of the hash array
+  uint64_t changed_offset;    // File offset of the bitmap of written pages
+} manifest_header_t;
+
+// Hashed segment of physical memory
+typedef struct manifest_segment_ {
+  uint64_t phys_start;        // Physical start address
+  uint64_t num_pages;         // Size in pages
+  uint64_t first_page;        // Index of the first page in the hash array
+} manifest_segment_t;
+
+#endif  // _REKALL_MANIFEST_H_
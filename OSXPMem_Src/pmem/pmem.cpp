@@ -21,6 +21,8 @@
 
 #include "pte_mmap_osx.h"
 
+#include <IOKit/IOLocks.h>
+
 // Toggle this flag to enable/disable debug logging.
 static const boolean_t pmem_debug_logging = TRUE;
 
@@ -86,6 +88,16 @@ static uint32_t pmem_mmap_size;
 // Default is using IOKit, which is stable, but easy to fool by a rootkit.
 static int pmem_mmap_method = PMEM_MMAP_IOKIT;
 
+// Physical memory is mapped in windows of up to this many bytes, which are
+// kept mapped until they are replaced by newer ones.
+static uint64_t pmem_window_size = PMEM_WINDOW_SIZE_DEFAULT;
+// Number of windows that are mapped at the same time.
+static const unsigned int pmem_num_windows = 8;
+// Cache of the currently mapped windows.
+static PMEM_WINDOW_CACHE pmem_windows;
+// Serializes reads, as they share the window cache and the rogue page.
+static IOLock *pmem_read_lock = NULL;
+
 // This function is called whenever a program in user space tries to read from
 // the device file. It will dispatch the appropriate function for the file that
 // is read by inspecting the given minor number.
@@ -125,6 +137,7 @@ static kern_return_t pmem_write(dev_t dev, struct uio *uio, __unused int rw) {
 static kern_return_t pmem_read_memory(struct uio *uio) {
   size_t read_bytes = 0;
 
+  IOLockLock(pmem_read_lock);
   while (uio_resid(uio) > 0) {
     uio_update(uio, 0);
     // Try to read as many times as necessary until the uio is full.
@@ -132,103 +145,156 @@ static kern_return_t pmem_read_memory(struct uio *uio) {
                                    uio_offset(uio) + uio_curriovlen(uio));
     uio_update(uio, read_bytes);
   }
+  IOLockUnlock(pmem_read_lock);
   return KERN_SUCCESS;
 }
 
-// Map a specific page into kernel virtual memory.
-// Supports multiple methods of mapping, the one used is specified in
-// pmem_mmap_method. Due to the nature of the mapping, old mappings become
-// invalid after calling this function again with a new mapping.
+// Window cache backend that maps a run of physical pages using IOKit.
+// The IOMemoryMap is kept as the handle, as releasing it destroys the mapping.
+static PMEM_WINDOW_STATUS pmem_iokit_map(PMEM_WINDOW_CACHE *self,
+                                         uint64_t phys, uint64_t size,
+                                         uint8_t **vaddr, void **handle) {
+  IOMemoryDescriptor *desc = NULL;
+  IOMemoryMap *map = NULL;
+
+  desc = IOMemoryDescriptor::withPhysicalAddress(phys, size,
+                                                 kIODirectionInOut);
+  if (!desc) {
+    return PMEM_WINDOW_ERROR;
+  }
+  map = desc->createMappingInTask(kernel_task, 0, kIODirectionInOut, 0, 0);
+  if (!map) {
+    desc->release();
+    return PMEM_WINDOW_ERROR;
+  }
+  *vaddr = reinterpret_cast<uint8_t *>(map->getAddress());
+  *handle = map;
+  return PMEM_WINDOW_SUCCESS;
+}
+
+// Destroys a mapping created by pmem_iokit_map().
+static void pmem_iokit_unmap(PMEM_WINDOW_CACHE *self, void *handle) {
+  IOMemoryMap *map = static_cast<IOMemoryMap *>(handle);
+  IOMemoryDescriptor *desc = map->getMemoryDescriptor();
+
+  map->release();
+  desc->release();
+}
+
+// Window cache backend that maps a page by remapping the rogue page of
+// pte_mmap. There is only one rogue page, so windows are always a single page
+// and the cache only has one slot in this mode.
+static PMEM_WINDOW_STATUS pmem_pte_map(PMEM_WINDOW_CACHE *self,
+                                       uint64_t phys, uint64_t size,
+                                       uint8_t **vaddr, void **handle) {
+  if (size != PAGE_SIZE) {
+    return PMEM_WINDOW_ERROR;
+  }
+  if (pte_mmap == NULL) {
+    pte_mmap = pte_mmap_osx_new();
+    if (pte_mmap == NULL) {
+      pmem_log("unable to initialize pte_mmap module, aborting...");
+      return PMEM_WINDOW_ERROR;
+    }
+  }
+  if (pte_mmap->remap_page(pte_mmap, phys) != PTE_SUCCESS) {
+    return PMEM_WINDOW_ERROR;
+  }
+  *vaddr = static_cast<uint8_t *>(pte_mmap->rogue_page.pointer);
+  *handle = NULL;
+  return PMEM_WINDOW_SUCCESS;
+}
+
+// The rogue page stays mapped until it is remapped, nothing to do here.
+static void pmem_pte_unmap(PMEM_WINDOW_CACHE *self, void *handle) {
+}
+
+// Finds the segment of the EFI memory map containing a physical address.
+// Windows are clipped to it, so they never extend into memory mapped I/O or
+// holes in the physical address space.
 //
 // Args:
-//  page:  The physical address of the page to map.
-//  vaddr: A pointer to the pointer that will be set with the address where the
-//         page has been mapped.
+//  phys: The physical address to look up.
+//  start: Will be set to the start of the segment.
+//  end: Will be set to the end of the segment.
 //
 // Returns:
-//  KERN_SUCCESS or KERN_FAILURE.
+//  1 if the address is in a segment that is safe to map as a whole, else 0.
 //
-static kern_return_t pmem_map_physical_page(uint64_t page, void **vaddr) {
-  kern_return_t status = KERN_FAILURE;
-  static IOMemoryDescriptor *page_desc = NULL;
-  static IOMemoryMap *page_map = NULL;
-
-  // Freeing these objects destroys the created mapping, so we have to keep a
-  // reference around until the next call.
-  if (page_desc != NULL) {
-    page_desc->release();
-    page_desc = NULL;
-  }
-  if (page_map != NULL) {
-    page_map->release();
-    page_map = NULL;
+static int pmem_window_range(PMEM_WINDOW_CACHE *self, uint64_t phys,
+                             uint64_t *start, uint64_t *end) {
+  uint32_t offset = 0;
+  EfiMemoryRange *segment = NULL;
+
+  for (offset = 0; offset + pmem_mmap_desc_size <= pmem_mmap_size;
+       offset += pmem_mmap_desc_size) {
+    segment = reinterpret_cast<EfiMemoryRange *>(
+        reinterpret_cast<uint8_t *>(pmem_mmap) + offset);
+    if (phys - segment->PhysicalStart >= segment->NumberOfPages * PAGE_SIZE) {
+      continue;
+    }
+    switch (segment->Type) {
+      case kEfiReservedMemoryType:
+      case kEfiUnusableMemory:
+      case kEfiMemoryMappedIO:
+      case kEfiMemoryMappedIOPortSpace:
+        return 0;
+
+      default:
+        *start = segment->PhysicalStart;
+        *end = segment->PhysicalStart + segment->NumberOfPages * PAGE_SIZE;
+        return 1;
+    }
   }
+  return 0;
+}
 
+// Unmaps all windows and sets up the window cache for the current mmap method.
+// Must be called with pmem_read_lock held, or before the device is created.
+static void pmem_setup_windows(void) {
+  pmem_window_cleanup(&pmem_windows);
   switch (pmem_mmap_method) {
-    case PMEM_MMAP_IOKIT:
-      page_desc = IOMemoryDescriptor::withPhysicalAddress(page,
-                                                          PAGE_SIZE,
-                                                          kIODirectionInOut);
-      if (!page_desc) {
-        goto error;
-      }
-      page_map = page_desc->createMappingInTask(kernel_task, 0, kIODirectionInOut,
-                                                0, 0);
-      if (!page_map) {
-        goto error;
-      }
-      *vaddr = reinterpret_cast<void *>(page_map->getAddress());
-      break;
-
     case PMEM_MMAP_PTE:
-      if (pte_mmap == NULL) {
-        pte_mmap = pte_mmap_osx_new();
-        if (pte_mmap == NULL) {
-          pmem_log("unable to initialize pte_mmap module, aborting...");
-          return KERN_FAILURE;
-        }
-      }
-      if (pte_mmap->remap_page(pte_mmap, page) != PTE_SUCCESS) {
-        goto error;
-      }
-      *vaddr = pte_mmap->rogue_page.pointer;
+      pmem_window_init(&pmem_windows, PAGE_SIZE, 1);
+      pmem_windows.map_ = pmem_pte_map;
+      pmem_windows.unmap_ = pmem_pte_unmap;
       break;
 
     default:
-      goto error;
+      pmem_window_init(&pmem_windows, pmem_window_size, pmem_num_windows);
+      pmem_windows.map_ = pmem_iokit_map;
+      pmem_windows.unmap_ = pmem_iokit_unmap;
+      break;
   }
-  status = KERN_SUCCESS;
-
- error:
-  return status;
+  pmem_windows.range_ = pmem_window_range;
 }
 
-// Copy the requested amount to userspace if it doesn't cross page boundaries
-// or memory mapped io. If it does, stop at the boundary. Will copy zeroes
-// if the given physical address is not backed by physical memory.
+// Copy the requested amount to userspace, as far as it is contiguous in one
+// mapped window. If the run ends at a window boundary, stop there. Will copy
+// zeroes up to the next page boundary if the given physical address can't be
+// mapped.
 //
 // args: uio is the userspace io request object
 // return: number of bytes copied successfully
 //
 static uint64_t pmem_partial_read(struct uio *uio, addr64_t start_addr,
                                   addr64_t end_addr) {
-  void *vaddr_page = NULL;
-  // Separate page and offset
+  uint8_t *vaddr = NULL;
+  uint64_t chunk_len = 0;
   uint64_t page_offset = start_addr & PAGE_MASK;
-  addr64_t page = trunc_page_64(start_addr);
-  // don't copy across page boundaries
-  uint32_t chunk_len = (uint32_t)MIN(PAGE_SIZE - page_offset,
-                                     end_addr - start_addr);
-  if (pmem_map_physical_page(page, &vaddr_page) != KERN_SUCCESS) {
+
+  if (pmem_windows.get(&pmem_windows, start_addr, end_addr, &vaddr,
+                       &chunk_len) != PMEM_WINDOW_SUCCESS) {
     pmem_error("page %#016llx could not be mapped into the kernel, "
-               "zero padding return buffer", page);
+               "zero padding return buffer", trunc_page_64(start_addr));
     // Zero pad this chunk, as it is not inside a valid page frame.
+    chunk_len = MIN(PAGE_SIZE - page_offset, end_addr - start_addr);
     uiomove64((addr64_t)pmem_zero_page + page_offset,
               (uint32_t)chunk_len, uio);
   } else {
-    // Successfully mapped page, copy contents...
-    uiomove64((reinterpret_cast<uint64_t>(vaddr_page) + page_offset),
-              (uint32_t)chunk_len, uio);
+    // Copy the whole run in one go, uiomove64() takes at most 4GB.
+    chunk_len = MIN(chunk_len, UINT32_MAX & ~PAGE_MASK);
+    uiomove64(reinterpret_cast<addr64_t>(vaddr), (uint32_t)chunk_len, uio);
   }
 
   return chunk_len;
@@ -238,6 +304,7 @@ static uint64_t pmem_partial_read(struct uio *uio, addr64_t start_addr,
 static kern_return_t pmem_ioctl(dev_t dev, u_long cmd, caddr_t data, int flag,
                                 struct proc *p) {
   int error = 0;
+  uint64_t window_size = 0;
 
   switch (cmd) {
     case PMEM_IOCTL_GET_MMAP_SIZE:
@@ -275,12 +342,18 @@ static kern_return_t pmem_ioctl(dev_t dev, u_long cmd, caddr_t data, int flag,
       switch (*(reinterpret_cast<int32_t *>(data))) {
         case PMEM_MMAP_IOKIT:
           pmem_log("Setting mmap method to IOKit");
+          IOLockLock(pmem_read_lock);
           pmem_mmap_method = *(reinterpret_cast<int32_t *>(data));
+          pmem_setup_windows();
+          IOLockUnlock(pmem_read_lock);
           break;
 
         case PMEM_MMAP_PTE:
           pmem_log("Setting mmap method to manual PTE remapping");
+          IOLockLock(pmem_read_lock);
           pmem_mmap_method = *(reinterpret_cast<int32_t *>(data));
+          pmem_setup_windows();
+          IOLockUnlock(pmem_read_lock);
           break;
 
         default:
@@ -289,6 +362,20 @@ static kern_return_t pmem_ioctl(dev_t dev, u_long cmd, caddr_t data, int flag,
       }
       break;
 
+    case PMEM_IOCTL_SET_WINDOW_SIZE:
+      window_size = *(reinterpret_cast<uint64_t *>(data));
+      if (window_size < PAGE_SIZE || window_size > PMEM_WINDOW_SIZE_MAX) {
+        pmem_log("Invalid window size %lld, ignoring ioctl SET_WINDOW_SIZE",
+                 window_size);
+        return EINVAL;
+      }
+      pmem_log("Setting window size to %lld bytes", window_size);
+      IOLockLock(pmem_read_lock);
+      pmem_window_size = window_size;
+      pmem_setup_windows();
+      IOLockUnlock(pmem_read_lock);
+      break;
+
     default:
       pmem_error("Illegal ioctl %08lx", cmd);
       return EFAULT;
@@ -362,6 +449,11 @@ static void pmem_error(const char *fmt, ...) {
 //       or returned unmodified in case everything went well.
 // return: the given error argument or KERN_FAILURE if anything went wrong
 static int pmem_cleanup(int error) {
+  pmem_window_cleanup(&pmem_windows);
+  if (pmem_read_lock) {
+    IOLockFree(pmem_read_lock);
+    pmem_read_lock = NULL;
+  }
   if (pmem_zero_page) {
     OSFree(pmem_zero_page, PAGE_SIZE, pmem_tag);
   }
@@ -403,6 +495,11 @@ kern_return_t pmem_start(kmod_info_t * ki, void *d) {
     return pmem_cleanup(KERN_FAILURE);
   }
   bzero(pmem_zero_page, PAGE_SIZE);
+  pmem_read_lock = IOLockAlloc();
+  if (pmem_read_lock == NULL) {
+    pmem_error("Failed to allocate lock for reads");
+    return pmem_cleanup(KERN_FAILURE);
+  }
   // Access the boot arguments through the platform export,
   // and parse the systems physical memory configuration.
   boot_args * ba = reinterpret_cast<boot_args *>(PE_state.bootArgs);
@@ -418,6 +515,8 @@ kern_return_t pmem_start(kmod_info_t * ki, void *d) {
            pmem_mmap, pmem_mmap_size, pmem_mmap_desc_size);
   pmem_log("Number of segments in memory map: %d",
            pmem_mmap_size / pmem_mmap_desc_size);
+  // Windows are clipped to the memory map, so set them up after parsing it.
+  pmem_setup_windows();
   // Install switch table
   pmem_devmajor = cdevsw_add(-1, &pmem_cdevsw);
   if (pmem_devmajor == -1) {
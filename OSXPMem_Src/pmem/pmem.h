@@ -26,6 +26,10 @@
 
 // ioctl commands for this driver
 #include "pmem_ioctls.h"
+// Cache of physical memory mapped into the kernel
+extern "C" {
+  #include "pmem_window.h"
+}
 // variable length function arguments for the logging functions
 #include <stdarg.h>
 // sysctl and general kernel tools
@@ -90,10 +94,27 @@ static kern_return_t pmem_write(dev_t dev, struct uio *uio, __unused int rw);
 static kern_return_t pmem_read_memory(struct uio *uio);
 
 // Will read as many bytes as possible from physical memory,
-// stopping at page boundaries or invalid regions like memory-mapped I/O.
+// stopping at window boundaries or invalid regions like memory-mapped I/O.
 static uint64_t pmem_partial_read(struct uio *uio, addr64_t addr,
                                   uint64_t requested_bytes);
 
+// Map and unmap windows of physical memory for the window cache.
+static PMEM_WINDOW_STATUS pmem_iokit_map(PMEM_WINDOW_CACHE *self,
+                                         uint64_t phys, uint64_t size,
+                                         uint8_t **vaddr, void **handle);
+static void pmem_iokit_unmap(PMEM_WINDOW_CACHE *self, void *handle);
+static PMEM_WINDOW_STATUS pmem_pte_map(PMEM_WINDOW_CACHE *self,
+                                       uint64_t phys, uint64_t size,
+                                       uint8_t **vaddr, void **handle);
+static void pmem_pte_unmap(PMEM_WINDOW_CACHE *self, void *handle);
+
+// Find the memory map segment a window around an address may span.
+static int pmem_window_range(PMEM_WINDOW_CACHE *self, uint64_t phys,
+                             uint64_t *start, uint64_t *end);
+
+// (Re)initialize the window cache for the current mmap method.
+static void pmem_setup_windows(void);
+
 // User-mode interface to obtain the binary memory map
 static kern_return_t pmem_ioctl(dev_t dev, u_long cmd, caddr_t data, int flag,
                                 struct proc *p);
@@ -21,12 +21,18 @@
 #define PMEM_GET_MMAP_DESC_SIZE 2
 #define PMEM_GET_DTB 3
 #define PMEM_SET_MMAP_METHOD 4
+#define PMEM_SET_WINDOW_SIZE 5
 
 #define PMEM_MMAP_TYPE uint64_t
 #define PMEM_MMAP_SIZE_TYPE uint32_t
 #define PMEM_MMAP_DESC_SIZE_TYPE uint32_t
 #define PMEM_DTB_TYPE uint64_t
 #define PMEM_MMAP_METHOD_TYPE int32_t
+#define PMEM_WINDOW_SIZE_TYPE uint64_t
+
+// Physical memory is mapped into the kernel in windows of this size.
+#define PMEM_WINDOW_SIZE_DEFAULT (1024 * 1024)
+#define PMEM_WINDOW_SIZE_MAX (64 * 1024 * 1024)
 
 #define PMEM_IOCTL_BASE 'p'
 
@@ -45,6 +51,9 @@
 #define PMEM_IOCTL_SET_MMAP_METHOD    _IOW(PMEM_IOCTL_BASE, \
                                            PMEM_SET_MMAP_METHOD, \
                                            PMEM_MMAP_METHOD_TYPE)
+#define PMEM_IOCTL_SET_WINDOW_SIZE    _IOW(PMEM_IOCTL_BASE, \
+                                           PMEM_SET_WINDOW_SIZE, \
+                                           PMEM_WINDOW_SIZE_TYPE)
 
 typedef enum PMEM_MMAP_METHOD_ {
   PMEM_MMAP_IOKIT,
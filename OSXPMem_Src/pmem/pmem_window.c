@@ -0,0 +1,209 @@
+// This module maps runs of physical memory into the kernel through a backend
+// and caches the mappings, see pmem_window.h.
+//
+// Copyright 2012 Google Inc. All Rights Reserved.
+// Author: Johannes Stüttgen (johannes.stuettgen@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pmem_window.h"
+
+// These types are defined in OS specific headers, however to remain independent
+// of them we define our own here:
+#define WINDOW_PAGE_SIZE 4096ULL
+#define WINDOW_PAGE_MASK (~(WINDOW_PAGE_SIZE - 1))
+
+// Unmap a window and mark its slot as unused.
+//
+// Args:
+//  self: The this pointer to the object using this function.
+//  window: The window to release.
+//
+static void pmem_window_release(PMEM_WINDOW_CACHE *self, PMEM_WINDOW *window) {
+  if (window->size != 0) {
+    self->unmap_(self, window->handle);
+  }
+  window->phys = 0;
+  window->size = 0;
+  window->vaddr = 0;
+  window->handle = 0;
+  window->last_use = 0;
+}
+
+// Find the slot for a new window. This is an unused slot if there is one,
+// otherwise the least recently used window is unmapped to make room.
+//
+// Args:
+//  self: The this pointer to the object using this function.
+//
+// Returns:
+//  A pointer to an unused slot.
+//
+static PMEM_WINDOW *pmem_window_evict(PMEM_WINDOW_CACHE *self) {
+  PMEM_WINDOW *victim = &self->windows[0];
+  unsigned int i;
+
+  for (i = 0; i < self->num_windows; i++) {
+    if (self->windows[i].size == 0) {
+      return &self->windows[i];
+    }
+    if (self->windows[i].last_use < victim->last_use) {
+      victim = &self->windows[i];
+    }
+  }
+  pmem_window_release(self, victim);
+  return victim;
+}
+
+// Get a kernel virtual address for a physical address, mapping a new window
+// if no cached window contains it.
+//
+// New windows are aligned to the window size and clipped to the range the
+// backend allows around the address, so a window never reaches into memory
+// that is not safe to map. Without such a range, or if mapping the whole
+// window fails, only the page containing the address is mapped.
+//
+// Args:
+//  self: The this pointer to the object using this function.
+//  addr: The physical address to look up.
+//  end: The end of the range the caller wants to access, must be > addr.
+//  vaddr: Will be set to the kernel virtual address of addr.
+//  len: Will be set to the number of bytes from addr up to end that are
+//       accessible at vaddr.
+//
+// Returns:
+//  PMEM_WINDOW_SUCCESS or PMEM_WINDOW_ERROR if the page at addr can't be
+//  mapped.
+//
+static PMEM_WINDOW_STATUS pmem_window_get(PMEM_WINDOW_CACHE *self,
+                                          uint64_t addr, uint64_t end,
+                                          uint8_t **vaddr, uint64_t *len) {
+  PMEM_WINDOW *window = 0;
+  uint64_t start = 0;
+  uint64_t stop = 0;
+  uint64_t range_start = 0;
+  uint64_t range_end = 0;
+  unsigned int i;
+
+  self->use_counter++;
+  for (i = 0; i < self->num_windows; i++) {
+    if (self->windows[i].size != 0 &&
+        addr - self->windows[i].phys < self->windows[i].size) {
+      window = &self->windows[i];
+      self->hits++;
+      break;
+    }
+  }
+  if (window == 0) {
+    self->misses++;
+    window = pmem_window_evict(self);
+    start = addr - addr % self->window_size;
+    stop = start + self->window_size;
+    if (self->range_ != 0 &&
+        self->range_(self, addr, &range_start, &range_end)) {
+      if (range_start > start) {
+        start = range_start & WINDOW_PAGE_MASK;
+      }
+      if (range_end < stop) {
+        stop = (range_end + WINDOW_PAGE_SIZE - 1) & WINDOW_PAGE_MASK;
+      }
+    } else {
+      start = addr & WINDOW_PAGE_MASK;
+      stop = start + WINDOW_PAGE_SIZE;
+    }
+    if (self->map_(self, start, stop - start, &window->vaddr,
+                   &window->handle) != PMEM_WINDOW_SUCCESS) {
+      // Maybe only part of the window is broken, try the single page.
+      if (stop - start == WINDOW_PAGE_SIZE) {
+        return PMEM_WINDOW_ERROR;
+      }
+      start = addr & WINDOW_PAGE_MASK;
+      stop = start + WINDOW_PAGE_SIZE;
+      if (self->map_(self, start, stop - start, &window->vaddr,
+                     &window->handle) != PMEM_WINDOW_SUCCESS) {
+        return PMEM_WINDOW_ERROR;
+      }
+    }
+    window->phys = start;
+    window->size = stop - start;
+  }
+  window->last_use = self->use_counter;
+  *vaddr = window->vaddr + (addr - window->phys);
+  *len = window->phys + window->size - addr;
+  if (*len > end - addr) {
+    *len = end - addr;
+  }
+  return PMEM_WINDOW_SUCCESS;
+}
+
+// Unmap all windows.
+//
+// Args:
+//  self: The this pointer to the object using this function.
+//
+static void pmem_window_flush(PMEM_WINDOW_CACHE *self) {
+  unsigned int i;
+
+  for (i = 0; i < PMEM_WINDOW_MAX_SLOTS; i++) {
+    pmem_window_release(self, &self->windows[i]);
+  }
+}
+
+// Initializer for objects of this class. Takes care of the non-abstract parts
+// of the object.
+//
+// Args:
+//  self: Pointer to the allocated memory for this object.
+//  window_size: Maximum size of a window in bytes.
+//  num_windows: Number of windows kept mapped at the same time.
+//
+void pmem_window_init(PMEM_WINDOW_CACHE *self, uint64_t window_size,
+                      unsigned int num_windows) {
+  unsigned int i;
+
+  // store this pointer
+  self->self = self;
+  // store non-abstract functions in vtable
+  self->get = pmem_window_get;
+  self->flush = pmem_window_flush;
+  self->range_ = 0;
+  // Initialize attributes
+  self->window_size = (window_size + WINDOW_PAGE_SIZE - 1) & WINDOW_PAGE_MASK;
+  if (self->window_size == 0) {
+    self->window_size = WINDOW_PAGE_SIZE;
+  }
+  self->num_windows = num_windows;
+  if (self->num_windows < 1) {
+    self->num_windows = 1;
+  }
+  if (self->num_windows > PMEM_WINDOW_MAX_SLOTS) {
+    self->num_windows = PMEM_WINDOW_MAX_SLOTS;
+  }
+  for (i = 0; i < PMEM_WINDOW_MAX_SLOTS; i++) {
+    self->windows[i].size = 0;
+  }
+  self->use_counter = 0;
+  self->hits = 0;
+  self->misses = 0;
+}
+
+// Call this before freeing the object or changing the backend.
+// Will unmap all windows. Safe to call on a zeroed object that has never been
+// initialized.
+//
+// Args:
+//  self: Pointer to the allocated memory for this object.
+//
+void pmem_window_cleanup(PMEM_WINDOW_CACHE *self) {
+  pmem_window_flush(self);
+}
@@ -0,0 +1,80 @@
+// This module keeps a small cache of windows of physical memory mapped into
+// the kernel. A read of a contiguous run of physical pages is served from a
+// single mapping, instead of mapping and unmapping every page. The actual
+// mapping is done by a backend, which makes it possible to test this code in
+// user space against a fake physical memory.
+//
+// Copyright 2012 Google Inc. All Rights Reserved.
+// Author: Johannes Stüttgen (johannes.stuettgen@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _REKALL_DRIVER_PMEM_WINDOW_H_
+#define _REKALL_DRIVER_PMEM_WINDOW_H_
+
+#include <sys/types.h>
+
+// Maximum number of windows that can be mapped at the same time.
+#define PMEM_WINDOW_MAX_SLOTS 16
+
+// Operating system independent error checking.
+typedef enum PMEM_WINDOW_STATUS_ {
+  PMEM_WINDOW_SUCCESS = 0,
+  PMEM_WINDOW_ERROR
+} PMEM_WINDOW_STATUS;
+
+// A run of physical memory mapped into the kernel.
+typedef struct PMEM_WINDOW_ {
+  uint64_t phys;       // Physical address of the first mapped byte
+  uint64_t size;       // Size of the mapping, 0 if the slot is unused
+  uint8_t *vaddr;      // Kernel virtual address of the mapping
+  void *handle;        // Handle the backend needs to unmap it again
+  uint64_t last_use;   // Value of the use counter when it was last used
+} PMEM_WINDOW;
+
+// Cache of mapped windows with least recently used replacement.
+// Create an object of this type by allocating some memory for it and calling
+// pmem_window_init() on it. Then fill in the backend functions.
+typedef struct PMEM_WINDOW_CACHE_ {
+  // this pointer.
+  struct PMEM_WINDOW_CACHE_ *self;
+  // Public
+  PMEM_WINDOW_STATUS (*get)(struct PMEM_WINDOW_CACHE_ *, uint64_t, uint64_t,
+                            uint8_t **, uint64_t *);
+  void (*flush)(struct PMEM_WINDOW_CACHE_ *);
+  // Private, implemented by the backend. range_ may be NULL.
+  PMEM_WINDOW_STATUS (*map_)(struct PMEM_WINDOW_CACHE_ *, uint64_t, uint64_t,
+                             uint8_t **, void **);
+  void (*unmap_)(struct PMEM_WINDOW_CACHE_ *, void *);
+  int (*range_)(struct PMEM_WINDOW_CACHE_ *, uint64_t, uint64_t *,
+                uint64_t *);
+  void *backend;
+  // Internal Attributes
+  uint64_t window_size;
+  unsigned int num_windows;
+  PMEM_WINDOW windows[PMEM_WINDOW_MAX_SLOTS];
+  uint64_t use_counter;
+  // Statistics
+  uint64_t hits;
+  uint64_t misses;
+} PMEM_WINDOW_CACHE;
+
+// Initializer for newly created objects. window_size is rounded up to whole
+// pages, num_windows is limited to PMEM_WINDOW_MAX_SLOTS.
+void pmem_window_init(PMEM_WINDOW_CACHE *self, uint64_t window_size,
+                      unsigned int num_windows);
+// Call this before freeing the object. Will unmap all windows.
+// Also safe on a zeroed object that was never initialized.
+void pmem_window_cleanup(PMEM_WINDOW_CACHE *self);
+
+#endif  // _REKALL_DRIVER_PMEM_WINDOW_H_
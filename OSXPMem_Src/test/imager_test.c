@@ -96,6 +96,189 @@ void test_dump_memory_macho(void) {
   assert(validate_test_image(kMachTestImagePath) == 0);
 }
 
+// The image must not depend on how the copy is split between threads. The
+// block size does not divide the segment size, so each segment ends with a
+// short block.
+void test_dump_memory_threads(void) {
+  assert(set_copy_threads(3) == EXIT_SUCCESS);
+  assert(set_copy_block_size(3 * PAGE_SIZE) == EXIT_SUCCESS);
+  assert(reset_mock_fs() == EXIT_SUCCESS);
+  assert(dump_memory_raw(MEM_DEV, DUMP_FILE) == EXIT_SUCCESS);
+  assert(validate_test_image(kRawTestImagePath) == 0);
+  assert(reset_mock_fs() == EXIT_SUCCESS);
+  assert(dump_memory_elf(MEM_DEV, DUMP_FILE) == EXIT_SUCCESS);
+  assert(validate_test_image(kElfTestImagePath) == 0);
+  assert(set_copy_threads(PMEM_DEFAULT_THREADS) == EXIT_SUCCESS);
+  assert(set_copy_block_size(PMEM_DEFAULT_BLOCK_SIZE) == EXIT_SUCCESS);
+}
+
+// Every block has to end up at the offset it was read from, no matter which
+// thread read it.
+void test_dump_memory_order(void) {
+  mock_fill = MOCK_FILL_ADDR;
+  assert(set_copy_threads(8) == EXIT_SUCCESS);
+  assert(set_copy_block_size(5 * PAGE_SIZE) == EXIT_SUCCESS);
+  assert(reset_mock_fs() == EXIT_SUCCESS);
+  assert(dump_memory_raw(MEM_DEV, DUMP_FILE) == EXIT_SUCCESS);
+  assert(validate_addr_pattern() == 0);
+  mock_fill = MOCK_FILL_BYTE;
+  assert(set_copy_threads(PMEM_DEFAULT_THREADS) == EXIT_SUCCESS);
+  assert(set_copy_block_size(PMEM_DEFAULT_BLOCK_SIZE) == EXIT_SUCCESS);
+}
+
+// A chunked image of mostly zero memory must be small and every accessible
+// page must read back from it unchanged.
+void test_dump_memory_chunked(void) {
+  chunked_header_t header;
+  chunked_entry_t *index = NULL;
+  uint64_t zero_chunks = 0;
+  uint8_t page[PAGE_SIZE];
+  uint8_t expected[PAGE_SIZE];
+  uint64_t accessible = 0;
+
+  mock_fill = MOCK_FILL_SPARSE;
+  assert(set_copy_block_size(96 * 1024) == EXIT_SUCCESS);
+  assert(reset_mock_fs() == EXIT_SUCCESS);
+  assert(dump_memory_chunked(MEM_DEV, DUMP_FILE) == EXIT_SUCCESS);
+  assert(load_chunked_index(DUMP_FILE, &header, &index) == EXIT_SUCCESS);
+  assert(header.num_segments == kNumMemorySegments);
+  for (uint64_t i = 0; i < header.num_chunks; i++) {
+    zero_chunks += index[i].type == CHUNK_ZERO;
+    assert(i == 0 || index[i].phys_addr > index[i - 1].phys_addr);
+  }
+  assert(zero_chunks > 0);
+  for (int segnum = 0; segnum < kNumMemorySegments; segnum++) {
+    EfiMemoryRange segment;
+    segment.Type = segnum % 15;
+    uint64_t start = (uint64_t)segnum * kNumTestPages * PAGE_SIZE;
+    if (!segment_accessible(&segment)) {
+      assert(find_chunk(&header, index, start) == NULL);
+      continue;
+    }
+    for (int pagenum = 0; pagenum < kNumTestPages; pagenum++) {
+      uint64_t addr = start + pagenum * PAGE_SIZE;
+      assert(read_chunked(DUMP_FILE, &header, index, addr, page,
+                          PAGE_SIZE) == EXIT_SUCCESS);
+      mock_fill_memory(expected, PAGE_SIZE, addr);
+      assert(memcmp(page, expected, PAGE_SIZE) == 0);
+      accessible += PAGE_SIZE;
+    }
+  }
+  // Reads may span chunks and blocks.
+  uint8_t span[3 * PAGE_SIZE];
+  uint64_t span_addr = kNumTestPages * PAGE_SIZE + 96 * 1024 - PAGE_SIZE;
+  assert(read_chunked(DUMP_FILE, &header, index, span_addr, span,
+                      sizeof(span)) == EXIT_SUCCESS);
+  for (int i = 0; i < 3; i++) {
+    mock_fill_memory(expected, PAGE_SIZE, span_addr + i * PAGE_SIZE);
+    assert(memcmp(span + i * PAGE_SIZE, expected, PAGE_SIZE) == 0);
+  }
+  assert(mock_dump_file_size() < accessible / 8);
+  free(index);
+  mock_fill = MOCK_FILL_BYTE;
+  assert(set_copy_block_size(PMEM_DEFAULT_BLOCK_SIZE) == EXIT_SUCCESS);
+}
+
+// Invalid pipeline settings must be rejected.
+void test_copy_settings(void) {
+  uint64_t size = 0;
+
+  assert(set_copy_threads(0) == EXIT_FAILURE);
+  assert(set_copy_threads(PMEM_MAX_THREADS + 1) == EXIT_FAILURE);
+  assert(set_copy_block_size(0) == EXIT_FAILURE);
+  assert(set_copy_block_size(PAGE_SIZE + 512) == EXIT_FAILURE);
+  assert(set_copy_block_size(2ULL * PMEM_MAX_BLOCK_SIZE) == EXIT_FAILURE);
+  assert(parse_size("16k", &size) == EXIT_SUCCESS && size == 16384);
+  assert(parse_size("8M", &size) == EXIT_SUCCESS && size == 8 << 20);
+  assert(parse_size("1g", &size) == EXIT_SUCCESS && size == 1 << 30);
+  assert(parse_size("4096", &size) == EXIT_SUCCESS && size == 4096);
+  assert(parse_size("4x", &size) == EXIT_FAILURE);
+  assert(parse_size("k", &size) == EXIT_FAILURE);
+  assert(parse_size("17179869183G", &size) == EXIT_SUCCESS &&
+         size == 17179869183ULL << 30);
+  assert(parse_size("17179869184G", &size) == EXIT_FAILURE);
+  assert(parse_size("18014398509481984k", &size) == EXIT_FAILURE);
+}
+
+// The page hash must be XXH64, so manifests can be checked with other tools.
+void test_xxhash64(void) {
+  uint8_t buf[PAGE_SIZE];
+
+  for (int i = 0; i < PAGE_SIZE; i++) {
+    buf[i] = i;
+  }
+  assert(xxhash64(buf, 0, 0) == 0xEF46DB3751D8E999ULL);
+  assert(xxhash64((const uint8_t *)"abc", 3, 0) == 0x44BC2CF5AD770999ULL);
+  assert(xxhash64(buf, 37, 0) == 0xD93FA2DFEE5C24C9ULL);
+  assert(xxhash64(buf, PAGE_SIZE, 0) == 0x0F6E64BE186AF6A4ULL);
+}
+
+// A manifest must hash every accessible page, and imaging against it as a
+// baseline must only write the pages that changed.
+void test_dump_memory_manifest(void) {
+  page_manifest_t manifest;
+  page_manifest_t baseline;
+  page_manifest_t delta;
+  uint8_t page[PAGE_SIZE];
+  uint8_t expected[PAGE_SIZE];
+  uint64_t hash = 0;
+
+  bzero(&manifest, sizeof(page_manifest_t));
+  bzero(&delta, sizeof(page_manifest_t));
+  mock_fill = MOCK_FILL_SPARSE;
+  assert(set_copy_threads(3) == EXIT_SUCCESS);
+  assert(set_copy_block_size(5 * PAGE_SIZE) == EXIT_SUCCESS);
+  assert(reset_mock_fs() == EXIT_SUCCESS);
+  set_page_manifest(&manifest, NULL);
+  assert(dump_memory_raw(MEM_DEV, DUMP_FILE) == EXIT_SUCCESS);
+  assert(manifest.num_changed == manifest.num_pages);
+  // The manifest must survive a round trip through a file.
+  assert(reset_mock_fs() == EXIT_SUCCESS);
+  assert(write_manifest(DUMP_FILE, &manifest) == EXIT_SUCCESS);
+  assert(load_manifest(DUMP_FILE, &baseline) == EXIT_SUCCESS);
+  assert(baseline.num_pages == manifest.num_pages);
+  assert(memcmp(baseline.hashes, manifest.hashes,
+                manifest.num_pages * sizeof(uint64_t)) == 0);
+  // Only every 32nd page stays the same when switching to the full pattern.
+  mock_fill = MOCK_FILL_ADDR;
+  assert(reset_mock_fs() == EXIT_SUCCESS);
+  set_page_manifest(&delta, &baseline);
+  assert(dump_memory_raw(MEM_DEV, DUMP_FILE) == EXIT_SUCCESS);
+  set_page_manifest(NULL, NULL);
+  assert(delta.num_pages == manifest.num_pages);
+  assert(delta.num_changed == delta.num_pages - delta.num_pages / 32);
+  for (int segnum = 0; segnum < kNumMemorySegments; segnum++) {
+    EfiMemoryRange segment;
+    segment.Type = segnum % 15;
+    uint64_t start = (uint64_t)segnum * kNumTestPages * PAGE_SIZE;
+    if (!segment_accessible(&segment)) {
+      assert(!manifest_find_page(&baseline, start, &hash));
+      continue;
+    }
+    for (int pagenum = 0; pagenum < kNumTestPages; pagenum++) {
+      uint64_t addr = start + pagenum * PAGE_SIZE;
+      mock_fill_memory(expected, PAGE_SIZE, addr);
+      assert(manifest_find_page(&baseline, addr, &hash));
+      bzero(page, PAGE_SIZE);
+      assert(mock_pread(DUMP_FILE, page, PAGE_SIZE, addr) >= 0);
+      if ((addr / PAGE_SIZE) % 32 == 0) {
+        // Unchanged pages are left out of the delta image.
+        assert(hash == xxhash64(expected, PAGE_SIZE, 0));
+        assert(buffer_is_zero(page, PAGE_SIZE));
+      } else {
+        assert(hash != xxhash64(expected, PAGE_SIZE, 0));
+        assert(memcmp(page, expected, PAGE_SIZE) == 0);
+      }
+    }
+  }
+  free_manifest(&manifest);
+  free_manifest(&baseline);
+  free_manifest(&delta);
+  mock_fill = MOCK_FILL_BYTE;
+  assert(set_copy_threads(PMEM_DEFAULT_THREADS) == EXIT_SUCCESS);
+  assert(set_copy_block_size(PMEM_DEFAULT_BLOCK_SIZE) == EXIT_SUCCESS);
+}
+
 int main(int argc, char **argv) {
   int status = EXIT_FAILURE;
 
@@ -107,6 +290,12 @@ int main(int argc, char **argv) {
   utest_run("creating a raw image", test_dump_memory_raw());
   utest_run("creating an elf image", test_dump_memory_elf());
   utest_run("creating a mach-o image", test_dump_memory_macho());
+  utest_run("creating images with 3 threads", test_dump_memory_threads());
+  utest_run("writing blocks in order", test_dump_memory_order());
+  utest_run("validating copy settings", test_copy_settings());
+  utest_run("creating a chunked image", test_dump_memory_chunked());
+  utest_run("hashing pages", test_xxhash64());
+  utest_run("creating a delta image", test_dump_memory_manifest());
   utest_summary();
   if (cleanup_tests() == EXIT_FAILURE) {
     ERROR_LOG("Failed to release test resources");
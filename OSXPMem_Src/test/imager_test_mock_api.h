@@ -28,6 +28,8 @@
 #define write(fd, buf, n) mock_write(fd, buf, n)
 #define read(fd, buf, n) mock_read(fd, buf, n)
 #define lseek(fd, offset, whence) mock_lseek(fd, offset, whence)
+#define pread(fd, buf, n, offset) mock_pread(fd, buf, n, offset)
+#define pwrite(fd, buf, n, offset) mock_pwrite(fd, buf, n, offset)
 // the mocked imager does not need a main function
 #define main(argc, argv) imager_main(argc, argv)
 
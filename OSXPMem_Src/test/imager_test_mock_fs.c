@@ -28,6 +28,7 @@
 #include "../imager/imager.h"
 #include "../pmem/pmem_ioctls.h"
 
+#include <assert.h>
 #include <fcntl.h>
 #include <limits.h>
 #include <mach/vm_param.h>
@@ -48,14 +49,19 @@ const int kNumTestPages = 128;
 
 // The test memory is a sequence of this byte.
 const uint8_t kTestByte = 0xFF;
+// What the test memory is filled with.
+mock_fill_t mock_fill = MOCK_FILL_BYTE;
 
 // A temporary file that can be used to write test images.
 int temp_file = -1;
-char temp_file_name[] = "/tmp/test_image_XXXXXX";
+static const char kTempFileTemplate[] = "/tmp/test_image_XXXXXX";
+char temp_file_name[sizeof(kTempFileTemplate)];
 
 // Initialize global data structures, create temp files.
 unsigned int init_mock_fs(void) {
   unsigned int status = EXIT_FAILURE;
+  // mkstemp() overwrites the template, so restore it for every reset.
+  memcpy(temp_file_name, kTempFileTemplate, sizeof(kTempFileTemplate));
   temp_file = mkstemp(temp_file_name);
   if (temp_file == -1) {
     ERROR_LOG("Failed to create temp file");
@@ -194,6 +200,71 @@ error:
   return result;
 }
 
+// Checks every accessible page of a raw image of the address pattern.
+//
+// return: 0 if each word in the image holds its own offset, -1 otherwise.
+//
+int validate_addr_pattern(void) {
+  uint64_t buf[PAGE_SIZE / sizeof(uint64_t)];
+
+  for (int segnum = 0; segnum < kNumMemorySegments; segnum++) {
+    EfiMemoryRange segment;
+    segment.Type = segnum % 15;
+    if (!segment_accessible(&segment)) {
+      continue;
+    }
+    for (int page = 0; page < kNumTestPages; page++) {
+      uint64_t addr = ((uint64_t)segnum * kNumTestPages + page) * PAGE_SIZE;
+      if (pread(temp_file, buf, PAGE_SIZE, addr) != PAGE_SIZE) {
+        ERROR_LOG("Failed to read page %#llx of the image", addr);
+        return -1;
+      }
+      for (int word = 0; word < PAGE_SIZE / sizeof(uint64_t); word++) {
+        if (buf[word] != addr + word * sizeof(uint64_t)) {
+          ERROR_LOG("Word %#llx of the image holds %#llx",
+                    addr + word * sizeof(uint64_t), buf[word]);
+          return -1;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+// Fills a buffer with the test memory at a physical address.
+//
+// args: buf is the buffer to fill.
+//       nbytes is the size of the buffer, a multiple of the page size.
+//       offset is the physical address of the buffer, page aligned.
+//
+void mock_fill_memory(void *buf, size_t nbytes, off_t offset) {
+  uint64_t *word = (uint64_t *)buf;
+
+  if (mock_fill == MOCK_FILL_BYTE) {
+    memset(buf, kTestByte, nbytes);
+    return;
+  }
+  for (size_t i = 0; i < nbytes / sizeof(uint64_t); i++) {
+    uint64_t addr = offset + i * sizeof(uint64_t);
+    if (mock_fill == MOCK_FILL_SPARSE && (addr / PAGE_SIZE) % 32 != 0) {
+      word[i] = 0;
+    } else {
+      word[i] = addr;
+    }
+  }
+}
+
+// Returns the size of the mocked dump file, or -1 on errors.
+off_t mock_dump_file_size(void) {
+  struct stat stat_buf;
+
+  if (fstat(temp_file, &stat_buf) != 0) {
+    ERROR_LOG("Failed to get stat for the dump file");
+    return -1;
+  }
+  return stat_buf.st_size;
+}
+
 // Creates a fictional memory map for testing with the mmap functions
 //
 // args: mmap is a pointer which recieves the test memory map
@@ -283,6 +354,37 @@ ssize_t mock_read(int fd, void *buf, size_t nbytes) {
   return nbytes;
 }
 
+// Reads from a buffer with test data instead of a file. Reads from the dump
+// file, done by the chunked image reader, go to the temp file.
+ssize_t mock_pread(int fd, void *buf, size_t nbytes, off_t offset) {
+  uint64_t segment_size = kNumTestPages * PAGE_SIZE;
+  EfiMemoryRange segment;
+
+  // Reads should only occur from the memory device or the dump file,
+  // everything else is a bug.
+  assert(fd == MEM_DEV || fd == DUMP_FILE);
+  if (fd == DUMP_FILE) {
+    return pread(temp_file, buf, nbytes, offset);
+  }
+  // The imager reads whole pages.
+  assert(nbytes > 0 && nbytes % PAGE_SIZE == 0 && offset % PAGE_SIZE == 0);
+  // Reads must stay within one accessible segment of the test memory map.
+  assert(offset / segment_size == (offset + nbytes - 1) / segment_size);
+  segment.Type = (offset / segment_size) % 15;
+  assert(segment_accessible(&segment));
+  mock_fill_memory(buf, nbytes, offset);
+  // Mocked reads never fail, except on failed assertions.
+  return nbytes;
+}
+
+// Writes to the dump file will be stored in the global temp file for
+// comparison with prepared test images.
+ssize_t mock_pwrite(int fd, const void *buf, size_t nbytes, off_t offset) {
+  // The imager should only write to the dumpfile.
+  assert(fd == DUMP_FILE);
+  return pwrite(temp_file, buf, nbytes, offset);
+}
+
 // Seeks in the test data.
 off_t mock_lseek(int fd, off_t offset, int whence) {
   off_t pos = 0;
@@ -21,6 +21,7 @@
 #define _REKALL_PMEM_IMAGER_MOCK_FS_H_
 
 #include <pexpert/i386/boot.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <sys/types.h>
 
@@ -39,6 +40,14 @@ extern const int kNumTestPages;
 
 // The test memory is mock-filled with this byte.
 extern const uint8_t kTestByte;
+// What the test memory is filled with.
+typedef enum {
+  MOCK_FILL_BYTE,    // kTestByte everywhere
+  MOCK_FILL_ADDR,    // The physical address of each 64 bit word, so blocks
+                     // written to the wrong place in an image can be found
+  MOCK_FILL_SPARSE,  // Like MOCK_FILL_ADDR in every 32nd page, zero elsewhere
+} mock_fill_t;
+extern mock_fill_t mock_fill;
 
 unsigned int init_mock_fs(void);
 unsigned int cleanup_mock_fs(void);
@@ -46,6 +55,12 @@ unsigned int reset_mock_fs(void);
 
 // Compare the mocked dump file with a reference file.
 int validate_test_image(const char *reference_image_path);
+// Check that a raw image of the address pattern has every word in place.
+int validate_addr_pattern(void);
+// Fill a buffer with the test memory at a physical address.
+void mock_fill_memory(void *buf, size_t nbytes, off_t offset);
+// Size of the mocked dump file.
+off_t mock_dump_file_size(void);
 
 // Will return test values instead of actually calling the ioctl.
 int mock_ioctl(int fd, unsigned long request, void *outptr);
@@ -58,6 +73,10 @@ int mock_close(int fd);
 ssize_t mock_write(int fd, const void *buf, size_t nbytes);
 // Reads from a buffer with test data instead of a file.
 ssize_t mock_read(int fd, void *buf, size_t nbytes);
+// Reads from the test data or the dump file at an offset.
+ssize_t mock_pread(int fd, void *buf, size_t nbytes, off_t offset);
+// Writes to the dump file at an offset.
+ssize_t mock_pwrite(int fd, const void *buf, size_t nbytes, off_t offset);
 // Seeks in the test data.
 off_t mock_lseek(int fd, off_t offset, int whence);
 
@@ -0,0 +1,234 @@
+// Tests for the mapping window cache of the pmem driver, using a fake physical
+// memory backend.
+//
+// Copyright 2012 Google Inc. All Rights Reserved.
+// Author: Johannes Stüttgen (johannes.stuettgen@gmail.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "error_log.h"
+#include "utest.h"
+
+#include "../pmem/pmem_window.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// The fake physical memory has this many pages.
+static const unsigned int kFakePages = 256;
+static const uint64_t kPage = 4096;
+
+// Fake physical memory and what happened to it.
+typedef struct {
+  uint8_t *memory;
+  // Physical ranges that may be mapped as a whole, [start, end).
+  uint64_t range_start[2];
+  uint64_t range_end[2];
+  // Mapping a window containing this page fails, unless it is mapped alone.
+  uint64_t broken_page;
+  unsigned int maps;
+  unsigned int unmaps;
+  unsigned int live;
+  uint64_t largest_map;
+} fake_phys_t;
+
+static fake_phys_t fake;
+static PMEM_WINDOW_CACHE cache;
+
+static PMEM_WINDOW_STATUS fake_map(PMEM_WINDOW_CACHE *self, uint64_t phys,
+                                   uint64_t size, uint8_t **vaddr,
+                                   void **handle) {
+  fake_phys_t *backend = (fake_phys_t *)self->backend;
+
+  // Windows are always whole pages inside the fake memory.
+  assert(phys % kPage == 0 && size % kPage == 0 && size > 0);
+  if (phys + size > kFakePages * kPage) {
+    return PMEM_WINDOW_ERROR;
+  }
+  if (backend->broken_page - phys < size && size > kPage) {
+    return PMEM_WINDOW_ERROR;
+  }
+  backend->maps++;
+  backend->live++;
+  if (size > backend->largest_map) {
+    backend->largest_map = size;
+  }
+  *vaddr = backend->memory + phys;
+  // The handle remembers the mapping so unmaps can be checked.
+  *handle = backend->memory + phys;
+  return PMEM_WINDOW_SUCCESS;
+}
+
+static void fake_unmap(PMEM_WINDOW_CACHE *self, void *handle) {
+  fake_phys_t *backend = (fake_phys_t *)self->backend;
+
+  assert((uint8_t *)handle >= backend->memory &&
+         (uint8_t *)handle < backend->memory + kFakePages * kPage);
+  assert(backend->live > 0);
+  backend->unmaps++;
+  backend->live--;
+}
+
+static int fake_range(PMEM_WINDOW_CACHE *self, uint64_t phys, uint64_t *start,
+                      uint64_t *end) {
+  fake_phys_t *backend = (fake_phys_t *)self->backend;
+
+  for (int i = 0; i < 2; i++) {
+    if (phys >= backend->range_start[i] && phys < backend->range_end[i]) {
+      *start = backend->range_start[i];
+      *end = backend->range_end[i];
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Set up fake memory where every 64 bit word holds its physical address, and
+// a cache with the given geometry on top of it.
+static void setup(uint64_t window_size, unsigned int num_windows) {
+  if (fake.memory == NULL) {
+    fake.memory = (uint8_t *)malloc(kFakePages * kPage);
+    assert(fake.memory != NULL);
+    for (uint64_t i = 0; i < kFakePages * kPage / sizeof(uint64_t); i++) {
+      ((uint64_t *)fake.memory)[i] = i * sizeof(uint64_t);
+    }
+  }
+  fake.range_start[0] = 0;
+  fake.range_end[0] = 100 * kPage;
+  fake.range_start[1] = 130 * kPage;
+  fake.range_end[1] = kFakePages * kPage;
+  fake.broken_page = UINT64_MAX;
+  fake.maps = 0;
+  fake.unmaps = 0;
+  fake.live = 0;
+  fake.largest_map = 0;
+  pmem_window_init(&cache, window_size, num_windows);
+  cache.map_ = fake_map;
+  cache.unmap_ = fake_unmap;
+  cache.range_ = fake_range;
+  cache.backend = &fake;
+}
+
+// Copy a range of fake physical memory through the cache, the way the driver
+// serves a read.
+static void read_through_cache(uint64_t addr, uint64_t end) {
+  while (addr < end) {
+    uint8_t *vaddr = NULL;
+    uint64_t len = 0;
+    assert(cache.get(&cache, addr, end, &vaddr, &len) == PMEM_WINDOW_SUCCESS);
+    assert(len > 0 && len <= end - addr);
+    assert(memcmp(vaddr, fake.memory + addr, len) == 0);
+    addr += len;
+  }
+}
+
+// A large read is served with one mapping per window, not per page.
+void test_sequential_read(void) {
+  setup(16 * kPage, 4);
+  read_through_cache(0, 96 * kPage);
+  assert(fake.maps == 6);
+  assert(fake.largest_map == 16 * kPage);
+  assert(fake.live <= 4);
+  cache.flush(&cache);
+  assert(fake.live == 0);
+}
+
+// Unaligned reads get the rest of the window, then continue in the next one.
+void test_unaligned_read(void) {
+  setup(16 * kPage, 4);
+  read_through_cache(3 * kPage + 123, 40 * kPage + 17);
+  assert(fake.maps == 3);
+  cache.flush(&cache);
+}
+
+// Windows are clipped to the ranges of the backend, never mapping the hole
+// between them.
+void test_range_clipping(void) {
+  uint8_t *vaddr = NULL;
+  uint64_t len = 0;
+
+  setup(64 * kPage, 4);
+  assert(cache.get(&cache, 99 * kPage, 140 * kPage, &vaddr, &len) == (
+      PMEM_WINDOW_SUCCESS));
+  assert(len == kPage);
+  assert(cache.get(&cache, 130 * kPage, 140 * kPage, &vaddr, &len) == (
+      PMEM_WINDOW_SUCCESS));
+  assert(cache.windows[1].phys == 130 * kPage);
+  assert(cache.windows[1].size == 62 * kPage);
+  // An address outside all ranges only gets its own page.
+  assert(cache.get(&cache, 110 * kPage + 8, 120 * kPage, &vaddr, &len) == (
+      PMEM_WINDOW_SUCCESS));
+  assert(len == kPage - 8);
+  assert(*(uint64_t *)vaddr == 110 * kPage + 8);
+  cache.flush(&cache);
+  assert(fake.live == 0);
+}
+
+// Recently used windows stay mapped, the least recently used one is replaced.
+void test_lru(void) {
+  uint8_t *vaddr = NULL;
+  uint64_t len = 0;
+
+  setup(8 * kPage, 3);
+  for (uint64_t window = 0; window < 3; window++) {
+    assert(cache.get(&cache, window * 8 * kPage, (window + 1) * 8 * kPage,
+                     &vaddr, &len) == PMEM_WINDOW_SUCCESS);
+  }
+  assert(fake.maps == 3);
+  // Touch window 0, making window 1 the least recently used.
+  assert(cache.get(&cache, 5 * kPage, 6 * kPage, &vaddr, &len) == (
+      PMEM_WINDOW_SUCCESS));
+  assert(fake.maps == 3 && cache.hits == 1);
+  // A fourth window replaces window 1.
+  assert(cache.get(&cache, 40 * kPage, 41 * kPage, &vaddr, &len) == (
+      PMEM_WINDOW_SUCCESS));
+  assert(fake.maps == 4 && fake.unmaps == 1 && fake.live == 3);
+  assert(cache.get(&cache, 0, kPage, &vaddr, &len) == PMEM_WINDOW_SUCCESS);
+  assert(cache.get(&cache, 16 * kPage, 17 * kPage, &vaddr, &len) == (
+      PMEM_WINDOW_SUCCESS));
+  assert(fake.maps == 4);
+  assert(cache.get(&cache, 8 * kPage, 9 * kPage, &vaddr, &len) == (
+      PMEM_WINDOW_SUCCESS));
+  assert(fake.maps == 5);
+  assert(*(uint64_t *)vaddr == 8 * kPage);
+  pmem_window_cleanup(&cache);
+  assert(fake.live == 0 && fake.unmaps == fake.maps);
+}
+
+// If a window can't be mapped as a whole, the driver still gets the page.
+void test_map_failure(void) {
+  uint8_t *vaddr = NULL;
+  uint64_t len = 0;
+
+  setup(16 * kPage, 4);
+  fake.broken_page = 20 * kPage;
+  read_through_cache(16 * kPage, 32 * kPage);
+  assert(fake.largest_map == kPage);
+  // Pages beyond the end of the fake memory can't be mapped at all.
+  fake.range_end[1] = (kFakePages + 16) * kPage;
+  assert(cache.get(&cache, kFakePages * kPage, (kFakePages + 1) * kPage,
+                   &vaddr, &len) == PMEM_WINDOW_ERROR);
+  cache.flush(&cache);
+  assert(fake.live == 0);
+}
+
+int main(int argc, char **argv) {
+  utest_run("reading sequentially", test_sequential_read());
+  utest_run("reading unaligned ranges", test_unaligned_read());
+  utest_run("clipping windows to ranges", test_range_clipping());
+  utest_run("replacing windows", test_lru());
+  utest_run("falling back to single pages", test_map_failure());
+  utest_summary();
+  free(fake.memory);
+  return current_test == passed_tests ? EXIT_SUCCESS : EXIT_FAILURE;
+}
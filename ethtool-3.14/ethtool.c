@@ -35,6 +35,11 @@
 #include <sys/utsname.h>
 #include <limits.h>
 #include <ctype.h>
+#include <fnmatch.h>
+#include <setjmp.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/wait.h>
 
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -119,6 +124,18 @@ enum {
 
 #define KERNEL_VERSION(a,b,c) (((a) << 16) + ((b) << 8) + (c))
 
+/* In batch mode, a command that gives up only ends that command */
+static jmp_buf *batch_return;
+
+static void exit_cmd(int rc) __attribute__((noreturn));
+
+static void exit_cmd(int rc)
+{
+	if (batch_return)
+		longjmp(*batch_return, rc + 1);
+	exit(rc);
+}
+
 static void exit_bad_args(void) __attribute__((noreturn));
 
 static void exit_bad_args(void)
@@ -126,7 +143,43 @@ static void exit_bad_args(void)
 	fprintf(stderr,
 		"ethtool: bad command line argument(s)\n"
 		"For more information run ethtool -h\n");
-	exit(1);
+	exit_cmd(1);
+}
+
+/* Memory that belongs to the current command.  In --batch mode
+ * exit_cmd() returns to the batch loop instead of exiting, so a command
+ * that fails half way can't free it itself; the batch loop frees it
+ * after every command instead.
+ */
+#define MAX_CMD_ALLOCS	8
+static void *cmd_allocs[MAX_CMD_ALLOCS];
+static unsigned int n_cmd_allocs;
+
+/* Remember p, which may be NULL, as memory of the current command */
+static void *cmd_track(void *p)
+{
+	if (p && n_cmd_allocs < MAX_CMD_ALLOCS)
+		cmd_allocs[n_cmd_allocs++] = p;
+	return p;
+}
+
+/* Free memory of the current command before it returns */
+static void cmd_free(void *p)
+{
+	unsigned int i;
+
+	for (i = 0; i < n_cmd_allocs; i++)
+		if (cmd_allocs[i] == p) {
+			cmd_allocs[i] = cmd_allocs[--n_cmd_allocs];
+			break;
+		}
+	free(p);
+}
+
+static void cmd_free_all(void)
+{
+	while (n_cmd_allocs)
+		free(cmd_allocs[--n_cmd_allocs]);
 }
 
 typedef enum {
@@ -403,7 +456,7 @@ static void parse_generic_cmdline(struct cmd_context *ctx,
 				}
 				case CMDL_STR: {
 					char **s = info[idx].wanted_val;
-					*s = strdup(argp[i]);
+					*s = cmd_track(strdup(argp[i]));
 					break;
 				}
 				default:
@@ -882,24 +935,25 @@ static char *unparse_rxfhashopts(u64 opts)
 	return buf;
 }
 
+/* Drivers with a register map can also compare two dumps field by field */
 static const struct {
 	const char *name;
 	int (*func)(struct ethtool_drvinfo *info, struct ethtool_regs *regs);
-
+	regdump_map_fn *map;
 } driver_list[] = {
 #ifdef ETHTOOL_ENABLE_PRETTY_DUMP
 	{ "8139cp", realtek_dump_regs },
 	{ "8139too", realtek_dump_regs },
 	{ "r8169", realtek_dump_regs },
 	{ "de2104x", de2104x_dump_regs },
-	{ "e1000", e1000_dump_regs },
-	{ "e1000e", e1000_dump_regs },
-	{ "igb", igb_dump_regs },
-	{ "ixgb", ixgb_dump_regs },
-	{ "ixgbe", ixgbe_dump_regs },
-	{ "ixgbevf", ixgbevf_dump_regs },
+	{ "e1000", e1000_dump_regs, e1000_regdump_map },
+	{ "e1000e", e1000_dump_regs, e1000_regdump_map },
+	{ "igb", igb_dump_regs, igb_regdump_map },
+	{ "ixgb", ixgb_dump_regs, ixgb_regdump_map },
+	{ "ixgbe", ixgbe_dump_regs, ixgbe_regdump_map },
+	{ "ixgbevf", ixgbevf_dump_regs, ixgbevf_regdump_map },
 	{ "natsemi", natsemi_dump_regs },
-	{ "e100", e100_dump_regs },
+	{ "e100", e100_dump_regs, e100_regdump_map },
 	{ "amd8111e", amd8111e_dump_regs },
 	{ "pcnet32", pcnet32_dump_regs },
 	{ "fec_8xx", fec_8xx_dump_regs },
@@ -931,6 +985,16 @@ void dump_hex(FILE *file, const u8 *data, int len, int offset)
 	fprintf(file, "\n");
 }
 
+static int find_driver(const char *driver)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(driver_list); i++)
+		if (!strncmp(driver_list[i].name, driver, ETHTOOL_BUSINFO_LEN))
+			return i;
+	return -1;
+}
+
 static int dump_regs(int gregs_dump_raw, int gregs_dump_hex,
 		     const char *gregs_dump_file,
 		     struct ethtool_drvinfo *info, struct ethtool_regs *regs)
@@ -958,18 +1022,14 @@ static int dump_regs(int gregs_dump_raw, int gregs_dump_hex,
 		fclose(f);
 	}
 
-	if (!gregs_dump_hex)
-		for (i = 0; i < ARRAY_SIZE(driver_list); i++)
-			if (!strncmp(driver_list[i].name, info->driver,
-				     ETHTOOL_BUSINFO_LEN)) {
-				if (driver_list[i].func(info, regs) == 0)
-					return 0;
-				/* This version (or some other
-				 * variation in the dump format) is
-				 * not handled; fall back to hex
-				 */
-				break;
-			}
+	if (!gregs_dump_hex) {
+		i = find_driver(info->driver);
+		/* If this version (or some other variation in the dump
+		 * format) is not handled, fall back to hex
+		 */
+		if (i >= 0 && driver_list[i].func(info, regs) == 0)
+			return 0;
+	}
 
 	dump_hex(stdout, regs->data, regs->len, 0);
 
@@ -1434,6 +1494,49 @@ static int dump_tsinfo(const struct ethtool_ts_info *info)
 	return 0;
 }
 
+/* Device information that --batch keeps between commands.  It is
+ * dropped after any command that may have changed the device.
+ */
+#define N_CACHED_SSETS (ETH_SS_FEATURES + 1)
+
+struct dev_cache {
+	struct dev_cache *next;
+	char devname[IFNAMSIZ];
+	int have_drvinfo;
+	struct ethtool_drvinfo drvinfo;
+	struct ethtool_gstrings *strings[N_CACHED_SSETS];
+};
+
+static void flush_dev_cache(struct dev_cache *cache)
+{
+	int i;
+
+	cache->have_drvinfo = 0;
+	for (i = 0; i < N_CACHED_SSETS; i++) {
+		free(cache->strings[i]);
+		cache->strings[i] = NULL;
+	}
+}
+
+static int get_drvinfo(struct cmd_context *ctx,
+		       struct ethtool_drvinfo *drvinfo)
+{
+	int err;
+
+	if (ctx->cache && ctx->cache->have_drvinfo) {
+		*drvinfo = ctx->cache->drvinfo;
+		return 0;
+	}
+
+	drvinfo->cmd = ETHTOOL_GDRVINFO;
+	err = send_ioctl(ctx, drvinfo);
+	if (err == 0 && ctx->cache) {
+		ctx->cache->drvinfo = *drvinfo;
+		ctx->cache->have_drvinfo = 1;
+	}
+	return err;
+}
+
 static struct ethtool_gstrings *
 get_stringset(struct cmd_context *ctx, enum ethtool_stringset set_id,
 	      ptrdiff_t drvinfo_offset, int null_terminate)
@@ -1444,33 +1547,53 @@ get_stringset(struct cmd_context *ctx, enum ethtool_stringset set_id,
 	} sset_info;
 	struct ethtool_drvinfo drvinfo;
 	u32 len, i;
-	struct ethtool_gstrings *strings;
+	struct ethtool_gstrings *strings, *cached = NULL;
+	size_t sz_strings;
 
-	sset_info.hdr.cmd = ETHTOOL_GSSET_INFO;
-	sset_info.hdr.reserved = 0;
-	sset_info.hdr.sset_mask = 1ULL << set_id;
-	if (send_ioctl(ctx, &sset_info) == 0) {
-		len = sset_info.hdr.sset_mask ? sset_info.hdr.data[0] : 0;
-	} else if (errno == EOPNOTSUPP && drvinfo_offset != 0) {
-		/* Fallback for old kernel versions */
-		drvinfo.cmd = ETHTOOL_GDRVINFO;
-		if (send_ioctl(ctx, &drvinfo))
-			return NULL;
-		len = *(u32 *)((char *)&drvinfo + drvinfo_offset);
+	if (ctx->cache && set_id < N_CACHED_SSETS)
+		cached = ctx->cache->strings[set_id];
+
+	if (cached) {
+		len = cached->len;
 	} else {
-		return NULL;
+		sset_info.hdr.cmd = ETHTOOL_GSSET_INFO;
+		sset_info.hdr.reserved = 0;
+		sset_info.hdr.sset_mask = 1ULL << set_id;
+		if (send_ioctl(ctx, &sset_info) == 0) {
+			len = sset_info.hdr.sset_mask ?
+				sset_info.hdr.data[0] : 0;
+		} else if (errno == EOPNOTSUPP && drvinfo_offset != 0) {
+			/* Fallback for old kernel versions */
+			if (get_drvinfo(ctx, &drvinfo))
+				return NULL;
+			len = *(u32 *)((char *)&drvinfo + drvinfo_offset);
+		} else {
+			return NULL;
+		}
 	}
 
-	strings = calloc(1, sizeof(*strings) + len * ETH_GSTRING_LEN);
+	sz_strings = sizeof(*strings) + len * ETH_GSTRING_LEN;
+	strings = calloc(1, sz_strings);
 	if (!strings)
 		return NULL;
 
-	strings->cmd = ETHTOOL_GSTRINGS;
-	strings->string_set = set_id;
-	strings->len = len;
-	if (len != 0 && send_ioctl(ctx, strings)) {
-		free(strings);
-		return NULL;
+	if (cached) {
+		memcpy(strings, cached, sz_strings);
+	} else {
+		strings->cmd = ETHTOOL_GSTRINGS;
+		strings->string_set = set_id;
+		strings->len = len;
+		if (len != 0 && send_ioctl(ctx, strings)) {
+			free(strings);
+			return NULL;
+		}
+
+		if (ctx->cache && set_id < N_CACHED_SSETS) {
+			cached = malloc(sz_strings);
+			if (cached)
+				memcpy(cached, strings, sz_strings);
+			ctx->cache->strings[set_id] = cached;
+		}
 	}
 
 	if (null_terminate)
@@ -1558,8 +1681,7 @@ static int do_gdrv(struct cmd_context *ctx)
 	if (ctx->argc != 0)
 		exit_bad_args();
 
-	drvinfo.cmd = ETHTOOL_GDRVINFO;
-	err = send_ioctl(ctx, &drvinfo);
+	err = get_drvinfo(ctx, &drvinfo);
 	if (err < 0) {
 		perror("Cannot get driver information");
 		return 71;
@@ -2627,8 +2749,7 @@ static int do_gregs(struct cmd_context *ctx)
 	parse_generic_cmdline(ctx, &gregs_changed,
 			      cmdline_gregs, ARRAY_SIZE(cmdline_gregs));
 
-	drvinfo.cmd = ETHTOOL_GDRVINFO;
-	err = send_ioctl(ctx, &drvinfo);
+	err = get_drvinfo(ctx, &drvinfo);
 	if (err < 0) {
 		perror("Cannot get driver information");
 		return 72;
@@ -2658,6 +2779,279 @@ static int do_gregs(struct cmd_context *ctx)
 	return 0;
 }
 
+/* Read a register dump saved with "-d DEVNAME raw on".  Raw dumps have
+ * no header, so the dump version is given by the user.
+ */
+static struct ethtool_regs *read_regs_file(const char *path, u32 version)
+{
+	struct ethtool_regs *regs;
+	struct stat st;
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (!f || fstat(fileno(f), &st) < 0) {
+		fprintf(stderr, "Can't open '%s': %s\n", path, strerror(errno));
+		if (f)
+			fclose(f);
+		return NULL;
+	}
+
+	regs = calloc(1, sizeof(*regs) + st.st_size);
+	if (!regs) {
+		perror("Cannot allocate memory for register dump");
+		fclose(f);
+		return NULL;
+	}
+	regs->cmd = ETHTOOL_GREGS;
+	regs->version = version;
+	regs->len = st.st_size;
+	if (regs->len && fread(regs->data, regs->len, 1, f) != 1) {
+		fprintf(stderr, "Can't read '%s'\n", path);
+		free(regs);
+		regs = NULL;
+	}
+	fclose(f);
+	return regs;
+}
+
+/* Decode dir/name into out_dir/name.txt */
+static int decode_regs_file(const char *dir, const char *name,
+			    const char *out_dir, struct ethtool_drvinfo *info,
+			    u32 version)
+{
+	char path[PATH_MAX];
+	struct ethtool_regs *regs;
+	int err;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	regs = read_regs_file(path, version);
+	if (!regs)
+		return -1;
+
+	snprintf(path, sizeof(path), "%s/%s.txt", out_dir, name);
+	if (!freopen(path, "w", stdout)) {
+		fprintf(stderr, "Can't create '%s': %s\n",
+			path, strerror(errno));
+		free(regs);
+		return -1;
+	}
+	err = dump_regs(0, 0, NULL, info, regs);
+	if (fflush(stdout))
+		err = -1;
+	free(regs);
+	return err;
+}
+
+static int compare_names(const void *a, const void *b)
+{
+	return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/* List the regular files in dir, sorted by name */
+static char **list_regs_files(const char *dir, unsigned int *count)
+{
+	char path[PATH_MAX];
+	unsigned int n = 0, size = 64;
+	struct dirent *ent;
+	struct stat st;
+	char **names, **new_names;
+	DIR *d;
+
+	d = opendir(dir);
+	if (!d) {
+		fprintf(stderr, "Can't open '%s': %s\n", dir, strerror(errno));
+		return NULL;
+	}
+	names = malloc(size * sizeof(*names));
+	if (!names)
+		goto nomem;
+
+	while ((ent = readdir(d))) {
+		if (ent->d_name[0] == '.')
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+		if (stat(path, &st) < 0 || !S_ISREG(st.st_mode))
+			continue;
+		if (n == size) {
+			size *= 2;
+			new_names = realloc(names, size * sizeof(*names));
+			if (!new_names)
+				goto nomem;
+			names = new_names;
+		}
+		names[n] = strdup(ent->d_name);
+		if (!names[n])
+			goto nomem;
+		n++;
+	}
+	closedir(d);
+
+	qsort(names, n, sizeof(*names), compare_names);
+	*count = n;
+	return names;
+
+nomem:
+	perror("Cannot allocate memory for file names");
+	closedir(d);
+	if (names) {
+		while (n)
+			free(names[--n]);
+		free(names);
+	}
+	return NULL;
+}
+
+/* Decode every raw dump in a directory.  The dumps are shared out
+ * between worker processes, each of which writes its output files
+ * independently.
+ */
+static int do_decode_dir(struct cmd_context *ctx)
+{
+	int decode_changed = 0;
+	char *decode_driver = NULL;
+	u32 decode_version = 1 << 24;
+	u32 decode_jobs = 0;
+	struct cmdline_info cmdline_decode[] = {
+		{ "driver", CMDL_STR, &decode_driver, NULL },
+		{ "version", CMDL_U32, &decode_version, NULL },
+		{ "jobs", CMDL_U32, &decode_jobs, NULL },
+	};
+	struct ethtool_drvinfo info;
+	const char *dir, *out_dir;
+	unsigned int i, j, n;
+	char **names;
+	int status, err = 0;
+	long cpus;
+	pid_t pid;
+
+	if (ctx->argc < 2)
+		exit_bad_args();
+	dir = ctx->argp[0];
+	out_dir = ctx->argp[1];
+	ctx->argc -= 2;
+	ctx->argp += 2;
+	parse_generic_cmdline(ctx, &decode_changed,
+			      cmdline_decode, ARRAY_SIZE(cmdline_decode));
+	if (!decode_driver)
+		exit_bad_args();
+
+	if (decode_jobs == 0) {
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		decode_jobs = cpus > 0 ? cpus : 1;
+	}
+
+	memset(&info, 0, sizeof(info));
+	strncpy(info.driver, decode_driver, sizeof(info.driver) - 1);
+
+	names = list_regs_files(dir, &n);
+	if (!names)
+		return 1;
+	if (decode_jobs > n)
+		decode_jobs = n;
+
+	fflush(NULL);
+	for (j = 0; j < decode_jobs; j++) {
+		pid = fork();
+		if (pid < 0) {
+			perror("Cannot start decoder");
+			err = 1;
+			break;
+		}
+		if (pid == 0) {
+			status = 0;
+			for (i = j; i < n; i += decode_jobs)
+				if (decode_regs_file(dir, names[i], out_dir,
+						     &info, decode_version))
+					status = 1;
+			_exit(status);
+		}
+	}
+	while (wait(&status) > 0)
+		if (!WIFEXITED(status) || WEXITSTATUS(status))
+			err = 1;
+
+	for (i = 0; i < n; i++)
+		free(names[i]);
+	free(names);
+	return err;
+}
+
+static void diff_regs_words(const u32 *old_words, const u32 *new_words,
+			    unsigned int n_words)
+{
+	unsigned int i;
+
+	for (i = 0; i < n_words; i++)
+		if (old_words[i] != new_words[i])
+			fprintf(stdout, "0x%04X: 0x%08X -> 0x%08X\n",
+				i * 4, old_words[i], new_words[i]);
+}
+
+/* Compare two raw dumps.  Drivers with a register map show the fields
+ * that changed; for others the words that changed are shown.
+ */
+static int do_decode_diff(struct cmd_context *ctx)
+{
+	int decode_changed = 0;
+	char *decode_driver = NULL;
+	u32 decode_version = 1 << 24;
+	struct cmdline_info cmdline_decode[] = {
+		{ "driver", CMDL_STR, &decode_driver, NULL },
+		{ "version", CMDL_U32, &decode_version, NULL },
+	};
+	struct ethtool_regs *old_regs, *new_regs;
+	const char *old_file, *new_file;
+	const u32 *old_words, *new_words;
+	unsigned int n_words;
+#ifdef ETHTOOL_ENABLE_PRETTY_DUMP
+	const struct regdump_map *map;
+	unsigned int variant;
+	int k;
+#endif
+
+	if (ctx->argc < 2)
+		exit_bad_args();
+	old_file = ctx->argp[0];
+	new_file = ctx->argp[1];
+	ctx->argc -= 2;
+	ctx->argp += 2;
+	parse_generic_cmdline(ctx, &decode_changed,
+			      cmdline_decode, ARRAY_SIZE(cmdline_decode));
+	if (!decode_driver)
+		exit_bad_args();
+
+	old_regs = read_regs_file(old_file, decode_version);
+	if (!old_regs)
+		return 1;
+	new_regs = read_regs_file(new_file, decode_version);
+	if (!new_regs) {
+		free(old_regs);
+		return 1;
+	}
+
+	if (old_regs->len != new_regs->len)
+		fprintf(stdout, "Dump lengths differ: %u and %u bytes\n",
+			old_regs->len, new_regs->len);
+	n_words = (old_regs->len < new_regs->len ?
+		   old_regs->len : new_regs->len) / sizeof(u32);
+	old_words = (const u32 *)old_regs->data;
+	new_words = (const u32 *)new_regs->data;
+
+#ifdef ETHTOOL_ENABLE_PRETTY_DUMP
+	k = find_driver(decode_driver);
+	if (k >= 0 && driver_list[k].map &&
+	    driver_list[k].map(old_regs, &map, &variant) == 0)
+		regdump_diff(stdout, map, variant, old_words, new_words,
+			     n_words);
+	else
+#endif
+		diff_regs_words(old_words, new_words, n_words);
+
+	free(old_regs);
+	free(new_regs);
+	return 0;
+}
+
 static int do_nway_rst(struct cmd_context *ctx)
 {
 	struct ethtool_value edata;
@@ -2692,8 +3086,7 @@ static int do_geeprom(struct cmd_context *ctx)
 	parse_generic_cmdline(ctx, &geeprom_changed,
 			      cmdline_geeprom, ARRAY_SIZE(cmdline_geeprom));
 
-	drvinfo.cmd = ETHTOOL_GDRVINFO;
-	err = send_ioctl(ctx, &drvinfo);
+	err = get_drvinfo(ctx, &drvinfo);
 	if (err < 0) {
 		perror("Cannot get driver information");
 		return 74;
@@ -2747,8 +3140,7 @@ static int do_seeprom(struct cmd_context *ctx)
 	parse_generic_cmdline(ctx, &seeprom_changed,
 			      cmdline_seeprom, ARRAY_SIZE(cmdline_seeprom));
 
-	drvinfo.cmd = ETHTOOL_GDRVINFO;
-	err = send_ioctl(ctx, &drvinfo);
+	err = get_drvinfo(ctx, &drvinfo);
 	if (err < 0) {
 		perror("Cannot get driver information");
 		return 74;
@@ -2876,21 +3268,202 @@ static int do_phys_id(struct cmd_context *ctx)
 	return err;
 }
 
+/* Options of -S */
+struct gstats_opts {
+	double interval;	/* seconds between samples, 0 for one sample */
+	unsigned int count;	/* number of intervals, 0 for no limit */
+	int json;		/* one JSON object per sample */
+	char **patterns;	/* only show stats matching these */
+	int n_patterns;
+};
+
+static void parse_gstats_args(struct cmd_context *ctx,
+			      struct gstats_opts *opts)
+{
+	char *endp;
+	int i;
+
+	memset(opts, 0, sizeof(*opts));
+	opts->patterns = cmd_track(calloc(ctx->argc + 1,
+					  sizeof(opts->patterns[0])));
+	if (!opts->patterns) {
+		perror("Cannot allocate memory for stats patterns");
+		exit_cmd(1);
+	}
+
+	for (i = 0; i < ctx->argc; i++) {
+		if (!strcmp(ctx->argp[i], "--interval")) {
+			if (++i >= ctx->argc)
+				exit_bad_args();
+			errno = 0;
+			opts->interval = strtod(ctx->argp[i], &endp);
+			if (errno || *endp || !(opts->interval > 0))
+				exit_bad_args();
+		} else if (!strcmp(ctx->argp[i], "--count")) {
+			opts->count = get_u32(ctx->argp[++i], 0);
+			if (opts->count == 0)
+				exit_bad_args();
+		} else if (!strcmp(ctx->argp[i], "--json")) {
+			opts->json = 1;
+		} else if (!strcmp(ctx->argp[i], "--match")) {
+			if (++i >= ctx->argc)
+				exit_bad_args();
+			opts->patterns[opts->n_patterns++] = ctx->argp[i];
+		} else {
+			exit_bad_args();
+		}
+	}
+
+	if (opts->count && !opts->interval)
+		exit_bad_args();
+}
+
+/* Return the indices of the stats selected by the patterns.  The
+ * patterns are only matched here, not on every sample.
+ */
+static unsigned int *
+select_gstats(const struct ethtool_gstrings *strings,
+	      const struct gstats_opts *opts, unsigned int *n_selected)
+{
+	char name[ETH_GSTRING_LEN + 1];
+	unsigned int *selected;
+	unsigned int i;
+	int j;
+
+	selected = calloc(strings->len + 1, sizeof(selected[0]));
+	if (!selected)
+		return NULL;
+
+	*n_selected = 0;
+	for (i = 0; i < strings->len; i++) {
+		if (opts->n_patterns) {
+			memcpy(name, &strings->data[i * ETH_GSTRING_LEN],
+			       ETH_GSTRING_LEN);
+			name[ETH_GSTRING_LEN] = 0;
+			for (j = 0; j < opts->n_patterns; j++)
+				if (!fnmatch(opts->patterns[j], name, 0))
+					break;
+			if (j == opts->n_patterns)
+				continue;
+		}
+		selected[(*n_selected)++] = i;
+	}
+
+	return selected;
+}
+
+static void print_json_gstring(const struct ethtool_gstrings *strings,
+			       unsigned int i)
+{
+	const u8 *name = &strings->data[i * ETH_GSTRING_LEN];
+	unsigned int j;
+
+	putchar('"');
+	for (j = 0; j < ETH_GSTRING_LEN && name[j]; j++) {
+		if (name[j] == '"' || name[j] == '\\')
+			printf("\\%c", name[j]);
+		else if (name[j] < 0x20 || name[j] >= 0x7f)
+			printf("\\u%04x", name[j]);
+		else
+			putchar(name[j]);
+	}
+	putchar('"');
+}
+
+static double timespec_diff(const struct timespec *a,
+			    const struct timespec *b)
+{
+	return (a->tv_sec - b->tv_sec) + (a->tv_nsec - b->tv_nsec) / 1e9;
+}
+
+static void print_gstats(struct cmd_context *ctx,
+			 const struct ethtool_gstrings *strings,
+			 const unsigned int *selected, unsigned int n_selected,
+			 const struct ethtool_stats *stats, int json)
+{
+	unsigned int i, k;
+
+	if (json) {
+		printf("{\"ifname\":\"%s\",\"stats\":{", ctx->devname);
+		for (k = 0; k < n_selected; k++) {
+			i = selected[k];
+			if (k)
+				putchar(',');
+			print_json_gstring(strings, i);
+			printf(":%llu", stats->data[i]);
+		}
+		printf("}}\n");
+		return;
+	}
+
+	/* todo - pretty-print the strings per-driver */
+	fprintf(stdout, "NIC statistics:\n");
+	for (k = 0; k < n_selected; k++) {
+		i = selected[k];
+		fprintf(stdout, "     %.*s: %llu\n",
+			ETH_GSTRING_LEN,
+			&strings->data[i * ETH_GSTRING_LEN],
+			stats->data[i]);
+	}
+}
+
+static void print_gstats_delta(struct cmd_context *ctx,
+			       const struct ethtool_gstrings *strings,
+			       const unsigned int *selected,
+			       unsigned int n_selected,
+			       const struct ethtool_stats *prev,
+			       const struct ethtool_stats *stats,
+			       double elapsed, int json)
+{
+	unsigned int i, k;
+	long long delta;
+
+	if (json)
+		printf("{\"ifname\":\"%s\",\"interval\":%.3f,\"stats\":{",
+		       ctx->devname, elapsed);
+	else
+		fprintf(stdout, "NIC statistics over %.3f s:\n", elapsed);
+
+	for (k = 0; k < n_selected; k++) {
+		i = selected[k];
+		/* Counters may wrap or be reset by the driver */
+		delta = (long long)(stats->data[i] - prev->data[i]);
+		if (json) {
+			if (k)
+				putchar(',');
+			print_json_gstring(strings, i);
+			printf(":{\"value\":%llu,\"delta\":%lld,\"rate\":%.2f}",
+			       stats->data[i], delta, delta / elapsed);
+		} else {
+			fprintf(stdout, "     %.*s: %llu %+lld (%.2f/s)\n",
+				ETH_GSTRING_LEN,
+				&strings->data[i * ETH_GSTRING_LEN],
+				stats->data[i], delta, delta / elapsed);
+		}
+	}
+
+	if (json)
+		printf("}}\n");
+}
+
 static int do_gstats(struct cmd_context *ctx)
 {
+	struct gstats_opts opts;
 	struct ethtool_gstrings *strings;
-	struct ethtool_stats *stats;
-	unsigned int n_stats, sz_stats, i;
+	struct ethtool_stats *stats, *prev, *tmp;
+	unsigned int n_stats, sz_stats, n_selected, *selected, tick;
+	struct timespec start, last, now, delay;
+	double wait;
 	int err;
 
-	if (ctx->argc != 0)
-		exit_bad_args();
+	parse_gstats_args(ctx, &opts);
 
 	strings = get_stringset(ctx, ETH_SS_STATS,
 				offsetof(struct ethtool_drvinfo, n_stats),
 				0);
 	if (!strings) {
 		perror("Cannot get stats strings information");
+		cmd_free(opts.patterns);
 		return 96;
 	}
 
@@ -2898,16 +3471,28 @@ static int do_gstats(struct cmd_context *ctx)
 	if (n_stats < 1) {
 		fprintf(stderr, "no stats available\n");
 		free(strings);
+		cmd_free(opts.patterns);
 		return 94;
 	}
 
 	sz_stats = n_stats * sizeof(u64);
 
+	/* Both buffers are allocated up front, so sampling at an interval
+	 * only costs one ETHTOOL_GSTATS per sample.
+	 */
+	selected = select_gstats(strings, &opts, &n_selected);
 	stats = calloc(1, sz_stats + sizeof(struct ethtool_stats));
-	if (!stats) {
+	prev = calloc(1, sz_stats + sizeof(struct ethtool_stats));
+	if (!selected || !stats || !prev) {
 		fprintf(stderr, "no memory available\n");
-		free(strings);
-		return 95;
+		err = 95;
+		goto out;
+	}
+
+	if (n_selected == 0) {
+		fprintf(stderr, "no stats match\n");
+		err = 94;
+		goto out;
 	}
 
 	stats->cmd = ETHTOOL_GSTATS;
@@ -2915,23 +3500,57 @@ static int do_gstats(struct cmd_context *ctx)
 	err = send_ioctl(ctx, stats);
 	if (err < 0) {
 		perror("Cannot get stats information");
-		free(strings);
-		free(stats);
-		return 97;
+		err = 97;
+		goto out;
 	}
+	err = 0;
 
-	/* todo - pretty-print the strings per-driver */
-	fprintf(stdout, "NIC statistics:\n");
-	for (i = 0; i < n_stats; i++) {
-		fprintf(stdout, "     %.*s: %llu\n",
-			ETH_GSTRING_LEN,
-			&strings->data[i * ETH_GSTRING_LEN],
-			stats->data[i]);
+	if (!opts.interval) {
+		print_gstats(ctx, strings, selected, n_selected, stats,
+			     opts.json);
+		goto out;
 	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	last = start;
+
+	for (tick = 1; !opts.count || tick <= opts.count; tick++) {
+		/* Keep to the schedule even if a sample was slow */
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		wait = tick * opts.interval - timespec_diff(&now, &start);
+		if (wait > 0) {
+			delay.tv_sec = (time_t)wait;
+			delay.tv_nsec = (long)((wait - delay.tv_sec) * 1e9);
+			nanosleep(&delay, NULL);
+		}
+
+		tmp = prev;
+		prev = stats;
+		stats = tmp;
+		stats->cmd = ETHTOOL_GSTATS;
+		stats->n_stats = n_stats;
+		if (send_ioctl(ctx, stats) < 0) {
+			perror("Cannot get stats information");
+			err = 97;
+			goto out;
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		print_gstats_delta(ctx, strings, selected, n_selected,
+				   prev, stats, timespec_diff(&now, &last),
+				   opts.json);
+		fflush(stdout);
+		last = now;
+	}
+
+out:
 	free(strings);
+	free(selected);
 	free(stats);
+	free(prev);
+	cmd_free(opts.patterns);
 
-	return 0;
+	return err;
 }
 
 static int do_srxntuple(struct cmd_context *ctx,
@@ -2982,6 +3601,13 @@ static int do_srxclass(struct cmd_context *ctx)
 				" classification rule\n");
 			return 1;
 		}
+	} else if (ctx->argc == 2 && !strcmp(ctx->argp[0], "load")) {
+		err = rxclass_rule_load(ctx, ctx->argp[1]);
+		if (err < 0) {
+			fprintf(stderr, "Cannot load"
+				" classification rules\n");
+			return 1;
+		}
 	} else if (!strcmp(ctx->argp[0], "delete")) {
 		int rx_class_rule_del =
 			get_uint_range(ctx->argp[1], 0, INT_MAX);
@@ -3026,6 +3652,10 @@ static int do_grxclass(struct cmd_context *ctx)
 		err = rxclass_rule_get(ctx, rx_class_rule_get);
 		if (err < 0)
 			fprintf(stderr, "Cannot get RX classification rule\n");
+	} else if (ctx->argc == 1 && !strcmp(ctx->argp[0], "dump")) {
+		err = rxclass_rule_dump(ctx);
+		if (err < 0)
+			fprintf(stderr, "RX classification rule retrieval failed\n");
 	} else if (ctx->argc == 0) {
 		nfccmd.cmd = ETHTOOL_GRXRINGS;
 		err = send_ioctl(ctx, &nfccmd);
@@ -3069,8 +3699,8 @@ static int do_grxfhindir(struct cmd_context *ctx)
 		return 103;
 	}
 
-	indir = malloc(sizeof(*indir) +
-		       indir_head.size * sizeof(*indir->ring_index));
+	indir = cmd_track(malloc(sizeof(*indir) +
+				 indir_head.size * sizeof(*indir->ring_index)));
 	indir->cmd = ETHTOOL_GRXFHINDIR;
 	indir->size = indir_head.size;
 	err = send_ioctl(ctx, indir);
@@ -3120,8 +3750,8 @@ static int do_srxfhindir(struct cmd_context *ctx)
 		return 104;
 	}
 
-	indir = malloc(sizeof(*indir) +
-		       indir_head.size * sizeof(*indir->ring_index));
+	indir = cmd_track(malloc(sizeof(*indir) +
+				 indir_head.size * sizeof(*indir->ring_index)));
 	indir->cmd = ETHTOOL_SRXFHINDIR;
 	indir->size = indir_head.size;
 
@@ -3139,14 +3769,14 @@ static int do_srxfhindir(struct cmd_context *ctx)
 		if (sum == 0) {
 			fprintf(stderr,
 				"At least one weight must be non-zero\n");
-			exit(1);
+			exit_cmd(1);
 		}
 
 		if (sum > indir->size) {
 			fprintf(stderr,
 				"Total weight exceeds the size of the "
 				"indirection table\n");
-			exit(1);
+			exit_cmd(1);
 		}
 
 		j = -1;
@@ -3744,6 +4374,7 @@ int send_ioctl(struct cmd_context *ctx, void *cmd)
 #endif
 
 static int show_usage(struct cmd_context *ctx);
+static int do_batch(struct cmd_context *ctx);
 
 static const struct option {
 	const char *opts;
@@ -3824,12 +4455,16 @@ static const struct option {
 	  "               [ TIME-IN-SECONDS ]\n" },
 	{ "-t|--test", 1, do_test, "Execute adapter self test",
 	  "               [ online | offline | external_lb ]\n" },
-	{ "-S|--statistics", 1, do_gstats, "Show adapter statistics" },
+	{ "-S|--statistics", 1, do_gstats, "Show adapter statistics",
+	  "		[ --interval N [ --count N ] ]\n"
+	  "		[ --json ]\n"
+	  "		[ --match PATTERN ... ]\n" },
 	{ "-n|-u|--show-nfc|--show-ntuple", 1, do_grxclass,
 	  "Show Rx network flow classification options or rules",
 	  "		[ rx-flow-hash tcp4|udp4|ah4|esp4|sctp4|"
 	  "tcp6|udp6|ah6|esp6|sctp6 |\n"
-	  "		  rule %d ]\n" },
+	  "		  rule %d |\n"
+	  "		  dump ]\n" },
 	{ "-N|-U|--config-nfc|--config-ntuple", 1, do_srxclass,
 	  "Configure Rx network flow classification options or rules",
 	  "		rx-flow-hash tcp4|udp4|ah4|esp4|sctp4|"
@@ -3851,6 +4486,7 @@ static const struct option {
 	  "			[ dst-mac %x:%x:%x:%x:%x:%x [m %x:%x:%x:%x:%x:%x] ]\n"
 	  "			[ action %d ]\n"
 	  "			[ loc %d]] |\n"
+	  "		load FILE|- |\n"
 	  "		delete %d\n" },
 	{ "-T|--show-time-stamping", 1, do_tsinfo,
 	  "Show time stamping capabilities" },
@@ -3891,6 +4527,18 @@ static const struct option {
 	  "		[ advertise %x ]\n"
 	  "		[ tx-lpi on|off ]\n"
 	  "		[ tx-timer %d ]\n"},
+	{ "--decode-dir", 0, do_decode_dir,
+	  "Decode the raw register dumps in DIR into OUTDIR",
+	  "		DIR OUTDIR driver NAME\n"
+	  "		[ version N ]\n"
+	  "		[ jobs N ]\n" },
+	{ "--decode-diff", 0, do_decode_diff,
+	  "Show the registers that differ between two raw dumps",
+	  "		FILE1 FILE2 driver NAME\n"
+	  "		[ version N ]\n" },
+	{ "--batch", 0, do_batch,
+	  "Run one command per line from FILE, or - for standard input",
+	  "		FILE|-\n" },
 	{ "-h|--help", 0, show_usage, "Show this help" },
 	{ "--version", 0, do_version, "Show version number" },
 	{}
@@ -3919,16 +4567,54 @@ static int show_usage(struct cmd_context *ctx)
 	return 0;
 }
 
-int main(int argc, char **argp)
+/* Commands that leave the device unchanged, so --batch may keep the
+ * driver information and string sets it has cached for the device.
+ */
+static int is_query(int (*func)(struct cmd_context *))
+{
+	static int (*const queries[])(struct cmd_context *) = {
+		do_gset, do_gpause, do_gcoalesce, do_gring, do_gfeatures,
+		do_gdrv, do_gregs, do_geeprom, do_phys_id, do_test,
+		do_gstats, do_grxclass, do_tsinfo, do_grxfhindir,
+		do_permaddr, do_getfwdump, do_gchannels, do_gprivflags,
+		do_getmodule, do_geee,
+	};
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(queries); i++)
+		if (func == queries[i])
+			return 1;
+	return 0;
+}
+
+static struct dev_cache *find_dev_cache(struct dev_cache **caches,
+					const char *devname)
+{
+	struct dev_cache *cache;
+
+	for (cache = *caches; cache; cache = cache->next)
+		if (!strcmp(cache->devname, devname))
+			return cache;
+
+	cache = calloc(1, sizeof(*cache));
+	if (!cache)
+		return NULL;
+	strcpy(cache->devname, devname);
+	cache->next = *caches;
+	*caches = cache;
+	return cache;
+}
+
+/* Run one command line.  ctx->fd is opened if the command needs it and
+ * kept for the next command.  With caches, device information is
+ * looked up in and added to the given list.
+ */
+static int do_command(struct cmd_context *ctx, int argc, char **argp,
+		      struct dev_cache **caches)
 {
 	int (*func)(struct cmd_context *);
 	int want_device;
-	struct cmd_context ctx;
-	int k;
-
-	/* Skip command name */
-	argp++;
-	argc--;
+	int k, rc;
 
 	/* First argument must be either a valid option or a device
 	 * name to get settings for (which we don't expect to begin
@@ -3961,31 +4647,149 @@ int main(int argc, char **argp)
 	want_device = 1;
 
 opt_found:
+	ctx->cache = NULL;
 	if (want_device) {
-		ctx.devname = *argp++;
+		ctx->devname = *argp++;
 		argc--;
 
-		if (ctx.devname == NULL)
+		if (ctx->devname == NULL)
 			exit_bad_args();
-		if (strlen(ctx.devname) >= IFNAMSIZ)
+		if (strlen(ctx->devname) >= IFNAMSIZ)
 			exit_bad_args();
 
 		/* Setup our control structures. */
-		memset(&ctx.ifr, 0, sizeof(ctx.ifr));
-		strcpy(ctx.ifr.ifr_name, ctx.devname);
+		memset(&ctx->ifr, 0, sizeof(ctx->ifr));
+		strcpy(ctx->ifr.ifr_name, ctx->devname);
 
 		/* Open control socket. */
-		ctx.fd = socket(AF_INET, SOCK_DGRAM, 0);
-		if (ctx.fd < 0) {
-			perror("Cannot get control socket");
-			return 70;
+		if (ctx->fd < 0) {
+			ctx->fd = socket(AF_INET, SOCK_DGRAM, 0);
+			if (ctx->fd < 0) {
+				perror("Cannot get control socket");
+				return 70;
+			}
 		}
+
+		if (caches)
+			ctx->cache = find_dev_cache(caches, ctx->devname);
+	}
+
+	ctx->argc = argc;
+	ctx->argp = argp;
+
+	rc = func(ctx);
+	if (ctx->cache && !is_query(func))
+		flush_dev_cache(ctx->cache);
+	return rc;
+}
+
+#define BATCH_MAX_LINE	1024
+#define BATCH_MAX_ARGS	(BATCH_MAX_LINE / 2)
+
+/* Read commands from a file, one per line, as they would be given after
+ * "ethtool" on the command line.  Empty lines and lines starting with
+ * '#' are skipped.  After each command a line giving its exit status is
+ * printed.
+ */
+static int do_batch(struct cmd_context *ctx)
+{
+	struct dev_cache *caches = NULL, *cache;
+	char line[BATCH_MAX_LINE + 1];
+	char *argp[BATCH_MAX_ARGS];
+	struct cmd_context batch_ctx;
+	unsigned int lineno = 0;
+	jmp_buf env;
+	int argc, rc, err = 0;
+	FILE *in;
+	char *p;
+
+	if (ctx->argc != 1 || batch_return)
+		exit_bad_args();
+
+	if (!strcmp(ctx->argp[0], "-")) {
+		in = stdin;
 	} else {
-		ctx.fd = -1;
+		in = fopen(ctx->argp[0], "r");
+		if (!in) {
+			perror("Cannot open batch file");
+			return 1;
+		}
 	}
 
-	ctx.argc = argc;
-	ctx.argp = argp;
+	memset(&batch_ctx, 0, sizeof(batch_ctx));
+	batch_ctx.fd = -1;
+
+	while (fgets(line, sizeof(line), in)) {
+		lineno++;
+
+		if (!strchr(line, '\n') && !feof(in)) {
+			fprintf(stderr, "Line %u is too long\n", lineno);
+			while (fgets(line, sizeof(line), in) &&
+			       !strchr(line, '\n'))
+				;
+			rc = 1;
+			goto status;
+		}
+
+		argc = 0;
+		for (p = strtok(line, " \t\r\n"); p;
+		     p = strtok(NULL, " \t\r\n")) {
+			if (argc == BATCH_MAX_ARGS - 1) {
+				fprintf(stderr,
+					"Line %u has too many arguments\n",
+					lineno);
+				rc = 1;
+				goto status;
+			}
+			argp[argc++] = p;
+		}
+		argp[argc] = NULL;
+
+		if (argc == 0 || argp[0][0] == '#')
+			continue;
+
+		rc = setjmp(env);
+		if (rc) {
+			rc--;
+		} else {
+			batch_return = &env;
+			rc = do_command(&batch_ctx, argc, argp, &caches);
+		}
+		batch_return = NULL;
+		cmd_free_all();
+
+	status:
+		fflush(stderr);
+		fprintf(stdout, "# line %u: exit status %d\n", lineno, rc);
+		fflush(stdout);
+		if (rc)
+			err = 1;
+	}
+
+	if (in != stdin)
+		fclose(in);
+	if (batch_ctx.fd >= 0)
+		close(batch_ctx.fd);
+	while (caches) {
+		cache = caches;
+		caches = cache->next;
+		flush_dev_cache(cache);
+		free(cache);
+	}
+
+	return err;
+}
+
+int main(int argc, char **argp)
+{
+	struct cmd_context ctx;
+
+	/* Skip command name */
+	argp++;
+	argc--;
 
-	return func(&ctx);
+	batch_return = NULL;
+	n_cmd_allocs = 0;
+	ctx.fd = -1;
+	return do_command(&ctx, argc, argp, NULL);
 }
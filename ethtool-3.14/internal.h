@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 #ifndef __APPLE__
 #include <endian.h>
@@ -165,10 +166,16 @@ struct cmd_context {
 	struct ifreq ifr;	/* ifreq suitable for ethtool ioctl */
 	int argc;		/* number of arguments to the sub-command */
 	char **argp;		/* arguments to the sub-command */
+	struct dev_cache *cache; /* device info kept by --batch, or NULL */
 };
 
 #ifdef TEST_ETHTOOL
 int test_cmdline(const char *args);
+int test_cmdline_output(const char *args, FILE *out);
+int test_cmdline_batch(const char *lines, FILE *out);
+double test_now(void);
+int test_check_rc(const char *args, int rc, int expected_rc);
+unsigned int test_blocks_left(void);
 
 struct cmd_expect {
 	const void *cmd;	/* expected command; NULL at end of list */
@@ -216,6 +223,12 @@ FILE *test_fopen(const char *path, const char *mode);
 int test_fclose(FILE *fh);
 #undef fclose
 #define fclose(fh) test_fclose(fh)
+int test_clock_gettime(clockid_t clk_id, struct timespec *tp);
+#undef clock_gettime
+#define clock_gettime(...) test_clock_gettime(__VA_ARGS__)
+int test_nanosleep(const struct timespec *req, struct timespec *rem);
+#undef nanosleep
+#define nanosleep(...) test_nanosleep(__VA_ARGS__)
 #endif
 #endif
 
@@ -224,6 +237,102 @@ int send_ioctl_set(struct cmd_context *ctx, void *cmd);
 
 void dump_hex(FILE *f, const u8 *data, int len, int offset);
 
+/* Table-driven register dumps.  A register dump is an array of 32-bit
+ * words; each register names the word it is stored in.
+ */
+
+/* A register field of bits lbn to lbn + width - 1, printed as one of
+ * names[] (or other if the value is beyond them), or as a number using
+ * fmt.  A field with neither is a heading.  The field is only shown if
+ * the register value matches cond_value under cond_mask.
+ */
+struct regdump_field {
+	const char *name;
+	u8 lbn, width;
+	u8 min_variant, max_variant;	/* max_variant 0 means no limit */
+	u32 cond_mask, cond_value;
+	const char *const *names;
+	u8 n_names;
+	const char *other;
+	const char *fmt;
+	u32 max;			/* numbers above this print as max */
+};
+
+#define REGDUMP_NAMES(...)						\
+	.names = (const char *const[]){ __VA_ARGS__ },			\
+	.n_names = ARRAY_SIZE(((const char *const[]){ __VA_ARGS__ }))
+#define REGDUMP_BIT(_name, _bit, _clear, _set)				\
+	.name = _name, .lbn = _bit, .width = 1, REGDUMP_NAMES(_clear, _set)
+#define REGDUMP_ENUM(_name, _lbn, _width, _other, ...)			\
+	.name = _name, .lbn = _lbn, .width = _width, .other = _other,	\
+	REGDUMP_NAMES(__VA_ARGS__)
+#define REGDUMP_NUM(_name, _lbn, _width, _fmt)				\
+	.name = _name, .lbn = _lbn, .width = _width, .fmt = _fmt
+#define REGDUMP_CONST(_name, _value)					\
+	.name = _name, REGDUMP_NAMES(_value)
+#define REGDUMP_HEADING(_name)	.name = _name
+#define REGDUMP_IF(_mask, _value)					\
+	.cond_mask = _mask, .cond_value = _value
+#define REGDUMP_VARIANTS(_min, _max)					\
+	.min_variant = _min, .max_variant = _max
+
+/* Register flags */
+#define REGDUMP_F_NO_ADDR	0x01	/* print no address */
+#define REGDUMP_F_DECODED	0x02	/* print the first field as value */
+
+/* A register, or an array of count registers in consecutive words.
+ * The name and description of an array are formats for the element
+ * number.  The register is only shown if word cond_index of the dump
+ * matches cond_value under cond_mask.
+ */
+struct regdump_reg {
+	const char *name, *desc;
+	u32 addr, addr_step;
+	u16 index, count;
+	u8 lbn, width;			/* width 0 means the whole word */
+	u8 flags;
+	u8 min_variant, max_variant;	/* max_variant 0 means no limit */
+	u16 cond_index;
+	u32 cond_mask, cond_value;
+	const struct regdump_field *fields;
+	u8 n_fields;
+};
+
+#define REGDUMP_REG(_addr, _index, _name, _desc)			\
+	.addr = _addr, .index = _index, .name = _name, .desc = _desc
+#define REGDUMP_ARRAY(_addr, _step, _index, _count, _name, _desc)	\
+	REGDUMP_REG(_addr, _index, _name, _desc),			\
+	.addr_step = _step, .count = _count
+#define REGDUMP_FIELDS(_fields)						\
+	.fields = _fields, .n_fields = ARRAY_SIZE(_fields)
+#define REGDUMP_IF_WORD(_index, _mask, _value)				\
+	.cond_index = _index, .cond_mask = _mask, .cond_value = _value
+
+/* The registers of a device, and the columns they are printed in */
+struct regdump_map {
+	const char *title;
+	const struct regdump_reg *regs;
+	unsigned int n_regs;
+	u8 name_width;		/* register names are padded to this */
+	u8 value_col;		/* register values start here */
+	u8 field_indent;
+	u8 field_col;		/* field values start here */
+};
+
+/* Look up the map and variant for a dump, or return -1 if the dump
+ * version is not known.
+ */
+typedef int regdump_map_fn(const struct ethtool_regs *regs,
+			   const struct regdump_map **map,
+			   unsigned int *variant);
+
+void regdump_print(FILE *out, const struct regdump_map *map,
+		   unsigned int variant, const u32 *words, unsigned int n_words);
+unsigned int regdump_diff(FILE *out, const struct regdump_map *map,
+			  unsigned int variant, const u32 *old_words,
+			  const u32 *new_words, unsigned int n_words);
+int regdump_dump_regs(regdump_map_fn *get_map, struct ethtool_regs *regs);
+
 /* National Semiconductor DP83815, DP83816 */
 int natsemi_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs);
 int natsemi_dump_eeprom(struct ethtool_drvinfo *info,
@@ -234,14 +343,17 @@ int de2104x_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs);
 
 /* Intel(R) PRO/1000 Gigabit Adapter Family */
 int e1000_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs);
+regdump_map_fn e1000_regdump_map;
 
 int igb_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs);
+regdump_map_fn igb_regdump_map;
 
 /* RealTek PCI */
 int realtek_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs);
 
 /* Intel(R) PRO/100 Fast Ethernet Adapter Family */
 int e100_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs);
+regdump_map_fn e100_regdump_map;
 
 /* Tigon3 */
 int tg3_dump_eeprom(struct ethtool_drvinfo *info, struct ethtool_eeprom *ee);
@@ -260,10 +372,13 @@ int ibm_emac_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs);
 
 /* Intel(R) PRO/10GBe Gigabit Adapter Family */
 int ixgb_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs);
+regdump_map_fn ixgb_regdump_map;
 
 int ixgbe_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs);
+regdump_map_fn ixgbe_regdump_map;
 
 int ixgbevf_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs);
+regdump_map_fn ixgbevf_regdump_map;
 
 /* Broadcom Tigon3 Ethernet controller */
 int tg3_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs);
@@ -301,6 +416,8 @@ int rxclass_rule_get(struct cmd_context *ctx, __u32 loc);
 int rxclass_rule_ins(struct cmd_context *ctx,
 		     struct ethtool_rx_flow_spec *fsp);
 int rxclass_rule_del(struct cmd_context *ctx, __u32 loc);
+int rxclass_rule_dump(struct cmd_context *ctx);
+int rxclass_rule_load(struct cmd_context *ctx, const char *filename);
 
 /* Module EEPROM parsing code */
 void sff8079_show_all(const __u8 *id);
@@ -2,37 +2,6 @@
 #include <stdio.h>
 #include "internal.h"
 
-/* Register Bit Masks */
-#define IXGBE_FCTRL_SBP            0x00000002
-#define IXGBE_FCTRL_MPE            0x00000100
-#define IXGBE_FCTRL_UPE            0x00000200
-#define IXGBE_FCTRL_BAM            0x00000400
-#define IXGBE_FCTRL_PMCF           0x00001000
-#define IXGBE_FCTRL_DPF            0x00002000
-#define IXGBE_FCTRL_RPFCE          0x00004000
-#define IXGBE_FCTRL_RFCE           0x00008000
-#define IXGBE_VLNCTRL_VET          0x0000FFFF
-#define IXGBE_VLNCTRL_CFI          0x10000000
-#define IXGBE_VLNCTRL_CFIEN        0x20000000
-#define IXGBE_VLNCTRL_VFE          0x40000000
-#define IXGBE_VLNCTRL_VME          0x80000000
-#define IXGBE_LINKS_UP             0x40000000
-#define IXGBE_LINKS_SPEED          0x20000000
-#define IXGBE_SRRCTL_BSIZEPKT_MASK 0x0000007F
-#define IXGBE_HLREG0_TXCRCEN       0x00000001
-#define IXGBE_HLREG0_RXCRCSTRP     0x00000002
-#define IXGBE_HLREG0_JUMBOEN       0x00000004
-#define IXGBE_HLREG0_TXPADEN       0x00000400
-#define IXGBE_HLREG0_LPBK          0x00008000
-#define IXGBE_RMCS_TFCE_802_3X     0x00000008
-#define IXGBE_RMCS_TFCE_PRIORITY   0x00000010
-#define IXGBE_FCCFG_TFCE_802_3X    0x00000008
-#define IXGBE_FCCFG_TFCE_PRIORITY  0x00000010
-#define IXGBE_MFLCN_PMCF           0x00000001 /* Pass MAC Control Frames */
-#define IXGBE_MFLCN_DPF            0x00000002 /* Discard Pause Frame */
-#define IXGBE_MFLCN_RPFCE          0x00000004 /* Receive Priority FC Enable */
-#define IXGBE_MFLCN_RFCE           0x00000008 /* Receive FC Enable */
-
 /* Device IDs */
 #define IXGBE_DEV_ID_82598               0x10B6
 #define IXGBE_DEV_ID_82598_BX            0x1508
@@ -125,1128 +94,501 @@ ixgbe_get_mac_type(u16 device_id)
 	return mac_type;
 }
 
-int
-ixgbe_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs)
-{
-	u32 *regs_buff = (u32 *)regs->data;
-	u32 regs_buff_len = regs->len / sizeof(*regs_buff);
-	u32 reg;
-	u16 hw_device_id = (u16) regs->version;
-	u8 version = (u8)(regs->version >> 24);
-	u8 i;
-	enum ixgbe_mac_type mac_type;
-
-	if (version == 0)
-		return -1;
-
-	/* The current driver reports the MAC type, but older versions
-	 * only report the device ID so we have to infer the MAC type.
-	 */
-	mac_type = version > 1 ? version : ixgbe_get_mac_type(hw_device_id);
-
-	reg = regs_buff[1065];
-	fprintf(stdout,
-	"0x042A4: LINKS (Link Status register)                 0x%08X\n"
-	"       Link Status:                                   %s\n"
-	"       Link Speed:                                    %s\n",
-	reg,
-	reg & IXGBE_LINKS_UP      ? "up"       : "down",
-	reg & IXGBE_LINKS_SPEED   ? "10G"      : "1G");
+static const struct regdump_field ixgbe_links[] = {
+	{ REGDUMP_BIT("Link Status", 30, "down", "up") },
+	{ REGDUMP_BIT("Link Speed", 29, "1G", "10G") },
+};
 
-	reg = regs_buff[515];
-	fprintf(stdout,
-	"0x05080: FCTRL (Filter Control register)              0x%08X\n"
-	"       Broadcast Accept:                              %s\n"
-	"       Unicast Promiscuous:                           %s\n"
-	"       Multicast Promiscuous:                         %s\n"
-	"       Store Bad Packets:                             %s\n",
-	reg,
-	reg & IXGBE_FCTRL_BAM     ? "enabled"  : "disabled",
-	reg & IXGBE_FCTRL_UPE     ? "enabled"  : "disabled",
-	reg & IXGBE_FCTRL_MPE     ? "enabled"  : "disabled",
-	reg & IXGBE_FCTRL_SBP     ? "enabled"  : "disabled");
+/* Some FCTRL bits are valid only on 82598, later MACs have them in MFLCN */
+static const struct regdump_field ixgbe_fctrl[] = {
+	{ REGDUMP_BIT("Broadcast Accept", 10, "disabled", "enabled") },
+	{ REGDUMP_BIT("Unicast Promiscuous", 9, "disabled", "enabled") },
+	{ REGDUMP_BIT("Multicast Promiscuous", 8, "disabled", "enabled") },
+	{ REGDUMP_BIT("Store Bad Packets", 1, "disabled", "enabled") },
+	{ REGDUMP_BIT("Receive Flow Control Packets", 15,
+		      "disabled", "enabled"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_BIT("Receive Priority Flow Control Packets", 14,
+		      "disabled", "enabled"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_BIT("Discard Pause Frames", 13, "disabled", "enabled"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_BIT("Pass MAC Control Frames", 12, "disabled", "enabled"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+};
 
-	/* Some FCTRL bits are valid only on 82598 */
-	if (mac_type == ixgbe_mac_82598EB) {
-		fprintf(stdout,
-		"       Receive Flow Control Packets:                  %s\n"
-		"       Receive Priority Flow Control Packets:         %s\n"
-		"       Discard Pause Frames:                          %s\n"
-		"       Pass MAC Control Frames:                       %s\n",
-		reg & IXGBE_FCTRL_RFCE    ? "enabled"  : "disabled",
-		reg & IXGBE_FCTRL_RPFCE   ? "enabled"  : "disabled",
-		reg & IXGBE_FCTRL_DPF     ? "enabled"  : "disabled",
-		reg & IXGBE_FCTRL_PMCF    ? "enabled"  : "disabled");
-	 }
+static const struct regdump_field ixgbe_mflcn[] = {
+	{ REGDUMP_BIT("Receive Flow Control Packets", 3,
+		      "disabled", "enabled") },
+	{ REGDUMP_BIT("Discard Pause Frames", 1, "disabled", "enabled") },
+	{ REGDUMP_BIT("Pass MAC Control Frames", 0, "disabled", "enabled") },
+	{ REGDUMP_BIT("Receive Priority Flow Control Packets", 2,
+		      "disabled", "enabled") },
+};
 
-	reg = regs_buff[1128];
-	if (mac_type >= ixgbe_mac_82599EB) {
-		fprintf(stdout,
-		"0x04294: MFLCN (TabMAC Flow Control register)         0x%08X\n"
-		"       Receive Flow Control Packets:                  %s\n"
-		"       Discard Pause Frames:                          %s\n"
-		"       Pass MAC Control Frames:                       %s\n"
-		"       Receive Priority Flow Control Packets:         %s\n",
-		reg,
-		reg & IXGBE_MFLCN_RFCE    ? "enabled"  : "disabled",
-		reg & IXGBE_FCTRL_DPF     ? "enabled"  : "disabled",
-		reg & IXGBE_FCTRL_PMCF    ? "enabled"  : "disabled",
-		reg & IXGBE_FCTRL_RPFCE   ? "enabled"  : "disabled");
-	}
+static const struct regdump_field ixgbe_vlnctrl[] = {
+	{ REGDUMP_BIT("VLAN Mode", 31, "disabled", "enabled") },
+	{ REGDUMP_BIT("VLAN Filter", 30, "disabled", "enabled") },
+};
 
-	reg = regs_buff[516];
-	fprintf(stdout,
-	"0x05088: VLNCTRL (VLAN Control register)              0x%08X\n"
-	"       VLAN Mode:                                     %s\n"
-	"       VLAN Filter:                                   %s\n",
-	reg,
-	reg & IXGBE_VLNCTRL_VME   ? "enabled"  : "disabled",
-	reg & IXGBE_VLNCTRL_VFE   ? "enabled"  : "disabled");
+static const struct regdump_field ixgbe_srrctl[] = {
+	{ REGDUMP_NUM("Receive Buffer Size", 0, 7, "%uKB"), .max = 16 },
+};
 
-	reg = regs_buff[437];
-	fprintf(stdout,
-	"0x02100: SRRCTL0 (Split and Replic Rx Control 0)      0x%08X\n"
-	"       Receive Buffer Size:                           %uKB\n",
-	reg,
-	(reg & IXGBE_SRRCTL_BSIZEPKT_MASK) <= 0x10 ? (reg & IXGBE_SRRCTL_BSIZEPKT_MASK) : 0x10);
+/* RMCS on 82598 and FCCFG on later MACs have the same layout */
+static const struct regdump_field ixgbe_fccfg[] = {
+	{ REGDUMP_BIT("Transmit Flow Control", 3, "disabled", "enabled") },
+	{ REGDUMP_BIT("Priority Flow Control", 4, "disabled", "enabled") },
+};
 
-	reg = regs_buff[829];
-	if (mac_type == ixgbe_mac_82598EB) {
-		fprintf(stdout,
-		"0x03D00: RMCS (Receive Music Control register)        0x%08X\n"
-		"       Transmit Flow Control:                         %s\n"
-		"       Priority Flow Control:                         %s\n",
-		reg,
-		reg & IXGBE_RMCS_TFCE_802_3X     ? "enabled"  : "disabled",
-		reg & IXGBE_RMCS_TFCE_PRIORITY   ? "enabled"  : "disabled");
-	} else if (mac_type >= ixgbe_mac_82599EB) {
-		fprintf(stdout,
-		"0x03D00: FCCFG (Flow Control Configuration)           0x%08X\n"
-		"       Transmit Flow Control:                         %s\n"
-		"       Priority Flow Control:                         %s\n",
-		reg,
-		reg & IXGBE_FCCFG_TFCE_802_3X     ? "enabled"  : "disabled",
-		reg & IXGBE_FCCFG_TFCE_PRIORITY   ? "enabled"  : "disabled");
-	}
+static const struct regdump_field ixgbe_hlreg0[] = {
+	{ REGDUMP_BIT("Transmit CRC", 0, "disabled", "enabled") },
+	{ REGDUMP_BIT("Receive CRC Strip", 1, "disabled", "enabled") },
+	{ REGDUMP_BIT("Jumbo Frames", 2, "disabled", "enabled") },
+	{ REGDUMP_BIT("Pad Short Frames", 10, "disabled", "enabled") },
+	{ REGDUMP_BIT("Loopback", 15, "disabled", "enabled") },
+};
 
-	reg = regs_buff[1047];
-	fprintf(stdout,
-	"0x04250: HLREG0 (Highlander Control 0 register)       0x%08X\n"
-	"       Transmit CRC:                                  %s\n"
-	"       Receive CRC Strip:                             %s\n"
-	"       Jumbo Frames:                                  %s\n"
-	"       Pad Short Frames:                              %s\n"
-	"       Loopback:                                      %s\n",
-	reg,
-	reg & IXGBE_HLREG0_TXCRCEN   ? "enabled"  : "disabled",
-	reg & IXGBE_HLREG0_RXCRCSTRP ? "enabled"  : "disabled",
-	reg & IXGBE_HLREG0_JUMBOEN   ? "enabled"  : "disabled",
-	reg & IXGBE_HLREG0_TXPADEN   ? "enabled"  : "disabled",
-	reg & IXGBE_HLREG0_LPBK      ? "enabled"  : "disabled");
+/* Registers from word 1129 on are only in dumps from newer drivers */
+static const struct regdump_reg ixgbe_regs[] = {
+	{ REGDUMP_REG(0x042A4, 1065, "LINKS", "Link Status register"),
+	  REGDUMP_FIELDS(ixgbe_links) },
+	{ REGDUMP_REG(0x05080, 515, "FCTRL", "Filter Control register"),
+	  REGDUMP_FIELDS(ixgbe_fctrl) },
+	{ REGDUMP_REG(0x04294, 1128, "MFLCN", "TabMAC Flow Control register"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0),
+	  REGDUMP_FIELDS(ixgbe_mflcn) },
+	{ REGDUMP_REG(0x05088, 516, "VLNCTRL", "VLAN Control register"),
+	  REGDUMP_FIELDS(ixgbe_vlnctrl) },
+	{ REGDUMP_REG(0x02100, 437, "SRRCTL0",
+		      "Split and Replic Rx Control 0"),
+	  REGDUMP_FIELDS(ixgbe_srrctl) },
+	{ REGDUMP_REG(0x03D00, 829, "RMCS", "Receive Music Control register"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB),
+	  REGDUMP_FIELDS(ixgbe_fccfg) },
+	{ REGDUMP_REG(0x03D00, 829, "FCCFG", "Flow Control Configuration"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0),
+	  REGDUMP_FIELDS(ixgbe_fccfg) },
+	{ REGDUMP_REG(0x04250, 1047, "HLREG0", "Highlander Control 0 register"),
+	  REGDUMP_FIELDS(ixgbe_hlreg0) },
 
 	/* General Registers */
-	fprintf(stdout,
-		"0x00000: CTRL        (Device Control)                 0x%08X\n",
-		regs_buff[0]);
-
-	fprintf(stdout,
-		"0x00008: STATUS      (Device Status)                  0x%08X\n",
-		regs_buff[1]);
-
-	fprintf(stdout,
-		"0x00018: CTRL_EXT    (Extended Device Control)        0x%08X\n",
-		regs_buff[2]);
-
-	fprintf(stdout,
-		"0x00020: ESDP        (Extended SDP Control)           0x%08X\n",
-		regs_buff[3]);
-
-	fprintf(stdout,
-		"0x00028: EODSDP      (Extended OD SDP Control)        0x%08X\n",
-		regs_buff[4]);
-
-	fprintf(stdout,
-		"0x00200: LEDCTL      (LED Control)                    0x%08X\n",
-		regs_buff[5]);
-
-	fprintf(stdout,
-		"0x00048: FRTIMER     (Free Running Timer)             0x%08X\n",
-		regs_buff[6]);
-
-	fprintf(stdout,
-		"0x0004C: TCPTIMER    (TCP Timer)                      0x%08X\n",
-		regs_buff[7]);
-
+	{ REGDUMP_REG(0x00000, 0, "CTRL", "Device Control") },
+	{ REGDUMP_REG(0x00008, 1, "STATUS", "Device Status") },
+	{ REGDUMP_REG(0x00018, 2, "CTRL_EXT", "Extended Device Control") },
+	{ REGDUMP_REG(0x00020, 3, "ESDP", "Extended SDP Control") },
+	{ REGDUMP_REG(0x00028, 4, "EODSDP", "Extended OD SDP Control") },
+	{ REGDUMP_REG(0x00200, 5, "LEDCTL", "LED Control") },
+	{ REGDUMP_REG(0x00048, 6, "FRTIMER", "Free Running Timer") },
+	{ REGDUMP_REG(0x0004C, 7, "TCPTIMER", "TCP Timer") },
 	/* NVM Register */
-	fprintf(stdout,
-		"0x10010: EEC         (EEPROM/Flash Control)           0x%08X\n",
-		regs_buff[8]);
-
-	fprintf(stdout,
-		"0x10014: EERD        (EEPROM Read)                    0x%08X\n",
-		regs_buff[9]);
-
-	fprintf(stdout,
-		"0x1001C: FLA         (Flash Access)                   0x%08X\n",
-		regs_buff[10]);
-
-	fprintf(stdout,
-		"0x10110: EEMNGCTL    (Manageability EEPROM Control)   0x%08X\n",
-		regs_buff[11]);
-
-	fprintf(stdout,
-		"0x10114: EEMNGDATA   (Manageability EEPROM R/W Data)  0x%08X\n",
-		regs_buff[12]);
-
-	fprintf(stdout,
-		"0x10110: FLMNGCTL    (Manageability Flash Control)    0x%08X\n",
-		regs_buff[13]);
-
-	fprintf(stdout,
-		"0x1011C: FLMNGDATA   (Manageability Flash Read Data)  0x%08X\n",
-		regs_buff[14]);
-
-	fprintf(stdout,
-		"0x10120: FLMNGCNT    (Manageability Flash Read Count) 0x%08X\n",
-		regs_buff[15]);
-
-	fprintf(stdout,
-		"0x1013C: FLOP        (Flash Opcode)                   0x%08X\n",
-		regs_buff[16]);
-
-	fprintf(stdout,
-		"0x10200: GRC         (General Receive Control)        0x%08X\n",
-		regs_buff[17]);
-
+	{ REGDUMP_REG(0x10010, 8, "EEC", "EEPROM/Flash Control") },
+	{ REGDUMP_REG(0x10014, 9, "EERD", "EEPROM Read") },
+	{ REGDUMP_REG(0x1001C, 10, "FLA", "Flash Access") },
+	{ REGDUMP_REG(0x10110, 11, "EEMNGCTL",
+		      "Manageability EEPROM Control") },
+	{ REGDUMP_REG(0x10114, 12, "EEMNGDATA",
+		      "Manageability EEPROM R/W Data") },
+	{ REGDUMP_REG(0x10110, 13, "FLMNGCTL", "Manageability Flash Control") },
+	{ REGDUMP_REG(0x1011C, 14, "FLMNGDATA",
+		      "Manageability Flash Read Data") },
+	{ REGDUMP_REG(0x10120, 15, "FLMNGCNT",
+		      "Manageability Flash Read Count") },
+	{ REGDUMP_REG(0x1013C, 16, "FLOP", "Flash Opcode") },
+	{ REGDUMP_REG(0x10200, 17, "GRC", "General Receive Control") },
 	/* Interrupt */
-	fprintf(stdout,
-		"0x00800: EICR        (Extended Interrupt Cause)       0x%08X\n",
-		regs_buff[18]);
-
-	fprintf(stdout,
-		"0x00808: EICS        (Extended Interrupt Cause Set)   0x%08X\n",
-		regs_buff[19]);
-
-	fprintf(stdout,
-		"0x00880: EIMS        (Extended Interr. Mask Set/Read) 0x%08X\n",
-		regs_buff[20]);
-
-	fprintf(stdout,
-		"0x00888: EIMC        (Extended Interrupt Mask Clear)  0x%08X\n",
-		regs_buff[21]);
-
-	fprintf(stdout,
-		"0x00810: EIAC        (Extended Interrupt Auto Clear)  0x%08X\n",
-		regs_buff[22]);
-
-	fprintf(stdout,
-		"0x00890: EIAM        (Extended Interr. Auto Mask EN)  0x%08X\n",
-		regs_buff[23]);
-
-	fprintf(stdout,
-		"0x00820: EITR0       (Extended Interrupt Throttle 0)  0x%08X\n",
-		regs_buff[24]);
-
-	fprintf(stdout,
-		"0x00900: IVAR0       (Interrupt Vector Allocation 0)  0x%08X\n",
-		regs_buff[25]);
-
-	fprintf(stdout,
-		"0x00000: MSIXT       (MSI-X Table)                    0x%08X\n",
-		regs_buff[26]);
-
-	if (mac_type == ixgbe_mac_82598EB)
-		fprintf(stdout,
-			"0x02000: MSIXPBA     (MSI-X Pending Bit Array)        0x%08X\n",
-			regs_buff[27]);
-
-	fprintf(stdout,
-		"0x11068: PBACL       (MSI-X PBA Clear)                0x%08X\n",
-		regs_buff[28]);
-
-	fprintf(stdout,
-		"0x00898: GPIE        (General Purpose Interrupt EN)   0x%08X\n",
-		regs_buff[29]);
-
+	{ REGDUMP_REG(0x00800, 18, "EICR", "Extended Interrupt Cause") },
+	{ REGDUMP_REG(0x00808, 19, "EICS", "Extended Interrupt Cause Set") },
+	{ REGDUMP_REG(0x00880, 20, "EIMS", "Extended Interr. Mask Set/Read") },
+	{ REGDUMP_REG(0x00888, 21, "EIMC", "Extended Interrupt Mask Clear") },
+	{ REGDUMP_REG(0x00810, 22, "EIAC", "Extended Interrupt Auto Clear") },
+	{ REGDUMP_REG(0x00890, 23, "EIAM", "Extended Interr. Auto Mask EN") },
+	{ REGDUMP_REG(0x00820, 24, "EITR0", "Extended Interrupt Throttle 0") },
+	{ REGDUMP_REG(0x00900, 25, "IVAR0", "Interrupt Vector Allocation 0") },
+	{ REGDUMP_REG(0x00000, 26, "MSIXT", "MSI-X Table") },
+	{ REGDUMP_REG(0x02000, 27, "MSIXPBA", "MSI-X Pending Bit Array"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_REG(0x11068, 28, "PBACL", "MSI-X PBA Clear") },
+	{ REGDUMP_REG(0x00898, 29, "GPIE", "General Purpose Interrupt EN") },
 	/* Flow Control */
-	fprintf(stdout,
-		"0x03008: PFCTOP      (Priority Flow Ctrl Type Opcode) 0x%08X\n",
-		regs_buff[30]);
-
-	for (i = 0; i < 4; i++)
-		fprintf(stdout,
-		"0x%05X: FCCTV%d      (Flow Ctrl Tx Timer Value %d)     0x%08X\n",
-		0x03200 + (4 * i), i, i, regs_buff[31 + i]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: FCRTL%d      (Flow Ctrl Rx Threshold low %d)   0x%08X\n",
-		0x3220 + (8 * i), i, i, regs_buff[35 + i]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: FCRTH%d      (Flow Ctrl Rx Threshold High %d)  0x%08X\n",
-		0x3260 + (8 * i), i, i, regs_buff[43 + i]);
-
-	fprintf(stdout,
-		"0x032A0: FCRTV       (Flow Control Refresh Threshold) 0x%08X\n",
-		regs_buff[51]);
-
-	fprintf(stdout,
-		"0x0CE00: TFCS        (Transmit Flow Control Status)   0x%08X\n",
-		regs_buff[52]);
-
+	{ REGDUMP_REG(0x03008, 30, "PFCTOP",
+		      "Priority Flow Ctrl Type Opcode") },
+	{ REGDUMP_ARRAY(0x03200, 0x4, 31, 4, "FCCTV%d",
+			"Flow Ctrl Tx Timer Value %d") },
+	{ REGDUMP_ARRAY(0x03220, 0x8, 35, 8, "FCRTL%d",
+			"Flow Ctrl Rx Threshold low %d") },
+	{ REGDUMP_ARRAY(0x03260, 0x8, 43, 8, "FCRTH%d",
+			"Flow Ctrl Rx Threshold High %d") },
+	{ REGDUMP_REG(0x032A0, 51, "FCRTV", "Flow Control Refresh Threshold") },
+	{ REGDUMP_REG(0x0CE00, 52, "TFCS", "Transmit Flow Control Status") },
 	/* Receive DMA */
-	for (i = 0; i < 64; i++)
-		fprintf(stdout,
-		"0x%05X: RDBAL%02d     (Rx Desc Base Addr Low %02d)       0x%08X\n",
-		0x01000 + (0x40 * i), i, i, regs_buff[53 + i]);
-
-	for (i = 0; i < 64; i++)
-		fprintf(stdout,
-		"0x%05X: RDBAH%02d     (Rx Desc Base Addr High %02d)      0x%08X\n",
-		0x01004 + (0x40 * i), i, i, regs_buff[117 + i]);
-
-	for (i = 0; i < 64; i++)
-		fprintf(stdout,
-		"0x%05X: RDLEN%02d     (Receive Descriptor Length %02d)   0x%08X\n",
-		0x01008 + (0x40 * i), i, i, regs_buff[181 + i]);
-
-	for (i = 0; i < 64; i++)
-		fprintf(stdout,
-		"0x%05X: RDH%02d       (Receive Descriptor Head %02d)     0x%08X\n",
-		0x01010 + (0x40 * i), i, i, regs_buff[245 + i]);
-
-	for (i = 0; i < 64; i++)
-		fprintf(stdout,
-		"0x%05X: RDT%02d       (Receive Descriptor Tail %02d)     0x%08X\n",
-		0x01018 + (0x40 * i), i, i, regs_buff[309 + i]);
-
-	for (i = 0; i < 64; i++)
-		fprintf(stdout,
-		"0x%05X: RXDCTL%02d    (Receive Descriptor Control %02d)  0x%08X\n",
-		0x01028 + (0x40 * i), i, i, regs_buff[373 + i]);
-
-	for (i = 0; i < 16; i++)
-		fprintf(stdout,
-		"0x%05X: SRRCTL%02d    (Split and Replic Rx Control %02d) 0x%08X\n",
-		0x02100 + (4 * i), i, i, regs_buff[437 + i]);
-
-	for (i = 0; i < 16; i++)
-		fprintf(stdout,
-		"0x%05X: DCA_RXCTRL%02d (Rx DCA Control %02d)             0x%08X\n",
-		0x02200 + (4 * i), i, i, regs_buff[453 + i]);
-
-	fprintf(stdout,
-		"0x02F00: RDRXCTL     (Receive DMA Control)            0x%08X\n",
-		regs_buff[469]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: RXPBSIZE%d   (Receive Packet Buffer Size %d)   0x%08X\n",
-		0x3C00 + (4 * i), i, i, regs_buff[470 + i]);
-
-	fprintf(stdout,
-		"0x03000: RXCTRL      (Receive Control)                0x%08X\n",
-		regs_buff[478]);
-
-	if (mac_type == ixgbe_mac_82598EB)
-		fprintf(stdout,
-			"0x03D04: DROPEN      (Drop Enable Control)            0x%08X\n",
-			regs_buff[479]);
-
+	{ REGDUMP_ARRAY(0x01000, 0x40, 53, 64, "RDBAL%02d",
+			"Rx Desc Base Addr Low %02d") },
+	{ REGDUMP_ARRAY(0x01004, 0x40, 117, 64, "RDBAH%02d",
+			"Rx Desc Base Addr High %02d") },
+	{ REGDUMP_ARRAY(0x01008, 0x40, 181, 64, "RDLEN%02d",
+			"Receive Descriptor Length %02d") },
+	{ REGDUMP_ARRAY(0x01010, 0x40, 245, 64, "RDH%02d",
+			"Receive Descriptor Head %02d") },
+	{ REGDUMP_ARRAY(0x01018, 0x40, 309, 64, "RDT%02d",
+			"Receive Descriptor Tail %02d") },
+	{ REGDUMP_ARRAY(0x01028, 0x40, 373, 64, "RXDCTL%02d",
+			"Receive Descriptor Control %02d") },
+	{ REGDUMP_ARRAY(0x02100, 0x4, 437, 16, "SRRCTL%02d",
+			"Split and Replic Rx Control %02d") },
+	{ REGDUMP_ARRAY(0x02200, 0x4, 453, 16, "DCA_RXCTRL%02d",
+			"Rx DCA Control %02d") },
+	{ REGDUMP_REG(0x02F00, 469, "RDRXCTL", "Receive DMA Control") },
+	{ REGDUMP_ARRAY(0x03C00, 0x4, 470, 8, "RXPBSIZE%d",
+			"Receive Packet Buffer Size %d") },
+	{ REGDUMP_REG(0x03000, 478, "RXCTRL", "Receive Control") },
+	{ REGDUMP_REG(0x03D04, 479, "DROPEN", "Drop Enable Control"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
 	/* Receive */
-	fprintf(stdout,
-		"0x05000: RXCSUM      (Receive Checksum Control)       0x%08X\n",
-		regs_buff[480]);
-
-	fprintf(stdout,
-		"0x05008: RFCTL       (Receive Filter Control)         0x%08X\n",
-		regs_buff[481]);
-
-	for (i = 0; i < 16; i++)
-		fprintf(stdout,
-		"0x%05X: RAL%02d       (Receive Address Low%02d)          0x%08X\n",
-		0x05400 + (8 * i), i, i, regs_buff[482 + i]);
-
-	for (i = 0; i < 16; i++)
-		fprintf(stdout,
-		"0x%05X: RAH%02d       (Receive Address High %02d)        0x%08X\n",
-		0x05404 + (8 * i), i, i, regs_buff[498 + i]);
-
-	fprintf(stdout,
-		"0x05480: PSRTYPE     (Packet Split Receive Type)      0x%08X\n",
-		regs_buff[514]);
-
-	fprintf(stdout,
-		"0x05090: MCSTCTRL    (Multicast Control)              0x%08X\n",
-		regs_buff[517]);
-
-	fprintf(stdout,
-		"0x05818: MRQC        (Multiple Rx Queues Command)     0x%08X\n",
-		regs_buff[518]);
-
-	fprintf(stdout,
-		"0x0581C: VMD_CTL     (VMDq Control)                   0x%08X\n",
-		regs_buff[519]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: IMIR%d       (Immediate Interrupt Rx %d)       0x%08X\n",
-		0x05A80 + (4 * i), i, i, regs_buff[520 + i]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: IMIREXT%d    (Immed. Interr. Rx Extended %d)   0x%08X\n",
-		0x05AA0 + (4 * i), i, i, regs_buff[528 + i]);
-
-	fprintf(stdout,
-		"0x05AC0: IMIRVP      (Immed. Interr. Rx VLAN Prior.)  0x%08X\n",
-		regs_buff[536]);
-
+	{ REGDUMP_REG(0x05000, 480, "RXCSUM", "Receive Checksum Control") },
+	{ REGDUMP_REG(0x05008, 481, "RFCTL", "Receive Filter Control") },
+	{ REGDUMP_ARRAY(0x05400, 0x8, 482, 16, "RAL%02d",
+			"Receive Address Low%02d") },
+	{ REGDUMP_ARRAY(0x05404, 0x8, 498, 16, "RAH%02d",
+			"Receive Address High %02d") },
+	{ REGDUMP_REG(0x05480, 514, "PSRTYPE", "Packet Split Receive Type") },
+	{ REGDUMP_REG(0x05090, 517, "MCSTCTRL", "Multicast Control") },
+	{ REGDUMP_REG(0x05818, 518, "MRQC", "Multiple Rx Queues Command") },
+	{ REGDUMP_REG(0x0581C, 519, "VMD_CTL", "VMDq Control") },
+	{ REGDUMP_ARRAY(0x05A80, 0x4, 520, 8, "IMIR%d",
+			"Immediate Interrupt Rx %d") },
+	{ REGDUMP_ARRAY(0x05AA0, 0x4, 528, 8, "IMIREXT%d",
+			"Immed. Interr. Rx Extended %d") },
+	{ REGDUMP_REG(0x05AC0, 536, "IMIRVP",
+		      "Immed. Interr. Rx VLAN Prior.") },
 	/* Transmit */
-	for (i = 0; i < 32; i++)
-		fprintf(stdout,
-		"0x%05X: TDBAL%02d     (Tx Desc Base Addr Low %02d)       0x%08X\n",
-		0x06000 + (0x40 * i), i, i, regs_buff[537 + i]);
-
-	for (i = 0; i < 32; i++)
-		fprintf(stdout,
-		"0x%05X: TDBAH%02d     (Tx Desc Base Addr High %02d)      0x%08X\n",
-		0x06004 + (0x40 * i), i, i, regs_buff[569 + i]);
-
-	for (i = 0; i < 32; i++)
-		fprintf(stdout,
-		"0x%05X: TDLEN%02d     (Tx Descriptor Length %02d)        0x%08X\n",
-		0x06008 + (0x40 * i), i, i, regs_buff[601 + i]);
-
-	for (i = 0; i < 32; i++)
-		fprintf(stdout,
-		"0x%05X: TDH%02d       (Transmit Descriptor Head %02d)    0x%08X\n",
-		0x06010 + (0x40 * i), i, i, regs_buff[633 + i]);
-
-	for (i = 0; i < 32; i++)
-		fprintf(stdout,
-		"0x%05X: TDT%02d       (Transmit Descriptor Tail %02d)    0x%08X\n",
-		0x06018 + (0x40 * i), i, i, regs_buff[665 + i]);
-
-	for (i = 0; i < 32; i++)
-		fprintf(stdout,
-		"0x%05X: TXDCTL%02d    (Tx Descriptor Control %02d)       0x%08X\n",
-		0x06028 + (0x40 * i), i, i, regs_buff[697 + i]);
-
-	for (i = 0; i < 32; i++)
-		fprintf(stdout,
-		"0x%05X: TDWBAL%02d    (Tx Desc Compl. WB Addr low %02d)  0x%08X\n",
-		0x06038 + (0x40 * i), i, i, regs_buff[729 + i]);
-
-	for (i = 0; i < 32; i++)
-		fprintf(stdout,
-		"0x%05X: TDWBAH%02d    (Tx Desc Compl. WB Addr High %02d) 0x%08X\n",
-		0x0603C + (0x40 * i), i, i, regs_buff[761 + i]);
-
-	fprintf(stdout,
-		"0x07E00: DTXCTL      (DMA Tx Control)                 0x%08X\n",
-		regs_buff[793]);
-
-	for (i = 0; i < 16; i++)
-		fprintf(stdout,
-		"0x%05X: DCA_TXCTRL%02d (Tx DCA Control %02d)             0x%08X\n",
-		0x07200 + (4 * i), i, i, regs_buff[794 + i]);
-
-	if (mac_type == ixgbe_mac_82598EB)
-		fprintf(stdout,
-			"0x0CB00: TIPG        (Transmit IPG Control)           0x%08X\n",
-			regs_buff[810]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: TXPBSIZE%d   (Transmit Packet Buffer Size %d)  0x%08X\n",
-		0x0CC00 + (4 * i), i, i, regs_buff[811 + i]);
-
-	fprintf(stdout,
-		"0x0CD10: MNGTXMAP    (Manageability Tx TC Mapping)    0x%08X\n",
-		regs_buff[819]);
-
+	{ REGDUMP_ARRAY(0x06000, 0x40, 537, 32, "TDBAL%02d",
+			"Tx Desc Base Addr Low %02d") },
+	{ REGDUMP_ARRAY(0x06004, 0x40, 569, 32, "TDBAH%02d",
+			"Tx Desc Base Addr High %02d") },
+	{ REGDUMP_ARRAY(0x06008, 0x40, 601, 32, "TDLEN%02d",
+			"Tx Descriptor Length %02d") },
+	{ REGDUMP_ARRAY(0x06010, 0x40, 633, 32, "TDH%02d",
+			"Transmit Descriptor Head %02d") },
+	{ REGDUMP_ARRAY(0x06018, 0x40, 665, 32, "TDT%02d",
+			"Transmit Descriptor Tail %02d") },
+	{ REGDUMP_ARRAY(0x06028, 0x40, 697, 32, "TXDCTL%02d",
+			"Tx Descriptor Control %02d") },
+	{ REGDUMP_ARRAY(0x06038, 0x40, 729, 32, "TDWBAL%02d",
+			"Tx Desc Compl. WB Addr low %02d") },
+	{ REGDUMP_ARRAY(0x0603C, 0x40, 761, 32, "TDWBAH%02d",
+			"Tx Desc Compl. WB Addr High %02d") },
+	{ REGDUMP_REG(0x07E00, 793, "DTXCTL", "DMA Tx Control") },
+	{ REGDUMP_ARRAY(0x07200, 0x4, 794, 16, "DCA_TXCTRL%02d",
+			"Tx DCA Control %02d") },
+	{ REGDUMP_REG(0x0CB00, 810, "TIPG", "Transmit IPG Control"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_ARRAY(0x0CC00, 0x4, 811, 8, "TXPBSIZE%d",
+			"Transmit Packet Buffer Size %d") },
+	{ REGDUMP_REG(0x0CD10, 819, "MNGTXMAP",
+		      "Manageability Tx TC Mapping") },
 	/* Wake Up */
-	fprintf(stdout,
-		"0x05800: WUC         (Wake up Control)                0x%08X\n",
-		regs_buff[820]);
-
-	fprintf(stdout,
-		"0x05808: WUFC        (Wake Up Filter Control)         0x%08X\n",
-		regs_buff[821]);
-
-	fprintf(stdout,
-		"0x05810: WUS         (Wake Up Status)                 0x%08X\n",
-		regs_buff[822]);
-
-	fprintf(stdout,
-		"0x05838: IPAV        (IP Address Valid)               0x%08X\n",
-		regs_buff[823]);
-
-	fprintf(stdout,
-		"0x05840: IP4AT       (IPv4 Address Table)             0x%08X\n",
-		regs_buff[824]);
-
-	fprintf(stdout,
-		"0x05880: IP6AT       (IPv6 Address Table)             0x%08X\n",
-		regs_buff[825]);
-
-	fprintf(stdout,
-		"0x05900: WUPL        (Wake Up Packet Length)          0x%08X\n",
-		regs_buff[826]);
-
-	fprintf(stdout,
-		"0x05A00: WUPM        (Wake Up Packet Memory)          0x%08X\n",
-		regs_buff[827]);
-
-	fprintf(stdout,
-		"0x09000: FHFT        (Flexible Host Filter Table)     0x%08X\n",
-		regs_buff[828]);
-
+	{ REGDUMP_REG(0x05800, 820, "WUC", "Wake up Control") },
+	{ REGDUMP_REG(0x05808, 821, "WUFC", "Wake Up Filter Control") },
+	{ REGDUMP_REG(0x05810, 822, "WUS", "Wake Up Status") },
+	{ REGDUMP_REG(0x05838, 823, "IPAV", "IP Address Valid") },
+	{ REGDUMP_REG(0x05840, 824, "IP4AT", "IPv4 Address Table") },
+	{ REGDUMP_REG(0x05880, 825, "IP6AT", "IPv6 Address Table") },
+	{ REGDUMP_REG(0x05900, 826, "WUPL", "Wake Up Packet Length") },
+	{ REGDUMP_REG(0x05A00, 827, "WUPM", "Wake Up Packet Memory") },
+	{ REGDUMP_REG(0x09000, 828, "FHFT", "Flexible Host Filter Table") },
 	/* DCB */
-	if (mac_type == ixgbe_mac_82598EB) {
-		fprintf(stdout,
-		"0x07F40: DPMCS       (Desc. Plan Music Ctrl Status)   0x%08X\n",
-		regs_buff[830]);
-
-		fprintf(stdout,
-		"0x0CD00: PDPMCS      (Pkt Data Plan Music ctrl Stat)  0x%08X\n",
-		regs_buff[831]);
-
-		fprintf(stdout,
-		"0x050A0: RUPPBMR     (Rx User Prior to Pkt Buff Map)  0x%08X\n",
-		regs_buff[832]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-			"0x%05X: RT2CR%d      (Receive T2 Configure %d)         0x%08X\n",
-			0x03C20 + (4 * i), i, i, regs_buff[833 + i]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-			"0x%05X: RT2SR%d      (Receive T2 Status %d)            0x%08X\n",
-			0x03C40 + (4 * i), i, i, regs_buff[841 + i]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-			"0x%05X: TDTQ2TCCR%d  (Tx Desc TQ2 TC Config %d)        0x%08X\n",
-			0x0602C + (0x40 * i), i, i, regs_buff[849 + i]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-			"0x%05X: TDTQ2TCSR%d  (Tx Desc TQ2 TC Status %d)        0x%08X\n",
-			0x0622C + (0x40 * i), i, i, regs_buff[857 + i]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-			"0x%05X: TDPT2TCCR%d  (Tx Data Plane T2 TC Config %d)   0x%08X\n",
-			0x0CD20 + (4 * i), i, i, regs_buff[865 + i]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-			"0x%05X: TDPT2TCSR%d  (Tx Data Plane T2 TC Status %d)   0x%08X\n",
-			0x0CD40 + (4 * i), i, i, regs_buff[873 + i]);
-	} else if (mac_type >= ixgbe_mac_82599EB) {
-		fprintf(stdout,
-			"0x04900: RTTDCS      (Tx Descr Plane Ctrl&Status)     0x%08X\n",
-			regs_buff[830]);
-
-		fprintf(stdout,
-			"0x0CD00: RTTPCS      (Tx Pkt Plane Ctrl&Status)       0x%08X\n",
-			regs_buff[831]);
-
-		fprintf(stdout,
-			"0x02430: RTRPCS      (Rx Packet Plane Ctrl&Status)    0x%08X\n",
-			regs_buff[832]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-			"0x%05X: RTRPT4C%d    (Rx Packet Plane T4 Config %d)    0x%08X\n",
-			0x02140 + (4 * i), i, i, regs_buff[833 + i]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-			"0x%05X: RTRPT4S%d    (Rx Packet Plane T4 Status %d)    0x%08X\n",
-			0x02160 + (4 * i), i, i, regs_buff[841 + i]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-			"0x%05X: RTTDT2C%d    (Tx Descr Plane T2 Config %d)     0x%08X\n",
-			0x04910 + (4 * i), i, i, regs_buff[849 + i]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-			"0x%05X: RTTDT2S%d    (Tx Descr Plane T2 Status %d)     0x%08X\n",
-			0x04930 + (4 * i), i, i, regs_buff[857 + i]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-			"0x%05X: RTTPT2C%d    (Tx Packet Plane T2 Config %d)    0x%08X\n",
-			0x0CD20 + (4 * i), i, i, regs_buff[865]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-			"0x%05X: RTTPT2S%d    (Tx Packet Plane T2 Status %d)    0x%08X\n",
-			0x0CD40 + (4 * i), i, i, regs_buff[873 + i]);
-
-		if (regs_buff_len > 1129) {
-			fprintf(stdout,
-			"0x03020: RTRUP2TC    (Rx User Prio to Traffic Classes)0x%08X\n",
-			regs_buff[1129]);
-
-			fprintf(stdout,
-			"0x0C800: RTTUP2TC    (Tx User Prio to Traffic Classes)0x%08X\n",
-			regs_buff[1130]);
-
-			for (i = 0; i < 4; i++)
-				fprintf(stdout,
-				"0x%05X: TXLLQ%d      (Strict Low Lat Tx Queues %d)     0x%08X\n",
-				0x082E0 + (4 * i), i, i, regs_buff[1131 + i]);
-
-			if (mac_type == ixgbe_mac_82599EB) {
-				fprintf(stdout,
-				"0x04980: RTTBCNRM    (DCB TX Rate Sched MMW)          0x%08X\n",
-				regs_buff[1135]);
-
-				fprintf(stdout,
-				"0x0498C: RTTBCNRD    (DCB TX Rate-Scheduler Drift)    0x%08X\n",
-				regs_buff[1136]);
-			} else if (mac_type == ixgbe_mac_X540) {
-				fprintf(stdout,
-				"0x04980: RTTQCNRM    (DCB TX QCN Rate Sched MMW)      0x%08X\n",
-				regs_buff[1135]);
-
-				fprintf(stdout,
-				"0x0498C: RTTQCNRR    (DCB TX QCN Rate Reset)          0x%08X\n",
-				regs_buff[1136]);
-
-				fprintf(stdout,
-				"0x08B00: RTTQCNCR    (DCB TX QCN Control)             0x%08X\n",
-				regs_buff[1137]);
-
-				fprintf(stdout,
-				"0x04A90: RTTQCNTG    (DCB TX QCN Tagging)             0x%08X\n",
-				regs_buff[1138]);
-			}
-		}
-	}
-
+	{ REGDUMP_REG(0x07F40, 830, "DPMCS", "Desc. Plan Music Ctrl Status"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_REG(0x0CD00, 831, "PDPMCS", "Pkt Data Plan Music ctrl Stat"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_REG(0x050A0, 832, "RUPPBMR", "Rx User Prior to Pkt Buff Map"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_ARRAY(0x03C20, 0x4, 833, 8, "RT2CR%d",
+			"Receive T2 Configure %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_ARRAY(0x03C40, 0x4, 841, 8, "RT2SR%d",
+			"Receive T2 Status %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_ARRAY(0x0602C, 0x40, 849, 8, "TDTQ2TCCR%d",
+			"Tx Desc TQ2 TC Config %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_ARRAY(0x0622C, 0x40, 857, 8, "TDTQ2TCSR%d",
+			"Tx Desc TQ2 TC Status %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_ARRAY(0x0CD20, 0x4, 865, 8, "TDPT2TCCR%d",
+			"Tx Data Plane T2 TC Config %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_ARRAY(0x0CD40, 0x4, 873, 8, "TDPT2TCSR%d",
+			"Tx Data Plane T2 TC Status %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_REG(0x04900, 830, "RTTDCS", "Tx Descr Plane Ctrl&Status"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0) },
+	{ REGDUMP_REG(0x0CD00, 831, "RTTPCS", "Tx Pkt Plane Ctrl&Status"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0) },
+	{ REGDUMP_REG(0x02430, 832, "RTRPCS", "Rx Packet Plane Ctrl&Status"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0) },
+	{ REGDUMP_ARRAY(0x02140, 0x4, 833, 8, "RTRPT4C%d",
+			"Rx Packet Plane T4 Config %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0) },
+	{ REGDUMP_ARRAY(0x02160, 0x4, 841, 8, "RTRPT4S%d",
+			"Rx Packet Plane T4 Status %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0) },
+	{ REGDUMP_ARRAY(0x04910, 0x4, 849, 8, "RTTDT2C%d",
+			"Tx Descr Plane T2 Config %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0) },
+	{ REGDUMP_ARRAY(0x04930, 0x4, 857, 8, "RTTDT2S%d",
+			"Tx Descr Plane T2 Status %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0) },
+	{ REGDUMP_ARRAY(0x0CD20, 0x4, 865, 8, "RTTPT2C%d",
+			"Tx Packet Plane T2 Config %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0) },
+	{ REGDUMP_ARRAY(0x0CD40, 0x4, 873, 8, "RTTPT2S%d",
+			"Tx Packet Plane T2 Status %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0) },
+	{ REGDUMP_REG(0x03020, 1129, "RTRUP2TC",
+		      "Rx User Prio to Traffic Classes"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0) },
+	{ REGDUMP_REG(0x0C800, 1130, "RTTUP2TC",
+		      "Tx User Prio to Traffic Classes"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0) },
+	{ REGDUMP_ARRAY(0x082E0, 0x4, 1131, 4, "TXLLQ%d",
+			"Strict Low Lat Tx Queues %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, 0) },
+	{ REGDUMP_REG(0x04980, 1135, "RTTBCNRM", "DCB TX Rate Sched MMW"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x0498C, 1136, "RTTBCNRD", "DCB TX Rate-Scheduler Drift"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82599EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x04980, 1135, "RTTQCNRM", "DCB TX QCN Rate Sched MMW"),
+	  REGDUMP_VARIANTS(ixgbe_mac_X540, ixgbe_mac_X540) },
+	{ REGDUMP_REG(0x0498C, 1136, "RTTQCNRR", "DCB TX QCN Rate Reset"),
+	  REGDUMP_VARIANTS(ixgbe_mac_X540, ixgbe_mac_X540) },
+	{ REGDUMP_REG(0x08B00, 1137, "RTTQCNCR", "DCB TX QCN Control"),
+	  REGDUMP_VARIANTS(ixgbe_mac_X540, ixgbe_mac_X540) },
+	{ REGDUMP_REG(0x04A90, 1138, "RTTQCNTG", "DCB TX QCN Tagging"),
+	  REGDUMP_VARIANTS(ixgbe_mac_X540, ixgbe_mac_X540) },
 	/* Statistics */
-	fprintf(stdout,
-		"0x04000: crcerrs     (CRC Error Count)                0x%08X\n",
-		regs_buff[881]);
-
-	fprintf(stdout,
-		"0x04004: illerrc     (Illegal Byte Error Count)       0x%08X\n",
-		regs_buff[882]);
-
-	fprintf(stdout,
-		"0x04008: errbc       (Error Byte Count)               0x%08X\n",
-		regs_buff[883]);
-
-	fprintf(stdout,
-		"0x04010: mspdc       (MAC Short Packet Discard Count) 0x%08X\n",
-		regs_buff[884]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: mpc%d        (Missed Packets Count %d)         0x%08X\n",
-		0x03FA0 + (4 * i), i, i, regs_buff[885 + i]);
-
-	fprintf(stdout,
-		"0x04034: mlfc        (MAC Local Fault Count)          0x%08X\n",
-		regs_buff[893]);
-
-	fprintf(stdout,
-		"0x04038: mrfc        (MAC Remote Fault Count)         0x%08X\n",
-		regs_buff[894]);
-
-	fprintf(stdout,
-		"0x04040: rlec        (Receive Length Error Count)     0x%08X\n",
-		regs_buff[895]);
-
-	fprintf(stdout,
-		"0x03F60: lxontxc     (Link XON Transmitted Count)     0x%08X\n",
-		regs_buff[896]);
-
-	fprintf(stdout,
-		"0x0CF60: lxonrxc     (Link XON Received Count)        0x%08X\n",
-		regs_buff[897]);
-
-	fprintf(stdout,
-		"0x03F68: lxofftxc    (Link XOFF Transmitted Count)    0x%08X\n",
-		regs_buff[898]);
-
-	fprintf(stdout,
-		"0x0CF68: lxoffrxc    (Link XOFF Received Count)       0x%08X\n",
-		regs_buff[899]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: pxontxc%d    (Priority XON Tx Count %d)        0x%08X\n",
-		0x03F00 + (4 * i), i, i, regs_buff[900 + i]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: pxonrxc%d    (Priority XON Received Count %d)  0x%08X\n",
-		0x0CF00 + (4 * i), i, i, regs_buff[908 + i]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: pxofftxc%d   (Priority XOFF Tx Count %d)       0x%08X\n",
-		0x03F20 + (4 * i), i, i, regs_buff[916 + i]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: pxoffrxc%d   (Priority XOFF Received Count %d) 0x%08X\n",
-		0x0CF20 + (4 * i), i, i, regs_buff[924 + i]);
-
-	fprintf(stdout,
-		"0x0405C: prc64       (Packets Received (64B) Count)   0x%08X\n",
-		regs_buff[932]);
-
-	fprintf(stdout,
-		"0x04060: prc127      (Packets Rx (65-127B) Count)     0x%08X\n",
-		regs_buff[933]);
-
-	fprintf(stdout,
-		"0x04064: prc255      (Packets Rx (128-255B) Count)    0x%08X\n",
-		regs_buff[934]);
-
-	fprintf(stdout,
-		"0x04068: prc511      (Packets Rx (256-511B) Count)    0x%08X\n",
-		regs_buff[935]);
-
-	fprintf(stdout,
-		"0x0406C: prc1023     (Packets Rx (512-1023B) Count)   0x%08X\n",
-		regs_buff[936]);
-
-	fprintf(stdout,
-		"0x04070: prc1522     (Packets Rx (1024-Max) Count)    0x%08X\n",
-		regs_buff[937]);
-
-	fprintf(stdout,
-		"0x04074: gprc        (Good Packets Received Count)    0x%08X\n",
-		regs_buff[938]);
-
-	fprintf(stdout,
-		"0x04078: bprc        (Broadcast Packets Rx Count)     0x%08X\n",
-		regs_buff[939]);
-
-	fprintf(stdout,
-		"0x0407C: mprc        (Multicast Packets Rx Count)     0x%08X\n",
-		regs_buff[940]);
-
-	fprintf(stdout,
-		"0x04080: gptc        (Good Packets Transmitted Count) 0x%08X\n",
-		regs_buff[941]);
-
-	fprintf(stdout,
-		"0x04088: gorcl       (Good Octets Rx Count Low)       0x%08X\n",
-		regs_buff[942]);
-
-	fprintf(stdout,
-		"0x0408C: gorch       (Good Octets Rx Count High)      0x%08X\n",
-		regs_buff[943]);
-
-	fprintf(stdout,
-		"0x04090: gotcl       (Good Octets Tx Count Low)       0x%08X\n",
-		regs_buff[944]);
-
-	fprintf(stdout,
-		"0x04094: gotch       (Good Octets Tx Count High)      0x%08X\n",
-		regs_buff[945]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: rnbc%d       (Receive No Buffers Count %d)     0x%08X\n",
-		0x03FC0 + (4 * i), i, i, regs_buff[946 + i]);
-
-	fprintf(stdout,
-		"0x040A4: ruc         (Receive Undersize count)        0x%08X\n",
-		regs_buff[954]);
-
-	fprintf(stdout,
-		"0x040A8: rfc         (Receive Fragment Count)         0x%08X\n",
-		regs_buff[955]);
-
-	fprintf(stdout,
-		"0x040AC: roc         (Receive Oversize Count)         0x%08X\n",
-		regs_buff[956]);
-
-	fprintf(stdout,
-		"0x040B0: rjc         (Receive Jabber Count)           0x%08X\n",
-		regs_buff[957]);
-
-	fprintf(stdout,
-		"0x040B4: mngprc      (Management Packets Rx Count)    0x%08X\n",
-		regs_buff[958]);
-
-	fprintf(stdout,
-		"0x040B8: mngpdc      (Management Pkts Dropped Count)  0x%08X\n",
-		regs_buff[959]);
-
-	fprintf(stdout,
-		"0x0CF90: mngptc      (Management Packets Tx Count)    0x%08X\n",
-		regs_buff[960]);
-
-	fprintf(stdout,
-		"0x040C0: torl        (Total Octets Rx Count Low)      0x%08X\n",
-		regs_buff[961]);
-
-	fprintf(stdout,
-		"0x040C4: torh        (Total Octets Rx Count High)     0x%08X\n",
-		regs_buff[962]);
-
-	fprintf(stdout,
-		"0x040D0: tpr         (Total Packets Received)         0x%08X\n",
-		regs_buff[963]);
-
-	fprintf(stdout,
-		"0x040D4: tpt         (Total Packets Transmitted)      0x%08X\n",
-		regs_buff[964]);
-
-	fprintf(stdout,
-		"0x040D8: ptc64       (Packets Tx (64B) Count)         0x%08X\n",
-		regs_buff[965]);
-
-	fprintf(stdout,
-		"0x040DC: ptc127      (Packets Tx (65-127B) Count)     0x%08X\n",
-		regs_buff[966]);
-
-	fprintf(stdout,
-		"0x040E0: ptc255      (Packets Tx (128-255B) Count)    0x%08X\n",
-		regs_buff[967]);
-
-	fprintf(stdout,
-		"0x040E4: ptc511      (Packets Tx (256-511B) Count)    0x%08X\n",
-		regs_buff[968]);
-
-	fprintf(stdout,
-		"0x040E8: ptc1023     (Packets Tx (512-1023B) Count)   0x%08X\n",
-		regs_buff[969]);
-
-	fprintf(stdout,
-		"0x040EC: ptc1522     (Packets Tx (1024-Max) Count)    0x%08X\n",
-		regs_buff[970]);
-
-	fprintf(stdout,
-		"0x040F0: mptc        (Multicast Packets Tx Count)     0x%08X\n",
-		regs_buff[971]);
-
-	fprintf(stdout,
-		"0x040F4: bptc        (Broadcast Packets Tx Count)     0x%08X\n",
-		regs_buff[972]);
-
-	fprintf(stdout,
-		"0x04120: xec         (XSUM Error Count)               0x%08X\n",
-		regs_buff[973]);
-
-	for (i = 0; i < 16; i++)
-		fprintf(stdout,
-		"0x%05X: qprc%02d      (Queue Packets Rx Count %02d)      0x%08X\n",
-		0x01030 + (0x40 * i), i, i, regs_buff[974 + i]);
-
-	for (i = 0; i < 16; i++)
-		fprintf(stdout,
-		"0x%05X: qptc%02d      (Queue Packets Tx Count %02d)      0x%08X\n",
-		0x06030 + (0x40 * i), i, i, regs_buff[990 + i]);
-
-	for (i = 0; i < 16; i++)
-		fprintf(stdout,
-		"0x%05X: qbrc%02d      (Queue Bytes Rx Count %02d)        0x%08X\n",
-		0x01034 + (0x40 * i), i, i, regs_buff[1006 + i]);
-
-	for (i = 0; i < 16; i++)
-		fprintf(stdout,
-		"0x%05X: qbtc%02d      (Queue Bytes Tx Count %02d)        0x%08X\n",
-		0x06034 + (0x40 * i), i, i, regs_buff[1022 + i]);
-
+	{ REGDUMP_REG(0x04000, 881, "crcerrs", "CRC Error Count") },
+	{ REGDUMP_REG(0x04004, 882, "illerrc", "Illegal Byte Error Count") },
+	{ REGDUMP_REG(0x04008, 883, "errbc", "Error Byte Count") },
+	{ REGDUMP_REG(0x04010, 884, "mspdc",
+		      "MAC Short Packet Discard Count") },
+	{ REGDUMP_ARRAY(0x03FA0, 0x4, 885, 8, "mpc%d",
+			"Missed Packets Count %d") },
+	{ REGDUMP_REG(0x04034, 893, "mlfc", "MAC Local Fault Count") },
+	{ REGDUMP_REG(0x04038, 894, "mrfc", "MAC Remote Fault Count") },
+	{ REGDUMP_REG(0x04040, 895, "rlec", "Receive Length Error Count") },
+	{ REGDUMP_REG(0x03F60, 896, "lxontxc", "Link XON Transmitted Count") },
+	{ REGDUMP_REG(0x0CF60, 897, "lxonrxc", "Link XON Received Count") },
+	{ REGDUMP_REG(0x03F68, 898, "lxofftxc",
+		      "Link XOFF Transmitted Count") },
+	{ REGDUMP_REG(0x0CF68, 899, "lxoffrxc", "Link XOFF Received Count") },
+	{ REGDUMP_ARRAY(0x03F00, 0x4, 900, 8, "pxontxc%d",
+			"Priority XON Tx Count %d") },
+	{ REGDUMP_ARRAY(0x0CF00, 0x4, 908, 8, "pxonrxc%d",
+			"Priority XON Received Count %d") },
+	{ REGDUMP_ARRAY(0x03F20, 0x4, 916, 8, "pxofftxc%d",
+			"Priority XOFF Tx Count %d") },
+	{ REGDUMP_ARRAY(0x0CF20, 0x4, 924, 8, "pxoffrxc%d",
+			"Priority XOFF Received Count %d") },
+	{ REGDUMP_REG(0x0405C, 932, "prc64", "Packets Received (64B) Count") },
+	{ REGDUMP_REG(0x04060, 933, "prc127", "Packets Rx (65-127B) Count") },
+	{ REGDUMP_REG(0x04064, 934, "prc255", "Packets Rx (128-255B) Count") },
+	{ REGDUMP_REG(0x04068, 935, "prc511", "Packets Rx (256-511B) Count") },
+	{ REGDUMP_REG(0x0406C, 936, "prc1023",
+		      "Packets Rx (512-1023B) Count") },
+	{ REGDUMP_REG(0x04070, 937, "prc1522", "Packets Rx (1024-Max) Count") },
+	{ REGDUMP_REG(0x04074, 938, "gprc", "Good Packets Received Count") },
+	{ REGDUMP_REG(0x04078, 939, "bprc", "Broadcast Packets Rx Count") },
+	{ REGDUMP_REG(0x0407C, 940, "mprc", "Multicast Packets Rx Count") },
+	{ REGDUMP_REG(0x04080, 941, "gptc", "Good Packets Transmitted Count") },
+	{ REGDUMP_REG(0x04088, 942, "gorcl", "Good Octets Rx Count Low") },
+	{ REGDUMP_REG(0x0408C, 943, "gorch", "Good Octets Rx Count High") },
+	{ REGDUMP_REG(0x04090, 944, "gotcl", "Good Octets Tx Count Low") },
+	{ REGDUMP_REG(0x04094, 945, "gotch", "Good Octets Tx Count High") },
+	{ REGDUMP_ARRAY(0x03FC0, 0x4, 946, 8, "rnbc%d",
+			"Receive No Buffers Count %d") },
+	{ REGDUMP_REG(0x040A4, 954, "ruc", "Receive Undersize count") },
+	{ REGDUMP_REG(0x040A8, 955, "rfc", "Receive Fragment Count") },
+	{ REGDUMP_REG(0x040AC, 956, "roc", "Receive Oversize Count") },
+	{ REGDUMP_REG(0x040B0, 957, "rjc", "Receive Jabber Count") },
+	{ REGDUMP_REG(0x040B4, 958, "mngprc", "Management Packets Rx Count") },
+	{ REGDUMP_REG(0x040B8, 959, "mngpdc",
+		      "Management Pkts Dropped Count") },
+	{ REGDUMP_REG(0x0CF90, 960, "mngptc", "Management Packets Tx Count") },
+	{ REGDUMP_REG(0x040C0, 961, "torl", "Total Octets Rx Count Low") },
+	{ REGDUMP_REG(0x040C4, 962, "torh", "Total Octets Rx Count High") },
+	{ REGDUMP_REG(0x040D0, 963, "tpr", "Total Packets Received") },
+	{ REGDUMP_REG(0x040D4, 964, "tpt", "Total Packets Transmitted") },
+	{ REGDUMP_REG(0x040D8, 965, "ptc64", "Packets Tx (64B) Count") },
+	{ REGDUMP_REG(0x040DC, 966, "ptc127", "Packets Tx (65-127B) Count") },
+	{ REGDUMP_REG(0x040E0, 967, "ptc255", "Packets Tx (128-255B) Count") },
+	{ REGDUMP_REG(0x040E4, 968, "ptc511", "Packets Tx (256-511B) Count") },
+	{ REGDUMP_REG(0x040E8, 969, "ptc1023",
+		      "Packets Tx (512-1023B) Count") },
+	{ REGDUMP_REG(0x040EC, 970, "ptc1522", "Packets Tx (1024-Max) Count") },
+	{ REGDUMP_REG(0x040F0, 971, "mptc", "Multicast Packets Tx Count") },
+	{ REGDUMP_REG(0x040F4, 972, "bptc", "Broadcast Packets Tx Count") },
+	{ REGDUMP_REG(0x04120, 973, "xec", "XSUM Error Count") },
+	{ REGDUMP_ARRAY(0x01030, 0x40, 974, 16, "qprc%02d",
+			"Queue Packets Rx Count %02d") },
+	{ REGDUMP_ARRAY(0x06030, 0x40, 990, 16, "qptc%02d",
+			"Queue Packets Tx Count %02d") },
+	{ REGDUMP_ARRAY(0x01034, 0x40, 1006, 16, "qbrc%02d",
+			"Queue Bytes Rx Count %02d") },
+	{ REGDUMP_ARRAY(0x06034, 0x40, 1022, 16, "qbtc%02d",
+			"Queue Bytes Tx Count %02d") },
 	/* MAC */
-	if (mac_type < ixgbe_mac_X540) {
-		fprintf(stdout,
-			"0x04200: PCS1GCFIG   (PCS_1G Gloabal Config 1)        0x%08X\n",
-			regs_buff[1038]);
-
-		fprintf(stdout,
-			"0x04208: PCS1GLCTL   (PCS_1G Link Control)            0x%08X\n",
-			regs_buff[1039]);
-
-		fprintf(stdout,
-			"0x0420C: PCS1GLSTA   (PCS_1G Link Status)             0x%08X\n",
-			regs_buff[1040]);
-
-		fprintf(stdout,
-			"0x04210: PCS1GDBG0   (PCS_1G Debug 0)                 0x%08X\n",
-			regs_buff[1041]);
-
-		fprintf(stdout,
-			"0x04214: PCS1GDBG1   (PCS_1G Debug 1)                 0x%08X\n",
-			regs_buff[1042]);
-
-		fprintf(stdout,
-			"0x04218: PCS1GANA    (PCS-1G Auto Neg. Adv.)          0x%08X\n",
-			regs_buff[1043]);
-
-		fprintf(stdout,
-			"0x0421C: PCS1GANLP   (PCS-1G AN LP Ability)           0x%08X\n",
-			regs_buff[1044]);
-
-		fprintf(stdout,
-			"0x04220: PCS1GANNP   (PCS_1G Auto Neg Next Page Tx)   0x%08X\n",
-			regs_buff[1045]);
-
-		fprintf(stdout,
-			"0x04224: PCS1GANLPNP (PCS_1G Auto Neg LPs Next Page)  0x%08X\n",
-			regs_buff[1046]);
-	}
-
-	fprintf(stdout,
-		"0x04244: HLREG1      (Highlander Status 1)            0x%08X\n",
-		regs_buff[1048]);
-
-	fprintf(stdout,
-		"0x04248: PAP         (Pause and Pace)                 0x%08X\n",
-		regs_buff[1049]);
-
-	fprintf(stdout,
-		"0x0424C: MACA        (MDI Auto-Scan Command and Addr) 0x%08X\n",
-		regs_buff[1050]);
-
-	fprintf(stdout,
-		"0x04250: APAE        (Auto-Scan PHY Address Enable)   0x%08X\n",
-		regs_buff[1051]);
-
-	fprintf(stdout,
-		"0x04254: ARD         (Auto-Scan Read Data)            0x%08X\n",
-		regs_buff[1052]);
-
-	fprintf(stdout,
-		"0x04258: AIS         (Auto-Scan Interrupt Status)     0x%08X\n",
-		regs_buff[1053]);
-
-	fprintf(stdout,
-		"0x0425C: MSCA        (MDI Single Command and Addr)    0x%08X\n",
-		regs_buff[1054]);
-
-	fprintf(stdout,
-		"0x04260: MSRWD       (MDI Single Read and Write Data) 0x%08X\n",
-		regs_buff[1055]);
-
-	fprintf(stdout,
-		"0x04264: MLADD       (MAC Address Low)                0x%08X\n",
-		regs_buff[1056]);
-
-	fprintf(stdout,
-		"0x04268: MHADD       (MAC Addr High/Max Frame size)   0x%08X\n",
-		regs_buff[1057]);
-
-	fprintf(stdout,
-		"0x0426C: TREG        (Test Register)                  0x%08X\n",
-		regs_buff[1058]);
-
-	if (mac_type < ixgbe_mac_X540) {
-		fprintf(stdout,
-			"0x04288: PCSS1       (XGXS Status 1)                  0x%08X\n",
-			regs_buff[1059]);
-
-		fprintf(stdout,
-			"0x0428C: PCSS2       (XGXS Status 2)                  0x%08X\n",
-			regs_buff[1060]);
-
-		fprintf(stdout,
-			"0x04290: XPCSS       (10GBASE-X PCS Status)           0x%08X\n",
-			regs_buff[1061]);
-
-		fprintf(stdout,
-			"0x04298: SERDESC     (SERDES Interface Control)       0x%08X\n",
-			regs_buff[1062]);
-
-		fprintf(stdout,
-			"0x0429C: MACS        (FIFO Status/CNTL Report)        0x%08X\n",
-			regs_buff[1063]);
-
-		fprintf(stdout,
-			"0x042A0: AUTOC       (Auto Negotiation Control)       0x%08X\n",
-			regs_buff[1064]);
-
-		fprintf(stdout,
-			"0x042A8: AUTOC2      (Auto Negotiation Control 2)     0x%08X\n",
-			regs_buff[1066]);
-
-		fprintf(stdout,
-			"0x042AC: AUTOC3      (Auto Negotiation Control 3)     0x%08X\n",
-			regs_buff[1067]);
-
-		fprintf(stdout,
-			"0x042B0: ANLP1       (Auto Neg Lnk Part. Ctrl Word 1) 0x%08X\n",
-			regs_buff[1068]);
-
-		fprintf(stdout,
-			"0x042B0: ANLP2       (Auto Neg Lnk Part. Ctrl Word 2) 0x%08X\n",
-			regs_buff[1069]);
-	}
-
-	if (mac_type == ixgbe_mac_82598EB) {
-		fprintf(stdout,
-			"0x04800: ATLASCTL    (Atlas Analog Configuration)     0x%08X\n",
-			regs_buff[1070]);
-
-		/* Diagnostic */
-		fprintf(stdout,
-			"0x02C20: RDSTATCTL   (Rx DMA Statistic Control)       0x%08X\n",
-			regs_buff[1071]);
-
-		for (i = 0; i < 8; i++)
-			fprintf(stdout,
-				"0x%05X: RDSTAT%d     (Rx DMA Statistics %d)            0x%08X\n",
-				0x02C00 + (4 * i), i, i, regs_buff[1072 + i]);
-
-		fprintf(stdout,
-			"0x02F08: RDHMPN      (Rx Desc Handler Mem Page num)   0x%08X\n",
-			regs_buff[1080]);
-
-		fprintf(stdout,
-			"0x02F10: RIC_DW0     (Rx Desc Hand. Mem Read Data 0)  0x%08X\n",
-			regs_buff[1081]);
-
-		fprintf(stdout,
-			"0x02F14: RIC_DW1     (Rx Desc Hand. Mem Read Data 1)  0x%08X\n",
-			regs_buff[1082]);
-
-		fprintf(stdout,
-			"0x02F18: RIC_DW2     (Rx Desc Hand. Mem Read Data 2)  0x%08X\n",
-			regs_buff[1083]);
-
-		fprintf(stdout,
-			"0x02F1C: RIC_DW3     (Rx Desc Hand. Mem Read Data 3)  0x%08X\n",
-			regs_buff[1084]);
-	}
-
-	if (mac_type < ixgbe_mac_X540)
-		fprintf(stdout,
-			"0x02F20: RDPROBE     (Rx Probe Mode Status)           0x%08X\n",
-			regs_buff[1085]);
-
-	fprintf(stdout,
-		"0x07C20: TDSTATCTL   (Tx DMA Statistic Control)       0x%08X\n",
-		regs_buff[1086]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: TDSTAT%d     (Tx DMA Statistics %d)            0x%08X\n",
-		0x07C00 + (4 * i), i, i, regs_buff[1087 + i]);
-
-	fprintf(stdout,
-		"0x07F08: TDHMPN      (Tx Desc Handler Mem Page Num)   0x%08X\n",
-		regs_buff[1095]);
-
-	fprintf(stdout,
-		"0x07F10: TIC_DW0     (Tx Desc Hand. Mem Read Data 0)  0x%08X\n",
-		regs_buff[1096]);
-
-	fprintf(stdout,
-		"0x07F14: TIC_DW1     (Tx Desc Hand. Mem Read Data 1)  0x%08X\n",
-		regs_buff[1097]);
-
-	fprintf(stdout,
-		"0x07F18: TIC_DW2     (Tx Desc Hand. Mem Read Data 2)  0x%08X\n",
-		regs_buff[1098]);
-
-	fprintf(stdout,
-		"0x07F1C: TIC_DW3     (Tx Desc Hand. Mem Read Data 3)  0x%08X\n",
-		regs_buff[1099]);
-
-	fprintf(stdout,
-		"0x07F20: TDPROBE     (Tx Probe Mode Status)           0x%08X\n",
-		regs_buff[1100]);
-
-	fprintf(stdout,
-		"0x0C600: TXBUFCTRL   (TX Buffer Access Control)       0x%08X\n",
-		regs_buff[1101]);
-
-	fprintf(stdout,
-		"0x0C610: TXBUFDATA0  (TX Buffer DATA 0)               0x%08X\n",
-		regs_buff[1102]);
-
-	fprintf(stdout,
-		"0x0C614: TXBUFDATA1  (TX Buffer DATA 1)               0x%08X\n",
-		regs_buff[1103]);
-
-	fprintf(stdout,
-		"0x0C618: TXBUFDATA2  (TX Buffer DATA 2)               0x%08X\n",
-		regs_buff[1104]);
-
-	fprintf(stdout,
-		"0x0C61C: TXBUFDATA3  (TX Buffer DATA 3)               0x%08X\n",
-		regs_buff[1105]);
-
-	fprintf(stdout,
-		"0x03600: RXBUFCTRL   (RX Buffer Access Control)       0x%08X\n",
-		regs_buff[1106]);
-
-	fprintf(stdout,
-		"0x03610: RXBUFDATA0  (RX Buffer DATA 0)               0x%08X\n",
-		regs_buff[1107]);
-
-	fprintf(stdout,
-		"0x03614: RXBUFDATA1  (RX Buffer DATA 1)               0x%08X\n",
-		regs_buff[1108]);
-
-	fprintf(stdout,
-		"0x03618: RXBUFDATA2  (RX Buffer DATA 2)               0x%08X\n",
-		regs_buff[1109]);
-
-	fprintf(stdout,
-		"0x0361C: RXBUFDATA3  (RX Buffer DATA 3)               0x%08X\n",
-		regs_buff[1110]);
-
-	for (i = 0; i < 8; i++)
-		fprintf(stdout,
-		"0x%05X: PCIE_DIAG%d  (PCIe Diagnostic %d)              0x%08X\n",
-		0x11090 + (4 * i), i, i, regs_buff[1111 + i]);
-
-	fprintf(stdout,
-		"0x050A4: RFVAL       (Receive Filter Validation)      0x%08X\n",
-		regs_buff[1119]);
-
-	if (mac_type < ixgbe_mac_X540) {
-		fprintf(stdout,
-			"0x042B8: MDFTC1      (MAC DFT Control 1)              0x%08X\n",
-			regs_buff[1120]);
-
-		fprintf(stdout,
-			"0x042C0: MDFTC2      (MAC DFT Control 2)              0x%08X\n",
-			regs_buff[1121]);
-
-		fprintf(stdout,
-			"0x042C4: MDFTFIFO1   (MAC DFT FIFO 1)                 0x%08X\n",
-			regs_buff[1122]);
-
-		fprintf(stdout,
-			"0x042C8: MDFTFIFO2   (MAC DFT FIFO 2)                 0x%08X\n",
-			regs_buff[1123]);
-
-		fprintf(stdout,
-			"0x042CC: MDFTS       (MAC DFT Status)                 0x%08X\n",
-			regs_buff[1124]);
-	}
+	{ REGDUMP_REG(0x04200, 1038, "PCS1GCFIG", "PCS_1G Gloabal Config 1"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x04208, 1039, "PCS1GLCTL", "PCS_1G Link Control"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x0420C, 1040, "PCS1GLSTA", "PCS_1G Link Status"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x04210, 1041, "PCS1GDBG0", "PCS_1G Debug 0"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x04214, 1042, "PCS1GDBG1", "PCS_1G Debug 1"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x04218, 1043, "PCS1GANA", "PCS-1G Auto Neg. Adv."),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x0421C, 1044, "PCS1GANLP", "PCS-1G AN LP Ability"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x04220, 1045, "PCS1GANNP",
+		      "PCS_1G Auto Neg Next Page Tx"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x04224, 1046, "PCS1GANLPNP",
+		      "PCS_1G Auto Neg LPs Next Page"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x04244, 1048, "HLREG1", "Highlander Status 1") },
+	{ REGDUMP_REG(0x04248, 1049, "PAP", "Pause and Pace") },
+	{ REGDUMP_REG(0x0424C, 1050, "MACA",
+		      "MDI Auto-Scan Command and Addr") },
+	{ REGDUMP_REG(0x04250, 1051, "APAE", "Auto-Scan PHY Address Enable") },
+	{ REGDUMP_REG(0x04254, 1052, "ARD", "Auto-Scan Read Data") },
+	{ REGDUMP_REG(0x04258, 1053, "AIS", "Auto-Scan Interrupt Status") },
+	{ REGDUMP_REG(0x0425C, 1054, "MSCA", "MDI Single Command and Addr") },
+	{ REGDUMP_REG(0x04260, 1055, "MSRWD",
+		      "MDI Single Read and Write Data") },
+	{ REGDUMP_REG(0x04264, 1056, "MLADD", "MAC Address Low") },
+	{ REGDUMP_REG(0x04268, 1057, "MHADD", "MAC Addr High/Max Frame size") },
+	{ REGDUMP_REG(0x0426C, 1058, "TREG", "Test Register") },
+	{ REGDUMP_REG(0x04288, 1059, "PCSS1", "XGXS Status 1"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x0428C, 1060, "PCSS2", "XGXS Status 2"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x04290, 1061, "XPCSS", "10GBASE-X PCS Status"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x04298, 1062, "SERDESC", "SERDES Interface Control"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x0429C, 1063, "MACS", "FIFO Status/CNTL Report"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x042A0, 1064, "AUTOC", "Auto Negotiation Control"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x042A8, 1066, "AUTOC2", "Auto Negotiation Control 2"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x042AC, 1067, "AUTOC3", "Auto Negotiation Control 3"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x042B0, 1068, "ANLP1", "Auto Neg Lnk Part. Ctrl Word 1"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x042B0, 1069, "ANLP2", "Auto Neg Lnk Part. Ctrl Word 2"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x04800, 1070, "ATLASCTL", "Atlas Analog Configuration"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	/* Diagnostic */
+	{ REGDUMP_REG(0x02C20, 1071, "RDSTATCTL", "Rx DMA Statistic Control"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_ARRAY(0x02C00, 0x4, 1072, 8, "RDSTAT%d",
+			"Rx DMA Statistics %d"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_REG(0x02F08, 1080, "RDHMPN", "Rx Desc Handler Mem Page num"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_REG(0x02F10, 1081, "RIC_DW0",
+		      "Rx Desc Hand. Mem Read Data 0"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_REG(0x02F14, 1082, "RIC_DW1",
+		      "Rx Desc Hand. Mem Read Data 1"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_REG(0x02F18, 1083, "RIC_DW2",
+		      "Rx Desc Hand. Mem Read Data 2"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_REG(0x02F1C, 1084, "RIC_DW3",
+		      "Rx Desc Hand. Mem Read Data 3"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_REG(0x02F20, 1085, "RDPROBE", "Rx Probe Mode Status"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x07C20, 1086, "TDSTATCTL", "Tx DMA Statistic Control") },
+	{ REGDUMP_ARRAY(0x07C00, 0x4, 1087, 8, "TDSTAT%d",
+			"Tx DMA Statistics %d") },
+	{ REGDUMP_REG(0x07F08, 1095, "TDHMPN",
+		      "Tx Desc Handler Mem Page Num") },
+	{ REGDUMP_REG(0x07F10, 1096, "TIC_DW0",
+		      "Tx Desc Hand. Mem Read Data 0") },
+	{ REGDUMP_REG(0x07F14, 1097, "TIC_DW1",
+		      "Tx Desc Hand. Mem Read Data 1") },
+	{ REGDUMP_REG(0x07F18, 1098, "TIC_DW2",
+		      "Tx Desc Hand. Mem Read Data 2") },
+	{ REGDUMP_REG(0x07F1C, 1099, "TIC_DW3",
+		      "Tx Desc Hand. Mem Read Data 3") },
+	{ REGDUMP_REG(0x07F20, 1100, "TDPROBE", "Tx Probe Mode Status") },
+	{ REGDUMP_REG(0x0C600, 1101, "TXBUFCTRL", "TX Buffer Access Control") },
+	{ REGDUMP_REG(0x0C610, 1102, "TXBUFDATA0", "TX Buffer DATA 0") },
+	{ REGDUMP_REG(0x0C614, 1103, "TXBUFDATA1", "TX Buffer DATA 1") },
+	{ REGDUMP_REG(0x0C618, 1104, "TXBUFDATA2", "TX Buffer DATA 2") },
+	{ REGDUMP_REG(0x0C61C, 1105, "TXBUFDATA3", "TX Buffer DATA 3") },
+	{ REGDUMP_REG(0x03600, 1106, "RXBUFCTRL", "RX Buffer Access Control") },
+	{ REGDUMP_REG(0x03610, 1107, "RXBUFDATA0", "RX Buffer DATA 0") },
+	{ REGDUMP_REG(0x03614, 1108, "RXBUFDATA1", "RX Buffer DATA 1") },
+	{ REGDUMP_REG(0x03618, 1109, "RXBUFDATA2", "RX Buffer DATA 2") },
+	{ REGDUMP_REG(0x0361C, 1110, "RXBUFDATA3", "RX Buffer DATA 3") },
+	{ REGDUMP_ARRAY(0x11090, 0x4, 1111, 8, "PCIE_DIAG%d",
+			"PCIe Diagnostic %d") },
+	{ REGDUMP_REG(0x050A4, 1119, "RFVAL", "Receive Filter Validation") },
+	{ REGDUMP_REG(0x042B8, 1120, "MDFTC1", "MAC DFT Control 1"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x042C0, 1121, "MDFTC2", "MAC DFT Control 2"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x042C4, 1122, "MDFTFIFO1", "MAC DFT FIFO 1"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x042C8, 1123, "MDFTFIFO2", "MAC DFT FIFO 2"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x042CC, 1124, "MDFTS", "MAC DFT Status"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82599EB) },
+	{ REGDUMP_REG(0x1106C, 1125, "PCIEECCCTL", "PCIe ECC Control"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_REG(0x0C300, 1126, "PBTXECC", "Packet Buffer Tx ECC"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+	{ REGDUMP_REG(0x03300, 1127, "PBRXECC", "Packet Buffer Rx ECC"),
+	  REGDUMP_VARIANTS(ixgbe_mac_82598EB, ixgbe_mac_82598EB) },
+};
 
-	if (mac_type == ixgbe_mac_82598EB) {
-		fprintf(stdout,
-			"0x1106C: PCIEECCCTL  (PCIe ECC Control)               0x%08X\n",
-			regs_buff[1125]);
+static const struct regdump_map ixgbe_map = {
+	.regs = ixgbe_regs,
+	.n_regs = ARRAY_SIZE(ixgbe_regs),
+	.name_width = 11,
+	.value_col = 54,
+	.field_indent = 7,
+	.field_col = 54,
+};
 
-		fprintf(stdout,
-			"0x0C300: PBTXECC     (Packet Buffer Tx ECC)           0x%08X\n",
-			regs_buff[1126]);
+int ixgbe_regdump_map(const struct ethtool_regs *regs,
+		      const struct regdump_map **map, unsigned int *variant)
+{
+	u16 hw_device_id = (u16) regs->version;
+	u8 version = (u8)(regs->version >> 24);
 
-		fprintf(stdout,
-			"0x03300: PBRXECC     (Packet Buffer Rx ECC)           0x%08X\n",
-			regs_buff[1127]);
-	}
+	if (version == 0)
+		return -1;
 
+	/* The current driver reports the MAC type, but older versions
+	 * only report the device ID so we have to infer the MAC type.
+	 */
+	*map = &ixgbe_map;
+	*variant = version > 1 ? version : ixgbe_get_mac_type(hw_device_id);
 	return 0;
 }
+
+int
+ixgbe_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs)
+{
+	return regdump_dump_regs(ixgbe_regdump_map, regs);
+}
@@ -2,179 +2,88 @@
 #include <stdio.h>
 #include "internal.h"
 
-int
-ixgbevf_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs)
+static const struct regdump_field ixgbevf_vfctrl[] = {
+	{ REGDUMP_CONST("VFCTRL", "(Write Only) N/A") },
+};
+
+static const struct regdump_reg ixgbevf_regs[] = {
+	{ REGDUMP_REG(0x00000, 0, "VFCTRL", "VF Control Register"),
+	  .flags = REGDUMP_F_DECODED, REGDUMP_FIELDS(ixgbevf_vfctrl) },
+	{ REGDUMP_REG(0x00008, 1, "VFSTATUS", "VF Status Register") },
+	{ REGDUMP_REG(0x00010, 2, "VFLINKS", "VF Link Status Register") },
+	{ REGDUMP_REG(0x03190, 3, "VFRXMEMWRAP",
+		      "Rx Packet Buffer Flush Detect") },
+	{ REGDUMP_REG(0x00048, 4, "VFFRTIMER", "VF Free Running Timer") },
+	{ REGDUMP_REG(0x00100, 5, "VFEICR", "VF Extended Interrupt Cause") },
+	{ REGDUMP_REG(0x00104, 6, "VFEICS",
+		      "VF Extended Interrupt Cause Set") },
+	{ REGDUMP_REG(0x00108, 7, "VFEIMS", "VF Extended Interrupt Mask Set") },
+	{ REGDUMP_REG(0x0010C, 8, "VFEIMC",
+		      "VF Extended Interrupt Mask Clear") },
+	{ REGDUMP_REG(0x00110, 9, "VFEIAC",
+		      "VF Extended Interrupt Auto Clear") },
+	{ REGDUMP_REG(0x00114, 10, "VFEIAM",
+		      "VF Extended Interrupt Auto Mask") },
+	{ REGDUMP_REG(0x00820, 11, "VFEITR(0)",
+		      "VF Extended Interrupt Throttle") },
+	{ REGDUMP_REG(0x00120, 12, "VFIVAR(0)",
+		      "VF Interrupt Vector Allocation") },
+	{ REGDUMP_REG(0x00140, 13, "VFIVAR_MISC", "VF Interrupt Vector Misc") },
+	{ REGDUMP_REG(0x00104, 28, "VFPSRTYPE",
+		      "VF Replication Packet Split Type") },
+	{ REGDUMP_ARRAY(0x01000, 0x40, 14, 2, "VFRDBAL(%d)",
+			"VF Rx Desc. Base Addr Low %d") },
+	{ REGDUMP_ARRAY(0x01004, 0x40, 16, 2, "VFRDBAH(%d)",
+			"VF Rx Desc. Base Addr High %d") },
+	{ REGDUMP_ARRAY(0x01008, 0x40, 18, 2, "VFRDLEN(%d)",
+			"VF Rx Desc. Length %d") },
+	{ REGDUMP_ARRAY(0x01010, 0x40, 20, 2, "VFRDH(%d)",
+			"VF Rx Desc. Head %d") },
+	{ REGDUMP_ARRAY(0x01018, 0x40, 22, 2, "VFRDT(%d)",
+			"VF Rx Desc. Tail %d") },
+	{ REGDUMP_ARRAY(0x01028, 0x40, 24, 2, "VFRDT(%d)",
+			"VF Rx Desc. Control %d") },
+	{ REGDUMP_ARRAY(0x01014, 0x40, 26, 2, "VFSRRCTL(%d)",
+			"VF Split Rx Control %d") },
+	{ REGDUMP_ARRAY(0x02000, 0x40, 29, 2, "VFTDBAL(%d)",
+			"VF Tx Desc. Base Addr Low %d") },
+	{ REGDUMP_ARRAY(0x02004, 0x40, 31, 2, "VFTDBAH(%d)",
+			"VF Tx Desc. Base Addr High %d") },
+	{ REGDUMP_ARRAY(0x02008, 0x40, 33, 2, "VFTDLEN(%d)",
+			"VF Tx Desc. Length %d") },
+	{ REGDUMP_ARRAY(0x02010, 0x40, 35, 2, "VFTDH(%d)",
+			"VF Tx Desc. Head %d") },
+	{ REGDUMP_ARRAY(0x02018, 0x40, 37, 2, "VFTDT(%d)",
+			"VF Tx Desc. Tail %d") },
+	{ REGDUMP_ARRAY(0x02028, 0x40, 39, 2, "VFTDT(%d)",
+			"VF Tx Desc. Control %d") },
+	{ REGDUMP_ARRAY(0x02038, 0x40, 41, 2, "VFTDWBAL(%d)",
+			"VF Tx Desc. Write Back Addr Lo %d") },
+	{ REGDUMP_ARRAY(0x0203C, 0x40, 43, 2, "VFTDWBAH(%d)",
+			"VF Tx Desc. Write Back Addr Hi %d") },
+};
+
+static const struct regdump_map ixgbevf_map = {
+	.regs = ixgbevf_regs,
+	.n_regs = ARRAY_SIZE(ixgbevf_regs),
+	.name_width = 11,
+	.value_col = 56,
+};
+
+int ixgbevf_regdump_map(const struct ethtool_regs *regs,
+			const struct regdump_map **map, unsigned int *variant)
 {
-	u32 *regs_buff = (u32 *)regs->data;
 	u8 version = (u8)(regs->version >> 24);
-	u8 i;
 
 	if (version == 0)
 		return -1;
-
-	fprintf(stdout,
-		"0x00000: VFCTRL      (VF Control Register) (Write Only) N/A\n");
-
-	fprintf(stdout,
-		"0x00008: VFSTATUS    (VF Status Register)               0x%08X\n",
-		regs_buff[1]);
-
-	fprintf(stdout,
-		"0x00010: VFLINKS     (VF Link Status Register)          0x%08X\n",
-		regs_buff[2]);
-
-	fprintf(stdout,
-		"0x03190: VFRXMEMWRAP (Rx Packet Buffer Flush Detect)    0x%08X\n",
-		regs_buff[3]);
-
-	fprintf(stdout,
-		"0x00048: VFFRTIMER   (VF Free Running Timer)            0x%08X\n",
-		regs_buff[4]);
-
-	fprintf(stdout,
-		"0x00100: VFEICR      (VF Extended Interrupt Cause)      0x%08X\n",
-		regs_buff[5]);
-
-	fprintf(stdout,
-		"0x00104: VFEICS      (VF Extended Interrupt Cause Set)  0x%08X\n",
-		regs_buff[6]);
-
-	fprintf(stdout,
-		"0x00108: VFEIMS      (VF Extended Interrupt Mask Set)   0x%08X\n",
-		regs_buff[7]);
-
-	fprintf(stdout,
-		"0x0010C: VFEIMC      (VF Extended Interrupt Mask Clear) 0x%08X\n",
-		regs_buff[8]);
-
-	fprintf(stdout,
-		"0x00110: VFEIAC      (VF Extended Interrupt Auto Clear) 0x%08X\n",
-		regs_buff[9]);
-
-	fprintf(stdout,
-		"0x00114: VFEIAM      (VF Extended Interrupt Auto Mask)  0x%08X\n",
-		regs_buff[10]);
-
-	fprintf(stdout,
-		"0x00820: VFEITR(0)   (VF Extended Interrupt Throttle)   0x%08X\n",
-		regs_buff[11]);
-
-	fprintf(stdout,
-		"0x00120: VFIVAR(0)   (VF Interrupt Vector Allocation)   0x%08X\n",
-		regs_buff[12]);
-
-	fprintf(stdout,
-		"0x00140: VFIVAR_MISC (VF Interrupt Vector Misc)         0x%08X\n",
-		regs_buff[13]);
-
-	fprintf(stdout,
-		"0x00104: VFPSRTYPE   (VF Replication Packet Split Type) 0x%08X\n",
-		regs_buff[28]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFRDBAL(%d)  (VF Rx Desc. Base Addr Low %d)      0x%08X\n",
-			0x1000 + 0x40*i,
-			i, i,
-			regs_buff[14+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFRDBAH(%d)  (VF Rx Desc. Base Addr High %d)     0x%08X\n",
-			0x1004 + 0x40*i,
-			i, i,
-			regs_buff[16+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFRDLEN(%d)  (VF Rx Desc. Length %d)             0x%08X\n",
-			0x1008 + 0x40*i,
-			i, i,
-			regs_buff[18+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFRDH(%d)    (VF Rx Desc. Head %d)               0x%08X\n",
-			0x1010 + 0x40*i,
-			i, i,
-			regs_buff[20+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFRDT(%d)    (VF Rx Desc. Tail %d)               0x%08X\n",
-			0x1018 + 0x40*i,
-			i, i,
-			regs_buff[22+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFRDT(%d)    (VF Rx Desc. Control %d),           0x%08X\n",
-			0x1028 + 0x40*i,
-			i, i,
-			regs_buff[24+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFSRRCTL(%d) (VF Split Rx Control %d)            0x%08X\n",
-			0x1014 + 0x40*i,
-			i, i,
-			regs_buff[26+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFTDBAL(%d)  (VF Tx Desc. Base Addr Low %d)      0x%08X\n",
-			0x2000 + 0x40*i,
-			i, i,
-			regs_buff[29+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFTDBAH(%d)  (VF Tx Desc. Base Addr High %d)     0x%08X\n",
-			0x2004 + 0x40*i,
-			i, i,
-			regs_buff[31+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFTDLEN(%d)  (VF Tx Desc. Length %d)             0x%08X\n",
-			0x2008 + 0x40*i,
-			i, i,
-			regs_buff[33+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFTDH(%d)    (VF Tx Desc. Head %d)               0x%08X\n",
-			0x2010 + 0x40*i,
-			i, i,
-			regs_buff[35+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFTDT(%d)    (VF Tx Desc. Tail %d)               0x%08X\n",
-			0x2018 + 0x40*i,
-			i, i,
-			regs_buff[37+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFTDT(%d)    (VF Tx Desc. Control %d)            0x%08X\n",
-			0x2028 + 0x40*i,
-			i, i,
-			regs_buff[39+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFTDWBAL(%d) (VF Tx Desc. Write Back Addr Lo %d) 0x%08X\n",
-			0x2038 + 0x40*i,
-			i, i,
-			regs_buff[41+i]);
-
-	for (i = 0; i < 2; i++)
-		fprintf(stdout,
-			"0x%05x: VFTDWBAH(%d) (VF Tx Desc. Write Back Addr Hi %d) 0x%08X\n",
-			0x203C + 0x40*i,
-			i, i,
-			regs_buff[43+i]);
-
+	*map = &ixgbevf_map;
+	*variant = 0;
 	return 0;
 }
+
+int
+ixgbevf_dump_regs(struct ethtool_drvinfo *info, struct ethtool_regs *regs)
+{
+	return regdump_dump_regs(ixgbevf_regdump_map, regs);
+}
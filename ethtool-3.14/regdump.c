@@ -0,0 +1,240 @@
+/****************************************************************************
+ * Table-driven register dump decoding
+ *
+ * Register maps describe where each register is stored in a dump and
+ * how its fields are decoded, in the way sfc.c describes the Solarstorm
+ * registers.  The same map is used to print a dump and to compare two.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation, incorporated herein by reference.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "internal.h"
+
+#define REGDUMP_TEXT_LEN 64
+
+static int variant_ok(unsigned int variant, u8 min_variant, u8 max_variant)
+{
+	return variant >= min_variant &&
+		(max_variant == 0 || variant <= max_variant);
+}
+
+static u32 bits(u32 value, unsigned int lbn, unsigned int width)
+{
+	if (width == 0)
+		return 0;
+	value >>= lbn;
+	return width < 32 ? value & ((1U << width) - 1) : value;
+}
+
+static int field_shown(const struct regdump_field *field,
+		       unsigned int variant, u32 value)
+{
+	return variant_ok(variant, field->min_variant, field->max_variant) &&
+		(value & field->cond_mask) == field->cond_value;
+}
+
+/* Return the text for a field, or NULL if the field is a heading */
+static const char *field_text(const struct regdump_field *field, u32 value,
+			      char *buf)
+{
+	u32 v = bits(value, field->lbn, field->width);
+
+	if (field->names) {
+		if (v < field->n_names && field->names[v])
+			return field->names[v];
+		if (field->other)
+			return field->other;
+		snprintf(buf, REGDUMP_TEXT_LEN, "%u", v);
+		return buf;
+	}
+	if (field->fmt) {
+		if (field->max && v > field->max)
+			v = field->max;
+		snprintf(buf, REGDUMP_TEXT_LEN, field->fmt, v);
+		return buf;
+	}
+	return NULL;
+}
+
+static int reg_shown(const struct regdump_reg *reg, unsigned int variant,
+		     const u32 *words, unsigned int n_words)
+{
+	if (!variant_ok(variant, reg->min_variant, reg->max_variant))
+		return 0;
+	if (reg->cond_mask &&
+	    (reg->cond_index >= n_words ||
+	     (words[reg->cond_index] & reg->cond_mask) != reg->cond_value))
+		return 0;
+	return 1;
+}
+
+static u32 reg_value(const struct regdump_reg *reg, const u32 *words,
+		     unsigned int i)
+{
+	u32 value = words[reg->index + i];
+
+	return reg->width ? bits(value, reg->lbn, reg->width) : value;
+}
+
+/* Print the register name and pad to the value column */
+static void print_reg_name(FILE *out, const struct regdump_map *map,
+			   const struct regdump_reg *reg, unsigned int i)
+{
+	char name[REGDUMP_TEXT_LEN], desc[REGDUMP_TEXT_LEN];
+	int len = 0;
+
+	if (reg->count) {
+		snprintf(name, sizeof(name), reg->name, i);
+		if (reg->desc)
+			snprintf(desc, sizeof(desc), reg->desc, i);
+	} else {
+		strcpy(name, reg->name);
+		if (reg->desc)
+			strcpy(desc, reg->desc);
+	}
+
+	if (!(reg->flags & REGDUMP_F_NO_ADDR))
+		len += fprintf(out, "0x%05X: ", reg->addr + i * reg->addr_step);
+	len += fprintf(out, "%-*s", map->name_width, name);
+	if (reg->desc)
+		len += fprintf(out, " (%s)", desc);
+	fprintf(out, "%*s", len < map->value_col ? map->value_col - len : 1,
+		"");
+}
+
+static const char *reg_text(const struct regdump_reg *reg, u32 value,
+			    char *buf)
+{
+	if (reg->flags & REGDUMP_F_DECODED)
+		return field_text(&reg->fields[0], value, buf);
+	snprintf(buf, REGDUMP_TEXT_LEN, "0x%0*X",
+		 reg->width ? (reg->width + 3) / 4 : 8, value);
+	return buf;
+}
+
+static void print_field_name(FILE *out, const struct regdump_map *map,
+			     const struct regdump_field *field)
+{
+	int len;
+
+	len = fprintf(out, "%*s%s:", map->field_indent, "", field->name);
+	fprintf(out, "%*s", len < map->field_col ? map->field_col - len : 1,
+		"");
+}
+
+void regdump_print(FILE *out, const struct regdump_map *map,
+		   unsigned int variant, const u32 *words, unsigned int n_words)
+{
+	const struct regdump_field *field;
+	const struct regdump_reg *reg;
+	char buf[REGDUMP_TEXT_LEN];
+	const char *text;
+	unsigned int i, j, count;
+	u32 value;
+
+	if (map->title)
+		fprintf(out, "%s\n", map->title);
+
+	for (reg = map->regs; reg < map->regs + map->n_regs; reg++) {
+		if (!reg_shown(reg, variant, words, n_words))
+			continue;
+		count = reg->count ? reg->count : 1;
+		for (i = 0; i < count && reg->index + i < n_words; i++) {
+			value = reg_value(reg, words, i);
+			print_reg_name(out, map, reg, i);
+			fprintf(out, "%s\n", reg_text(reg, value, buf));
+
+			j = reg->flags & REGDUMP_F_DECODED ? 1 : 0;
+			for (; j < reg->n_fields; j++) {
+				field = &reg->fields[j];
+				if (!field_shown(field, variant, value))
+					continue;
+				text = field_text(field, value, buf);
+				if (text) {
+					print_field_name(out, map, field);
+					fprintf(out, "%s\n", text);
+				} else {
+					fprintf(out, "%*s%s\n",
+						map->field_indent, "",
+						field->name);
+				}
+			}
+		}
+	}
+}
+
+/* Print the registers that differ between two dumps, with the fields
+ * that changed, and return the number of registers printed.
+ */
+unsigned int regdump_diff(FILE *out, const struct regdump_map *map,
+			  unsigned int variant, const u32 *old_words,
+			  const u32 *new_words, unsigned int n_words)
+{
+	char old_buf[REGDUMP_TEXT_LEN], new_buf[REGDUMP_TEXT_LEN];
+	const char *old_text, *new_text;
+	const struct regdump_field *field;
+	const struct regdump_reg *reg;
+	unsigned int i, j, count, n_diff = 0;
+	int old_shown, new_shown;
+	u32 old_value, new_value;
+
+	for (reg = map->regs; reg < map->regs + map->n_regs; reg++) {
+		old_shown = reg_shown(reg, variant, old_words, n_words);
+		new_shown = reg_shown(reg, variant, new_words, n_words);
+		if (!old_shown && !new_shown)
+			continue;
+		count = reg->count ? reg->count : 1;
+		for (i = 0; i < count && reg->index + i < n_words; i++) {
+			old_value = reg_value(reg, old_words, i);
+			new_value = reg_value(reg, new_words, i);
+			if (old_value == new_value)
+				continue;
+			n_diff++;
+
+			print_reg_name(out, map, reg, i);
+			fprintf(out, "%s -> ",
+				old_shown ? reg_text(reg, old_value, old_buf) :
+				"-");
+			fprintf(out, "%s\n",
+				new_shown ? reg_text(reg, new_value, new_buf) :
+				"-");
+
+			j = reg->flags & REGDUMP_F_DECODED ? 1 : 0;
+			for (; j < reg->n_fields; j++) {
+				field = &reg->fields[j];
+				old_text = new_text = "-";
+				if (old_shown &&
+				    field_shown(field, variant, old_value))
+					old_text = field_text(field, old_value,
+							      old_buf);
+				if (new_shown &&
+				    field_shown(field, variant, new_value))
+					new_text = field_text(field, new_value,
+							      new_buf);
+				if (!old_text || !new_text ||
+				    !strcmp(old_text, new_text))
+					continue;
+				print_field_name(out, map, field);
+				fprintf(out, "%s -> %s\n", old_text, new_text);
+			}
+		}
+	}
+
+	return n_diff;
+}
+
+int regdump_dump_regs(regdump_map_fn *get_map, struct ethtool_regs *regs)
+{
+	const struct regdump_map *map;
+	unsigned int variant;
+
+	if (get_map(regs, &map, &variant) < 0)
+		return -1;
+	regdump_print(stdout, map, variant, (const u32 *)regs->data,
+		      regs->len / sizeof(u32));
+	return 0;
+}
@@ -257,19 +257,11 @@ int rxclass_rule_get(struct cmd_context *ctx, __u32 loc)
 	return err;
 }
 
-int rxclass_rule_getall(struct cmd_context *ctx)
+static int rxclass_get_rule_locs(struct cmd_context *ctx, __u32 count,
+				 struct ethtool_rxnfc **nfccmdp)
 {
 	struct ethtool_rxnfc *nfccmd;
-	__u32 *rule_locs;
-	int err, i;
-	__u32 count;
-
-	/* determine rule count */
-	err = rxclass_get_dev_info(ctx, &count, NULL);
-	if (err < 0)
-		return err;
-
-	fprintf(stdout, "Total %d rules\n\n", count);
+	int err;
 
 	/* alloc memory for request of location list */
 	nfccmd = calloc(1, sizeof(*nfccmd) + (count * sizeof(__u32)));
@@ -289,6 +281,28 @@ int rxclass_rule_getall(struct cmd_context *ctx)
 		return err;
 	}
 
+	*nfccmdp = nfccmd;
+	return 0;
+}
+
+int rxclass_rule_getall(struct cmd_context *ctx)
+{
+	struct ethtool_rxnfc *nfccmd;
+	__u32 *rule_locs;
+	int err, i;
+	__u32 count;
+
+	/* determine rule count */
+	err = rxclass_get_dev_info(ctx, &count, NULL);
+	if (err < 0)
+		return err;
+
+	fprintf(stdout, "Total %d rules\n\n", count);
+
+	err = rxclass_get_rule_locs(ctx, count, &nfccmd);
+	if (err < 0)
+		return err;
+
 	/* write locations to bitmap */
 	rule_locs = nfccmd->rule_locs;
 	for (i = 0; i < count; i++) {
@@ -317,6 +331,8 @@ struct rmgr_ctrl {
 	unsigned long		*slot;
 	__u32			n_rules;
 	__u32			size;
+	/* all slots above this one are in use */
+	__u32			last;
 };
 
 static int rmgr_ins(struct rmgr_ctrl *rmgr, __u32 loc)
@@ -343,8 +359,14 @@ static int rmgr_find_empty_slot(struct rmgr_ctrl *rmgr,
 	if (rmgr->driver_select)
 		return 0;
 
-	/* start at the end of the list since it is lowest priority */
-	loc = rmgr->size - 1;
+	/*
+	 * Start at the end of the list since it is lowest priority.  Slots
+	 * are only ever taken, so a search can resume below the slot that
+	 * the previous one found.
+	 */
+	loc = rmgr->last;
+	if (loc >= rmgr->size)
+		goto full;
 
 	/* locate the first slot a rule can be placed in */
 	slot_num = loc / BITS_PER_LONG;
@@ -358,7 +380,7 @@ static int rmgr_find_empty_slot(struct rmgr_ctrl *rmgr,
 	 * If loc rolls over it should be greater than or equal to rmgr->size
 	 * and as such we know we have reached the end of the list.
 	 */
-	if (!~(rmgr->slot[slot_num] | (~1UL << rmgr->size % BITS_PER_LONG))) {
+	if (!~(rmgr->slot[slot_num] | (~0UL << (loc % BITS_PER_LONG) << 1))) {
 		loc -= 1 + (loc % BITS_PER_LONG);
 		slot_num--;
 	}
@@ -382,9 +404,11 @@ static int rmgr_find_empty_slot(struct rmgr_ctrl *rmgr,
 	/* location found, insert rule */
 	if (loc < rmgr->size) {
 		fsp->location = loc;
+		rmgr->last = loc - 1;
 		return rmgr_ins(rmgr, loc);
 	}
 
+full:
 	/* No space to add this rule */
 	fprintf(stderr, "rmgr: Cannot find appropriate slot to insert rule\n");
 
@@ -433,6 +457,7 @@ static int rmgr_init(struct cmd_context *ctx, struct rmgr_ctrl *rmgr)
 		perror("rmgr: Invalid RX class rules table size");
 		return -1;
 	}
+	rmgr->last = rmgr->size - 1;
 
 	/* initialize bitmap for storage of valid locations */
 	rmgr->slot = calloc(1, BITS_TO_LONGS(rmgr->size) * sizeof(long));
@@ -695,6 +720,28 @@ static const struct rule_opts rule_nfc_ether[] = {
 	  offsetof(struct ethtool_rx_flow_spec, m_ext.data) },
 };
 
+static const struct {
+	const char		*name;
+	int			flow_type;
+	const struct rule_opts	*options;
+	int			n_opts;
+} rule_flow_types[] = {
+	{ "tcp4", TCP_V4_FLOW,
+	  rule_nfc_tcp_ip4, ARRAY_SIZE(rule_nfc_tcp_ip4) },
+	{ "udp4", UDP_V4_FLOW,
+	  rule_nfc_tcp_ip4, ARRAY_SIZE(rule_nfc_tcp_ip4) },
+	{ "sctp4", SCTP_V4_FLOW,
+	  rule_nfc_tcp_ip4, ARRAY_SIZE(rule_nfc_tcp_ip4) },
+	{ "ah4", AH_V4_FLOW,
+	  rule_nfc_esp_ip4, ARRAY_SIZE(rule_nfc_esp_ip4) },
+	{ "esp4", ESP_V4_FLOW,
+	  rule_nfc_esp_ip4, ARRAY_SIZE(rule_nfc_esp_ip4) },
+	{ "ip4", IP_USER_FLOW,
+	  rule_nfc_usr_ip4, ARRAY_SIZE(rule_nfc_usr_ip4) },
+	{ "ether", ETHER_FLOW,
+	  rule_nfc_ether, ARRAY_SIZE(rule_nfc_ether) },
+};
+
 static int rxclass_get_long(char *str, long long *val, int size)
 {
 	long long max = ~0ULL >> (65 - size);
@@ -992,47 +1039,15 @@ int rxclass_parse_ruleopts(struct cmd_context *ctx,
 	if (argc < 1)
 		goto syntax_err;
 
-	if (!strcmp(argp[0], "tcp4"))
-		flow_type = TCP_V4_FLOW;
-	else if (!strcmp(argp[0], "udp4"))
-		flow_type = UDP_V4_FLOW;
-	else if (!strcmp(argp[0], "sctp4"))
-		flow_type = SCTP_V4_FLOW;
-	else if (!strcmp(argp[0], "ah4"))
-		flow_type = AH_V4_FLOW;
-	else if (!strcmp(argp[0], "esp4"))
-		flow_type = ESP_V4_FLOW;
-	else if (!strcmp(argp[0], "ip4"))
-		flow_type = IP_USER_FLOW;
-	else if (!strcmp(argp[0], "ether"))
-		flow_type = ETHER_FLOW;
-	else
+	for (i = 0; i < ARRAY_SIZE(rule_flow_types); i++)
+		if (!strcmp(argp[0], rule_flow_types[i].name))
+			break;
+	if (i == ARRAY_SIZE(rule_flow_types))
 		goto syntax_err;
 
-	switch (flow_type) {
-	case TCP_V4_FLOW:
-	case UDP_V4_FLOW:
-	case SCTP_V4_FLOW:
-		options = rule_nfc_tcp_ip4;
-		n_opts = ARRAY_SIZE(rule_nfc_tcp_ip4);
-		break;
-	case AH_V4_FLOW:
-	case ESP_V4_FLOW:
-		options = rule_nfc_esp_ip4;
-		n_opts = ARRAY_SIZE(rule_nfc_esp_ip4);
-		break;
-	case IP_USER_FLOW:
-		options = rule_nfc_usr_ip4;
-		n_opts = ARRAY_SIZE(rule_nfc_usr_ip4);
-		break;
-	case ETHER_FLOW:
-		options = rule_nfc_ether;
-		n_opts = ARRAY_SIZE(rule_nfc_ether);
-		break;
-	default:
-		fprintf(stderr, "Add rule, invalid rule type[%s]\n", argp[0]);
-		return -1;
-	}
+	flow_type = rule_flow_types[i].flow_type;
+	options = rule_flow_types[i].options;
+	n_opts = rule_flow_types[i].n_opts;
 
 	memset(p, 0, sizeof(*fsp));
 	fsp->flow_type = flow_type;
@@ -1101,3 +1116,340 @@ syntax_err:
 	fprintf(stderr, "Add rule, invalid syntax\n");
 	return -1;
 }
+
+/*
+ * Rule files hold one rule per line, in the syntax of -N flow-type.
+ * Empty lines and lines starting with '#' are ignored.
+ */
+
+static int rxclass_opt_size(const struct rule_opts *opt)
+{
+	switch (opt->type) {
+	case OPT_U8:
+		return 1;
+	case OPT_U16:
+	case OPT_BE16:
+		return 2;
+	case OPT_S32:
+	case OPT_U32:
+	case OPT_BE32:
+	case OPT_IP4:
+		return 4;
+	case OPT_MAC:
+		return ETH_ALEN;
+	case OPT_U64:
+	case OPT_BE64:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+static void rxclass_print_opt_val(FILE *out, const unsigned char *p,
+				  const struct rule_opts *opt, int mask)
+{
+	char ip_str[INET_ADDRSTRLEN];
+	__be32 ip;
+	int i;
+
+	switch (opt->type) {
+	case OPT_S32:
+		fprintf(out, "%d", *(const int *)p);
+		break;
+	case OPT_U8:
+		fprintf(out, mask ? "0x%x" : "%u", *p);
+		break;
+	case OPT_U16:
+		fprintf(out, mask ? "0x%x" : "%u", *(const u16 *)p);
+		break;
+	case OPT_U32:
+		fprintf(out, mask ? "0x%x" : "%u", *(const u32 *)p);
+		break;
+	case OPT_U64:
+		fprintf(out, "0x%llx", *(const u64 *)p);
+		break;
+	case OPT_BE16:
+		fprintf(out, mask ? "0x%x" : "%u",
+			ntohs(*(const __be16 *)p));
+		break;
+	case OPT_BE32:
+		fprintf(out, mask ? "0x%x" : "%u",
+			ntohl(*(const __be32 *)p));
+		break;
+	case OPT_BE64:
+		fprintf(out, "0x%llx", ntohll(*(const __be64 *)p));
+		break;
+	case OPT_IP4:
+		memcpy(&ip, p, sizeof(ip));
+		fputs(inet_ntop(AF_INET, &ip, ip_str, INET_ADDRSTRLEN), out);
+		break;
+	case OPT_MAC:
+		for (i = 0; i < ETH_ALEN; i++)
+			fprintf(out, i ? ":%02x" : "%02x", p[i]);
+		break;
+	default:
+		break;
+	}
+}
+
+/* Print a rule in a form that rxclass_parse_ruleopts() reads back */
+static int rxclass_dump_rule(FILE *out, struct ethtool_rx_flow_spec *fsp)
+{
+	const unsigned char *p = (const unsigned char *)fsp;
+	const struct rule_opts *opt, *prev;
+	unsigned char umask[8];
+	int flow_type, i, j, k, size;
+
+	flow_type = fsp->flow_type & ~(FLOW_EXT | FLOW_MAC_EXT);
+	for (i = 0; i < ARRAY_SIZE(rule_flow_types); i++)
+		if (rule_flow_types[i].flow_type == flow_type)
+			break;
+	if (i == ARRAY_SIZE(rule_flow_types) ||
+	    (flow_type == IP_USER_FLOW &&
+	     fsp->h_u.usr_ip4_spec.ip_ver != ETH_RX_NFC_IP4)) {
+		fprintf(out, "# rule %u: flow type %d not supported\n",
+			fsp->location, flow_type);
+		return -1;
+	}
+
+	fprintf(out, "flow-type %s", rule_flow_types[i].name);
+
+	for (j = 0; j < rule_flow_types[i].n_opts; j++) {
+		opt = &rule_flow_types[i].options[j];
+		size = rxclass_opt_size(opt);
+		if (opt->moffset < 0 || size == 0)
+			continue;
+		if ((opt->flag & (NTUPLE_FLAG_VLAN | NTUPLE_FLAG_UDEF |
+				  NTUPLE_FLAG_VETH)) &&
+		    !(fsp->flow_type & FLOW_EXT))
+			continue;
+		if (opt->flag == NFC_FLAG_MAC_ADDR &&
+		    !(fsp->flow_type & FLOW_MAC_EXT))
+			continue;
+
+		/* Several options of ip4 share the same bytes */
+		for (k = 0; k < j; k++) {
+			prev = &rule_flow_types[i].options[k];
+			if (prev->moffset >= 0 &&
+			    prev->offset < opt->offset + size &&
+			    opt->offset < prev->offset +
+					  rxclass_opt_size(prev))
+				break;
+		}
+		if (k < j)
+			continue;
+
+		/* A field that is not matched at all has a zero mask */
+		for (k = 0; k < size; k++)
+			if (p[opt->moffset + k])
+				break;
+		if (k == size)
+			continue;
+
+		fprintf(out, " %s ", opt->name);
+		rxclass_print_opt_val(out, p + opt->offset, opt, 0);
+
+		/* The mask is only given where not all bits are matched */
+		for (k = 0; k < size; k++)
+			if (p[opt->moffset + k] != 0xff)
+				break;
+		if (k == size)
+			continue;
+
+		for (k = 0; k < size; k++)
+			umask[k] = ~p[opt->moffset + k];
+		fputs(" m ", out);
+		rxclass_print_opt_val(out, umask, opt, 1);
+	}
+
+	if (fsp->ring_cookie == RX_CLS_FLOW_DISC)
+		fputs(" action -1", out);
+	else
+		fprintf(out, " action %llu", fsp->ring_cookie);
+	fprintf(out, " loc %u\n", fsp->location);
+
+	return 0;
+}
+
+int rxclass_rule_dump(struct cmd_context *ctx)
+{
+	struct ethtool_rxnfc *nfccmd, rulecmd;
+	int err, i;
+	__u32 count;
+
+	err = rxclass_get_dev_info(ctx, &count, NULL);
+	if (err < 0)
+		return err;
+
+	err = rxclass_get_rule_locs(ctx, count, &nfccmd);
+	if (err < 0)
+		return err;
+
+	for (i = 0; i < count; i++) {
+		rulecmd.cmd = ETHTOOL_GRXCLSRULE;
+		memset(&rulecmd.fs, 0, sizeof(rulecmd.fs));
+		rulecmd.fs.location = nfccmd->rule_locs[i];
+		err = send_ioctl(ctx, &rulecmd);
+		if (err < 0) {
+			perror("rxclass: Cannot get RX class rule");
+			break;
+		}
+		rxclass_dump_rule(stdout, &rulecmd.fs);
+	}
+
+	free(nfccmd);
+
+	return err;
+}
+
+#define RULE_LINE_MAX	1024
+
+/* Read all rules of a rule file, so that nothing is inserted if any
+ * of them is bad.
+ */
+static int rxclass_read_rules(struct cmd_context *ctx, FILE *in,
+			      struct ethtool_rx_flow_spec **rulesp,
+			      __u32 *n_rulesp)
+{
+	struct ethtool_rx_flow_spec *rules = NULL, *new_rules;
+	__u32 n_rules = 0, max_rules = 0;
+	char line[RULE_LINE_MAX + 1];
+	char *argp[RULE_LINE_MAX / 2];
+	struct cmd_context line_ctx;
+	unsigned int lineno = 0;
+	int argc;
+	char *q;
+
+	line_ctx = *ctx;
+
+	while (fgets(line, sizeof(line), in)) {
+		lineno++;
+
+		if (!strchr(line, '\n') && !feof(in)) {
+			fprintf(stderr, "rxclass: line %u is too long\n",
+				lineno);
+			goto err;
+		}
+
+		argc = 0;
+		for (q = strtok(line, " \t\r\n"); q && argc < ARRAY_SIZE(argp);
+		     q = strtok(NULL, " \t\r\n"))
+			argp[argc++] = q;
+		if (argc == 0 || argp[0][0] == '#')
+			continue;
+
+		/* Lines may start like the command line does */
+		line_ctx.argc = argc;
+		line_ctx.argp = argp;
+		if (!strcmp(argp[0], "flow-type")) {
+			line_ctx.argc--;
+			line_ctx.argp++;
+		}
+
+		if (n_rules == max_rules) {
+			max_rules = max_rules ? 2 * max_rules : 64;
+			new_rules = malloc(max_rules * sizeof(*rules));
+			if (!new_rules) {
+				perror("rxclass: Cannot allocate memory for"
+				       " RX class rules");
+				goto err;
+			}
+			if (rules)
+				memcpy(new_rules, rules,
+				       n_rules * sizeof(*rules));
+			free(rules);
+			rules = new_rules;
+		}
+
+		if (rxclass_parse_ruleopts(&line_ctx, &rules[n_rules]) < 0) {
+			fprintf(stderr, "rxclass: Bad rule in line %u\n",
+				lineno);
+			goto err;
+		}
+		n_rules++;
+	}
+
+	*rulesp = rules;
+	*n_rulesp = n_rules;
+	return 0;
+
+err:
+	free(rules);
+	return -1;
+}
+
+int rxclass_rule_load(struct cmd_context *ctx, const char *filename)
+{
+	struct ethtool_rx_flow_spec *rules;
+	struct ethtool_rxnfc nfccmd;
+	struct rmgr_ctrl rmgr;
+	__u32 n_rules, i;
+	FILE *in;
+	int err;
+
+	if (!strcmp(filename, "-")) {
+		in = stdin;
+	} else {
+		in = fopen(filename, "r");
+		if (!in) {
+			perror("rxclass: Cannot open rule file");
+			return -1;
+		}
+	}
+
+	err = rxclass_read_rules(ctx, in, &rules, &n_rules);
+	if (in != stdin)
+		fclose(in);
+	if (err < 0)
+		return err;
+
+	/*
+	 * A "loc" is an absolute index into the device's rule table, just
+	 * as for a single rule, whether or not other rules in the file need
+	 * a free slot.  Read the table of used locations once for the whole
+	 * file and check the given locations against its size before
+	 * anything is inserted.  They are reserved first, then the other
+	 * rules get free slots from the bitmap in file order, just as if
+	 * they had been added one at a time.  A driver that picks locations
+	 * itself gets all of them unchanged.
+	 */
+	err = rmgr_init(ctx, &rmgr);
+	if (err < 0)
+		goto out;
+
+	for (i = 0; i < n_rules && !rmgr.driver_select; i++) {
+		if (rules[i].location & RX_CLS_LOC_SPECIAL)
+			continue;
+		err = rmgr_ins(&rmgr, rules[i].location);
+		if (err < 0)
+			goto out;
+	}
+
+	for (i = 0; i < n_rules; i++) {
+		if (!(rules[i].location & RX_CLS_LOC_SPECIAL))
+			continue;
+		err = rmgr_find_empty_slot(&rmgr, &rules[i]);
+		if (err < 0)
+			goto out;
+	}
+
+	for (i = 0; i < n_rules; i++) {
+		nfccmd.cmd = ETHTOOL_SRXCLSRLINS;
+		nfccmd.fs = rules[i];
+		err = send_ioctl(ctx, &nfccmd);
+		if (err < 0) {
+			perror("rmgr: Cannot insert RX class rule");
+			fprintf(stderr, "Inserted %u of %u rules\n",
+				i, n_rules);
+			goto out;
+		}
+	}
+
+	printf("Inserted %u rules\n", n_rules);
+
+out:
+	rmgr_cleanup(&rmgr);
+	free(rules);
+
+	return err;
+}
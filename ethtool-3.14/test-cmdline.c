@@ -126,6 +126,30 @@ static struct test_case {
 	{ 0, "-S devname" },
 	{ 0, "--statistics devname" },
 	{ 1, "-S" },
+	{ 0, "-S devname --interval 1" },
+	{ 0, "-S devname --interval 0.5 --count 10" },
+	{ 0, "--statistics devname --json --match rx_* --match tx_*" },
+	{ 1, "-S devname --count 10" },
+	{ 1, "-S devname --interval foo" },
+	{ 1, "-S devname --interval -1" },
+	{ 1, "-S devname --interval 1 --count 0" },
+	{ 1, "-S devname --match" },
+	{ 1, "-S devname foo" },
+	{ 1, "--decode-dir" },
+	{ 1, "--decode-dir /tmp" },
+	{ 1, "--decode-dir /tmp /tmp" },
+	{ 1, "--decode-dir /tmp /tmp driver" },
+	{ 1, "--decode-dir /tmp /tmp driver e1000 jobs" },
+	{ 1, "--decode-dir /nonexistent/ethtool-dumps /tmp driver e1000" },
+	{ 1, "--decode-diff" },
+	{ 1, "--decode-diff a" },
+	{ 1, "--decode-diff a b" },
+	{ 1, "--decode-diff a b driver e1000 foo" },
+	{ 1, "--decode-diff /nonexistent/a /nonexistent/b driver e1000" },
+	{ 0, "--batch -" },
+	{ 1, "--batch" },
+	{ 1, "--batch - foo" },
+	{ 1, "--batch /nonexistent/ethtool-batch" },
 	/* Argument parsing for -n/-u is specialised */
 	{ 0, "-n devname rx-flow-hash tcp4" },
 	{ 0, "-u devname rx-flow-hash sctp4" },
@@ -251,9 +275,25 @@ int send_ioctl(struct cmd_context *ctx, void *cmd)
 	test_exit(0);
 }
 
+/* Lines for ethtool --batch.  The first command to send an ioctl ends
+ * the test with status 0, so this also shows that a batch carries on
+ * after a command fails.
+ */
+static struct test_case batch_test_cases[] = {
+	{ 0, "" },
+	{ 0, "# comment\n\n   \n" },
+	{ 0, "--version\n-h\n" },
+	{ 1, "-s devname speed foo\n--version\n" },
+	{ 1, "--version\n16_char_devname!\n" },
+	{ 0, "-s devname speed foo\n-S devname\n" },
+	{ 0, "--version\n-S devname --interval 1 --count 2\n" },
+	{ 1, "--batch -\n" },
+};
+
 int main(void)
 {
 	struct test_case *tc;
+	unsigned int blocks;
 	int test_rc;
 	int rc = 0;
 
@@ -268,5 +308,31 @@ int main(void)
 		}
 	}
 
+	for (tc = batch_test_cases;
+	     tc < batch_test_cases + ARRAY_SIZE(batch_test_cases); tc++) {
+		if (getenv("ETHTOOL_TEST_VERBOSE"))
+			printf("I: Test batch: %s\n", tc->args);
+		test_rc = test_cmdline_batch(tc->args, NULL);
+		if (test_rc != tc->rc) {
+			fprintf(stderr, "E: ethtool --batch of \"%s\" returns %d\n",
+				tc->args, test_rc);
+			rc = 1;
+		}
+	}
+
+	/* Memory of commands that fail in a batch is freed, so a batch of
+	 * many bad lines leaves no more allocated than one bad line.
+	 */
+	test_cmdline_batch("-S devname --match\n", NULL);
+	blocks = test_blocks_left();
+	test_cmdline_batch("-S devname --match\n-S devname --count 0\n"
+			   "-S devname --match rx --bogus\n"
+			   "-d devname file foo bogus\n", NULL);
+	if (test_blocks_left() != blocks) {
+		fprintf(stderr, "E: failed batch commands leave %u blocks, "
+			"not %u\n", test_blocks_left(), blocks);
+		rc = 1;
+	}
+
 	return rc;
 }
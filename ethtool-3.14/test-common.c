@@ -16,6 +16,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/fcntl.h>
+#include <sys/time.h>
 #include <unistd.h>
 #define TEST_NO_WRAPPERS
 #include "internal.h"
@@ -113,15 +114,26 @@ void *test_realloc(void *ptr, size_t size)
 	return block + 1;
 }
 
+/* Blocks still allocated when the last command returned */
+static unsigned int blocks_left;
+
 static void test_free_all(void)
 {
 	struct list_head *block, *next;
 
-	list_for_each_safe(block, next, &malloc_list)
+	blocks_left = 0;
+	list_for_each_safe(block, next, &malloc_list) {
 		free(block);
+		blocks_left++;
+	}
 	init_list_head(&malloc_list);
 }
 
+unsigned int test_blocks_left(void)
+{
+	return blocks_left;
+}
+
 /* Close files at end of test */
 
 struct file_node {
@@ -249,6 +261,27 @@ static void test_close_all(void)
 	init_list_head(&file_list);
 }
 
+/* Fake clock, so that waiting for an interval takes no time */
+
+static struct timespec test_clock;
+
+int test_clock_gettime(clockid_t clk_id, struct timespec *tp)
+{
+	*tp = test_clock;
+	return 0;
+}
+
+int test_nanosleep(const struct timespec *req, struct timespec *rem)
+{
+	test_clock.tv_sec += req->tv_sec;
+	test_clock.tv_nsec += req->tv_nsec;
+	if (test_clock.tv_nsec >= 1000000000) {
+		test_clock.tv_sec++;
+		test_clock.tv_nsec -= 1000000000;
+	}
+	return 0;
+}
+
 /* Wrap test main function */
 
 static jmp_buf test_return;
@@ -291,7 +324,13 @@ int test_ioctl(const struct cmd_expect *expect, void *cmd)
 	}
 }
 
-int test_cmdline(const char *args)
+/* Standard input for the next command, or NULL for /dev/null */
+static FILE *test_stdin;
+
+/* Run ethtool with the given arguments.  If 'out' is not NULL, standard
+ * output goes there rather than to /dev/null.
+ */
+int test_cmdline_output(const char *args, FILE *out)
 {
 	int argc, i;
 	char **argv;
@@ -331,8 +370,11 @@ int test_cmdline(const char *args)
 	}
 
 	fflush(NULL);
-	dup2(dev_null, STDIN_FILENO);
-	if (getenv("TEST_TEST_VERBOSE")) {
+	/* Drop anything the last command left unread */
+	fflush(stdin);
+	dup2(test_stdin ? fileno(test_stdin) : dev_null, STDIN_FILENO);
+	clearerr(stdin);
+	if (getenv("TEST_TEST_VERBOSE") && !out) {
 		orig_stderr = stderr;
 	} else {
 		orig_stdout_fd = dup(STDOUT_FILENO);
@@ -341,7 +383,11 @@ int test_cmdline(const char *args)
 			rc = -1;
 			goto out;
 		}
-		dup2(dev_null, STDOUT_FILENO);
+		dup2(out ? fileno(out) : dev_null, STDOUT_FILENO);
+	}
+	if (getenv("TEST_TEST_VERBOSE")) {
+		orig_stderr = stderr;
+	} else {
 		orig_stderr_fd = dup(STDERR_FILENO);
 		if (orig_stderr_fd < 0) {
 			perror("dup stderr");
@@ -357,6 +403,9 @@ int test_cmdline(const char *args)
 		dup2(dev_null, STDERR_FILENO);
 	}
 
+	test_clock.tv_sec = 0;
+	test_clock.tv_nsec = 0;
+
 	rc = setjmp(test_return);
 	rc = rc ? rc - 1 : test_main(argc, argv);
 
@@ -381,3 +430,49 @@ out:
 	test_close_all();
 	return rc;
 }
+
+int test_cmdline(const char *args)
+{
+	return test_cmdline_output(args, NULL);
+}
+
+/* Run ethtool --batch with the given lines as standard input */
+int test_cmdline_batch(const char *lines, FILE *out)
+{
+	int rc;
+
+	test_stdin = tmpfile();
+	if (!test_stdin) {
+		perror("tmpfile");
+		return -1;
+	}
+	fputs(lines, test_stdin);
+	rewind(test_stdin);
+
+	rc = test_cmdline_output("--batch -", out);
+
+	fclose(test_stdin);
+	test_stdin = NULL;
+	return rc;
+}
+
+/* Wall clock time in seconds, for tests that time themselves */
+double test_now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* Report a command that did not return the expected code.  Return 1 if
+ * it didn't, else 0, so that results can be or-ed together.
+ */
+int test_check_rc(const char *args, int rc, int expected_rc)
+{
+	if (rc != expected_rc) {
+		fprintf(stderr, "E: ethtool %s returns %d\n", args, rc);
+		return 1;
+	}
+	return 0;
+}
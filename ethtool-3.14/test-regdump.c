@@ -0,0 +1,204 @@
+/****************************************************************************
+ * Test cases and benchmark for offline register dump decoding
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation, incorporated herein by reference.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define TEST_NO_WRAPPERS
+#include "internal.h"
+
+#define N_DUMPS		200
+#define DUMP_WORDS	1024
+
+int send_ioctl(struct cmd_context *ctx, void *cmd)
+{
+	errno = EOPNOTSUPP;
+	return -1;
+}
+
+static int write_file(const char *path, const void *data, size_t len)
+{
+	FILE *f;
+
+	f = fopen(path, "w");
+	if (!f) {
+		perror(path);
+		return -1;
+	}
+	if (len && fwrite(data, len, 1, f) != 1) {
+		perror(path);
+		fclose(f);
+		return -1;
+	}
+	return fclose(f);
+}
+
+/* Read a whole file into a NUL-terminated buffer */
+static char *read_file(const char *path)
+{
+	char *buf;
+	long len;
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (!f)
+		return NULL;
+	fseek(f, 0, SEEK_END);
+	len = ftell(f);
+	rewind(f);
+	buf = malloc(len + 1);
+	if (buf && len && fread(buf, len, 1, f) != 1) {
+		free(buf);
+		buf = NULL;
+	}
+	if (buf)
+		buf[len] = 0;
+	fclose(f);
+	return buf;
+}
+
+static void fill_dump(u32 *words, unsigned int seed)
+{
+	unsigned int i;
+
+	srand(seed);
+	for (i = 0; i < DUMP_WORDS; i++)
+		words[i] = (u32)rand() << 16 ^ (u32)rand();
+}
+
+/* Check that every decoded file matches a direct decode of its dump */
+static int check_outputs(const char *out_dir)
+{
+	static u32 words[DUMP_WORDS];
+	struct ethtool_regs regs = { .version = 1 << 24 };
+	const struct regdump_map *map;
+	unsigned int i, variant;
+	char path[256], ref_path[256], *expected, *actual;
+	FILE *f;
+	int rc = 0;
+
+	igb_regdump_map(&regs, &map, &variant);
+	snprintf(ref_path, sizeof(ref_path), "%s/expected", out_dir);
+	for (i = 0; i < N_DUMPS && rc == 0; i++) {
+		fill_dump(words, i);
+		f = fopen(ref_path, "w");
+		if (!f) {
+			perror(ref_path);
+			return 1;
+		}
+		regdump_print(f, map, variant, words, DUMP_WORDS);
+		fclose(f);
+
+		snprintf(path, sizeof(path), "%s/dump-%03u.txt", out_dir, i);
+		expected = read_file(ref_path);
+		actual = read_file(path);
+		if (!expected || !actual || strcmp(actual, expected)) {
+			fprintf(stderr, "E: %s is not the decoded dump\n", path);
+			rc = 1;
+		}
+		free(actual);
+		free(expected);
+	}
+	unlink(ref_path);
+	return rc;
+}
+
+int main(void)
+{
+	static u32 words[DUMP_WORDS], words2[DUMP_WORDS];
+	char dir[] = "/tmp/ethtool-dumps-XXXXXX";
+	char out_dir[] = "/tmp/ethtool-decoded-XXXXXX";
+	char path[256], path2[256], args[1024], *diff;
+	double t0, t_one, t_four;
+	unsigned int i;
+	FILE *out;
+	int rc = 0;
+
+	if (!mkdtemp(dir) || !mkdtemp(out_dir)) {
+		perror("mkdtemp");
+		return 1;
+	}
+
+	for (i = 0; i < N_DUMPS; i++) {
+		fill_dump(words, i);
+		snprintf(path, sizeof(path), "%s/dump-%03u", dir, i);
+		if (write_file(path, words, sizeof(words))) {
+			rc = 1;
+			goto out;
+		}
+	}
+
+	/* One worker and four workers give the same files */
+	snprintf(args, sizeof(args), "--decode-dir %s %s driver igb jobs 1",
+		 dir, out_dir);
+	t0 = test_now();
+	rc |= test_check_rc(args, test_cmdline(args), 0);
+	t_one = test_now() - t0;
+	rc |= check_outputs(out_dir);
+
+	for (i = 0; i < N_DUMPS; i++) {
+		snprintf(path, sizeof(path), "%s/dump-%03u.txt", out_dir, i);
+		unlink(path);
+	}
+	snprintf(args, sizeof(args), "--decode-dir %s %s driver igb jobs 4",
+		 dir, out_dir);
+	t0 = test_now();
+	rc |= test_check_rc(args, test_cmdline(args), 0);
+	t_four = test_now() - t0;
+	rc |= check_outputs(out_dir);
+
+	printf("decode-dir: %u dumps, 1 job %.3f s, 4 jobs %.3f s\n",
+	       N_DUMPS, t_one, t_four);
+
+	/* A field that changes is shown with its old and new values */
+	fill_dump(words, 0);
+	memcpy(words2, words, sizeof(words));
+	words[0] &= ~0x40;	/* CTRL.SLU */
+	words2[0] |= 0x40;
+	snprintf(path, sizeof(path), "%s/old", out_dir);
+	snprintf(path2, sizeof(path2), "%s/new", out_dir);
+	if (write_file(path, words, sizeof(words)) ||
+	    write_file(path2, words2, sizeof(words2) / 2)) {
+		rc = 1;
+		goto out;
+	}
+	snprintf(args, sizeof(args), "--decode-diff %s %s driver igb",
+		 path, path2);
+	snprintf(path, sizeof(path), "%s/diff", out_dir);
+	out = fopen(path, "w");
+	if (!out) {
+		perror(path);
+		rc = 1;
+		goto out;
+	}
+	rc |= test_check_rc(args, test_cmdline_output(args, out), 0);
+	fclose(out);
+	diff = read_file(path);
+	if (!diff || !strstr(diff, "Dump lengths differ: 4096 and 2048") ||
+	    !strstr(diff, "CTRL") || !strstr(diff, "-> ") ||
+	    strstr(diff, "STATUS")) {
+		fprintf(stderr, "E: unexpected diff output:\n%s\n",
+			diff ? diff : "");
+		rc = 1;
+	}
+	free(diff);
+
+	snprintf(args, sizeof(args),
+		 "--decode-diff /nonexistent/a /nonexistent/b driver igb");
+	rc |= test_check_rc(args, test_cmdline(args), 1);
+	snprintf(args, sizeof(args),
+		 "--decode-dir /nonexistent %s driver igb", out_dir);
+	rc |= test_check_rc(args, test_cmdline(args), 1);
+
+out:
+	snprintf(args, sizeof(args), "rm -rf %s %s", dir, out_dir);
+	if (system(args))
+		rc = 1;
+	return rc;
+}
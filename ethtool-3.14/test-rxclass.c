@@ -0,0 +1,378 @@
+/****************************************************************************
+ * Test cases and benchmark for loading and dumping RX classification rules
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation, incorporated herein by reference.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define TEST_NO_WRAPPERS
+#include "internal.h"
+
+#define N_RULES		10000
+#define TABLE_SIZE	16384
+
+/* A fake device with a network flow classifier of up to TABLE_SIZE rules */
+static struct ethtool_rx_flow_spec table[TABLE_SIZE];
+static unsigned char used[TABLE_SIZE];
+static __u32 table_size, n_used;
+static unsigned long n_ioctls;
+
+static void reset_device(__u32 size)
+{
+	memset(table, 0, sizeof(table));
+	memset(used, 0, sizeof(used));
+	table_size = size;
+	n_used = 0;
+	n_ioctls = 0;
+}
+
+int send_ioctl(struct cmd_context *ctx, void *cmd)
+{
+	struct ethtool_rxnfc *nfccmd = cmd;
+	struct ethtool_value *eval = cmd;
+	__u32 loc, n;
+
+	n_ioctls++;
+
+	switch (nfccmd->cmd) {
+	case ETHTOOL_GFLAGS:
+		eval->data = 0;
+		return 0;
+	case ETHTOOL_GRXCLSRLCNT:
+		nfccmd->rule_cnt = n_used;
+		nfccmd->data = 0;
+		return 0;
+	case ETHTOOL_GRXCLSRLALL:
+		if (nfccmd->rule_cnt < n_used) {
+			errno = EMSGSIZE;
+			return -1;
+		}
+		for (loc = 0, n = 0; loc < table_size; loc++)
+			if (used[loc])
+				nfccmd->rule_locs[n++] = loc;
+		nfccmd->rule_cnt = n;
+		nfccmd->data = table_size;
+		return 0;
+	case ETHTOOL_GRXCLSRULE:
+		loc = nfccmd->fs.location;
+		if (loc >= table_size || !used[loc]) {
+			errno = ENOENT;
+			return -1;
+		}
+		nfccmd->fs = table[loc];
+		return 0;
+	case ETHTOOL_SRXCLSRLINS:
+		loc = nfccmd->fs.location;
+		if (loc >= table_size) {
+			errno = EINVAL;
+			return -1;
+		}
+		if (!used[loc])
+			n_used++;
+		used[loc] = 1;
+		table[loc] = nfccmd->fs;
+		return 0;
+	case ETHTOOL_SRXCLSRLDEL:
+		loc = nfccmd->fs.location;
+		if (loc >= table_size || !used[loc]) {
+			errno = ENOENT;
+			return -1;
+		}
+		used[loc] = 0;
+		n_used--;
+		return 0;
+	default:
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+}
+
+/* The rules cover every flow type and option.  Every 1000th rule has a
+ * fixed location at the bottom of the table, the others are placed by the
+ * rule manager.
+ */
+static void format_rule(char *buf, size_t size, unsigned int i)
+{
+	char loc[16] = "";
+
+	if (i % 1000 == 500)
+		snprintf(loc, sizeof(loc), " loc %u", i / 1000);
+
+	switch (i % 8) {
+	case 0:
+		snprintf(buf, size,
+			 "tcp4 src-ip 10.%u.%u.1 dst-port %u action %u%s",
+			 i >> 8 & 0xff, i & 0xff, 1024 + i, i % 16, loc);
+		break;
+	case 1:
+		snprintf(buf, size,
+			 "udp4 dst-ip 192.168.%u.%u m 0.0.0.255 src-port %u "
+			 "m 0xff00 tos 4 action -1%s",
+			 i >> 8 & 0xff, i & 0xff, i, loc);
+		break;
+	case 2:
+		snprintf(buf, size,
+			 "sctp4 dst-port %u vlan 0x%x m 0xf000 action 3%s",
+			 i, i & 0xfff, loc);
+		break;
+	case 3:
+		snprintf(buf, size,
+			 "esp4 spi %u user-def 0x%x action 1%s", i,
+			 i * 7, loc);
+		break;
+	case 4:
+		snprintf(buf, size, "ah4 src-ip 172.16.0.%u spi 0x%x "
+			 "vlan-etype 0x8100 action 2%s", i & 0xff, i, loc);
+		break;
+	case 5:
+		snprintf(buf, size,
+			 "ip4 l4proto 6 src-port %u dst-mac 00:11:22:33:%02x:%02x "
+			 "action 4%s", i, i >> 8 & 0xff, i & 0xff, loc);
+		break;
+	case 6:
+		snprintf(buf, size,
+			 "ip4 l4data 0x%x m 0xffff0000 tos 1 m 0xfe action 5%s",
+			 i, loc);
+		break;
+	case 7:
+		snprintf(buf, size,
+			 "ether src 02:00:00:00:%02x:%02x m 00:00:00:00:ff:00 "
+			 "proto 0x800 dst 02:00:00:00:00:01 action 6%s",
+			 i >> 8 & 0xff, i & 0xff, loc);
+		break;
+	}
+}
+
+static int write_rules(const char *path, unsigned int n_rules)
+{
+	char rule[256];
+	unsigned int i;
+	FILE *f;
+
+	f = fopen(path, "w");
+	if (!f) {
+		perror(path);
+		return -1;
+	}
+	fprintf(f, "# %u rules\n\n", n_rules);
+	for (i = 0; i < n_rules; i++) {
+		format_rule(rule, sizeof(rule), i);
+		/* Lines may or may not start with flow-type */
+		fprintf(f, "%s%s\n", i % 2 ? "flow-type " : "", rule);
+	}
+	return fclose(f);
+}
+
+/* Load n_locs rules with the given locations and n_any rules without into
+ * a device with a table of size rules.  "loc" is absolute whether or not
+ * any rule needs a free slot, so the rules must either all be inserted
+ * with the given ones exactly there, or none at all.
+ */
+static int check_locs(const char *path, __u32 size, const __u32 *locs,
+		      unsigned int n_locs, unsigned int n_any,
+		      int expected_rc)
+{
+	char args[512];
+	unsigned int i;
+	FILE *f;
+	int rc;
+
+	f = fopen(path, "w");
+	if (!f) {
+		perror(path);
+		return 1;
+	}
+	for (i = 0; i < n_locs; i++)
+		fprintf(f, "tcp4 dst-port %u action 1 loc %u\n", i, locs[i]);
+	for (i = 0; i < n_any; i++)
+		fprintf(f, "udp4 dst-port %u action 2\n", i);
+	if (fclose(f)) {
+		perror(path);
+		return 1;
+	}
+
+	reset_device(size);
+	snprintf(args, sizeof(args), "-N devname load %s", path);
+	rc = test_check_rc(args, test_cmdline(args), expected_rc);
+	if (expected_rc) {
+		if (n_used != 0) {
+			fprintf(stderr, "E: %s inserted %u rules\n",
+				args, n_used);
+			rc = 1;
+		}
+		return rc;
+	}
+	if (n_used != n_locs + n_any) {
+		fprintf(stderr, "E: %s inserted %u rules\n", args, n_used);
+		rc = 1;
+	}
+	for (i = 0; i < n_locs; i++)
+		if (!used[locs[i]] || table[locs[i]].location != locs[i] ||
+		    table[locs[i]].flow_type != TCP_V4_FLOW) {
+			fprintf(stderr, "E: %s: no rule at location %u\n",
+				args, locs[i]);
+			rc = 1;
+		}
+	return rc;
+}
+
+int main(void)
+{
+	static const __u32 good_locs[] = { 0, 5, 63 };
+	static const __u32 bad_locs[] = { 5, 64 };
+
+	static struct ethtool_rx_flow_spec saved[TABLE_SIZE];
+	char rules_path[] = "/tmp/ethtool-rules-XXXXXX";
+	char dump_path[] = "/tmp/ethtool-dump-XXXXXX";
+	char args[512], rule[256];
+	unsigned long load_ioctls, single_ioctls;
+	double t0, t_load, t_single;
+	__u32 loc, expected;
+	unsigned int i;
+	FILE *dump;
+	int fd, rc = 0;
+
+	fd = mkstemp(rules_path);
+	if (fd < 0) {
+		perror("mkstemp");
+		return 1;
+	}
+	close(fd);
+	fd = mkstemp(dump_path);
+	if (fd < 0) {
+		perror("mkstemp");
+		unlink(rules_path);
+		return 1;
+	}
+	close(fd);
+
+	/* Bulk load: the rule table is read once */
+	if (write_rules(rules_path, N_RULES)) {
+		rc = 1;
+		goto out;
+	}
+	reset_device(TABLE_SIZE);
+	snprintf(args, sizeof(args), "-N devname load %s", rules_path);
+	t0 = test_now();
+	rc |= test_check_rc(args, test_cmdline(args), 0);
+	t_load = test_now() - t0;
+	load_ioctls = n_ioctls;
+	if (n_used != N_RULES || load_ioctls != N_RULES + 2) {
+		fprintf(stderr, "E: load gave %u rules with %lu ioctls\n",
+			n_used, load_ioctls);
+		rc = 1;
+	}
+
+	/* Placed rules take the highest free slots in file order */
+	expected = TABLE_SIZE - 1;
+	for (i = 0; i < N_RULES; i++) {
+		if (i % 1000 == 500)
+			continue;
+		for (loc = 0; loc < TABLE_SIZE; loc++)
+			if (used[loc] && table[loc].location == expected)
+				break;
+		if (loc == TABLE_SIZE) {
+			fprintf(stderr, "E: no rule at location %u\n",
+				expected);
+			rc = 1;
+			break;
+		}
+		expected--;
+	}
+	memcpy(saved, table, sizeof(table));
+
+	/* Dump, and load the dump into an empty device */
+	dump = fopen(dump_path, "w");
+	if (!dump) {
+		perror(dump_path);
+		rc = 1;
+		goto out;
+	}
+	rc |= test_check_rc("-n devname dump",
+			    test_cmdline_output("-n devname dump", dump), 0);
+	fclose(dump);
+	if (n_ioctls != load_ioctls + N_RULES + 2) {
+		fprintf(stderr, "E: dump used %lu ioctls\n",
+			n_ioctls - load_ioctls);
+		rc = 1;
+	}
+
+	reset_device(TABLE_SIZE);
+	snprintf(args, sizeof(args), "-N devname load %s", dump_path);
+	rc |= test_check_rc(args, test_cmdline(args), 0);
+	if (n_ioctls != N_RULES + 2 || n_used != N_RULES ||
+	    memcmp(saved, table, sizeof(table))) {
+		fprintf(stderr, "E: reloaded dump differs from the rules\n");
+		rc = 1;
+	}
+
+	/* The same rules one at a time */
+	reset_device(TABLE_SIZE);
+	t0 = test_now();
+	for (i = 0; i < N_RULES; i++) {
+		format_rule(rule, sizeof(rule), i);
+		snprintf(args, sizeof(args), "-N devname flow-type %s", rule);
+		rc |= test_check_rc(args, test_cmdline(args), 0);
+	}
+	t_single = test_now() - t0;
+	single_ioctls = n_ioctls;
+	if (memcmp(saved, table, sizeof(table))) {
+		fprintf(stderr, "E: single rules differ from loaded rules\n");
+		rc = 1;
+	}
+
+	printf("load:   %u rules, %lu ioctls, %.3f s\n",
+	       N_RULES, load_ioctls, t_load);
+	printf("single: %u rules, %lu ioctls, %.3f s\n",
+	       N_RULES, single_ioctls, t_single);
+
+	/* A bad rule, or a full table, means nothing is inserted */
+	if (write_rules(rules_path, 10)) {
+		rc = 1;
+		goto out;
+	}
+	dump = fopen(rules_path, "a");
+	if (dump) {
+		fputs("tcp4 src-ip 10.0.0.300 action 1\n", dump);
+		fclose(dump);
+	}
+	reset_device(TABLE_SIZE);
+	snprintf(args, sizeof(args), "-N devname load %s", rules_path);
+	rc |= test_check_rc(args, test_cmdline(args), 1);
+	if (n_ioctls != 0) {
+		fprintf(stderr, "E: bad rule file sent %lu ioctls\n",
+			n_ioctls);
+		rc = 1;
+	}
+
+	if (write_rules(rules_path, 10)) {
+		rc = 1;
+		goto out;
+	}
+	reset_device(8);
+	rc |= test_check_rc(args, test_cmdline(args), 1);
+	if (n_used != 0) {
+		fprintf(stderr, "E: full table got %u rules\n", n_used);
+		rc = 1;
+	}
+
+	rc |= test_check_rc("-N devname load /nonexistent/rules",
+			    test_cmdline("-N devname load /nonexistent/rules"),
+			    1);
+
+	/* Given locations with and without rules to place */
+	rc |= check_locs(rules_path, 64, good_locs, ARRAY_SIZE(good_locs), 0, 0);
+	rc |= check_locs(rules_path, 64, good_locs, ARRAY_SIZE(good_locs), 4, 0);
+	rc |= check_locs(rules_path, 64, bad_locs, ARRAY_SIZE(bad_locs), 0, 1);
+	rc |= check_locs(rules_path, 64, bad_locs, ARRAY_SIZE(bad_locs), 4, 1);
+
+out:
+	unlink(rules_path);
+	unlink(dump_path);
+	return rc;
+}
@@ -0,0 +1,301 @@
+/****************************************************************************
+ * Test cases for ethtool statistics
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation, incorporated herein by reference.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define TEST_NO_WRAPPERS
+#include "internal.h"
+
+static const struct {
+	struct ethtool_sset_info cmd;
+	u32 data[1];
+}
+cmd_gssetinfo = { { ETHTOOL_GSSET_INFO, 0, 1ULL << ETH_SS_STATS }, 3 };
+
+static const struct {
+	struct ethtool_gstrings cmd;
+	u8 data[3][ETH_GSTRING_LEN];
+}
+cmd_gstrings = {
+	{ ETHTOOL_GSTRINGS, ETH_SS_STATS, 3 },
+	{
+		"rx_packets",
+		"tx_packets",
+		"rx_errors",
+	}
+};
+
+static const struct ethtool_stats cmd_gstats = { ETHTOOL_GSTATS, 3 };
+
+static const struct {
+	struct ethtool_stats cmd;
+	u64 data[3];
+}
+cmd_gstats_0 = { { ETHTOOL_GSTATS, 3 }, { 1000, 500, 2 } },
+cmd_gstats_1 = { { ETHTOOL_GSTATS, 3 }, { 1100, 550, 2 } },
+cmd_gstats_2 = { { ETHTOOL_GSTATS, 3 }, { 1400, 560, 1 } };
+
+static const struct cmd_expect cmd_expect_gstats[] = {
+	{ &cmd_gssetinfo, sizeof(cmd_gssetinfo.cmd),
+	  0, &cmd_gssetinfo, sizeof(cmd_gssetinfo) },
+	{ &cmd_gstrings, sizeof(cmd_gstrings.cmd),
+	  0, &cmd_gstrings, sizeof(cmd_gstrings) },
+	{ &cmd_gstats, sizeof(cmd_gstats),
+	  0, &cmd_gstats_0, sizeof(cmd_gstats_0) },
+	{ 0, 0, 0, 0, 0 }
+};
+
+static const struct cmd_expect cmd_expect_gstats_strings_only[] = {
+	{ &cmd_gssetinfo, sizeof(cmd_gssetinfo.cmd),
+	  0, &cmd_gssetinfo, sizeof(cmd_gssetinfo) },
+	{ &cmd_gstrings, sizeof(cmd_gstrings.cmd),
+	  0, &cmd_gstrings, sizeof(cmd_gstrings) },
+	{ 0, 0, 0, 0, 0 }
+};
+
+static const struct cmd_expect cmd_expect_gstats_2[] = {
+	{ &cmd_gssetinfo, sizeof(cmd_gssetinfo.cmd),
+	  0, &cmd_gssetinfo, sizeof(cmd_gssetinfo) },
+	{ &cmd_gstrings, sizeof(cmd_gstrings.cmd),
+	  0, &cmd_gstrings, sizeof(cmd_gstrings) },
+	{ &cmd_gstats, sizeof(cmd_gstats),
+	  0, &cmd_gstats_0, sizeof(cmd_gstats_0) },
+	{ &cmd_gstats, sizeof(cmd_gstats),
+	  0, &cmd_gstats_1, sizeof(cmd_gstats_1) },
+	{ &cmd_gstats, sizeof(cmd_gstats),
+	  0, &cmd_gstats_2, sizeof(cmd_gstats_2) },
+	{ 0, 0, 0, 0, 0 }
+};
+
+static const struct cmd_expect cmd_expect_gstats_fail[] = {
+	{ &cmd_gssetinfo, sizeof(cmd_gssetinfo.cmd),
+	  0, &cmd_gssetinfo, sizeof(cmd_gssetinfo) },
+	{ &cmd_gstrings, sizeof(cmd_gstrings.cmd),
+	  0, &cmd_gstrings, sizeof(cmd_gstrings) },
+	{ &cmd_gstats, sizeof(cmd_gstats),
+	  0, &cmd_gstats_0, sizeof(cmd_gstats_0) },
+	{ &cmd_gstats, sizeof(cmd_gstats), -ENODEV },
+	{ 0, 0, 0, 0, 0 }
+};
+
+static const struct cmd_expect cmd_expect_none[] = {
+	{ 0, 0, 0, 0, 0 }
+};
+
+static const struct ethtool_value cmd_nway_rst = { ETHTOOL_NWAY_RST };
+
+/* A batch only fetches the strings once per device */
+static const struct cmd_expect cmd_expect_batch_cached[] = {
+	{ &cmd_gssetinfo, sizeof(cmd_gssetinfo.cmd),
+	  0, &cmd_gssetinfo, sizeof(cmd_gssetinfo) },
+	{ &cmd_gstrings, sizeof(cmd_gstrings.cmd),
+	  0, &cmd_gstrings, sizeof(cmd_gstrings) },
+	{ &cmd_gstats, sizeof(cmd_gstats),
+	  0, &cmd_gstats_0, sizeof(cmd_gstats_0) },
+	{ &cmd_gstats, sizeof(cmd_gstats),
+	  0, &cmd_gstats_1, sizeof(cmd_gstats_1) },
+	{ &cmd_gssetinfo, sizeof(cmd_gssetinfo.cmd),
+	  0, &cmd_gssetinfo, sizeof(cmd_gssetinfo) },
+	{ &cmd_gstrings, sizeof(cmd_gstrings.cmd),
+	  0, &cmd_gstrings, sizeof(cmd_gstrings) },
+	{ &cmd_gstats, sizeof(cmd_gstats),
+	  0, &cmd_gstats_2, sizeof(cmd_gstats_2) },
+	{ &cmd_gstats, sizeof(cmd_gstats),
+	  0, &cmd_gstats_0, sizeof(cmd_gstats_0) },
+	{ 0, 0, 0, 0, 0 }
+};
+
+/* ...until a command may have changed the device */
+static const struct cmd_expect cmd_expect_batch_flushed[] = {
+	{ &cmd_gssetinfo, sizeof(cmd_gssetinfo.cmd),
+	  0, &cmd_gssetinfo, sizeof(cmd_gssetinfo) },
+	{ &cmd_gstrings, sizeof(cmd_gstrings.cmd),
+	  0, &cmd_gstrings, sizeof(cmd_gstrings) },
+	{ &cmd_gstats, sizeof(cmd_gstats),
+	  0, &cmd_gstats_0, sizeof(cmd_gstats_0) },
+	{ &cmd_nway_rst, sizeof(cmd_nway_rst.cmd), 0 },
+	{ &cmd_gssetinfo, sizeof(cmd_gssetinfo.cmd),
+	  0, &cmd_gssetinfo, sizeof(cmd_gssetinfo) },
+	{ &cmd_gstrings, sizeof(cmd_gstrings.cmd),
+	  0, &cmd_gstrings, sizeof(cmd_gstrings) },
+	{ &cmd_gstats, sizeof(cmd_gstats),
+	  0, &cmd_gstats_1, sizeof(cmd_gstats_1) },
+	{ 0, 0, 0, 0, 0 }
+};
+
+static struct test_case {
+	int rc;
+	const char *args;
+	const struct cmd_expect *expect;
+	const char *output;
+} const test_cases[] = {
+	{ 0, "-S devname", cmd_expect_gstats,
+	  "NIC statistics:\n"
+	  "     rx_packets: 1000\n"
+	  "     tx_packets: 500\n"
+	  "     rx_errors: 2\n" },
+	{ 0, "-S devname --match rx_*", cmd_expect_gstats,
+	  "NIC statistics:\n"
+	  "     rx_packets: 1000\n"
+	  "     rx_errors: 2\n" },
+	{ 0, "--statistics devname --match tx_packets --match *errors",
+	  cmd_expect_gstats,
+	  "NIC statistics:\n"
+	  "     tx_packets: 500\n"
+	  "     rx_errors: 2\n" },
+	{ 0, "-S devname --json", cmd_expect_gstats,
+	  "{\"ifname\":\"devname\",\"stats\":{\"rx_packets\":1000,"
+	  "\"tx_packets\":500,\"rx_errors\":2}}\n" },
+	{ 0, "-S devname --interval 1 --count 2", cmd_expect_gstats_2,
+	  "NIC statistics over 1.000 s:\n"
+	  "     rx_packets: 1100 +100 (100.00/s)\n"
+	  "     tx_packets: 550 +50 (50.00/s)\n"
+	  "     rx_errors: 2 +0 (0.00/s)\n"
+	  "NIC statistics over 1.000 s:\n"
+	  "     rx_packets: 1400 +300 (300.00/s)\n"
+	  "     tx_packets: 560 +10 (10.00/s)\n"
+	  "     rx_errors: 1 -1 (-1.00/s)\n" },
+	{ 0, "-S devname --interval 0.5 --count 2 --json --match rx_packets",
+	  cmd_expect_gstats_2,
+	  "{\"ifname\":\"devname\",\"interval\":0.500,\"stats\":"
+	  "{\"rx_packets\":{\"value\":1100,\"delta\":100,\"rate\":200.00}}}\n"
+	  "{\"ifname\":\"devname\",\"interval\":0.500,\"stats\":"
+	  "{\"rx_packets\":{\"value\":1400,\"delta\":300,\"rate\":600.00}}}\n" },
+	{ 97, "-S devname --interval 1 --count 2", cmd_expect_gstats_fail,
+	  "" },
+	{ 94, "-S devname --match foo*", cmd_expect_gstats_strings_only, "" },
+	{ 1, "-S devname --count 2", cmd_expect_none, "" },
+	{ 1, "-S devname --interval 0", cmd_expect_none, "" },
+	{ 1, "-S devname --interval", cmd_expect_none, "" },
+	{ 1, "-S devname --interval 1 --count", cmd_expect_none, "" },
+	{ 1, "-S devname --match", cmd_expect_none, "" },
+	{ 1, "-S devname foo", cmd_expect_none, "" },
+};
+
+/* Lines for ethtool --batch */
+static struct test_case const batch_test_cases[] = {
+	{ 0, "-S devname --match rx_packets\n"
+	     "-S devname --json --match tx_packets\n"
+	     "-S devname2 --match rx_errors\n"
+	     "-S devname2 --match rx_errors\n",
+	  cmd_expect_batch_cached,
+	  "NIC statistics:\n"
+	  "     rx_packets: 1000\n"
+	  "# line 1: exit status 0\n"
+	  "{\"ifname\":\"devname\",\"stats\":{\"tx_packets\":550}}\n"
+	  "# line 2: exit status 0\n"
+	  "NIC statistics:\n"
+	  "     rx_errors: 1\n"
+	  "# line 3: exit status 0\n"
+	  "NIC statistics:\n"
+	  "     rx_errors: 2\n"
+	  "# line 4: exit status 0\n" },
+	{ 0, "-S devname --match tx_packets\n"
+	     "-r devname\n"
+	     "-S devname --match tx_packets\n",
+	  cmd_expect_batch_flushed,
+	  "NIC statistics:\n"
+	  "     tx_packets: 500\n"
+	  "# line 1: exit status 0\n"
+	  "# line 2: exit status 0\n"
+	  "NIC statistics:\n"
+	  "     tx_packets: 550\n"
+	  "# line 3: exit status 0\n" },
+	{ 1, "-S devname foo\n"
+	     "# comment\n"
+	     "\n"
+	     "-S devname --match tx_packets\n"
+	     "-S devname --match foo*\n",
+	  cmd_expect_gstats,
+	  "# line 1: exit status 1\n"
+	  "NIC statistics:\n"
+	  "     tx_packets: 500\n"
+	  "# line 4: exit status 0\n"
+	  "# line 5: exit status 94\n" },
+};
+
+static int expect_matched;
+static const struct cmd_expect *expect_next;
+
+int send_ioctl(struct cmd_context *ctx, void *cmd)
+{
+	int rc = test_ioctl(expect_next, cmd);
+
+	if (rc == TEST_IOCTL_MISMATCH) {
+		expect_matched = 0;
+		test_exit(0);
+	}
+	expect_next++;
+	return rc;
+}
+
+static int run_test(const struct test_case *tc, int batch)
+{
+	char output[1024];
+	size_t len;
+	FILE *out;
+	int test_rc;
+
+	if (getenv("ETHTOOL_TEST_VERBOSE"))
+		printf("I: Test %s: %s\n", batch ? "batch" : "command line",
+		       tc->args);
+	expect_matched = 1;
+	expect_next = tc->expect;
+	out = tmpfile();
+	if (!out) {
+		perror("tmpfile");
+		return 1;
+	}
+	if (batch)
+		test_rc = test_cmdline_batch(tc->args, out);
+	else
+		test_rc = test_cmdline_output(tc->args, out);
+	rewind(out);
+	len = fread(output, 1, sizeof(output) - 1, out);
+	output[len] = 0;
+	fclose(out);
+
+	/* If we found a mismatch, or there is still another
+	 * expected ioctl to match, the test failed.
+	 */
+	if (!expect_matched || expect_next->cmd) {
+		fprintf(stderr,
+			"E: ethtool %s deviated from the expected "
+			"ioctl sequence after %zu calls\n",
+			tc->args, expect_next - tc->expect);
+		return 1;
+	} else if (test_rc != tc->rc) {
+		fprintf(stderr, "E: ethtool %s returns %d\n",
+			tc->args, test_rc);
+		return 1;
+	} else if (strcmp(output, tc->output)) {
+		fprintf(stderr,
+			"E: ethtool %s printed:\n%s"
+			"E: but expected:\n%s",
+			tc->args, output, tc->output);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	const struct test_case *tc;
+	int rc = 0;
+
+	for (tc = test_cases; tc < test_cases + ARRAY_SIZE(test_cases); tc++)
+		rc |= run_test(tc, 0);
+	for (tc = batch_test_cases;
+	     tc < batch_test_cases + ARRAY_SIZE(batch_test_cases); tc++)
+		rc |= run_test(tc, 1);
+
+	return rc;
+}
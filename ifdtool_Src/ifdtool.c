@@ -17,17 +17,24 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
  */
 
+#define _GNU_SOURCE
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <getopt.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "ifdtool.h"
 
-#define NUM_REGIONS 5
+#define FD_SIGNATURE 0x0FF0A55A
 
 static const struct region_name region_names[NUM_REGIONS] = {
 	{ "Flash Descriptor", "fd" },
@@ -37,19 +44,83 @@ static const struct region_name region_names[NUM_REGIONS] = {
 	{ "Platform Data", "pd" }
 };
 
-static fdbar_t *find_fd(char *image, int size)
+/* Byte ranges of the image changed by the edit modes. With --in-place only
+ * these are written back to the file.
+ */
+static range_t dirty_ranges[MAX_DIRTY_RANGES];
+static int num_dirty_ranges = 0;
+
+static void mark_dirty(char *image, void *start, int size)
 {
-	int i, found = 0;
+	int offset = (char *)start - image;
+	int end = offset + size;
+	int i, j;
 
+	/* Merge with all ranges it overlaps or touches, keeping them sorted */
+	for (i = 0; i < num_dirty_ranges; i++) {
+		if (dirty_ranges[i].offset + dirty_ranges[i].size >= offset)
+			break;
+	}
+	for (j = i; j < num_dirty_ranges && dirty_ranges[j].offset <= end; j++) {
+		if (dirty_ranges[j].offset < offset)
+			offset = dirty_ranges[j].offset;
+		if (dirty_ranges[j].offset + dirty_ranges[j].size > end)
+			end = dirty_ranges[j].offset + dirty_ranges[j].size;
+	}
+	if (i == j && num_dirty_ranges == MAX_DIRTY_RANGES) {
+		/* Out of slots, cover everything with a single range */
+		i = 0;
+		j = num_dirty_ranges;
+		if (dirty_ranges[0].offset < offset)
+			offset = dirty_ranges[0].offset;
+		if (dirty_ranges[j - 1].offset + dirty_ranges[j - 1].size > end)
+			end = dirty_ranges[j - 1].offset + dirty_ranges[j - 1].size;
+	}
+	memmove(&dirty_ranges[i + 1], &dirty_ranges[j],
+		(num_dirty_ranges - j) * sizeof(range_t));
+	num_dirty_ranges -= j - i - 1;
+	dirty_ranges[i].offset = offset;
+	dirty_ranges[i].size = end - offset;
+}
+
+/* Returns the offset of the descriptor signature, or -1 */
+static int scan_fd(char *image, int size)
+{
+	int i = 0;
+
+#ifdef __SSE2__
+	/* Compare 16 dwords per iteration, and only look at the single
+	 * dwords of a block that contains the signature.
+	 */
+	const __m128i sig = _mm_set1_epi32(FD_SIGNATURE);
+	for (; i + 64 <= size; i += 64) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(image + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(image + i + 16));
+		__m128i c = _mm_loadu_si128((const __m128i *)(image + i + 32));
+		__m128i d = _mm_loadu_si128((const __m128i *)(image + i + 48));
+		__m128i hit = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi32(a, sig),
+				     _mm_cmpeq_epi32(b, sig)),
+			_mm_or_si128(_mm_cmpeq_epi32(c, sig),
+				     _mm_cmpeq_epi32(d, sig)));
+		if (_mm_movemask_epi8(hit))
+			break;
+	}
+#endif
 	/* Scan for FD signature */
-	for (i = 0; i < (size - 4); i += 4) {
-		if (*(uint32_t *) (image + i) == 0x0FF0A55A) {
-			found = 1;
-			break;	// signature found.
-		}
+	for (; i + 4 <= size; i += 4) {
+		if (*(uint32_t *) (image + i) == FD_SIGNATURE)
+			return i;	// signature found.
 	}
 
-	if (!found) {
+	return -1;
+}
+
+static fdbar_t *find_fd(char *image, int size)
+{
+	int i = scan_fd(image, size);
+
+	if (i < 0) {
 		printf("No Flash Descriptor found in this image\n");
 		return NULL;
 	}
@@ -547,6 +618,231 @@ static void write_regions(char *image, int size)
 	}
 }
 
+/* Bulk extraction: every image gets a directory below extract_dir, and the
+ * worker threads take the next image from extract_jobs until none are left.
+ */
+static const char *extract_dir;
+static extract_job_t *extract_jobs;
+static int num_extract_jobs, next_extract_job;
+static pthread_mutex_t extract_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int copy_region(int image_fd, char *image, region_t region,
+		       const char *path)
+{
+	int fd, left = region.size;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC,
+		  S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	if (fd == -1) {
+		perror(path);
+		return -1;
+	}
+#ifdef __linux__
+	/* Let the kernel copy the data, or share the blocks on file systems
+	 * that support reflinks, instead of passing it through user space.
+	 */
+	loff_t offset = region.base;
+	while (left > 0) {
+		ssize_t copied = copy_file_range(image_fd, &offset, fd, NULL,
+						 left, 0);
+		if (copied <= 0)
+			break;
+		left -= copied;
+	}
+#else
+	(void)image_fd;
+#endif
+	/* Whatever the kernel didn't copy is written from the mapping */
+	if (left > 0 && pwrite(fd, image + region.base + region.size - left,
+			       left, region.size - left) != left) {
+		perror(path);
+		close(fd);
+		return -1;
+	}
+	if (close(fd) == -1) {
+		perror(path);
+		return -1;
+	}
+	return 0;
+}
+
+static void extract_image(extract_job_t *job)
+{
+	char path[FILENAME_MAX];
+	struct stat buf;
+	char *image = MAP_FAILED;
+	int fd, size, i;
+
+	job->failed = 1;
+
+	fd = open(job->filename, O_RDONLY);
+	if (fd == -1) {
+		perror(job->filename);
+		return;
+	}
+	if (fstat(fd, &buf) == -1) {
+		perror(job->filename);
+		goto out;
+	}
+	size = buf.st_size;
+	if (size > 0)
+		image = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (image == MAP_FAILED) {
+		fprintf(stderr, "Could not map %s\n", job->filename);
+		goto out;
+	}
+
+	i = scan_fd(image, size);
+	if (i < 0) {
+		fprintf(stderr, "No Flash Descriptor found in %s\n",
+			job->filename);
+		goto out;
+	}
+	fdbar_t *fdb = (fdbar_t *) (image + i);
+	int frba_offset = ((fdb->flmap0 >> 16) & 0xff) << 4;
+	if (frba_offset + (int)sizeof(frba_t) > size) {
+		fprintf(stderr, "Region table of %s lies outside the image\n",
+			job->filename);
+		goto out;
+	}
+	frba_t *frba = (frba_t *) (image + frba_offset);
+
+	snprintf(path, sizeof(path), "%s/%s", extract_dir, job->name);
+	if (mkdir(path, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) &&
+	    errno != EEXIST) {
+		perror(path);
+		goto out;
+	}
+
+	for (i = 0; i < NUM_REGIONS; i++) {
+		region_t region = get_region(frba, i);
+		job->size[i] = 0;
+		if (region.size <= 0)
+			continue;
+		if (region.base + region.size > size) {
+			fprintf(stderr, "%s region of %s lies outside the image\n",
+				region_name(i), job->filename);
+			goto out;
+		}
+		snprintf(path, sizeof(path), "%s/%s/%s", extract_dir,
+			 job->name, region_filename(i));
+		if (copy_region(fd, image, region, path))
+			goto out;
+		sha256(image + region.base, region.size, job->hash[i]);
+		job->size[i] = region.size;
+	}
+
+	job->failed = 0;
+out:
+	if (image != MAP_FAILED)
+		munmap(image, size);
+	close(fd);
+}
+
+static void *extract_worker(void *arg)
+{
+	int i;
+
+	(void)arg;
+	for (;;) {
+		pthread_mutex_lock(&extract_lock);
+		i = next_extract_job++;
+		pthread_mutex_unlock(&extract_lock);
+		if (i >= num_extract_jobs)
+			return NULL;
+		extract_image(&extract_jobs[i]);
+	}
+}
+
+/* Extract the regions of all images into per image directories below dir,
+ * using up to num_threads threads, and write the hashes of all regions to
+ * dir/manifest in the format of sha256sum. Returns the number of images
+ * that failed.
+ */
+static int extract_images(char **filenames, int count, const char *dir,
+			  int num_threads)
+{
+	char path[FILENAME_MAX];
+	pthread_t *threads;
+	FILE *manifest;
+	int i, j, failed = 0;
+
+	extract_dir = dir;
+	num_extract_jobs = count;
+	next_extract_job = 0;
+	extract_jobs = calloc(count, sizeof(*extract_jobs));
+	threads = calloc(num_threads, sizeof(*threads));
+	if (!extract_jobs || !threads) {
+		printf("Out of memory.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < count; i++) {
+		const char *name = strrchr(filenames[i], '/');
+		extract_jobs[i].filename = filenames[i];
+		extract_jobs[i].name = name ? name + 1 : filenames[i];
+		for (j = 0; j < i; j++) {
+			if (!strcmp(extract_jobs[i].name, extract_jobs[j].name)) {
+				fprintf(stderr, "%s and %s would be extracted "
+					"to the same directory\n",
+					filenames[j], filenames[i]);
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+
+	if (mkdir(dir, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) &&
+	    errno != EEXIST) {
+		perror(dir);
+		exit(EXIT_FAILURE);
+	}
+
+	if (num_threads > count)
+		num_threads = count;
+	for (i = 0; i < num_threads; i++) {
+		if (pthread_create(&threads[i], NULL, extract_worker, NULL)) {
+			fprintf(stderr, "Could not start worker thread\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	for (i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	snprintf(path, sizeof(path), "%s/manifest", dir);
+	manifest = fopen(path, "w");
+	if (!manifest) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < count; i++) {
+		extract_job_t *job = &extract_jobs[i];
+		if (job->failed) {
+			failed++;
+			continue;
+		}
+		for (j = 0; j < NUM_REGIONS; j++) {
+			int k;
+			if (!job->size[j])
+				continue;
+			for (k = 0; k < SHA256_DIGEST_SIZE; k++)
+				fprintf(manifest, "%02x", job->hash[j][k]);
+			fprintf(manifest, "  %s/%s\n", job->name,
+				region_filename(j));
+		}
+	}
+	if (fclose(manifest)) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+
+	printf("Extracted %d of %d images into %s\n", count - failed, count,
+	       dir);
+
+	free(threads);
+	free(extract_jobs);
+	return failed;
+}
+
 static void write_image(char *filename, char *image, int size)
 {
 	char new_filename[FILENAME_MAX]; // allow long file names
@@ -566,10 +862,82 @@ static void write_image(char *filename, char *image, int size)
 	close(new_fd);
 }
 
-static void set_spi_frequency(char *filename, char *image, int size,
-			      enum spi_frequency freq)
+static void write_image_in_place(char *filename, char *image)
+{
+	int i, fd, written = 0;
+
+	fd = open(filename, O_WRONLY);
+	if (fd == -1) {
+		perror("Could not open file");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < num_dirty_ranges; i++) {
+		range_t *range = &dirty_ranges[i];
+		if (pwrite(fd, image + range->offset, range->size,
+			   range->offset) != range->size) {
+			perror("Error while writing");
+			exit(EXIT_FAILURE);
+		}
+		written += range->size;
+	}
+	if (close(fd) == -1) {
+		perror("Error while writing");
+		exit(EXIT_FAILURE);
+	}
+	printf("Patched %d bytes in %d ranges of %s\n", written,
+	       num_dirty_ranges, filename);
+}
+
+static char *load_image(char *filename, int *size, int *mapped)
+{
+	struct stat buf;
+	char *image;
+	int fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd == -1) {
+		perror("Could not open file");
+		exit(EXIT_FAILURE);
+	}
+	if (fstat(fd, &buf) == -1) {
+		perror("Could not stat file");
+		exit(EXIT_FAILURE);
+	}
+	*size = buf.st_size;
+
+	printf("File %s is %d bytes\n", filename, *size);
+
+	/* A private mapping only reads the pages that are looked at, and
+	 * edits stay in memory until they are written out.
+	 */
+	image = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (image != MAP_FAILED) {
+		*mapped = 1;
+		close(fd);
+		return image;
+	}
+
+	*mapped = 0;
+	image = malloc(*size);
+	if (!image) {
+		printf("Out of memory.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (read(fd, image, *size) != *size) {
+		perror("Could not read file");
+		exit(EXIT_FAILURE);
+	}
+
+	close(fd);
+	return image;
+}
+
+static void set_spi_frequency(char *image, int size, enum spi_frequency freq)
 {
 	fdbar_t *fdb = find_fd(image, size);
+	if (!fdb)
+		exit(EXIT_FAILURE);
 	fcba_t *fcba = (fcba_t *) (image + (((fdb->flmap0) & 0xff) << 4));
 
 	/* clear bits 21-29 */
@@ -581,21 +949,25 @@ static void set_spi_frequency(char *filename, char *image, int size,
 	/* Fast Read Clock Frequency */
 	fcba->flcomp |= freq << 21;
 
-	write_image(filename, image, size);
+	mark_dirty(image, &fcba->flcomp, sizeof(fcba->flcomp));
 }
 
-static void set_em100_mode(char *filename, char *image, int size)
+static void set_em100_mode(char *image, int size)
 {
 	fdbar_t *fdb = find_fd(image, size);
+	if (!fdb)
+		exit(EXIT_FAILURE);
 	fcba_t *fcba = (fcba_t *) (image + (((fdb->flmap0) & 0xff) << 4));
 
 	fcba->flcomp &= ~(1 << 30);
-	set_spi_frequency(filename, image, size, SPI_FREQUENCY_20MHZ);
+	set_spi_frequency(image, size, SPI_FREQUENCY_20MHZ);
 }
 
-static void lock_descriptor(char *filename, char *image, int size)
+static void lock_descriptor(char *image, int size)
 {
 	fdbar_t *fdb = find_fd(image, size);
+	if (!fdb)
+		exit(EXIT_FAILURE);
 	fmba_t *fmba = (fmba_t *) (image + (((fdb->flmap1) & 0xff) << 4));
 	/* TODO: Dynamically take Platform Data Region and GbE Region
 	 * into regard.
@@ -604,18 +976,20 @@ static void lock_descriptor(char *filename, char *image, int size)
 	fmba->flmstr2 = 0x0c0d0000;
 	fmba->flmstr3 = 0x08080118;
 
-	write_image(filename, image, size);
+	mark_dirty(image, fmba, sizeof(fmba_t));
 }
 
-static void unlock_descriptor(char *filename, char *image, int size)
+static void unlock_descriptor(char *image, int size)
 {
 	fdbar_t *fdb = find_fd(image, size);
+	if (!fdb)
+		exit(EXIT_FAILURE);
 	fmba_t *fmba = (fmba_t *) (image + (((fdb->flmap1) & 0xff) << 4));
 	fmba->flmstr1 = 0xffff0000;
 	fmba->flmstr2 = 0xffff0000;
 	fmba->flmstr3 = 0x08080118;
 
-	write_image(filename, image, size);
+	mark_dirty(image, fmba, sizeof(fmba_t));
 }
 
 void inject_region(char *filename, char *image, int size, int region_type,
@@ -680,10 +1054,10 @@ void inject_region(char *filename, char *image, int size, int region_type,
 	}
 
 	close(region_fd);
+	mark_dirty(image, image + region.base, offset + region_size);
 
 	printf("Adding %s as the %s section of %s\n",
 	       region_fname, region_name(region_type), filename);
-	write_image(filename, image, size);
 }
 
 unsigned int next_pow2(unsigned int x)
@@ -716,7 +1090,174 @@ static int regions_collide(region_t r1, region_t r2)
 	return 0;
 }
 
-void new_layout(char *filename, char *image, int size, char *layout_fname)
+/* Work out which bytes of the old image go where in the new one. A growing
+ * region is copied to its end, a shrinking one is copied from its end.
+ */
+static void plan_layout(layout_plan_t *plan, region_t *current_regions,
+			region_t *new_regions, int new_extent, int size)
+{
+	int i, j, end = 0;
+
+	plan->num_moves = 0;
+	plan->num_fills = 0;
+	plan->size = new_extent;
+
+	for (i = 0; i < NUM_REGIONS; i++) {
+		region_t current = current_regions[i];
+		region_t new = new_regions[i];
+		move_t move;
+
+		if (new.size == 0)
+			continue;
+
+		if (current.size > 0 && current.base + current.size > size) {
+			fprintf(stderr, "Region %s lies outside the image.\n",
+				region_name(i));
+			exit(EXIT_FAILURE);
+		}
+
+		move.region = i;
+		move.from = current.base;
+		move.to = new.base;
+		move.size = new.size;
+		if (new.size > current.size) {
+			/* copy to the end of the new region */
+			move.to += new.size - current.size;
+			move.size = current.size;
+		} else {
+			/* copy from the end of the current region */
+			move.from += current.size - new.size;
+		}
+		if (move.size == 0)
+			continue;
+
+		/* keep the moves sorted by destination */
+		for (j = plan->num_moves; j > 0; j--) {
+			if (plan->moves[j - 1].to < move.to)
+				break;
+			plan->moves[j] = plan->moves[j - 1];
+		}
+		plan->moves[j] = move;
+		plan->num_moves++;
+	}
+
+	/* everything in between is erased flash */
+	for (i = 0; i <= plan->num_moves; i++) {
+		int next = new_extent;
+
+		if (i < plan->num_moves)
+			next = plan->moves[i].to;
+		if (next > end) {
+			plan->fills[plan->num_fills].offset = end;
+			plan->fills[plan->num_fills].size = next - end;
+			plan->num_fills++;
+		}
+		if (i < plan->num_moves)
+			end = plan->moves[i].to + plan->moves[i].size;
+	}
+}
+
+static void print_plan(layout_plan_t *plan)
+{
+	int i, moved = 0, filled = 0;
+
+	for (i = 0; i < plan->num_moves; i++) {
+		move_t *move = &plan->moves[i];
+		printf("Copy Descriptor %d (%s) (%d bytes)\n", move->region,
+				region_name(move->region), move->size);
+		printf("   from %08x:%08x\n", move->from,
+				move->from + move->size - 1);
+		printf("     to %08x:%08x\n", move->to,
+				move->to + move->size - 1);
+		moved += move->size;
+	}
+	for (i = 0; i < plan->num_fills; i++) {
+		range_t *fill = &plan->fills[i];
+		printf("Fill %08x:%08x with 0xff (%d bytes)\n", fill->offset,
+				fill->offset + fill->size - 1, fill->size);
+		filled += fill->size;
+	}
+	printf("Moving %d bytes and filling %d bytes.\n", moved, filled);
+}
+
+static void pwrite_all(int fd, const char *buf, int len, int offset)
+{
+	while (len > 0) {
+		ssize_t written = pwrite(fd, buf, len, offset);
+		if (written <= 0) {
+			perror("Error while writing");
+			exit(EXIT_FAILURE);
+		}
+		buf += written;
+		len -= written;
+		offset += written;
+	}
+}
+
+/* Build the new image in <filename>.new straight from the mapped old image,
+ * then put the updated region table in place.
+ */
+static void write_layout(char *filename, char *image, layout_plan_t *plan,
+			 frba_t *frba, int frba_offset)
+{
+	char new_filename[FILENAME_MAX];
+	char erased[0x10000];
+	int i, new_fd;
+
+	for (i = 0; i < plan->num_moves; i++) {
+		move_t *move = &plan->moves[i];
+		if (frba_offset >= move->to &&
+		    frba_offset + (int)sizeof(*frba) <= move->to + move->size)
+			break;
+	}
+	if (i == plan->num_moves) {
+		fprintf(stderr, "The new layout drops the Flash Descriptor.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	snprintf(new_filename, sizeof(new_filename), "%s.new", filename);
+	printf("Writing new image to %s\n", new_filename);
+
+	new_fd = open(new_filename, O_WRONLY | O_CREAT | O_TRUNC,
+			S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	if (new_fd == -1) {
+		perror("Could not open file");
+		exit(EXIT_FAILURE);
+	}
+	/* Allocate the whole file up front, the writes can come in any order */
+	if (ftruncate(new_fd, plan->size) == -1) {
+		perror("Error while writing");
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < plan->num_moves; i++) {
+		move_t *move = &plan->moves[i];
+		pwrite_all(new_fd, image + move->from, move->size, move->to);
+	}
+
+	memset(erased, 0xff, sizeof(erased));
+	for (i = 0; i < plan->num_fills; i++) {
+		int offset = plan->fills[i].offset;
+		int left = plan->fills[i].size;
+		while (left > 0) {
+			int len = left < (int)sizeof(erased) ?
+					left : (int)sizeof(erased);
+			pwrite_all(new_fd, erased, len, offset);
+			offset += len;
+			left -= len;
+		}
+	}
+
+	pwrite_all(new_fd, (char *)frba, sizeof(*frba), frba_offset);
+
+	if (close(new_fd) == -1) {
+		perror("Error while writing");
+		exit(EXIT_FAILURE);
+	}
+}
+
+void new_layout(char *filename, char *image, int size, char *layout_fname,
+		int dry_run)
 {
 	FILE *romlayout;
 	char tempstr[256];
@@ -726,7 +1267,7 @@ void new_layout(char *filename, char *image, int size, char *layout_fname)
 	region_t current_regions[NUM_REGIONS];
 	region_t new_regions[NUM_REGIONS];
 	int new_extent = 0;
-	char *new_image;
+	layout_plan_t plan;
 
 	/* load current descriptor map and regions */
 	fdbar_t *fdb = find_fd(image, size);
@@ -810,53 +1351,18 @@ void new_layout(char *filename, char *image, int size, char *layout_fname)
 		printf("The new image is %d bytes.\n", new_extent);
 	}
 
-	/* copy regions to a new image */
-	new_image = malloc(new_extent);
-	memset(new_image, 0xff, new_extent);
-	for (i = 0; i < NUM_REGIONS; i++) {
-		int copy_size = new_regions[i].size;
-		int offset_current = 0, offset_new = 0;
-		region_t current = current_regions[i];
-		region_t new = new_regions[i];
-
-		if (new.size == 0)
-			continue;
-
-		if (new.size > current.size) {
-			/* copy from the end of the current region */
-			copy_size = current.size;
-			offset_new = new.size - current.size;
-		}
-
-		if (new.size < current.size) {
-			/* copy to the end of the new region */
-			offset_current = current.size - new.size;
-		}
-
-		printf("Copy Descriptor %d (%s) (%d bytes)\n", i,
-				region_name(i), copy_size);
-		printf("   from %08x+%08x:%08x (%10d)\n", current.base,
-				offset_current, current.limit, current.size);
-		printf("     to %08x+%08x:%08x (%10d)\n", new.base,
-				offset_new, new.limit, new.size);
-
-		memcpy(new_image + new.base + offset_new,
-				image + current.base + offset_current,
-				copy_size);
-	}
+	plan_layout(&plan, current_regions, new_regions, new_extent, size);
+	print_plan(&plan);
 
 	/* update new descriptor regions */
-	fdb = find_fd(new_image, new_extent);
-	if (!fdb)
-		exit(EXIT_FAILURE);
-
-	frba = (frba_t *) (new_image + (((fdb->flmap0 >> 16) & 0xff) << 4));
 	for (i = 1; i < NUM_REGIONS; i++) {
 		set_region(frba, i, new_regions[i]);
 	}
 
-	write_image(filename, new_image, new_extent);
-	free(new_image);
+	if (dry_run)
+		return;
+
+	write_layout(filename, image, &plan, frba, (char *)frba - image);
 }
 
 static void print_version(void)
@@ -878,20 +1384,33 @@ static void print_version(void)
 static void print_usage(const char *name)
 {
 	printf("usage: %s [-vhdix?] <filename>\n", name);
+	printf("       %s -X <directory> [-j <jobs>] <filename>...\n", name);
 	printf("\n"
 	       "   -d | --dump:                      dump intel firmware descriptor\n"
 	       "   -f | --layout <filename>          dump regions into a flashrom layout file\n"
 	       "   -x | --extract:                   extract intel fd modules\n"
+	       "   -X | --extract-all <directory>    extract the modules of all images into\n"
+	       "                                     <directory>/<image>/ and write their\n"
+	       "                                     SHA-256 hashes to <directory>/manifest\n"
+	       "   -j | --jobs <jobs>                number of images to extract at a time\n"
 	       "   -i | --inject <region>:<module>   inject file <module> into region <region>\n"
 	       "   -n | --newlayout <filename>       update regions using a flashrom layout file\n"
+	       "   -D | --dry-run                    with --newlayout, only print the copies\n"
+	       "                                     that would be made\n"
 	       "   -s | --spifreq <20|33|50>         set the SPI frequency\n"
 	       "   -e | --em100                      set SPI frequency to 20MHz and disable\n"
 	       "                                     Dual Output Fast Read Support\n"
 	       "   -l | --lock                       Lock firmware descriptor and ME region\n"
 	       "   -u | --unlock                     Unlock firmware descriptor and ME region\n"
+	       "   -p | --in-place                   patch the changed bytes into <filename>\n"
+	       "                                     instead of writing <filename>.new\n"
 	       "   -v | --version:                   print the version\n"
 	       "   -h | --help:                      print this help\n\n"
 	       "<region> is one of Descriptor, BIOS, ME, GbE, Platform\n"
+	       "\n"
+	       "--inject, --spifreq, --em100, --lock and --unlock may be combined,\n"
+	       "and --inject may be given once for each region. All of them are\n"
+	       "applied before the image is written.\n"
 	       "\n");
 }
 
@@ -900,27 +1419,37 @@ int main(int argc, char *argv[])
 	int opt, option_index = 0;
 	int mode_dump = 0, mode_extract = 0, mode_inject = 0, mode_spifreq = 0;
 	int mode_em100 = 0, mode_locked = 0, mode_unlocked = 0;
-	int mode_layout = 0, mode_newlayout = 0;
+	int mode_layout = 0, mode_newlayout = 0, mode_inplace = 0;
+	int dry_run = 0;
 	char *region_type_string = NULL, *region_fname = NULL, *layout_fname = NULL;
 	int region_type = -1, inputfreq = 0;
 	enum spi_frequency spifreq = SPI_FREQUENCY_20MHZ;
+	int inject_types[NUM_REGIONS];
+	char *inject_fnames[NUM_REGIONS];
+	int i, mode_edit, image_mapped;
+	int mode_bulk = 0, jobs = 0;
+	char *bulk_dir = NULL;
 
 	static struct option long_options[] = {
 		{"dump", 0, NULL, 'd'},
 		{"layout", 1, NULL, 'f'},
 		{"extract", 0, NULL, 'x'},
+		{"extract-all", 1, NULL, 'X'},
+		{"jobs", 1, NULL, 'j'},
 		{"inject", 1, NULL, 'i'},
 		{"newlayout", 1, NULL, 'n'},
+		{"dry-run", 0, NULL, 'D'},
 		{"spifreq", 1, NULL, 's'},
 		{"em100", 0, NULL, 'e'},
 		{"lock", 0, NULL, 'l'},
 		{"unlock", 0, NULL, 'u'},
+		{"in-place", 0, NULL, 'p'},
 		{"version", 0, NULL, 'v'},
 		{"help", 0, NULL, 'h'},
 		{0, 0, 0, 0}
 	};
 
-	while ((opt = getopt_long(argc, argv, "df:xi:n:s:eluvh?",
+	while ((opt = getopt_long(argc, argv, "df:xX:j:i:n:Ds:elupvh?",
 				  long_options, &option_index)) != EOF) {
 		switch (opt) {
 		case 'd':
@@ -938,6 +1467,19 @@ int main(int argc, char *argv[])
 		case 'x':
 			mode_extract = 1;
 			break;
+		case 'X':
+			mode_bulk = 1;
+			bulk_dir = optarg;
+			break;
+		case 'j':
+			jobs = atoi(optarg);
+			if (jobs <= 0) {
+				fprintf(stderr, "Invalid number of jobs: %s\n\n",
+					optarg);
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
 		case 'i':
 			// separate type and file name
 			region_type_string = strdup(optarg);
@@ -966,7 +1508,17 @@ int main(int argc, char *argv[])
 				print_usage(argv[0]);
 				exit(EXIT_FAILURE);
 			}
-			mode_inject = 1;
+			for (i = 0; i < mode_inject; i++) {
+				if (inject_types[i] == region_type) {
+					fprintf(stderr, "Region %s is injected twice\n",
+						region_name(region_type));
+					exit(EXIT_FAILURE);
+				}
+			}
+			inject_types[mode_inject] = region_type;
+			inject_fnames[mode_inject] = region_fname;
+			region_type = -1;
+			mode_inject++;
 			break;
 		case 'n':
 			mode_newlayout = 1;
@@ -1015,6 +1567,12 @@ int main(int argc, char *argv[])
 				exit(EXIT_FAILURE);
 			}
 			break;
+		case 'D':
+			dry_run = 1;
+			break;
+		case 'p':
+			mode_inplace = 1;
+			break;
 		case 'v':
 			print_version();
 			exit(EXIT_SUCCESS);
@@ -1028,55 +1586,68 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	if ((mode_dump + mode_layout + mode_extract + mode_inject +
-		mode_newlayout + (mode_spifreq | mode_em100 | mode_unlocked |
-		 mode_locked)) > 1) {
+	mode_edit = mode_inject || mode_spifreq || mode_em100 ||
+		    mode_locked || mode_unlocked;
+
+	if ((mode_dump + mode_layout + mode_extract + mode_bulk +
+	     mode_newlayout + mode_edit) > 1) {
 		fprintf(stderr, "You may not specify more than one mode.\n\n");
 		print_usage(argv[0]);
 		exit(EXIT_FAILURE);
 	}
 
-	if ((mode_dump + mode_layout + mode_extract + mode_inject +
-	     mode_newlayout + mode_spifreq + mode_em100 + mode_locked +
-	     mode_unlocked) == 0) {
-		fprintf(stderr, "You need to specify a mode.\n\n");
+	if (mode_inplace && !mode_edit) {
+		fprintf(stderr, "--in-place only works with --inject, --spifreq,"
+			" --em100, --lock and --unlock.\n\n");
 		print_usage(argv[0]);
 		exit(EXIT_FAILURE);
 	}
 
-	if (optind + 1 != argc) {
-		fprintf(stderr, "You need to specify a file.\n\n");
+	if (dry_run && !mode_newlayout) {
+		fprintf(stderr, "--dry-run only works with --newlayout.\n\n");
 		print_usage(argv[0]);
 		exit(EXIT_FAILURE);
 	}
 
-	char *filename = argv[optind];
-	int bios_fd = open(filename, O_RDONLY);
-	if (bios_fd == -1) {
-		perror("Could not open file");
+	if (jobs && !mode_bulk) {
+		fprintf(stderr, "--jobs only works with --extract-all.\n\n");
+		print_usage(argv[0]);
 		exit(EXIT_FAILURE);
 	}
-	struct stat buf;
-	if (fstat(bios_fd, &buf) == -1) {
-		perror("Could not stat file");
+
+	if ((mode_dump + mode_layout + mode_extract + mode_bulk +
+	     mode_inject + mode_newlayout + mode_spifreq + mode_em100 +
+	     mode_locked + mode_unlocked) == 0) {
+		fprintf(stderr, "You need to specify a mode.\n\n");
+		print_usage(argv[0]);
 		exit(EXIT_FAILURE);
 	}
-	int size = buf.st_size;
 
-	printf("File %s is %d bytes\n", filename, size);
-
-	char *image = malloc(size);
-	if (!image) {
-		printf("Out of memory.\n");
-		exit(EXIT_FAILURE);
+	if (mode_bulk) {
+		if (optind == argc) {
+			fprintf(stderr, "You need to specify a file.\n\n");
+			print_usage(argv[0]);
+			exit(EXIT_FAILURE);
+		}
+		if (!jobs)
+			jobs = sysconf(_SC_NPROCESSORS_ONLN);
+		if (jobs <= 0)
+			jobs = 1;
+		if (extract_images(argv + optind, argc - optind, bulk_dir,
+				   jobs))
+			exit(EXIT_FAILURE);
+		return 0;
 	}
 
-	if (read(bios_fd, image, size) != size) {
-		perror("Could not read file");
+	if (optind + 1 != argc) {
+		fprintf(stderr, "You need to specify a file.\n\n");
+		print_usage(argv[0]);
 		exit(EXIT_FAILURE);
 	}
 
-	close(bios_fd);
+	char *filename = argv[optind];
+	int size;
+	char *image = load_image(filename, &size, &image_mapped);
 
 	if (mode_dump)
 		dump_fd(image, size);
@@ -1087,26 +1658,36 @@ int main(int argc, char *argv[])
 	if (mode_extract)
 		write_regions(image, size);
 
-	if (mode_inject)
-		inject_region(filename, image, size, region_type,
-				region_fname);
-
 	if (mode_newlayout)
-		new_layout(filename, image, size, layout_fname);
+		new_layout(filename, image, size, layout_fname, dry_run);
+
+	for (i = 0; i < mode_inject; i++)
+		inject_region(filename, image, size, inject_types[i],
+				inject_fnames[i]);
 
 	if (mode_spifreq)
-		set_spi_frequency(filename, image, size, spifreq);
+		set_spi_frequency(image, size, spifreq);
 
 	if (mode_em100)
-		set_em100_mode(filename, image, size);
+		set_em100_mode(image, size);
 
-	if(mode_locked)
-		lock_descriptor(filename, image, size);
+	if (mode_locked)
+		lock_descriptor(image, size);
 
 	if (mode_unlocked)
-		unlock_descriptor(filename, image, size);
+		unlock_descriptor(image, size);
+
+	if (mode_edit) {
+		if (mode_inplace)
+			write_image_in_place(filename, image);
+		else
+			write_image(filename, image, size);
+	}
 
-	free(image);
+	if (image_mapped)
+		munmap(image, size);
+	else
+		free(image);
 
 	return 0;
 }
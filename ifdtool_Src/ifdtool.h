@@ -18,6 +18,7 @@
  */
 
 #include <stdint.h>
+#include "sha256.h"
 #define IFDTOOL_VERSION "1.1"
 
 #define LAYOUT_LINELEN 80
@@ -112,6 +113,41 @@ typedef struct {
 	int base, limit, size;
 } region_t;
 
+#define NUM_REGIONS 5
+
+/* A range of bytes in the image file */
+typedef struct {
+	int offset, size;
+} range_t;
+
+#define MAX_DIRTY_RANGES 32
+
+/* Region copied from the old to the new image by --newlayout */
+typedef struct {
+	int region;
+	int from, to, size;
+} move_t;
+
+/* All the writes needed to build the new image. The fills are the ranges
+ * not covered by any move, they are set to 0xff.
+ */
+typedef struct {
+	move_t moves[NUM_REGIONS];
+	int num_moves;
+	range_t fills[NUM_REGIONS + 1];
+	int num_fills;
+	int size;
+} layout_plan_t;
+
+/* One image of a bulk extraction and the hashes of its regions */
+typedef struct {
+	const char *filename;
+	const char *name;	// directory below the output directory
+	int failed;
+	int size[NUM_REGIONS];
+	uint8_t hash[NUM_REGIONS][SHA256_DIGEST_SIZE];
+} extract_job_t;
+
 struct region_name {
 	char *pretty;
 	char *terse;
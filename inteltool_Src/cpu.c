@@ -38,6 +38,9 @@ unsigned int cpuid(unsigned int op)
 {
 	uint32_t ret;
 
+	if (snapshot_mode == SNAPSHOT_DECODE)
+		return snapshot_cpuid(op);
+
 #if defined(__PIC__) || defined(__DARWIN__) && !defined(__LP64__)
 	asm volatile (
 		"push " BREG "\n\t"
@@ -52,9 +55,11 @@ unsigned int cpuid(unsigned int op)
 	return ret;
 }
 
-#ifndef __DARWIN__
 int msr_readerror = 0;
 
+#ifndef __DARWIN__
+static int msr_partial; /* Not all bits of the last MSR could be read */
+
 msr_t rdmsr(int addr)
 {
 	uint32_t buf[2];
@@ -73,8 +78,7 @@ msr_t rdmsr(int addr)
 	}
 
 	if (errno == 5) {
-		printf(" (*)"); // Not all bits of the MSR could be read
-		msr_readerror = 1;
+		msr_partial = 1;
 	} else {
 		// A severe error.
 		perror("Could not read() MSR");
@@ -86,9 +90,36 @@ msr_t rdmsr(int addr)
 }
 #endif
 
-int print_intel_core_msrs(void)
+/*
+ * Read an MSR on the core whose MSRs are open, or take it from the snapshot.
+ * Returns 1 if not all bits of the MSR could be read.
+ */
+static int read_core_msr(int core, int addr, msr_t *msr)
+{
+	int partial = 0;
+
+	if (snapshot_mode == SNAPSHOT_DECODE) {
+		partial = snapshot_msr(core, addr, msr);
+		if (partial < 0) {
+			msr->hi = msr->lo = 0xffffffff;
+			partial = 1;
+		}
+		return partial;
+	}
+#ifndef __DARWIN__
+	msr_partial = 0;
+	*msr = rdmsr(addr);
+	partial = msr_partial;
+#else
+	*msr = rdmsr(addr);
+#endif
+	return partial;
+}
+
+static int dump_intel_core_msrs(int capture)
 {
 	unsigned int i, core, id;
+	int partial;
 	msr_t msr;
 
 #define IA32_PLATFORM_ID		0x0017
@@ -1043,56 +1074,92 @@ int print_intel_core_msrs(void)
 	}
 
 #ifndef __DARWIN__
-	fd_msr = open("/dev/cpu/0/msr", O_RDWR);
-	if (fd_msr < 0) {
-		perror("Error while opening /dev/cpu/0/msr");
-		printf("Did you run 'modprobe msr'?\n");
-		return -1;
+	if (snapshot_mode != SNAPSHOT_DECODE) {
+		fd_msr = open("/dev/cpu/0/msr", O_RDWR);
+		if (fd_msr < 0) {
+			perror("Error while opening /dev/cpu/0/msr");
+			printf("Did you run 'modprobe msr'?\n");
+			return -1;
+		}
 	}
 #endif
 
-	printf("\n===================== SHARED MSRs (All Cores) =====================\n");
+	if (!capture)
+		printf("\n===================== SHARED MSRs (All Cores) =====================\n");
 
 	for (i = 0; i < cpu->num_global_msrs; i++) {
-		msr = rdmsr(cpu->global_msrs[i].number);
+		partial = read_core_msr(0, cpu->global_msrs[i].number, &msr);
+		if (capture) {
+			snapshot_add_msr(0, cpu->global_msrs[i].number, msr, partial);
+			continue;
+		}
+		if (partial) {
+			printf(" (*)");
+			msr_readerror = 1;
+		}
 		printf(" MSR 0x%08X = 0x%08X:0x%08X (%s)\n",
 		       cpu->global_msrs[i].number, msr.hi, msr.lo,
 		       cpu->global_msrs[i].name);
 	}
 
-	close(fd_msr);
+#ifndef __DARWIN__
+	if (snapshot_mode != SNAPSHOT_DECODE)
+		close(fd_msr);
+#endif
 
 	for (core = 0; core < 8; core++) {
+		if (snapshot_mode == SNAPSHOT_DECODE) {
+			if (!snapshot_has_core(core))
+				break;
+		} else {
 #ifndef __DARWIN__
-		char msrfilename[64];
-		memset(msrfilename, 0, 64);
-		sprintf(msrfilename, "/dev/cpu/%u/msr", core);
+			char msrfilename[64];
+			memset(msrfilename, 0, 64);
+			sprintf(msrfilename, "/dev/cpu/%u/msr", core);
 
-		fd_msr = open(msrfilename, O_RDWR);
+			fd_msr = open(msrfilename, O_RDWR);
 
-		/* If the file is not there, we're probably through. No error,
-		 * since we successfully opened /dev/cpu/0/msr before.
-		 */
-		if (fd_msr < 0)
-			break;
+			/* If the file is not there, we're probably through. No error,
+			 * since we successfully opened /dev/cpu/0/msr before.
+			 */
+			if (fd_msr < 0)
+				break;
 #endif
-		if (cpu->num_per_core_msrs)
+		}
+		if (cpu->num_per_core_msrs && !capture)
 			printf("\n====================== UNIQUE MSRs  (core %u) ======================\n", core);
 
 		for (i = 0; i < cpu->num_per_core_msrs; i++) {
-			msr = rdmsr(cpu->per_core_msrs[i].number);
+			partial = read_core_msr(core, cpu->per_core_msrs[i].number, &msr);
+			if (capture) {
+				snapshot_add_msr(core, cpu->per_core_msrs[i].number, msr, partial);
+				continue;
+			}
+			if (partial) {
+				printf(" (*)");
+				msr_readerror = 1;
+			}
 			printf(" MSR 0x%08X = 0x%08X:0x%08X (%s)\n",
 			       cpu->per_core_msrs[i].number, msr.hi, msr.lo,
 			       cpu->per_core_msrs[i].name);
 		}
 #ifndef __DARWIN__
-		close(fd_msr);
+		if (snapshot_mode != SNAPSHOT_DECODE)
+			close(fd_msr);
 #endif
 	}
 
-#ifndef __DARWIN__
 	if (msr_readerror)
 		printf("\n(*) Some MSRs could not be read. The marked values are unreliable.\n");
-#endif
 	return 0;
 }
+
+int print_intel_core_msrs(void)
+{
+	return dump_intel_core_msrs(0);
+}
+
+int capture_intel_core_msrs(void)
+{
+	return dump_intel_core_msrs(1);
+}
@@ -332,21 +332,27 @@ static const gpio_default_t pp_pch_mobile_defaults[] = {
 };
 
 static uint16_t gpiobase;
+static const uint8_t *gpio_io;
+
+static uint32_t read_reg(const io_register_t *const reg)
+{
+	return read_io_image(gpio_io, reg->addr, reg->size);
+}
 
 static void print_reg(const io_register_t *const reg)
 {
 	switch (reg->size) {
 	case 4:
 		printf("gpiobase+0x%04x: 0x%08x (%s)\n",
-			reg->addr, inl(gpiobase+reg->addr), reg->name);
+			reg->addr, read_reg(reg), reg->name);
 		break;
 	case 2:
 		printf("gpiobase+0x%04x: 0x%04x     (%s)\n",
-			reg->addr, inw(gpiobase+reg->addr), reg->name);
+			reg->addr, read_reg(reg), reg->name);
 		break;
 	case 1:
 		printf("gpiobase+0x%04x: 0x%02x       (%s)\n",
-			reg->addr, inb(gpiobase+reg->addr), reg->name);
+			reg->addr, read_reg(reg), reg->name);
 		break;
 	}
 }
@@ -356,13 +362,13 @@ static uint32_t get_diff(const io_register_t *const reg, const uint32_t def)
 	uint32_t gpio_diff = 0;
 	switch (reg->size) {
 	case 4:
-		gpio_diff = def ^ inl(gpiobase+reg->addr);
+		gpio_diff = def ^ read_reg(reg);
 		break;
 	case 2:
-		gpio_diff = (uint16_t)def ^ inw(gpiobase+reg->addr);
+		gpio_diff = (uint16_t)def ^ read_reg(reg);
 		break;
 	case 1:
-		gpio_diff = (uint8_t)def ^ inb(gpiobase+reg->addr);
+		gpio_diff = (uint8_t)def ^ read_reg(reg);
 		break;
 	}
 	return gpio_diff;
@@ -393,17 +399,21 @@ static void print_diff(const io_register_t *const reg,
 	}
 }
 
-int print_gpios(struct pci_dev *sb, int show_all, int show_diffs)
+static int dump_gpios(struct pci_dev *sb, int show_all, int show_diffs,
+		      int capture)
 {
 	int i, j, size, defaults_size = 0;
 	const io_register_t *gpio_registers;
 	const gpio_default_t *gpio_defaults = NULL;
 	uint32_t gpio_diff;
+	uint8_t *io;
 
-	if (show_diffs && !show_all)
-		printf("\n========== GPIO DIFFS ===========\n\n");
-	else
-		printf("\n============= GPIOS =============\n\n");
+	if (!capture) {
+		if (show_diffs && !show_all)
+			printf("\n========== GPIO DIFFS ===========\n\n");
+		else
+			printf("\n============= GPIOS =============\n\n");
+	}
 
 	switch (sb->device_id) {
 	case PCI_DEVICE_ID_INTEL_Z68:
@@ -556,6 +566,14 @@ int print_gpios(struct pci_dev *sb, int show_all, int show_diffs)
 		return 1;
 	}
 
+	if (capture)
+		return snapshot_add_io(gpiobase, gpio_registers, size) ? 1 : 0;
+
+	io = map_io(gpiobase, gpio_registers, size);
+	if (io == NULL)
+		return 1;
+	gpio_io = io;
+
 	printf("GPIOBASE = 0x%04x (IO)\n\n", gpiobase);
 
 	j = 0;
@@ -580,5 +598,16 @@ int print_gpios(struct pci_dev *sb, int show_all, int show_diffs)
 		}
 	}
 
+	unmap_io(io);
 	return 0;
 }
+
+int print_gpios(struct pci_dev *sb, int show_all, int show_diffs)
+{
+	return dump_gpios(sb, show_all, show_diffs, 0);
+}
+
+int capture_gpios(struct pci_dev *sb)
+{
+	return dump_gpios(sb, 1, 0, 1);
+}
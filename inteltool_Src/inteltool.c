@@ -199,7 +199,7 @@ void print_version(void)
 
 void print_usage(const char *name)
 {
-	printf("usage: %s [-vh?gGrpmedPMa]\n", name);
+	printf("usage: %s [-vh?gGrpmedPMa] [-c file | -D file]\n", name);
 	printf("\n"
 	     "   -v | --version:                   print the version\n"
 	     "   -h | --help:                      print this help\n\n"
@@ -213,7 +213,9 @@ void print_usage(const char *name)
 	     "   -P | --pciexpress:                dump northbridge PCIEXBAR registers\n\n"
 	     "   -M | --msrs:                      dump CPU MSRs\n"
 	     "   -A | --ambs:                      dump AMB registers\n"
-	     "   -a | --all:                       dump all known registers\n"
+	     "   -a | --all:                       dump all known registers\n\n"
+	     "   -c | --capture <file>:            save the raw registers to a snapshot file\n"
+	     "   -D | --decode <file>:             dump the registers from a snapshot file\n"
 	     "\n");
 	exit(1);
 }
@@ -221,9 +223,10 @@ void print_usage(const char *name)
 int main(int argc, char *argv[])
 {
 	struct pci_access *pacc;
-	struct pci_dev *sb = NULL, *nb, *dev;
+	struct pci_dev *sb = NULL, *nb, *dev, *devices;
 	int i, opt, option_index = 0;
 	unsigned int id;
+	const char *capture_file = NULL, *decode_file = NULL;
 
 	char *sbname = "unknown", *nbname = "unknown";
 
@@ -246,10 +249,12 @@ int main(int argc, char *argv[])
 		{"msrs", 0, 0, 'M'},
 		{"ambs", 0, 0, 'A'},
 		{"all", 0, 0, 'a'},
+		{"capture", 1, 0, 'c'},
+		{"decode", 1, 0, 'D'},
 		{0, 0, 0, 0}
 	};
 
-	while ((opt = getopt_long(argc, argv, "vh?gGrpmedPMaA",
+	while ((opt = getopt_long(argc, argv, "vh?gGrpmedPMaAc:D:",
                                   long_options, &option_index)) != EOF) {
 		switch (opt) {
 		case 'v':
@@ -298,6 +303,12 @@ int main(int argc, char *argv[])
 		case 'A':
 			dump_ambs = 1;
 			break;
+		case 'c':
+			capture_file = optarg;
+			break;
+		case 'D':
+			decode_file = optarg;
+			break;
 		case 'h':
 		case '?':
 		default:
@@ -307,31 +318,55 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (capture_file && decode_file) {
+		printf("Use either --capture or --decode.\n");
+		exit(1);
+	}
+
+	/* A snapshot has no PCIe extended config space or AMB registers. */
+	if (decode_file && (dump_pciexbar || dump_ambs)) {
+		printf("Skipping PCIEXBAR and AMB registers, they are not part of a snapshot.\n");
+		dump_pciexbar = 0;
+		dump_ambs = 0;
+	}
+
+	pacc = pci_alloc();
+
+	if (decode_file) {
+		if (snapshot_load(decode_file, pacc))
+			exit(1);
+		devices = snapshot_devices();
+	} else {
 #if defined(__FreeBSD__)
-	if (open("/dev/io", O_RDWR) < 0) {
-		perror("/dev/io");
+		if (open("/dev/io", O_RDWR) < 0) {
+			perror("/dev/io");
 #else
-	if (iopl(3)) {
-		perror("iopl");
+		if (iopl(3)) {
+			perror("iopl");
 #endif
-		printf("You need to be root.\n");
-		exit(1);
-	}
+			printf("You need to be root.\n");
+			exit(1);
+		}
 
 #ifndef __DARWIN__
-	if ((fd_mem = open("/dev/mem", O_RDWR)) < 0) {
-		perror("Can not open /dev/mem");
-		exit(1);
-	}
+		if ((fd_mem = open("/dev/mem", O_RDWR)) < 0) {
+			perror("Can not open /dev/mem");
+			exit(1);
+		}
 #endif
 
-	pacc = pci_alloc();
-	pci_init(pacc);
-	pci_scan_bus(pacc);
+		pci_init(pacc);
+		pci_scan_bus(pacc);
+		devices = pacc->devices;
+
+		if (capture_file && snapshot_create(capture_file))
+			exit(1);
+	}
 
 	/* Find the required devices */
-	for (dev = pacc->devices; dev; dev = dev->next) {
-		pci_fill_info(dev, PCI_FILL_CLASS);
+	for (dev = devices; dev; dev = dev->next) {
+		if (!decode_file)
+			pci_fill_info(dev, PCI_FILL_CLASS);
 		/* The ISA/LPC bridge can be 0x1f, 0x07, or 0x04 so we probe. */
 		if (dev->device_class == 0x0601) { /* ISA/LPC bridge */
 			if (sb == NULL)
@@ -349,20 +384,22 @@ int main(int argc, char *argv[])
 		exit(1);
 	}
 
-	pci_fill_info(sb, PCI_FILL_IDENT|PCI_FILL_BASES|PCI_FILL_SIZES|PCI_FILL_CLASS);
+	if (!decode_file)
+		pci_fill_info(sb, PCI_FILL_IDENT|PCI_FILL_BASES|PCI_FILL_SIZES|PCI_FILL_CLASS);
 
 	if (sb->vendor_id != PCI_VENDOR_ID_INTEL) {
 		printf("Not an Intel(R) southbridge.\n");
 		exit(1);
 	}
 
-	nb = pci_get_dev(pacc, 0, 0, 0x00, 0);
+	nb = get_pci_dev(pacc, 0, 0, 0x00, 0);
 	if (!nb) {
 		printf("No northbridge found.\n");
 		exit(1);
 	}
 
-	pci_fill_info(nb, PCI_FILL_IDENT|PCI_FILL_BASES|PCI_FILL_SIZES|PCI_FILL_CLASS);
+	if (!decode_file)
+		pci_fill_info(nb, PCI_FILL_IDENT|PCI_FILL_BASES|PCI_FILL_SIZES|PCI_FILL_CLASS);
 
 	if (nb->vendor_id != PCI_VENDOR_ID_INTEL) {
 		printf("Not an Intel(R) northbridge.\n");
@@ -370,6 +407,8 @@ int main(int argc, char *argv[])
 	}
 
 	id = cpuid(1);
+	if (capture_file)
+		snapshot_add_cpuid(1, id);
 
 	/* Intel has suggested applications to display the family of a CPU as
 	 * the sum of the "Family" and the "Extended Family" fields shown
@@ -395,6 +434,22 @@ int main(int argc, char *argv[])
 	printf("Southbridge: %04x:%04x (%s)\n",
 		sb->vendor_id, sb->device_id, sbname);
 
+	/* Only copy the raw registers, they are decoded with --decode. */
+	if (capture_file) {
+		capture_gpios(sb);
+		capture_rcba(sb);
+		capture_pmbase(sb, pacc);
+		capture_mchbar(nb, pacc);
+		capture_epbar(nb);
+		capture_dmibar(nb);
+		capture_intel_core_msrs();
+		if (snapshot_close(pacc))
+			exit(1);
+		pci_free_dev(nb);
+		pci_cleanup(pacc);
+		return 0;
+	}
+
 	/* Now do the deed */
 
 	if (dump_gpios) {
@@ -444,7 +499,10 @@ int main(int argc, char *argv[])
 		print_ambs(nb, pacc);
 	}
 	/* Clean up */
-	pci_free_dev(nb);
+	if (decode_file)
+		snapshot_free();
+	else
+		pci_free_dev(nb);
 	// pci_free_dev(sb); // TODO: glibc detected "double free or corruption"
 	pci_cleanup(pacc);
 
@@ -190,3 +190,40 @@ int print_epbar(struct pci_dev *nb);
 int print_dmibar(struct pci_dev *nb);
 int print_pciexbar(struct pci_dev *nb);
 int print_ambs(struct pci_dev *nb, struct pci_access *pacc);
+int capture_intel_core_msrs(void);
+int capture_mchbar(struct pci_dev *nb, struct pci_access *pacc);
+int capture_pmbase(struct pci_dev *sb, struct pci_access *pacc);
+int capture_rcba(struct pci_dev *sb);
+int capture_gpios(struct pci_dev *sb);
+int capture_epbar(struct pci_dev *nb);
+int capture_dmibar(struct pci_dev *nb);
+
+/* Snapshots: the dump functions read the hardware through these, so that
+ * they decode a snapshot the same way as the live registers. */
+#define SNAPSHOT_LIVE		0
+#define SNAPSHOT_CAPTURE	1
+#define SNAPSHOT_DECODE		2
+extern int snapshot_mode;
+
+int snapshot_create(const char *filename);
+int snapshot_close(struct pci_access *pacc);
+int snapshot_add_mem(uint64_t phys_addr, size_t len);
+int snapshot_add_io(uint16_t base, const io_register_t *regs, int count);
+int snapshot_add_msr(int core, int addr, msr_t msr, int read_error);
+int snapshot_add_cpuid(unsigned int op, unsigned int value);
+
+int snapshot_load(const char *filename, struct pci_access *pacc);
+struct pci_dev *snapshot_devices(void);
+void snapshot_free(void);
+unsigned int snapshot_cpuid(unsigned int op);
+int snapshot_msr(int core, int addr, msr_t *msr);
+int snapshot_has_core(int core);
+
+struct pci_dev *get_pci_dev(struct pci_access *pacc, int domain, int bus,
+			    int dev, int func);
+void write_pci_long(struct pci_dev *dev, int pos, uint32_t val);
+void *map_mmio(uint64_t phys_addr, size_t len);
+void unmap_mmio(void *virt_addr, size_t len);
+uint8_t *map_io(uint16_t base, const io_register_t *regs, int count);
+void unmap_io(uint8_t *image);
+uint32_t read_io_image(const uint8_t *image, uint16_t addr, int size);
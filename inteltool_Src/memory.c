@@ -152,15 +152,16 @@ static void dump_timings (void)
 /*
  * (G)MCH MMIO Config Space
  */
-int print_mchbar(struct pci_dev *nb, struct pci_access *pacc)
+static int dump_mchbar(struct pci_dev *nb, struct pci_access *pacc, int capture)
 {
-	int i, size = (16 * 1024);
+	int i, size = (16 * 1024), nregs = 0;
 	uint64_t mchbar_phys;
 	const io_register_t *mch_registers = NULL;
 	struct pci_dev *nb_device6; /* "overflow device" on i865 */
 	uint16_t pcicmd6;
 
-	printf("\n============= MCHBAR ============\n\n");
+	if (!capture)
+		printf("\n============= MCHBAR ============\n\n");
 
 	switch (nb->device_id) {
 	case PCI_DEVICE_ID_INTEL_82865:
@@ -172,7 +173,11 @@ int print_mchbar(struct pci_dev *nb, struct pci_access *pacc)
 		 * The actual base address is in BAR6 on i865 where on
 		 * i945/i965 the base address is in MCHBAR.
 		 */
-		nb_device6 = pci_get_dev(pacc, 0, 0, 0x06, 0);  /* Device 6 */
+		nb_device6 = get_pci_dev(pacc, 0, 0, 0x06, 0);  /* Device 6 */
+		if (!nb_device6) {
+			printf("Northbridge device 6 not found.\n");
+			return 1;
+		}
 		mchbar_phys = pci_read_long(nb_device6, 0x10);  /* BAR6 */
 		pcicmd6 = pci_read_long(nb_device6, 0x04);      /* PCICMD6 */
 
@@ -180,7 +185,7 @@ int print_mchbar(struct pci_dev *nb, struct pci_access *pacc)
 		if (!(pcicmd6 & (1 << 1))) {
 			printf("Access to BAR6 is currently disabled, "
 			       "attempting to enable.\n");
-			pci_write_long(nb_device6, 0x04, pcicmd6 | (1 << 1));
+			write_pci_long(nb_device6, 0x04, pcicmd6 | (1 << 1));
 			if (pci_read_long(nb_device6, 0x04) & (1 << 1))
 				printf("Enabled successfully.\n");
 			else
@@ -219,7 +224,7 @@ int print_mchbar(struct pci_dev *nb, struct pci_access *pacc)
 			printf("Access to the MCHBAR is currently disabled, "
 				   "attempting to enable.\n");
 			mchbar_phys |= 0x1;
-			pci_write_long(nb, 0x48, mchbar_phys);
+			write_pci_long(nb, 0x48, mchbar_phys);
 			if(pci_read_long(nb, 0x48) & 1)
 				printf("Enabled successfully.\n");
 			else
@@ -250,7 +255,8 @@ int print_mchbar(struct pci_dev *nb, struct pci_access *pacc)
 		break;
 	case PCI_DEVICE_ID_INTEL_CORE_2ND_GEN:
 		mch_registers = sandybridge_mch_registers;
-		size = ARRAY_SIZE(sandybridge_mch_registers);
+		nregs = ARRAY_SIZE(sandybridge_mch_registers);
+		size = (32 * 1024);
 	case PCI_DEVICE_ID_INTEL_CORE_3RD_GEN_A: /* pretty printing not implemented yet */
 	case PCI_DEVICE_ID_INTEL_CORE_3RD_GEN_B:
 	case PCI_DEVICE_ID_INTEL_CORE_3RD_GEN_C:
@@ -264,7 +270,10 @@ int print_mchbar(struct pci_dev *nb, struct pci_access *pacc)
 		return 1;
 	}
 
-	mchbar = map_physical(mchbar_phys, size);
+	if (capture)
+		return snapshot_add_mem(mchbar_phys, size) ? 1 : 0;
+
+	mchbar = map_mmio(mchbar_phys, size);
 
 	if (mchbar == NULL) {
 		if (nb->device_id == PCI_DEVICE_ID_INTEL_82865)
@@ -280,8 +289,8 @@ int print_mchbar(struct pci_dev *nb, struct pci_access *pacc)
 		printf("MCHBAR = 0x%08" PRIx64 " (MEM)\n\n", mchbar_phys);
 
 	if (mch_registers != NULL) {
-		printf("%d registers:\n", size);
-		for (i = 0; i < size; i++) {
+		printf("%d registers:\n", nregs);
+		for (i = 0; i < nregs; i++) {
 			switch (mch_registers[i].size) {
 				case 8:
 					printf("mchbase+0x%04x: 0x%016"PRIx64" (%s)\n",
@@ -317,11 +326,26 @@ int print_mchbar(struct pci_dev *nb, struct pci_access *pacc)
 	}
 
 	if (nb->device_id == PCI_DEVICE_ID_INTEL_CORE_1ST_GEN) {
-		printf ("clock_speed_index = %x\n", read_500 (0,0x609, 6) >> 1);
-		dump_timings ();
+		/* The timings are read by writing to the MCHBAR. */
+		if (snapshot_mode == SNAPSHOT_DECODE) {
+			printf ("Timings are not part of the snapshot.\n");
+		} else {
+			printf ("clock_speed_index = %x\n", read_500 (0,0x609, 6) >> 1);
+			dump_timings ();
+		}
 	}
-	unmap_physical((void *)mchbar, size);
+	unmap_mmio((void *)mchbar, size);
 	return 0;
 }
 
+int print_mchbar(struct pci_dev *nb, struct pci_access *pacc)
+{
+	return dump_mchbar(nb, pacc, 0);
+}
+
+int capture_mchbar(struct pci_dev *nb, struct pci_access *pacc)
+{
+	return dump_mchbar(nb, pacc, 1);
+}
+
 
@@ -121,13 +121,14 @@ static const io_register_t sandybridge_dmi_registers[] = {
 /*
  * Egress Port Root Complex MMIO configuration space
  */
-int print_epbar(struct pci_dev *nb)
+static int dump_epbar(struct pci_dev *nb, int capture)
 {
 	int i, size = (4 * 1024);
 	volatile uint8_t *epbar;
 	uint64_t epbar_phys;
 
-	printf("\n============= EPBAR =============\n\n");
+	if (!capture)
+		printf("\n============= EPBAR =============\n\n");
 
 	switch (nb->device_id) {
 	case PCI_DEVICE_ID_INTEL_82915:
@@ -163,7 +164,10 @@ int print_epbar(struct pci_dev *nb)
 		return 1;
 	}
 
-	epbar = map_physical(epbar_phys, size);
+	if (capture)
+		return snapshot_add_mem(epbar_phys, size) ? 1 : 0;
+
+	epbar = map_mmio(epbar_phys, size);
 
 	if (epbar == NULL) {
 		perror("Error mapping EPBAR");
@@ -176,21 +180,32 @@ int print_epbar(struct pci_dev *nb)
 			printf("0x%04x: 0x%08x\n", i, *(uint32_t *)(epbar+i));
 	}
 
-	unmap_physical((void *)epbar, size);
+	unmap_mmio((void *)epbar, size);
 	return 0;
 }
 
+int print_epbar(struct pci_dev *nb)
+{
+	return dump_epbar(nb, 0);
+}
+
+int capture_epbar(struct pci_dev *nb)
+{
+	return dump_epbar(nb, 1);
+}
+
 /*
  * MCH-ICH Serial Interconnect Ingress Root Complex MMIO configuration space
  */
-int print_dmibar(struct pci_dev *nb)
+static int dump_dmibar(struct pci_dev *nb, int capture)
 {
-	int i, size = (4 * 1024);
+	int i, size = (4 * 1024), nregs = 0;
 	volatile uint8_t *dmibar;
 	uint64_t dmibar_phys;
 	const io_register_t *dmi_registers = NULL;
 
-	printf("\n============= DMIBAR ============\n\n");
+	if (!capture)
+		printf("\n============= DMIBAR ============\n\n");
 
 	switch (nb->device_id) {
 	case PCI_DEVICE_ID_INTEL_82915:
@@ -227,18 +242,18 @@ int print_dmibar(struct pci_dev *nb)
 		/* DMIBAR is called DMIRCBAR in Nehalem */
 		dmibar_phys = pci_read_long(nb, 0x50) & 0xfffff000; /* 31:12 */
 		dmi_registers = nehalem_dmi_registers;
-		size = ARRAY_SIZE(nehalem_dmi_registers);
+		nregs = ARRAY_SIZE(nehalem_dmi_registers);
 		break;
 	case PCI_DEVICE_ID_INTEL_CORE_1ST_GEN:
 		dmibar_phys = pci_read_long(nb, 0x68);
 		dmibar_phys |= ((uint64_t)pci_read_long(nb, 0x6c)) << 32;
 		dmibar_phys &= 0x0000000ffffff000UL; /* 35:12 */
 		dmi_registers = westmere_dmi_registers;
-		size = ARRAY_SIZE(westmere_dmi_registers);
+		nregs = ARRAY_SIZE(westmere_dmi_registers);
 		break;
 	case PCI_DEVICE_ID_INTEL_CORE_2ND_GEN:
 		dmi_registers = sandybridge_dmi_registers;
-		size = ARRAY_SIZE(sandybridge_dmi_registers);
+		nregs = ARRAY_SIZE(sandybridge_dmi_registers);
 	case PCI_DEVICE_ID_INTEL_CORE_3RD_GEN_A: /* pretty printing not implemented yet */
 	case PCI_DEVICE_ID_INTEL_CORE_3RD_GEN_B:
 	case PCI_DEVICE_ID_INTEL_CORE_3RD_GEN_C:
@@ -252,7 +267,10 @@ int print_dmibar(struct pci_dev *nb)
 		return 1;
 	}
 
-	dmibar = map_physical(dmibar_phys, size);
+	if (capture)
+		return snapshot_add_mem(dmibar_phys, size) ? 1 : 0;
+
+	dmibar = map_mmio(dmibar_phys, size);
 
 	if (dmibar == NULL) {
 		perror("Error mapping DMIBAR");
@@ -261,7 +279,7 @@ int print_dmibar(struct pci_dev *nb)
 
 	printf("DMIBAR = 0x%08" PRIx64 " (MEM)\n\n", dmibar_phys);
 	if (dmi_registers != NULL) {
-		for (i = 0; i < size; i++) {
+		for (i = 0; i < nregs; i++) {
 			switch (dmi_registers[i].size) {
 				case 4:
 					printf("dmibase+0x%04x: 0x%08x (%s)\n",
@@ -290,10 +308,20 @@ int print_dmibar(struct pci_dev *nb)
 		}
 	}
 
-	unmap_physical((void *)dmibar, size);
+	unmap_mmio((void *)dmibar, size);
 	return 0;
 }
 
+int print_dmibar(struct pci_dev *nb)
+{
+	return dump_dmibar(nb, 0);
+}
+
+int capture_dmibar(struct pci_dev *nb)
+{
+	return dump_dmibar(nb, 1);
+}
+
 /*
  * PCIe MMIO configuration space
  */
@@ -646,14 +646,16 @@ static const io_register_t i63xx_pm_registers[] = {
 	{ 0x7c, 4, "RESERVED" },
 };
 
-int print_pmbase(struct pci_dev *sb, struct pci_access *pacc)
+static int dump_pmbase(struct pci_dev *sb, struct pci_access *pacc, int capture)
 {
 	int i, size;
 	uint16_t pmbase;
 	const io_register_t *pm_registers;
 	struct pci_dev *acpi;
+	uint8_t *io;
 
-	printf("\n============= PMBASE ============\n\n");
+	if (!capture)
+		printf("\n============= PMBASE ============\n\n");
 
 	switch (sb->device_id) {
 	case PCI_DEVICE_ID_INTEL_Z68:
@@ -745,7 +747,7 @@ int print_pmbase(struct pci_dev *sb, struct pci_access *pacc)
 		size = ARRAY_SIZE(ich0_pm_registers);
 		break;
 	case PCI_DEVICE_ID_INTEL_82371XX:
-		acpi = pci_get_dev(pacc, sb->domain, sb->bus, sb->dev, 3);
+		acpi = get_pci_dev(pacc, sb->domain, sb->bus, sb->dev, 3);
 		if (!acpi) {
 			printf("Southbridge function 3 not found.\n");
 			return 1;
@@ -791,6 +793,13 @@ int print_pmbase(struct pci_dev *sb, struct pci_access *pacc)
 		return 1;
 	}
 
+	if (capture)
+		return snapshot_add_io(pmbase, pm_registers, size) ? 1 : 0;
+
+	io = map_io(pmbase, pm_registers, size);
+	if (io == NULL)
+		return 1;
+
 	printf("PMBASE = 0x%04x (IO)\n\n", pmbase);
 
 	for (i = 0; i < size; i++) {
@@ -799,30 +808,41 @@ int print_pmbase(struct pci_dev *sb, struct pci_access *pacc)
 			printf("pmbase+0x%04x: 0x%08x (%s)\n"
 			       "               0x%08x\n",
 				pm_registers[i].addr,
-				inl(pmbase+pm_registers[i].addr),
+				read_io_image(io, pm_registers[i].addr, 4),
 				pm_registers[i].name,
-				inl(pmbase+pm_registers[i].addr+4));
+				read_io_image(io, pm_registers[i].addr+4, 4));
 			break;
 		case 4:
 			printf("pmbase+0x%04x: 0x%08x (%s)\n",
 				pm_registers[i].addr,
-				inl(pmbase+pm_registers[i].addr),
+				read_io_image(io, pm_registers[i].addr, 4),
 				pm_registers[i].name);
 			break;
 		case 2:
 			printf("pmbase+0x%04x: 0x%04x     (%s)\n",
 				pm_registers[i].addr,
-				inw(pmbase+pm_registers[i].addr),
+				read_io_image(io, pm_registers[i].addr, 2),
 				pm_registers[i].name);
 			break;
 		case 1:
 			printf("pmbase+0x%04x: 0x%02x       (%s)\n",
 				pm_registers[i].addr,
-				inb(pmbase+pm_registers[i].addr),
+				read_io_image(io, pm_registers[i].addr, 1),
 				pm_registers[i].name);
 			break;
 		}
 	}
 
+	unmap_io(io);
 	return 0;
 }
+
+int print_pmbase(struct pci_dev *sb, struct pci_access *pacc)
+{
+	return dump_pmbase(sb, pacc, 0);
+}
+
+int capture_pmbase(struct pci_dev *sb, struct pci_access *pacc)
+{
+	return dump_pmbase(sb, pacc, 1);
+}
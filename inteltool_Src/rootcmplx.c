@@ -22,13 +22,14 @@
 #include <stdlib.h>
 #include "inteltool.h"
 
-int print_rcba(struct pci_dev *sb)
+static int dump_rcba(struct pci_dev *sb, int capture)
 {
 	int i, size = 0x4000;
 	volatile uint8_t *rcba;
 	uint32_t rcba_phys;
 
-	printf("\n============= RCBA ==============\n\n");
+	if (!capture)
+		printf("\n============= RCBA ==============\n\n");
 
 	switch (sb->device_id) {
 	case PCI_DEVICE_ID_INTEL_ICH6:
@@ -108,7 +109,10 @@ int print_rcba(struct pci_dev *sb)
 		return 1;
 	}
 
-	rcba = map_physical(rcba_phys, size);
+	if (capture)
+		return snapshot_add_mem(rcba_phys, size) ? 1 : 0;
+
+	rcba = map_mmio(rcba_phys, size);
 
 	if (rcba == NULL) {
 		perror("Error mapping RCBA");
@@ -122,6 +126,16 @@ int print_rcba(struct pci_dev *sb)
 			printf("0x%04x: 0x%08x\n", i, *(uint32_t *)(rcba + i));
 	}
 
-	unmap_physical((void *)rcba, size);
+	unmap_mmio((void *)rcba, size);
 	return 0;
 }
+
+int print_rcba(struct pci_dev *sb)
+{
+	return dump_rcba(sb, 0);
+}
+
+int capture_rcba(struct pci_dev *sb)
+{
+	return dump_rcba(sb, 1);
+}
@@ -0,0 +1,602 @@
+/*
+ * inteltool - dump all registers on an Intel CPU + chipset based system.
+ *
+ * Snapshots: capture the raw register windows of a machine into one file
+ * and decode them later, on any machine and without root.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/time.h>
+#include "inteltool.h"
+
+/*
+ * A snapshot file starts with a 16 byte header: the magic, the uint32
+ * format version and a reserved uint32. Then follow records, each a
+ * struct snapshot_record and len bytes of data, padded to 8 bytes.
+ * Everything is in host byte order, register data as read from the
+ * hardware.
+ */
+#define SNAPSHOT_MAGIC		"INTELSNP"
+#define SNAPSHOT_VERSION	1
+
+#define SNAPSHOT_CPUID		1	/* addr: leaf, data: uint32 eax */
+#define SNAPSHOT_PCI		2	/* addr: domain:bus:dev.fn, data: config space */
+#define SNAPSHOT_MEM		3	/* addr: physical address, data: MMIO window */
+#define SNAPSHOT_IO		4	/* addr: I/O port, data: I/O range */
+#define SNAPSHOT_MSR		5	/* addr: MSR, core: core, data: msr_t */
+
+#define SNAPSHOT_F_READ_ERROR	(1 << 0)
+
+#define PCI_CONFIG_SIZE		256
+#define MAX_EXTRA_DEVS		8
+
+struct snapshot_record {
+	uint32_t type;
+	uint32_t flags;
+	uint64_t addr;
+	uint32_t len;
+	uint32_t core;
+};
+
+struct snapshot_entry {
+	struct snapshot_record rec;
+	uint8_t *data;
+};
+
+int snapshot_mode = SNAPSHOT_LIVE;
+
+/* capture */
+static FILE *snapshot_file;
+static const char *snapshot_name;
+static struct pci_dev *extra_devs[MAX_EXTRA_DEVS];
+static int num_extra_devs;
+static unsigned int num_records;
+static size_t num_bytes;
+static double start_time;
+
+/* decode */
+static uint8_t *snapshot_buf;
+static struct snapshot_entry *entries;
+static unsigned int num_entries;
+static struct pci_dev *snapshot_devs;
+
+static double now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static uint64_t pci_addr(int domain, int bus, int dev, int func)
+{
+	return ((uint64_t)domain << 16) | (bus << 8) | (dev << 3) | func;
+}
+
+static int add_record(uint32_t type, uint32_t flags, uint64_t addr,
+		      uint32_t core, const void *data, uint32_t len)
+{
+	static const uint8_t pad[8];
+	struct snapshot_record rec;
+
+	memset(&rec, 0, sizeof(rec));
+	rec.type = type;
+	rec.flags = flags;
+	rec.addr = addr;
+	rec.len = len;
+	rec.core = core;
+	if (fwrite(&rec, sizeof(rec), 1, snapshot_file) != 1 ||
+	    (len && fwrite(data, len, 1, snapshot_file) != 1) ||
+	    ((len & 7) && fwrite(pad, 8 - (len & 7), 1, snapshot_file) != 1)) {
+		perror(snapshot_name);
+		return -1;
+	}
+	num_records++;
+	num_bytes += len;
+	return 0;
+}
+
+int snapshot_create(const char *filename)
+{
+	uint32_t header[2] = { SNAPSHOT_VERSION, 0 };
+
+	snapshot_file = fopen(filename, "wb");
+	if (snapshot_file == NULL) {
+		perror(filename);
+		return -1;
+	}
+	snapshot_name = filename;
+	if (fwrite(SNAPSHOT_MAGIC, 8, 1, snapshot_file) != 1 ||
+	    fwrite(header, sizeof(header), 1, snapshot_file) != 1) {
+		perror(filename);
+		fclose(snapshot_file);
+		return -1;
+	}
+	snapshot_mode = SNAPSHOT_CAPTURE;
+	start_time = now();
+	return 0;
+}
+
+static int add_dev(struct pci_dev *dev)
+{
+	uint8_t config[PCI_CONFIG_SIZE];
+
+	if (!pci_read_block(dev, 0, config, sizeof(config)))
+		return 0;
+	return add_record(SNAPSHOT_PCI, 0,
+			  pci_addr(dev->domain, dev->bus, dev->dev, dev->func),
+			  0, config, sizeof(config));
+}
+
+/*
+ * The config space is saved last, so that it shows the MCHBAR enable bits
+ * as they were set while capturing.
+ */
+int snapshot_close(struct pci_access *pacc)
+{
+	struct pci_dev *dev;
+	int i, ret = 0;
+
+	for (dev = pacc->devices; dev; dev = dev->next)
+		ret |= add_dev(dev);
+	for (i = 0; i < num_extra_devs; i++) {
+		for (dev = pacc->devices; dev; dev = dev->next)
+			if (dev->domain == extra_devs[i]->domain &&
+			    dev->bus == extra_devs[i]->bus &&
+			    dev->dev == extra_devs[i]->dev &&
+			    dev->func == extra_devs[i]->func)
+				break;
+		if (dev == NULL)
+			ret |= add_dev(extra_devs[i]);
+	}
+
+	if (fclose(snapshot_file)) {
+		perror(snapshot_name);
+		ret = -1;
+	}
+	snapshot_file = NULL;
+	snapshot_mode = SNAPSHOT_LIVE;
+	if (ret)
+		return -1;
+
+	printf("Captured %u records, %zu bytes of registers, in %.3f ms to %s\n",
+	       num_records, num_bytes, (now() - start_time) * 1000,
+	       snapshot_name);
+	return 0;
+}
+
+/*
+ * Chipset registers expect naturally aligned 32 bit accesses, which
+ * memcpy() does not guarantee.
+ */
+static void copy_mmio(uint32_t *dst, const volatile uint32_t *src, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len / 4; i++)
+		dst[i] = src[i];
+}
+
+int snapshot_add_mem(uint64_t phys_addr, size_t len)
+{
+	volatile uint32_t *virt_addr;
+	uint32_t *buf;
+	int ret;
+
+	virt_addr = map_physical(phys_addr, len);
+	if (virt_addr == NULL)
+		return -1;
+	buf = malloc(len);
+	if (buf == NULL) {
+		perror("malloc");
+		unmap_physical((void *)virt_addr, len);
+		return -1;
+	}
+	copy_mmio(buf, virt_addr, len);
+	unmap_physical((void *)virt_addr, len);
+
+	ret = add_record(SNAPSHOT_MEM, 0, phys_addr, 0, buf, len);
+	free(buf);
+	return ret;
+}
+
+static size_t io_size(const io_register_t *regs, int count)
+{
+	size_t size = 0;
+	int i;
+
+	for (i = 0; i < count; i++)
+		if (regs[i].addr + (size_t)regs[i].size > size)
+			size = regs[i].addr + regs[i].size;
+	return size;
+}
+
+/* Only the listed registers are read, other I/O ports may have side effects. */
+static void read_io(uint16_t base, const io_register_t *regs, int count,
+		    uint8_t *image)
+{
+	uint32_t val;
+	uint16_t val16;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		uint8_t *p = image + regs[i].addr;
+
+		switch (regs[i].size) {
+		case 8:
+			val = inl(base + regs[i].addr);
+			memcpy(p, &val, 4);
+			val = inl(base + regs[i].addr + 4);
+			memcpy(p + 4, &val, 4);
+			break;
+		case 4:
+			val = inl(base + regs[i].addr);
+			memcpy(p, &val, 4);
+			break;
+		case 2:
+			val16 = inw(base + regs[i].addr);
+			memcpy(p, &val16, 2);
+			break;
+		case 1:
+			*p = inb(base + regs[i].addr);
+			break;
+		}
+	}
+}
+
+int snapshot_add_io(uint16_t base, const io_register_t *regs, int count)
+{
+	size_t size = io_size(regs, count);
+	uint8_t *image;
+	int ret;
+
+	image = calloc(1, size);
+	if (image == NULL) {
+		perror("calloc");
+		return -1;
+	}
+	read_io(base, regs, count, image);
+	ret = add_record(SNAPSHOT_IO, 0, base, 0, image, size);
+	free(image);
+	return ret;
+}
+
+int snapshot_add_msr(int core, int addr, msr_t msr, int read_error)
+{
+	uint32_t val[2] = { msr.lo, msr.hi };
+
+	return add_record(SNAPSHOT_MSR, read_error ? SNAPSHOT_F_READ_ERROR : 0,
+			  addr, core, val, sizeof(val));
+}
+
+int snapshot_add_cpuid(unsigned int op, unsigned int value)
+{
+	uint32_t eax = value;
+
+	return add_record(SNAPSHOT_CPUID, 0, op, 0, &eax, sizeof(eax));
+}
+
+/* Find the record of a register window that holds [addr, addr + len) */
+static struct snapshot_entry *find_window(uint32_t type, uint64_t addr,
+					  uint64_t len)
+{
+	unsigned int i;
+
+	for (i = 0; i < num_entries; i++) {
+		struct snapshot_record *rec = &entries[i].rec;
+
+		if (rec->type == type &&
+		    rec->addr <= addr && addr + len <= rec->addr + rec->len)
+			return &entries[i];
+	}
+	return NULL;
+}
+
+static struct snapshot_entry *find_entry(uint32_t type, uint64_t addr,
+					 uint32_t core)
+{
+	unsigned int i;
+
+	for (i = 0; i < num_entries; i++) {
+		struct snapshot_record *rec = &entries[i].rec;
+
+		if (rec->type == type && rec->addr == addr && rec->core == core)
+			return &entries[i];
+	}
+	return NULL;
+}
+
+static int add_snapshot_dev(struct pci_access *pacc, struct snapshot_entry *e)
+{
+	struct pci_dev *dev, **tail;
+
+	if (e->rec.len < 0x40) {
+		fprintf(stderr, "Short config space for %04" PRIx64 ":%02" PRIx64
+			":%02" PRIx64 ".%" PRIx64 " in the snapshot.\n",
+			e->rec.addr >> 16, (e->rec.addr >> 8) & 0xff,
+			(e->rec.addr >> 3) & 0x1f, e->rec.addr & 7);
+		return -1;
+	}
+
+	dev = calloc(1, sizeof(*dev));
+	if (dev == NULL) {
+		perror("calloc");
+		return -1;
+	}
+	dev->domain = e->rec.addr >> 16;
+	dev->bus = (e->rec.addr >> 8) & 0xff;
+	dev->dev = (e->rec.addr >> 3) & 0x1f;
+	dev->func = e->rec.addr & 7;
+	dev->access = pacc;
+	/* Config space reads are served from the cache and never reach
+	 * a libpci access method. */
+	pci_setup_cache(dev, e->data, e->rec.len);
+	dev->vendor_id = pci_read_word(dev, PCI_VENDOR_ID);
+	dev->device_id = pci_read_word(dev, PCI_DEVICE_ID);
+	dev->device_class = pci_read_word(dev, PCI_CLASS_DEVICE);
+	dev->known_fields = PCI_FILL_IDENT | PCI_FILL_CLASS;
+
+	for (tail = &snapshot_devs; *tail; tail = &(*tail)->next)
+		;
+	*tail = dev;
+	return 0;
+}
+
+int snapshot_load(const char *filename, struct pci_access *pacc)
+{
+	struct snapshot_record rec;
+	uint32_t header[2];
+	char magic[8];
+	size_t pos, size;
+	long len;
+	FILE *f;
+
+	f = fopen(filename, "rb");
+	if (f == NULL) {
+		perror(filename);
+		return -1;
+	}
+	if (fseek(f, 0, SEEK_END) || (len = ftell(f)) < 0 ||
+	    fseek(f, 0, SEEK_SET)) {
+		perror(filename);
+		fclose(f);
+		return -1;
+	}
+	size = len;
+	snapshot_buf = malloc(size ? size : 1);
+	if (snapshot_buf == NULL) {
+		perror("malloc");
+		fclose(f);
+		return -1;
+	}
+	if (size && fread(snapshot_buf, size, 1, f) != 1) {
+		perror(filename);
+		fclose(f);
+		goto err;
+	}
+	fclose(f);
+
+	if (size < sizeof(magic) + sizeof(header))
+		goto bad;
+	memcpy(magic, snapshot_buf, sizeof(magic));
+	memcpy(header, snapshot_buf + sizeof(magic), sizeof(header));
+	if (memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)))
+		goto bad;
+	if (header[0] != SNAPSHOT_VERSION) {
+		fprintf(stderr, "%s: snapshot version %u is not supported.\n",
+			filename, header[0]);
+		goto err;
+	}
+
+	for (pos = sizeof(magic) + sizeof(header); pos < size;
+	     pos += sizeof(rec) + ((rec.len + 7) & ~7)) {
+		struct snapshot_entry *e;
+
+		if (size - pos < sizeof(rec))
+			goto bad;
+		memcpy(&rec, snapshot_buf + pos, sizeof(rec));
+		if (size - pos - sizeof(rec) < rec.len)
+			goto bad;
+		e = realloc(entries, (num_entries + 1) * sizeof(*entries));
+		if (e == NULL) {
+			perror("realloc");
+			goto err;
+		}
+		entries = e;
+		e = &entries[num_entries++];
+		e->rec = rec;
+		e->data = snapshot_buf + pos + sizeof(rec);
+		if (rec.type == SNAPSHOT_PCI && add_snapshot_dev(pacc, e))
+			goto err;
+	}
+
+	snapshot_mode = SNAPSHOT_DECODE;
+	return 0;
+
+bad:
+	fprintf(stderr, "%s: not an inteltool snapshot, or truncated.\n",
+		filename);
+err:
+	snapshot_free();
+	return -1;
+}
+
+struct pci_dev *snapshot_devices(void)
+{
+	return snapshot_devs;
+}
+
+void snapshot_free(void)
+{
+	struct pci_dev *dev, *next;
+
+	for (dev = snapshot_devs; dev; dev = next) {
+		next = dev->next;
+		free(dev);
+	}
+	snapshot_devs = NULL;
+	free(entries);
+	entries = NULL;
+	num_entries = 0;
+	free(snapshot_buf);
+	snapshot_buf = NULL;
+	snapshot_mode = SNAPSHOT_LIVE;
+}
+
+unsigned int snapshot_cpuid(unsigned int op)
+{
+	struct snapshot_entry *e = find_entry(SNAPSHOT_CPUID, op, 0);
+	uint32_t eax = 0;
+
+	if (e && e->rec.len >= sizeof(eax))
+		memcpy(&eax, e->data, sizeof(eax));
+	return eax;
+}
+
+int snapshot_msr(int core, int addr, msr_t *msr)
+{
+	struct snapshot_entry *e = find_entry(SNAPSHOT_MSR, addr, core);
+	uint32_t val[2];
+
+	if (e == NULL || e->rec.len < sizeof(val))
+		return -1;
+	memcpy(val, e->data, sizeof(val));
+	msr->lo = val[0];
+	msr->hi = val[1];
+	return e->rec.flags & SNAPSHOT_F_READ_ERROR ? 1 : 0;
+}
+
+int snapshot_has_core(int core)
+{
+	unsigned int i;
+
+	for (i = 0; i < num_entries; i++)
+		if (entries[i].rec.type == SNAPSHOT_MSR &&
+		    entries[i].rec.core == (uint32_t)core)
+			return 1;
+	return 0;
+}
+
+/*
+ * Hardware access for the dump functions. When decoding, the registers
+ * come from the snapshot instead.
+ */
+struct pci_dev *get_pci_dev(struct pci_access *pacc, int domain, int bus,
+			    int dev, int func)
+{
+	struct pci_dev *d;
+
+	if (snapshot_mode == SNAPSHOT_DECODE) {
+		for (d = snapshot_devs; d; d = d->next)
+			if (d->domain == domain && d->bus == bus &&
+			    d->dev == dev && d->func == func)
+				return d;
+		return NULL;
+	}
+
+	d = pci_get_dev(pacc, domain, bus, dev, func);
+	if (d && snapshot_mode == SNAPSHOT_CAPTURE &&
+	    num_extra_devs < MAX_EXTRA_DEVS)
+		extra_devs[num_extra_devs++] = d;
+	return d;
+}
+
+/* A snapshot is read only, so the write is dropped when decoding. */
+void write_pci_long(struct pci_dev *dev, int pos, uint32_t val)
+{
+	if (snapshot_mode != SNAPSHOT_DECODE)
+		pci_write_long(dev, pos, val);
+}
+
+void *map_mmio(uint64_t phys_addr, size_t len)
+{
+	struct snapshot_entry *e;
+
+	if (snapshot_mode != SNAPSHOT_DECODE)
+		return map_physical(phys_addr, len);
+
+	e = find_window(SNAPSHOT_MEM, phys_addr, len);
+	if (e == NULL) {
+		printf("0x%08" PRIx64 "[0x%zx] is not in the snapshot\n",
+		       phys_addr, len);
+		errno = ENOENT;
+		return NULL;
+	}
+	return e->data + (phys_addr - e->rec.addr);
+}
+
+void unmap_mmio(void *virt_addr, size_t len)
+{
+	if (snapshot_mode != SNAPSHOT_DECODE)
+		unmap_physical(virt_addr, len);
+}
+
+/*
+ * Read the listed I/O registers into a copy of the I/O range at base, so
+ * that they can be printed from memory like a MMIO window.
+ */
+uint8_t *map_io(uint16_t base, const io_register_t *regs, int count)
+{
+	size_t size = io_size(regs, count);
+	struct snapshot_entry *e;
+	uint8_t *image;
+
+	if (snapshot_mode == SNAPSHOT_DECODE) {
+		e = find_window(SNAPSHOT_IO, base, size);
+		if (e == NULL) {
+			printf("I/O range 0x%04x[0x%zx] is not in the snapshot\n",
+			       base, size);
+			return NULL;
+		}
+		return e->data + (base - e->rec.addr);
+	}
+
+	image = calloc(1, size ? size : 1);
+	if (image == NULL) {
+		perror("calloc");
+		return NULL;
+	}
+	read_io(base, regs, count, image);
+	return image;
+}
+
+void unmap_io(uint8_t *image)
+{
+	if (snapshot_mode != SNAPSHOT_DECODE)
+		free(image);
+}
+
+uint32_t read_io_image(const uint8_t *image, uint16_t addr, int size)
+{
+	uint32_t val32;
+	uint16_t val16;
+
+	switch (size) {
+	case 4:
+		memcpy(&val32, image + addr, 4);
+		return val32;
+	case 2:
+		memcpy(&val16, image + addr, 2);
+		return val16;
+	case 1:
+		return image[addr];
+	}
+	return 0;
+}
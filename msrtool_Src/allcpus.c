@@ -0,0 +1,170 @@
+/*
+ * This file is part of msrtool.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#include <sched.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "msrtool.h"
+
+struct allcpus_pool {
+	struct msrsnapshot *snap;
+	pthread_mutex_t lock;
+	unsigned int next;
+};
+
+/* Run on the CPU whose MSRs are read, so the kernel does not need to send
+ * an interrupt to another CPU for every rdmsr. */
+void pin_to_cpu(uint8_t cpu) {
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+		printf_verbose("Could not pin a thread to cpu %d\n", cpu);
+#endif
+}
+
+static void *allcpus_worker(void *arg) {
+	struct allcpus_pool *pool = arg;
+	struct msrsnapshot *s = pool->snap;
+	unsigned int c, m;
+	uint8_t cpu;
+
+	while (1) {
+		pthread_mutex_lock(&pool->lock);
+		c = pool->next++;
+		pthread_mutex_unlock(&pool->lock);
+		if (c >= s->ncpus)
+			break;
+		cpu = s->cpus[c];
+		pin_to_cpu(cpu);
+		if (!sys->open(cpu, SYS_RDONLY))
+			continue;
+		for (m = 0; m < s->nmsrs; m++)
+			s->valid[m * s->ncpus + c] = sys->rdmsr(cpu, s->addrs[m], &s->vals[m * s->ncpus + c]);
+		sys->close(cpu);
+	}
+	return NULL;
+}
+
+static double now(void) {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/**
+ * Read the MSRs of all targets on every CPU and write them as one snapshot,
+ * followed by the MSRs whose value is not the same on all CPUs.
+ *
+ * @param fn Output file name, - for stdout.
+ * @return 0 on success, 1 on failure.
+ */
+int do_allcpus(const char *fn) {
+	struct msrsnapshot snap;
+	struct allcpus_pool pool;
+	pthread_t threads[MAX_CORES];
+	uint8_t cpus[MAX_CORES];
+	const struct msrdef *m;
+	unsigned int i, n, nthreads, nmsrs = 0;
+	size_t len = 0;
+	uint8_t tn;
+	long online;
+	double start;
+	FILE *fout;
+	int err, ret = 1;
+
+	if (NULL == sys->listcpus) {
+		fprintf(stderr, "System %s can not list its CPUs, use -c instead.\n", sys->name);
+		return 1;
+	}
+	n = sys->listcpus(cpus);
+	if (0 == n) {
+		fprintf(stderr, "No CPUs found!\n");
+		return 1;
+	}
+
+	for (tn = 0; tn < targets_found; tn++)
+		for (m = targets[tn]->msrs; !MSR_ISEOT(*m); m++)
+			nmsrs++;
+	if (!snapshot_alloc(&snap, n, nmsrs))
+		return 1;
+	memcpy(snap.cpus, cpus, n);
+	for (i = 0, tn = 0; tn < targets_found; tn++) {
+		len += strlen(targets[tn]->name) + 1;
+		for (m = targets[tn]->msrs; !MSR_ISEOT(*m); m++)
+			snap.addrs[i++] = m->addr;
+	}
+	snap.targetnames = malloc(len + 1);
+	if (NULL == snap.targetnames) {
+		perror("malloc");
+		goto done;
+	}
+	snap.targetnames[0] = 0;
+	for (tn = 0; tn < targets_found; tn++) {
+		if (tn)
+			strcat(snap.targetnames, " ");
+		strcat(snap.targetnames, targets[tn]->name);
+	}
+
+	/* the workers look up definitions to report errors */
+	indexmsrdefs();
+
+	online = sysconf(_SC_NPROCESSORS_ONLN);
+	nthreads = online > 0 && (unsigned long)online < n ? online : n;
+	pool.snap = &snap;
+	pool.next = 0;
+	pthread_mutex_init(&pool.lock, NULL);
+	start = now();
+	for (i = 0; i < nthreads; i++)
+		if ((err = pthread_create(&threads[i], NULL, allcpus_worker, &pool))) {
+			fprintf(stderr, "pthread_create: %s\n", strerror(err));
+			break;
+		}
+	nthreads = i;
+	if (0 == nthreads)
+		allcpus_worker(&pool);
+	for (i = 0; i < nthreads; i++)
+		pthread_join(threads[i], NULL);
+	pthread_mutex_destroy(&pool.lock);
+	printf_verbose("Read %d MSRs on %d CPUs with %d threads in %.3f s\n", nmsrs, n, nthreads, now() - start);
+
+	if (0 == strcmp(fn, "-"))
+		fout = stdout;
+	else if (NULL == (fout = fopen(fn, "w"))) {
+		perror("fopen()");
+		goto done;
+	}
+	snapshot_write(fout, &snap);
+	snapshot_diff(fout, &snap);
+	if (fout != stdout)
+		ret = fclose(fout) ? 1 : 0;
+	else
+		ret = fflush(fout) ? 1 : 0;
+done:
+	snapshot_free(&snap);
+	return ret;
+}
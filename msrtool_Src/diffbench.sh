@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+#
+# This file is part of msrtool.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License version 2 as
+# published by the Free Software Foundation.
+#
+# Time diff mode on two snapshots of the intel_nehalem MSRs, without
+# access to hardware. Every tenth value differs between the snapshots.
+#
+# usage: diffbench.sh [msrtool] [lines]
+
+MSRTOOL=${1:-./msrtool}
+LINES=${2:-100000}
+TMP=${TMPDIR:-/tmp}/msrtool-bench.$$
+trap 'rm -f $TMP.*' EXIT
+
+$MSRTOOL -q -t intel_nehalem -l | grep '^0x' > $TMP.addrs || exit 1
+for SEED in 1 2; do
+	awk -v n=$LINES -v seed=$SEED '{ a[NR] = $1 } END {
+		srand(1)
+		for (i = 0; i < n; i++) {
+			hi = int(rand() * 65536); lo = int(rand() * 65536)
+			if (seed == 2 && i % 10 == 0)
+				lo = (lo + 1) % 65536
+			printf "%s 0x%08x%04x%04x\n", a[i % NR + 1], i, hi, lo
+		}
+	}' $TMP.addrs > $TMP.$SEED
+done
+paste -d ' ' $TMP.1 $TMP.2 | awk '{ print $1, $2, $4 }' > $TMP.diff
+
+echo "diffing two snapshots of $LINES lines"
+time $MSRTOOL -q -t intel_nehalem -d $TMP.diff > $TMP.out
+echo "$(grep -c '^-0x' $TMP.out) MSRs differ"
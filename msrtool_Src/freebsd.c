@@ -27,7 +27,7 @@
 
 #include "msrtool.h"
 
-static int msr_fd[MAX_CORES] = {-1, -1, -1, -1, -1, -1, -1, -1};
+static int msr_fd[MAX_CORES] = { [0 ... MAX_CORES - 1] = -1 };
 
 int freebsd_probe(const struct sysdef *system)
 {
@@ -46,9 +46,6 @@ int freebsd_open(uint8_t cpu, enum SysModes mode)
 	int flags;
 	char devname[32];
 
-	if (cpu >= MAX_CORES)
-		return 0;
-
 	if (SYS_RDWR == mode)
 		flags = O_RDWR;
 	else if (SYS_WRONLY == mode)
@@ -70,9 +67,6 @@ int freebsd_open(uint8_t cpu, enum SysModes mode)
 
 int freebsd_close(uint8_t cpu)
 {
-	if (cpu >= MAX_CORES)
-		return 0;
-
 	if (msr_fd[cpu] != -1)
 		close(msr_fd[cpu]);
 	msr_fd[cpu] = -1;
@@ -84,9 +78,6 @@ int freebsd_rdmsr(uint8_t cpu, uint32_t addr, struct msr *val)
 #ifdef __FreeBSD__
 	cpuctl_msr_args_t args;
 
-	if (cpu >= MAX_CORES)
-		return 0;
-
 	if (msr_fd[cpu] < 0)
 		return 0;
 
@@ -21,12 +21,14 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <dirent.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 
 #include "msrtool.h"
 
-static int msr_fd[MAX_CORES] = {-1, -1, -1, -1, -1, -1, -1, -1};
+static int msr_fd[MAX_CORES] = { [0 ... MAX_CORES - 1] = -1 };
 
 int linux_probe(const struct sysdef *system) {
 	struct stat st;
@@ -48,10 +50,6 @@ int linux_open(uint8_t cpu, enum SysModes mode) {
 		fmode = O_RDONLY;
 		break;
 	}
-	if (cpu >= MAX_CORES) {
-		fprintf(stderr, "%s: only cores 0-%d are supported. requested=%d\n", __func__, MAX_CORES, cpu);
-		return 0;
-	}
 	if (snprintf(fn, sizeof(fn), "/dev/cpu/%d/msr", cpu) == -1) {
 		fprintf(stderr, "%s: snprintf: %s\n", __func__, strerror(errno));
 		return 0;
@@ -66,26 +64,53 @@ int linux_open(uint8_t cpu, enum SysModes mode) {
 
 int linux_close(uint8_t cpu) {
 	int ret;
-	if (cpu >= MAX_CORES) {
-		fprintf(stderr, "%s: only cores 0-%d are supported. requested=%d\n", __func__, MAX_CORES, cpu);
-		return 0;
-	}
 	ret = close(msr_fd[cpu]);
-	msr_fd[cpu] = 0;
+	msr_fd[cpu] = -1;
 	return 0 == ret;
 }
 
+/* pread() keeps no file position, so threads reading different CPUs never
+ * share any state here. */
 int linux_rdmsr(uint8_t cpu, uint32_t addr, struct msr *val) {
 	struct msr tmp;
-	if (lseek(msr_fd[cpu], addr, SEEK_SET) == -1) {
-		SYSERROR(lseek, addr);
-		return 0;
-	}
-	if (read(msr_fd[cpu], &tmp, 8) != 8) {
-		SYSERROR(read, addr);
+	if (pread(msr_fd[cpu], &tmp, 8, addr) != 8) {
+		SYSERROR(pread, addr);
 		return 0;
 	}
 	val->hi = tmp.lo;
 	val->lo = tmp.hi;
 	return 1;
 }
+
+static int cpu_cmp(const void *a, const void *b) {
+	return *(const uint8_t *)a - *(const uint8_t *)b;
+}
+
+int linux_listcpus(uint8_t *cpus) {
+	int n = 0;
+	char fn[32], *end;
+	unsigned long num;
+	struct dirent *de;
+	struct stat st;
+	DIR *dir = opendir("/dev/cpu");
+	if (NULL == dir) {
+		fprintf(stderr, "opendir(/dev/cpu): %s\n", strerror(errno));
+		return 0;
+	}
+	while (NULL != (de = readdir(dir))) {
+		num = strtoul(de->d_name, &end, 10);
+		if (end == de->d_name || *end)
+			continue;
+		if (num >= MAX_CORES) {
+			fprintf(stderr, "%s: only cores 0-%d are supported. ignoring=%lu\n", __func__, MAX_CORES - 1, num);
+			continue;
+		}
+		snprintf(fn, sizeof(fn), "/dev/cpu/%lu/msr", num);
+		if (stat(fn, &st))
+			continue;
+		cpus[n++] = num;
+	}
+	closedir(dir);
+	qsort(cpus, n, sizeof(*cpus), cpu_cmp);
+	return n;
+}
@@ -30,6 +30,7 @@
 #include "msrtool.h"
 
 #define DEFAULT_CPU 0
+#define DEFAULT_INTERVAL 100
 static uint8_t cpu = DEFAULT_CPU;
 
 uint8_t targets_found = 0;
@@ -57,15 +58,17 @@ static struct targetdef alltargets[] = {
 };
 
 static struct sysdef allsystems[] = {
-	{ "linux", "Linux with /dev/cpu/*/msr", linux_probe, linux_open, linux_close, linux_rdmsr },
-	{ "darwin", "Mac OS X with DirectHW", darwin_probe, darwin_open, darwin_close, darwin_rdmsr },
-	{ "freebsd", "FreeBSD with /dev/cpuctl*", freebsd_probe, freebsd_open, freebsd_close, freebsd_rdmsr },
+	{ "linux", "Linux with /dev/cpu/*/msr", linux_probe, linux_open, linux_close, linux_rdmsr, linux_listcpus },
+	{ "darwin", "Mac OS X with DirectHW", darwin_probe, darwin_open, darwin_close, darwin_rdmsr, NULL },
+	{ "freebsd", "FreeBSD with /dev/cpuctl*", freebsd_probe, freebsd_open, freebsd_close, freebsd_rdmsr, NULL },
+	{ "snapshot", "MSR values from a snapshot file, see -f", snapshot_probe, snapshot_open, snapshot_close, snapshot_rdmsr, snapshot_listcpus },
 	{ SYSTEM_EOT }
 };
 
 static void syntax(char *argv[]) {
-	printf("syntax: %s [-hvqrkl] [-c cpu] [-m system] [-t target ...]\n", argv[0]);
-	printf("\t [-i addr=hi[:]lo] | [-s file] | [-d [:]file] | addr...\n");
+	printf("syntax: %s [-hvqrkl] [-c cpu] [-m system] [-t target ...] [-f file]\n", argv[0]);
+	printf("\t [-i addr=hi[:]lo] | [-s file] | [-d [:]file] | [-a file] |\n");
+	printf("\t [-S file [-B] [-C cpus] [-I ms] [-n count] [addr...]] | addr...\n");
 	printf("  -h\t show this help text\n");
 	printf("  -v\t be verbose\n");
 	printf("  -q\t be quiet (overrides -v)\n");
@@ -75,6 +78,8 @@ static void syntax(char *argv[]) {
 	printf("  -c\t access MSRs on the specified CPU, default=%d\n", DEFAULT_CPU);
 	printf("  -m\t force a system, e.g: -m linux\n");
 	printf("  -t\t force a target, can be used multiple times, e.g: -t geodelx -t cs5536\n");
+	printf("  -f\t read MSR values from a snapshot file written by -a instead of hardware\n");
+	printf("\t the snapshot's targets are used unless -t is given\n");
 	printf("  -i\t immediate mode\n");
 	printf("\t decode hex addr=hi:lo for the target without reading hw value\n");
 	printf("\t e.g: -i 4c00000f=f2f100ff56960004\n");
@@ -86,6 +91,18 @@ static void syntax(char *argv[]) {
 	printf("\t read one address and value per line and compare with current hw value,\n");
 	printf("\t printing differences to stdout. use the filename - to read from stdin\n");
 	printf("\t use :file or :- to reverse diff, normally hw values are considered new\n");
+	printf("  -a\t all CPUs mode\n");
+	printf("\t read all MSRs of the target(s) on every CPU and write them to file with one\n");
+	printf("\t column per CPU, then decode the MSRs where some CPUs differ from the others\n");
+	printf("\t use the filename - for stdout\n");
+	printf("  -S\t sample mode\n");
+	printf("\t read the given MSR address(es), or APERF, MPERF, PERF_STATUS, THERM_STATUS and\n");
+	printf("\t the RAPL energy counters, at a fixed interval and log them to file as CSV with\n");
+	printf("\t derived MHz, watts and temperature. use the filename - for stdout\n");
+	printf("  -B\t write the sample log in binary instead of CSV\n");
+	printf("  -C\t sample the listed CPUs, e.g: -C 0-3,8, default is the -c CPU\n");
+	printf("  -I\t sample interval in milliseconds, default=%d\n", DEFAULT_INTERVAL);
+	printf("  -n\t number of samples, default=0 samples until interrupted\n");
 	printf("  addr.. direct mode, read and decode values for the given MSR address(es)\n");
 }
 
@@ -273,9 +290,13 @@ int main(int argc, char *argv[]) {
 	const struct targetdef *t;
 	uint8_t tn, listmsrs = 0, listknown = 0, input = 0;
 	uint32_t addr = 0;
-	const char *streamfn = NULL, *difffn = NULL;
+	const char *streamfn = NULL, *difffn = NULL, *allcpusfn = NULL, *snapfn = NULL, *samplefn = NULL;
+	struct sampleopts sampleopts = { .interval_us = DEFAULT_INTERVAL * 1000 };
+	uint32_t *sampleaddrs = NULL;
+	int i;
+	char *names, *name;
 	struct msr msrval = MSR2(-1, -1);
-	while ((c = getopt(argc, argv, "hqvrklc:m:t:a:i:s:d:")) != -1)
+	while ((c = getopt(argc, argv, "hqvrklc:m:t:a:f:i:s:d:S:BC:I:n:")) != -1)
 		switch (c) {
 		case 'h':
 			syntax(argv);
@@ -329,6 +350,31 @@ int main(int argc, char *argv[]) {
 		case 'd':
 			difffn = optarg;
 			break;
+		case 'a':
+			allcpusfn = optarg;
+			break;
+		case 'f':
+			snapfn = optarg;
+			break;
+		case 'S':
+			samplefn = optarg;
+			break;
+		case 'B':
+			sampleopts.binary = 1;
+			break;
+		case 'C':
+			sampleopts.cpulist = optarg;
+			break;
+		case 'I':
+			sampleopts.interval_us = strtod(optarg, NULL) * 1000;
+			if (0 == sampleopts.interval_us) {
+				fprintf(stderr, "invalid interval in -I argument!\n");
+				return 1;
+			}
+			break;
+		case 'n':
+			sampleopts.count = strtoul(optarg, NULL, 0);
+			break;
 		default:
 			break;
 		}
@@ -346,6 +392,14 @@ int main(int argc, char *argv[]) {
 	pci_init(pacc);
 	pci_scan_bus(pacc);
 
+	if (snapfn) {
+		if (!snapshot_load(snapfn))
+			return 1;
+		for (sys = allsystems; strcmp(sys->name, "snapshot"); sys++)
+			;
+		printf_quiet("Using snapshot %s\n", snapfn);
+	}
+
 	if (!sys && !input && !listknown)
 		for (sys = allsystems; !SYSTEM_ISEOT(*sys); sys++) {
 			printf_verbose("Probing for system %s: %s\n", sys->name, sys->prettyname);
@@ -358,7 +412,17 @@ int main(int argc, char *argv[]) {
 	if (targets)
 		for (tn = 0; tn < targets_found; tn++)
 			printf_quiet("Forced target %s: %s\n", targets[tn]->name, targets[tn]->prettyname);
-	else
+	else if (snapfn && snapshot_targets() && NULL != (names = strdup(snapshot_targets()))) {
+		/** a snapshot may come from another machine, so use its targets */
+		for (name = strtok(names, " "); name; name = strtok(NULL, " "))
+			for (t = alltargets; !TARGET_ISEOT(*t); t++)
+				if (!strcmp(t->name, name)) {
+					printf_quiet("Snapshot target %s: %s\n", t->name, t->prettyname);
+					add_target(t);
+					break;
+				}
+		free(names);
+	} else
 		for (t = alltargets; !TARGET_ISEOT(*t); t++) {
 			printf_verbose("Probing for target %s: %s\n", t->name, t->prettyname);
 			if (!t->probe(t, id))
@@ -418,6 +482,32 @@ int main(int argc, char *argv[]) {
 		goto done;
 	}
 
+	if (allcpusfn) {
+		if (!found_system())
+			return 1;
+		return do_allcpus(allcpusfn);
+	}
+
+	if (samplefn) {
+		if (!found_system())
+			return 1;
+		if (optind < argc) {
+			sampleaddrs = malloc((argc - optind) * sizeof(*sampleaddrs));
+			if (NULL == sampleaddrs) {
+				perror("malloc");
+				return 1;
+			}
+			for (i = optind; i < argc; i++)
+				sampleaddrs[i - optind] = msraddrbyname(argv[i]);
+			sampleopts.addrs = sampleaddrs;
+			sampleopts.naddrs = argc - optind;
+		}
+		sampleopts.cpu = cpu;
+		ret = do_sample(samplefn, &sampleopts);
+		free(sampleaddrs);
+		return ret;
+	}
+
 	if (optind == argc) {
 		syntax(argv);
 		printf("\nNo mode or address(es) specified!\n");
@@ -437,6 +527,7 @@ int main(int argc, char *argv[]) {
 	}
 	ret = 0;
 done:
-	sys->close(cpu);
+	if (sys && sys->name)
+		sys->close(cpu);
 	return ret;
 }
@@ -95,7 +95,7 @@ struct msrdef {
 #define NOBITS {{ BITVAL_EOT }}
 #define RESERVED "RSVD", "Reserved", PRESENT_HEXDEC, NOBITS
 
-#define MAX_CORES 8
+#define MAX_CORES 256
 
 typedef enum {
 	VENDOR_INTEL = 1,
@@ -135,6 +135,19 @@ struct sysdef {
 	int (*open)(uint8_t cpu, enum SysModes mode);
 	int (*close)(uint8_t cpu);
 	int (*rdmsr)(uint8_t cpu, uint32_t addr, struct msr *val);
+	/* fills cpus with up to MAX_CORES CPU numbers, returns how many */
+	int (*listcpus)(uint8_t *cpus);
+};
+
+/* MSR values read on several CPUs; vals and valid hold nmsrs rows of ncpus */
+struct msrsnapshot {
+	unsigned int ncpus;
+	uint8_t cpus[MAX_CORES];
+	unsigned int nmsrs;
+	uint32_t *addrs;
+	struct msr *vals;
+	uint8_t *valid;
+	char *targetnames;
 };
 
 #define SYSTEM_EOT .name = NULL
@@ -170,6 +183,7 @@ int msr_eq(const struct msr a, const struct msr b);
 struct msr msr_shl(const struct msr a, const uint8_t bits);
 struct msr msr_shr(const struct msr a, const uint8_t bits);
 void msr_and(struct msr *a, const struct msr b);
+int indexmsrdefs(void);
 const struct msrdef *findmsrdef(const uint32_t addr);
 uint32_t msraddrbyname(const char *name);
 void dumpmsrdefs(const struct targetdef *t);
@@ -178,6 +192,31 @@ uint8_t str2msr(char *str, struct msr *msr, char **endptr);
 void decodemsr(const uint8_t cpu, const uint32_t addr, const struct msr val);
 uint8_t diff_msr(FILE *fout, const uint32_t addr, const struct msr a, const struct msr b);
 
+/* snapshot.c */
+int snapshot_alloc(struct msrsnapshot *s, unsigned int ncpus, unsigned int nmsrs);
+void snapshot_free(struct msrsnapshot *s);
+int snapshot_read(FILE *f, const char *fn, struct msrsnapshot *s);
+void snapshot_write(FILE *f, const struct msrsnapshot *s);
+void snapshot_diff(FILE *f, const struct msrsnapshot *s);
+int snapshot_load(const char *fn);
+const char *snapshot_targets(void);
+
+/* allcpus.c */
+void pin_to_cpu(uint8_t cpu);
+int do_allcpus(const char *fn);
+
+/* sample.c */
+struct sampleopts {
+	uint8_t cpu;
+	const char *cpulist;	/* e.g. 0-3,8; NULL to sample cpu only */
+	const uint32_t *addrs;	/* NULL for the default power and thermal MSRs */
+	unsigned int naddrs;
+	uint32_t interval_us;
+	unsigned long count;	/* 0 to sample until interrupted */
+	uint8_t binary;
+};
+int do_sample(const char *fn, const struct sampleopts *opts);
+
 
 
 /** system externs **/
@@ -187,6 +226,7 @@ extern int linux_probe(const struct sysdef *system);
 extern int linux_open(uint8_t cpu, enum SysModes mode);
 extern int linux_close(uint8_t cpu);
 extern int linux_rdmsr(uint8_t cpu, uint32_t addr, struct msr *val);
+extern int linux_listcpus(uint8_t *cpus);
 
 /* darwin.c */
 extern int darwin_probe(const struct sysdef *system);
@@ -200,6 +240,13 @@ extern int freebsd_open(uint8_t cpu, enum SysModes mode);
 extern int freebsd_close(uint8_t cpu);
 extern int freebsd_rdmsr(uint8_t cpu, uint32_t addr, struct msr *val);
 
+/* snapshot.c */
+extern int snapshot_probe(const struct sysdef *system);
+extern int snapshot_open(uint8_t cpu, enum SysModes mode);
+extern int snapshot_close(uint8_t cpu);
+extern int snapshot_rdmsr(uint8_t cpu, uint32_t addr, struct msr *val);
+extern int snapshot_listcpus(uint8_t *cpus);
+
 /** target externs **/
 
 /* geodegx2.c */
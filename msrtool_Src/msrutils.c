@@ -19,7 +19,9 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
+#include <ctype.h>
 
 #include "msrtool.h"
 
@@ -147,11 +149,131 @@ void msr_and(struct msr *a, const struct msr b) {
 	a->lo &= b.lo;
 }
 
+/*
+ * Lookup tables over the MSR definitions of all targets: the definitions
+ * sorted by address, and a hash table on the symbol. Each entry keeps its
+ * position in target order, so that the first definition wins like when
+ * the targets are searched one after the other.
+ */
+struct msrindex {
+	const struct msrdef *m;
+	uint32_t pos;
+};
+
+static struct msrindex *byaddr = NULL, *byname = NULL;
+static uint32_t nbyaddr = 0, namemask = 0;
+static const struct targetdef **indexed = NULL;
+static uint8_t nindexed = 0;
+
+static uint32_t symbolhash(const char *name) {
+	uint32_t h = 2166136261u;
+	while (*name)
+		h = (h ^ (uint8_t)tolower(*name++)) * 16777619u;
+	return h;
+}
+
+static int addr_cmp(const void *a, const void *b) {
+	const struct msrindex *x = a, *y = b;
+	if (x->m->addr != y->m->addr)
+		return x->m->addr < y->m->addr ? -1 : 1;
+	return x->pos < y->pos ? -1 : x->pos > y->pos;
+}
+
+static void freeindex(void) {
+	free(byaddr);
+	free(byname);
+	byaddr = byname = NULL;
+	nbyaddr = namemask = 0;
+	indexed = NULL;
+	nindexed = 0;
+}
+
+/**
+ * Build the lookup tables for the current targets, unless they are up to
+ * date. The lookup functions do this themselves; call it before starting
+ * threads so that they only ever read the tables.
+ *
+ * @return 1 when the tables can be used, 0 when they could not be built.
+ */
+int indexmsrdefs(void) {
+	uint8_t t;
+	uint32_t n = 0, i, j, size;
+	const struct msrdef *m;
+
+	if (byaddr && indexed == targets && nindexed == targets_found)
+		return 1;
+	freeindex();
+	if (!targets)
+		return 0;
+
+	for (t = 0; t < targets_found; t++)
+		for (m = targets[t]->msrs; !MSR_ISEOT(*m); m++)
+			n++;
+	for (size = 16; size < 2 * n; size *= 2)
+		;
+	byaddr = malloc((n ? n : 1) * sizeof(*byaddr));
+	byname = calloc(size, sizeof(*byname));
+	if (NULL == byaddr || NULL == byname) {
+		perror("malloc");
+		freeindex();
+		return 0;
+	}
+	namemask = size - 1;
+
+	for (n = 0, t = 0; t < targets_found; t++)
+		for (m = targets[t]->msrs; !MSR_ISEOT(*m); m++, n++) {
+			byaddr[n].m = m;
+			byaddr[n].pos = n;
+			for (j = symbolhash(m->symbol) & namemask; byname[j].m; j = (j + 1) & namemask)
+				if (!strcasecmp(byname[j].m->symbol, m->symbol))
+					break;
+			if (!byname[j].m) {
+				byname[j].m = m;
+				byname[j].pos = n;
+			}
+		}
+
+	qsort(byaddr, n, sizeof(*byaddr), addr_cmp);
+	for (i = 0, j = 0; i < n; i++)
+		if (0 == j || byaddr[j - 1].m->addr != byaddr[i].m->addr)
+			byaddr[j++] = byaddr[i];
+	nbyaddr = j;
+
+	indexed = targets;
+	nindexed = targets_found;
+	return 1;
+}
+
+static const struct msrindex *findbyaddr(const uint32_t addr) {
+	uint32_t lo = 0, hi = nbyaddr, mid;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (byaddr[mid].m->addr < addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo < nbyaddr && byaddr[lo].m->addr == addr ? &byaddr[lo] : NULL;
+}
+
+static const struct msrindex *findbyname(const char *name) {
+	uint32_t j;
+	for (j = symbolhash(name) & namemask; byname[j].m; j = (j + 1) & namemask)
+		if (!strcasecmp(byname[j].m->symbol, name))
+			return &byname[j];
+	return NULL;
+}
+
 const struct msrdef *findmsrdef(const uint32_t addr) {
 	uint8_t t;
 	const struct msrdef *m;
+	const struct msrindex *e;
 	if (!targets)
 		return NULL;
+	if (indexmsrdefs()) {
+		e = findbyaddr(addr);
+		return e ? e->m : NULL;
+	}
 	for (t = 0; t < targets_found; t++)
 		for (m = targets[t]->msrs; !MSR_ISEOT(*m); m++)
 			if (addr == m->addr)
@@ -163,8 +285,14 @@ uint32_t msraddrbyname(const char *name) {
 	uint8_t t;
 	const uint32_t addr = strtoul(name, NULL, 16);
 	const struct msrdef *m;
+	const struct msrindex *a, *n;
 	if (!targets)
 		return addr;
+	if (indexmsrdefs()) {
+		a = findbyaddr(addr);
+		n = findbyname(name);
+		return n && (!a || n->pos < a->pos) ? n->m->addr : addr;
+	}
 	for (t = 0; t < targets_found; t++)
 		for (m = targets[t]->msrs; !MSR_ISEOT(*m); m++) {
 			if (addr == m->addr)
@@ -0,0 +1,496 @@
+/*
+ * This file is part of msrtool.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "msrtool.h"
+
+/*
+ * Sample mode: one thread per CPU, pinned to it, reads the MSRs at a fixed
+ * interval and puts the raw values into its own ring buffer. A writer
+ * thread drains the rings, works out the rates from consecutive samples
+ * and writes the log, so that formatting and disk writes never delay a
+ * sample. Each ring has a single producer and a single consumer and needs
+ * no lock.
+ */
+
+#define MSR_IA32_MPERF			0x000000e7
+#define MSR_IA32_APERF			0x000000e8
+#define MSR_PLATFORM_INFO		0x000000ce
+#define MSR_IA32_PERF_STATUS		0x00000198
+#define MSR_IA32_THERM_STATUS		0x0000019c
+#define MSR_TEMPERATURE_TARGET		0x000001a2
+#define MSR_RAPL_POWER_UNIT		0x00000606
+#define MSR_PKG_ENERGY_STATUS		0x00000611
+#define MSR_PP0_ENERGY_STATUS		0x00000639
+
+#define SAMPLE_MAX_MSRS 32
+#define SAMPLE_RING 1024	/* records per CPU, must be a power of two */
+
+static const uint32_t default_msrs[] = {
+	MSR_IA32_MPERF,
+	MSR_IA32_APERF,
+	MSR_IA32_PERF_STATUS,
+	MSR_IA32_THERM_STATUS,
+	MSR_PKG_ENERGY_STATUS,
+	MSR_PP0_ENERGY_STATUS,
+};
+
+struct sampleset;
+
+struct sample {
+	uint64_t ns;
+	uint32_t valid;		/* bit i is set when vals[i] was read */
+	uint64_t vals[SAMPLE_MAX_MSRS];
+};
+
+struct sampler {
+	struct sampleset *set;
+	uint8_t cpu;
+	pthread_t thread;
+	atomic_uint head, tail;
+	atomic_int done;
+	uint32_t invalid;	/* bit i is set once addrs[i] failed to read */
+	unsigned long dropped;
+	struct sample prev;	/* writer only */
+	uint8_t have_prev;
+	struct sample ring[SAMPLE_RING];
+};
+
+/* Constants for the derived values, 0 when unknown */
+struct sampleunits {
+	uint32_t base_mhz;
+	uint32_t energy_shift;
+	uint32_t tjmax;
+};
+
+struct sampleset {
+	const struct sampleopts *opts;
+	const uint32_t *addrs;
+	unsigned int naddrs;
+	struct sampler *samplers;
+	unsigned int nsamplers;
+	struct sampleunits units;
+	int mperf, aperf, therm, pkg, pp0;
+	uint64_t start_ns;
+	FILE *fout;
+	int err;
+};
+
+static volatile sig_atomic_t stop_sampling = 0;
+
+static void sample_stop(int sig) {
+	stop_sampling = 1;
+}
+
+static uint64_t now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void sleep_until(uint64_t ns) {
+	struct timespec ts;
+#if defined(__linux__)
+	ts.tv_sec = ns / 1000000000;
+	ts.tv_nsec = ns % 1000000000;
+	while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) && !stop_sampling)
+		;
+#else
+	uint64_t t = now_ns();
+	if (ns <= t)
+		return;
+	ts.tv_sec = (ns - t) / 1000000000;
+	ts.tv_nsec = (ns - t) % 1000000000;
+	nanosleep(&ts, NULL);
+#endif
+}
+
+static void *sampler_thread(void *arg) {
+	struct sampler *s = arg;
+	struct sampleset *set = s->set;
+	struct sample *rec;
+	struct msr val;
+	unsigned int i, head, n;
+	uint64_t next;
+
+	pin_to_cpu(s->cpu);
+
+	next = set->start_ns;
+	for (n = 0; !stop_sampling && (!set->opts->count || n < set->opts->count); n++) {
+		sleep_until(next);
+		next += (uint64_t)set->opts->interval_us * 1000;
+		head = atomic_load_explicit(&s->head, memory_order_relaxed);
+		if (head - atomic_load_explicit(&s->tail, memory_order_acquire) == SAMPLE_RING) {
+			s->dropped++;
+			continue;
+		}
+		rec = &s->ring[head & (SAMPLE_RING - 1)];
+		rec->ns = now_ns() - set->start_ns;
+		rec->valid = 0;
+		for (i = 0; i < set->naddrs; i++) {
+			if (s->invalid & (1U << i))
+				continue;
+			if (!sys->rdmsr(s->cpu, set->addrs[i], &val)) {
+				/* Not going to appear later, leave the column empty */
+				fprintf(stderr, "cpu %d: MSR 0x%08x can not be read, no longer sampling it\n", s->cpu, set->addrs[i]);
+				s->invalid |= 1U << i;
+				continue;
+			}
+			rec->vals[i] = (uint64_t)val.hi << 32 | val.lo;
+			rec->valid |= 1U << i;
+		}
+		atomic_store_explicit(&s->head, head + 1, memory_order_release);
+	}
+	atomic_store_explicit(&s->done, 1, memory_order_release);
+	return NULL;
+}
+
+/* Not every target defines the MSRs sampled by default */
+static const char *sample_symbol(uint32_t addr) {
+	const struct msrdef *m = findmsrdef(addr);
+	if (m)
+		return m->symbol;
+	switch (addr) {
+	case MSR_IA32_MPERF:
+		return "IA32_MPERF";
+	case MSR_IA32_APERF:
+		return "IA32_APERF";
+	case MSR_IA32_PERF_STATUS:
+		return "IA32_PERF_STATUS";
+	case MSR_IA32_THERM_STATUS:
+		return "IA32_THERM_STATUS";
+	case MSR_PKG_ENERGY_STATUS:
+		return "MSR_PKG_ENERGY_STATUS";
+	case MSR_PP0_ENERGY_STATUS:
+		return "MSR_PP0_ENERGY_STATUS";
+	}
+	return NULL;
+}
+
+static int has(const struct sample *rec, int i) {
+	return i >= 0 && (rec->valid & (1U << i));
+}
+
+static void write_header(struct sampleset *set) {
+	const char *symbol;
+	unsigned int i;
+	uint32_t n;
+
+	if (set->opts->binary) {
+		n = set->naddrs;
+		fwrite("MSRSAMP1", 8, 1, set->fout);
+		fwrite(&n, sizeof(n), 1, set->fout);
+		fwrite(&set->opts->interval_us, sizeof(set->opts->interval_us), 1, set->fout);
+		fwrite(&set->units, sizeof(set->units), 1, set->fout);
+		fwrite(set->addrs, sizeof(*set->addrs), n, set->fout);
+		return;
+	}
+	fprintf(set->fout, "time,cpu");
+	for (i = 0; i < set->naddrs; i++) {
+		symbol = sample_symbol(set->addrs[i]);
+		if (symbol)
+			fprintf(set->fout, ",%s", symbol);
+		else
+			fprintf(set->fout, ",0x%08x", set->addrs[i]);
+	}
+	if (set->aperf >= 0 && set->mperf >= 0)
+		fprintf(set->fout, ",avg_mhz,bzy_mhz");
+	if (set->pkg >= 0)
+		fprintf(set->fout, ",pkg_watts");
+	if (set->pp0 >= 0)
+		fprintf(set->fout, ",pp0_watts");
+	if (set->therm >= 0)
+		fprintf(set->fout, ",temp_c");
+	fprintf(set->fout, "\n");
+}
+
+/* Print the change in watts of a 32-bit energy counter, which wraps */
+static void write_watts(struct sampleset *set, const struct sample *rec, const struct sample *prev, int i, double dt) {
+	uint32_t delta;
+	if (!has(rec, i) || !prev || !has(prev, i) || !set->units.energy_shift) {
+		fprintf(set->fout, ",");
+		return;
+	}
+	delta = (uint32_t)rec->vals[i] - (uint32_t)prev->vals[i];
+	fprintf(set->fout, ",%.3f", delta / (double)(1ULL << set->units.energy_shift) / dt);
+}
+
+static void write_record(struct sampleset *set, struct sampler *s, const struct sample *rec) {
+	const struct sample *prev = s->have_prev ? &s->prev : NULL;
+	uint32_t cpu = s->cpu;
+	uint64_t da, dm;
+	unsigned int i;
+	double dt = 0;
+
+	if (set->opts->binary) {
+		fwrite(&rec->ns, sizeof(rec->ns), 1, set->fout);
+		fwrite(&cpu, sizeof(cpu), 1, set->fout);
+		fwrite(&rec->valid, sizeof(rec->valid), 1, set->fout);
+		fwrite(rec->vals, sizeof(*rec->vals), set->naddrs, set->fout);
+		return;
+	}
+
+	fprintf(set->fout, "%.6f,%d", rec->ns / 1e9, cpu);
+	for (i = 0; i < set->naddrs; i++)
+		if (has(rec, i))
+			fprintf(set->fout, ",%llu", (unsigned long long)rec->vals[i]);
+		else
+			fprintf(set->fout, ",");
+	if (prev && rec->ns > prev->ns)
+		dt = (rec->ns - prev->ns) / 1e9;
+	else
+		prev = NULL;
+	if (set->aperf >= 0 && set->mperf >= 0) {
+		if (prev && has(rec, set->aperf) && has(prev, set->aperf) && has(rec, set->mperf) && has(prev, set->mperf)) {
+			/* unsigned subtraction copes with the counters wrapping */
+			da = rec->vals[set->aperf] - prev->vals[set->aperf];
+			dm = rec->vals[set->mperf] - prev->vals[set->mperf];
+			fprintf(set->fout, ",%.0f", da / dt / 1e6);
+			if (dm && set->units.base_mhz)
+				fprintf(set->fout, ",%.0f", (double)set->units.base_mhz * da / dm);
+			else
+				fprintf(set->fout, ",");
+		} else
+			fprintf(set->fout, ",,");
+	}
+	if (set->pkg >= 0)
+		write_watts(set, rec, prev, set->pkg, dt);
+	if (set->pp0 >= 0)
+		write_watts(set, rec, prev, set->pp0, dt);
+	if (set->therm >= 0) {
+		/* bit 31 flags a valid reading, in degrees below TjMax */
+		if (has(rec, set->therm) && set->units.tjmax && (rec->vals[set->therm] & (1U << 31)))
+			fprintf(set->fout, ",%d", set->units.tjmax - (int)((rec->vals[set->therm] >> 16) & 0x7f));
+		else
+			fprintf(set->fout, ",");
+	}
+	fprintf(set->fout, "\n");
+}
+
+static void *writer_thread(void *arg) {
+	struct sampleset *set = arg;
+	struct sampler *s;
+	struct timespec pause;
+	unsigned int i, head, tail, drained, done;
+
+	write_header(set);
+	pause.tv_sec = set->opts->interval_us / 2000000;
+	pause.tv_nsec = set->opts->interval_us / 2 % 1000000 * 1000;
+	do {
+		drained = 0;
+		done = 1;
+		for (i = 0; i < set->nsamplers; i++) {
+			s = &set->samplers[i];
+			if (!atomic_load_explicit(&s->done, memory_order_acquire))
+				done = 0;
+			head = atomic_load_explicit(&s->head, memory_order_acquire);
+			tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+			for (; tail != head; tail++, drained++) {
+				write_record(set, s, &s->ring[tail & (SAMPLE_RING - 1)]);
+				s->prev = s->ring[tail & (SAMPLE_RING - 1)];
+				s->have_prev = 1;
+				atomic_store_explicit(&s->tail, tail + 1, memory_order_release);
+			}
+		}
+		if (drained)
+			fflush(set->fout);
+		else if (!done)
+			nanosleep(&pause, NULL);
+	} while (!done || drained);
+
+	if (ferror(set->fout))
+		set->err = 1;
+	return NULL;
+}
+
+/* Parse a list of CPUs such as 0-3,8 into cpus, return how many */
+static int parse_cpulist(const char *list, uint8_t *cpus) {
+	unsigned long first, last, c;
+	const char *p = list;
+	char *end;
+	int n = 0;
+
+	while (*p) {
+		first = last = strtoul(p, &end, 10);
+		if (end == p)
+			break;
+		if ('-' == *end) {
+			p = end + 1;
+			last = strtoul(p, &end, 10);
+			if (end == p)
+				break;
+		}
+		if (last < first || last >= MAX_CORES)
+			break;
+		for (c = first; c <= last && n < MAX_CORES; c++)
+			cpus[n++] = c;
+		p = end;
+		if (',' == *p)
+			p++;
+		else if (*p)
+			break;
+	}
+	if (*p || 0 == n) {
+		fprintf(stderr, "invalid CPU list '%s'\n", list);
+		return 0;
+	}
+	return n;
+}
+
+static int find_addr(const uint32_t *addrs, unsigned int n, uint32_t addr) {
+	unsigned int i;
+	for (i = 0; i < n; i++)
+		if (addrs[i] == addr)
+			return i;
+	return -1;
+}
+
+/* Read the constants that the derived values need, once, on the first CPU */
+static void read_units(struct sampleset *set) {
+	uint8_t cpu = set->samplers[0].cpu;
+	struct msr val;
+
+	memset(&set->units, 0, sizeof(set->units));
+	if (!sys->open(cpu, SYS_RDONLY))
+		return;
+	if ((set->aperf >= 0 || set->mperf >= 0) && sys->rdmsr(cpu, MSR_PLATFORM_INFO, &val))
+		set->units.base_mhz = ((val.lo >> 8) & 0xff) * 100;
+	if ((set->pkg >= 0 || set->pp0 >= 0) && sys->rdmsr(cpu, MSR_RAPL_POWER_UNIT, &val))
+		set->units.energy_shift = (val.lo >> 8) & 0x1f;
+	if (set->therm >= 0 && sys->rdmsr(cpu, MSR_TEMPERATURE_TARGET, &val))
+		set->units.tjmax = (val.lo >> 16) & 0xff;
+	sys->close(cpu);
+}
+
+/**
+ * Sample MSRs on a set of CPUs at a fixed interval and log them.
+ *
+ * @param fn Log file name, - for stdout.
+ * @param opts Sampling options.
+ * @return 0 on success, 1 on failure.
+ */
+int do_sample(const char *fn, const struct sampleopts *opts) {
+	struct sampleset set;
+	uint8_t cpus[MAX_CORES];
+	pthread_t writer;
+	struct sigaction sa;
+	unsigned int i, opened = 0, started = 0;
+	int n, err, ret = 1;
+
+	memset(&set, 0, sizeof(set));
+	set.opts = opts;
+	if (opts->naddrs) {
+		set.addrs = opts->addrs;
+		set.naddrs = opts->naddrs;
+	} else {
+		set.addrs = default_msrs;
+		set.naddrs = sizeof(default_msrs) / sizeof(*default_msrs);
+	}
+	if (set.naddrs > SAMPLE_MAX_MSRS) {
+		fprintf(stderr, "At most %d MSRs can be sampled.\n", SAMPLE_MAX_MSRS);
+		return 1;
+	}
+	set.mperf = find_addr(set.addrs, set.naddrs, MSR_IA32_MPERF);
+	set.aperf = find_addr(set.addrs, set.naddrs, MSR_IA32_APERF);
+	set.therm = find_addr(set.addrs, set.naddrs, MSR_IA32_THERM_STATUS);
+	set.pkg = find_addr(set.addrs, set.naddrs, MSR_PKG_ENERGY_STATUS);
+	set.pp0 = find_addr(set.addrs, set.naddrs, MSR_PP0_ENERGY_STATUS);
+
+	if (opts->cpulist) {
+		n = parse_cpulist(opts->cpulist, cpus);
+		if (0 == n)
+			return 1;
+	} else {
+		cpus[0] = opts->cpu;
+		n = 1;
+	}
+
+	set.samplers = calloc(n, sizeof(*set.samplers));
+	if (NULL == set.samplers) {
+		perror("calloc");
+		return 1;
+	}
+	set.nsamplers = n;
+	for (i = 0; i < set.nsamplers; i++) {
+		set.samplers[i].set = &set;
+		set.samplers[i].cpu = cpus[i];
+	}
+
+	read_units(&set);
+	/* open every CPU before starting, so that samples only pread() */
+	for (opened = 0; opened < set.nsamplers; opened++)
+		if (!sys->open(set.samplers[opened].cpu, SYS_RDONLY))
+			goto done;
+
+	if (0 == strcmp(fn, "-"))
+		set.fout = stdout;
+	else if (NULL == (set.fout = fopen(fn, set.opts->binary ? "wb" : "w"))) {
+		perror("fopen()");
+		goto done;
+	}
+
+	indexmsrdefs();
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = sample_stop;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	/* the first sample is taken one interval from now */
+	set.start_ns = now_ns() + (uint64_t)opts->interval_us * 1000;
+	for (started = 0; started < set.nsamplers; started++) {
+		err = pthread_create(&set.samplers[started].thread, NULL, sampler_thread, &set.samplers[started]);
+		if (err) {
+			fprintf(stderr, "pthread_create: %s\n", strerror(err));
+			stop_sampling = 1;
+			break;
+		}
+	}
+	/* samplers that never started are done */
+	for (i = started; i < set.nsamplers; i++)
+		atomic_store(&set.samplers[i].done, 1);
+	err = pthread_create(&writer, NULL, writer_thread, &set);
+	if (err) {
+		fprintf(stderr, "pthread_create: %s\n", strerror(err));
+		stop_sampling = 1;
+	}
+	for (i = 0; i < started; i++)
+		pthread_join(set.samplers[i].thread, NULL);
+	if (!err) {
+		pthread_join(writer, NULL);
+		ret = set.err || started < set.nsamplers;
+	}
+
+	for (i = 0; i < set.nsamplers; i++)
+		if (set.samplers[i].dropped)
+			fprintf(stderr, "cpu %d: %lu samples dropped, the log could not keep up\n",
+				set.samplers[i].cpu, set.samplers[i].dropped);
+	if (set.fout != stdout && fclose(set.fout))
+		ret = 1;
+done:
+	while (opened)
+		sys->close(set.samplers[--opened].cpu);
+	free(set.samplers);
+	return ret;
+}
@@ -0,0 +1,384 @@
+/*
+ * This file is part of msrtool.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "msrtool.h"
+
+/*
+ * A snapshot file has a "cpus" line naming the CPU of each value column and
+ * one line per MSR with the address followed by one value per CPU, or - if
+ * the MSR could not be read on that CPU. An optional "targets" line names
+ * the targets the snapshot was taken for. Lines starting with # are
+ * comments, so the decoded differences written after the values are
+ * ignored when a snapshot is read back.
+ */
+
+int snapshot_alloc(struct msrsnapshot *s, unsigned int ncpus, unsigned int nmsrs) {
+	/* calloc(0) may return NULL, so always allocate at least one row */
+	unsigned int rows = nmsrs ? nmsrs : 1;
+	s->ncpus = ncpus;
+	s->nmsrs = nmsrs;
+	s->addrs = calloc(rows, sizeof(*s->addrs));
+	s->vals = calloc(rows * ncpus, sizeof(*s->vals));
+	s->valid = calloc(rows * ncpus, sizeof(*s->valid));
+	s->targetnames = NULL;
+	if (NULL == s->addrs || NULL == s->vals || NULL == s->valid) {
+		perror("calloc");
+		snapshot_free(s);
+		return 0;
+	}
+	return 1;
+}
+
+void snapshot_free(struct msrsnapshot *s) {
+	free(s->addrs);
+	free(s->vals);
+	free(s->valid);
+	free(s->targetnames);
+	s->addrs = NULL;
+	s->vals = NULL;
+	s->valid = NULL;
+	s->targetnames = NULL;
+	s->nmsrs = s->ncpus = 0;
+}
+
+static int snapshot_grow(struct msrsnapshot *s, unsigned int nmsrs) {
+	void *addrs, *vals, *valid;
+	addrs = realloc(s->addrs, nmsrs * sizeof(*s->addrs));
+	if (addrs)
+		s->addrs = addrs;
+	vals = realloc(s->vals, nmsrs * s->ncpus * sizeof(*s->vals));
+	if (vals)
+		s->vals = vals;
+	valid = realloc(s->valid, nmsrs * s->ncpus * sizeof(*s->valid));
+	if (valid)
+		s->valid = valid;
+	if (!addrs || !vals || !valid) {
+		perror("realloc");
+		return 0;
+	}
+	return 1;
+}
+
+static int snapshot_parse_cpus(char *line, const char *fn, uint32_t linenum, struct msrsnapshot *s) {
+	char *tok, *end;
+	unsigned long num;
+	for (tok = strtok(line, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n")) {
+		num = strtoul(tok, &end, 10);
+		if (end == tok || *end || num >= MAX_CORES || s->ncpus == MAX_CORES) {
+			fprintf(stderr, "%s:%d: invalid CPU '%s'\n", fn, linenum, tok);
+			return 0;
+		}
+		s->cpus[s->ncpus++] = num;
+	}
+	if (0 == s->ncpus) {
+		fprintf(stderr, "%s:%d: no CPUs listed\n", fn, linenum);
+		return 0;
+	}
+	return 1;
+}
+
+static int snapshot_parse_row(char *line, const char *fn, uint32_t linenum, struct msrsnapshot *s) {
+	unsigned int c, row = s->nmsrs;
+	char *tok, *end;
+	tok = strtok(line, " \t\r\n");
+	s->addrs[row] = strtoul(tok, &end, 16);
+	for (c = 0; c < s->ncpus; c++) {
+		tok = strtok(NULL, " \t\r\n");
+		if (NULL == tok) {
+			fprintf(stderr, "%s:%d: expected %d values\n", fn, linenum, s->ncpus);
+			return 0;
+		}
+		s->valid[row * s->ncpus + c] = strcmp(tok, "-") != 0;
+		if (s->valid[row * s->ncpus + c] && !str2msr(tok, &s->vals[row * s->ncpus + c], NULL)) {
+			fprintf(stderr, "%s:%d: invalid MSR value '%s'\n", fn, linenum, tok);
+			return 0;
+		}
+	}
+	s->nmsrs++;
+	return 1;
+}
+
+int snapshot_read(FILE *f, const char *fn, struct msrsnapshot *s) {
+	char *line = NULL;
+	size_t linesize = 0;
+	unsigned int size = 0;
+	uint32_t linenum;
+	int ret = 0;
+
+	memset(s, 0, sizeof(*s));
+	for (linenum = 1; getline(&line, &linesize, f) != -1; ++linenum) {
+		if (0 == strncmp(line, "targets ", 8)) {
+			free(s->targetnames);
+			s->targetnames = strdup(line + 8);
+			if (NULL == s->targetnames) {
+				perror("strdup");
+				goto done;
+			}
+			s->targetnames[strcspn(s->targetnames, "\r\n")] = 0;
+		} else if (0 == strncmp(line, "cpus ", 5)) {
+			if (s->ncpus) {
+				fprintf(stderr, "%s:%d: more than one cpus line\n", fn, linenum);
+				goto done;
+			}
+			if (!snapshot_parse_cpus(line + 5, fn, linenum, s))
+				goto done;
+		} else if (0 == strncmp(line, "0x", 2)) {
+			if (0 == s->ncpus) {
+				fprintf(stderr, "%s:%d: values before the cpus line\n", fn, linenum);
+				goto done;
+			}
+			if (s->nmsrs == size) {
+				size = size ? size * 2 : 256;
+				if (!snapshot_grow(s, size))
+					goto done;
+			}
+			if (!snapshot_parse_row(line, fn, linenum, s))
+				goto done;
+		}
+	}
+	if (!feof(f)) {
+		fprintf(stderr, "%s:%d: getline: %s\n", fn, linenum, strerror(errno));
+		goto done;
+	}
+	if (0 == s->ncpus) {
+		fprintf(stderr, "%s: no cpus line, not a snapshot\n", fn);
+		goto done;
+	}
+	ret = 1;
+done:
+	free(line);
+	if (!ret)
+		snapshot_free(s);
+	return ret;
+}
+
+void snapshot_write(FILE *f, const struct msrsnapshot *s) {
+	unsigned int m, c;
+	const struct msrdef *def;
+	const struct msr *val;
+
+	if (s->targetnames)
+		fprintf(f, "targets %s\n", s->targetnames);
+	fprintf(f, "cpus");
+	for (c = 0; c < s->ncpus; c++)
+		fprintf(f, " %d", s->cpus[c]);
+	fprintf(f, "\n");
+	for (m = 0; m < s->nmsrs; m++) {
+		def = findmsrdef(s->addrs[m]);
+		if (def)
+			fprintf(f, "# %s\n", def->symbol);
+		fprintf(f, "0x%08x", s->addrs[m]);
+		for (c = 0; c < s->ncpus; c++) {
+			val = &s->vals[m * s->ncpus + c];
+			if (s->valid[m * s->ncpus + c])
+				fprintf(f, " 0x%08x%08x", val->hi, val->lo);
+			else
+				fprintf(f, " -");
+		}
+		fprintf(f, "\n");
+	}
+}
+
+/* Print the CPUs in column order whose value matches that of column first */
+static void print_cpulist(FILE *f, const struct msrsnapshot *s, unsigned int row, unsigned int first) {
+	const struct msr *vals = &s->vals[row * s->ncpus];
+	const uint8_t *valid = &s->valid[row * s->ncpus];
+	unsigned int c, start = 0, last = 0, n = 0;
+
+	for (c = first; c < s->ncpus; c++) {
+		if (valid[c] != valid[first] || (valid[c] && !msr_eq(vals[c], vals[first])))
+			continue;
+		if (n && s->cpus[c] == last + 1) {
+			last = s->cpus[c];
+			continue;
+		}
+		if (n)
+			fprintf(f, start == last ? "%d," : "%d-%d,", start, last);
+		start = last = s->cpus[c];
+		n++;
+	}
+	fprintf(f, start == last ? "%d" : "%d-%d", start, last);
+}
+
+/**
+ * Print each MSR whose value is not the same on all CPUs. The CPUs are
+ * grouped by value, and the groups that differ from the most common value
+ * are decoded against it like in diff mode.
+ */
+void snapshot_diff(FILE *f, const struct msrsnapshot *s) {
+	unsigned int m, c, g, ngroups, major, ndiff = 0;
+	unsigned int first[MAX_CORES], count[MAX_CORES];
+	const struct msrdef *def;
+	const struct msr *vals;
+	const uint8_t *valid;
+
+	fprintf(f, "\n# CPUs that differ from the majority\n");
+	for (m = 0; m < s->nmsrs; m++) {
+		vals = &s->vals[m * s->ncpus];
+		valid = &s->valid[m * s->ncpus];
+		ngroups = 0;
+		for (c = 0; c < s->ncpus; c++) {
+			for (g = 0; g < ngroups; g++)
+				if (valid[c] == valid[first[g]] && (!valid[c] || msr_eq(vals[c], vals[first[g]])))
+					break;
+			if (g == ngroups) {
+				first[ngroups] = c;
+				count[ngroups++] = 0;
+			}
+			count[g]++;
+		}
+		if (ngroups < 2)
+			continue;
+		for (major = 0, g = 1; g < ngroups; g++)
+			if (count[g] > count[major])
+				major = g;
+
+		ndiff++;
+		def = findmsrdef(s->addrs[m]);
+		fprintf(f, "# 0x%08x %s: ", s->addrs[m], def ? def->symbol : "");
+		if (valid[first[major]])
+			fprintf(f, "0x%08x%08x", vals[first[major]].hi, vals[first[major]].lo);
+		else
+			fprintf(f, "unreadable");
+		fprintf(f, " on %d of %d CPUs\n", count[major], s->ncpus);
+		for (g = 0; g < ngroups; g++) {
+			if (g == major)
+				continue;
+			fprintf(f, "# cpus ");
+			print_cpulist(f, s, m, first[g]);
+			if (valid[first[g]])
+				fprintf(f, ": 0x%08x%08x\n", vals[first[g]].hi, vals[first[g]].lo);
+			else
+				fprintf(f, ": unreadable\n");
+			if (valid[first[g]] && valid[first[major]])
+				diff_msr(f, s->addrs[m], vals[first[major]], vals[first[g]]);
+		}
+		fprintf(f, "\n");
+	}
+	if (0 == ndiff)
+		fprintf(f, "# none, all CPUs agree\n");
+}
+
+/** snapshot system **/
+
+static struct msrsnapshot snap;
+static int snap_col[MAX_CORES];
+static uint32_t *snap_sorted;
+
+static int row_cmp(const void *a, const void *b) {
+	const uint32_t x = snap.addrs[*(const uint32_t *)a], y = snap.addrs[*(const uint32_t *)b];
+	return x < y ? -1 : x > y;
+}
+
+/**
+ * Load a snapshot file to be used instead of hardware by the snapshot
+ * system.
+ *
+ * @param fn Snapshot file name, - for stdin.
+ * @return 1 on success, 0 on failure.
+ */
+int snapshot_load(const char *fn) {
+	FILE *f;
+	unsigned int i;
+	int ret;
+
+	if (0 == strcmp(fn, "-"))
+		f = stdin;
+	else if (NULL == (f = fopen(fn, "r"))) {
+		perror("fopen()");
+		return 0;
+	}
+	ret = snapshot_read(f, fn, &snap);
+	if (f != stdin)
+		fclose(f);
+	if (!ret)
+		return 0;
+
+	for (i = 0; i < MAX_CORES; i++)
+		snap_col[i] = -1;
+	for (i = 0; i < snap.ncpus; i++)
+		snap_col[snap.cpus[i]] = i;
+	snap_sorted = malloc((snap.nmsrs ? snap.nmsrs : 1) * sizeof(*snap_sorted));
+	if (NULL == snap_sorted) {
+		perror("malloc");
+		snapshot_free(&snap);
+		return 0;
+	}
+	for (i = 0; i < snap.nmsrs; i++)
+		snap_sorted[i] = i;
+	qsort(snap_sorted, snap.nmsrs, sizeof(*snap_sorted), row_cmp);
+	return 1;
+}
+
+const char *snapshot_targets(void) {
+	return snap.targetnames;
+}
+
+int snapshot_probe(const struct sysdef *system) {
+	return 0;
+}
+
+int snapshot_open(uint8_t cpu, enum SysModes mode) {
+	if (0 == snap.ncpus) {
+		fprintf(stderr, "%s: no snapshot loaded, use -f file\n", __func__);
+		return 0;
+	}
+	if (SYS_RDONLY != mode) {
+		fprintf(stderr, "%s: snapshots are read-only\n", __func__);
+		return 0;
+	}
+	if (-1 == snap_col[cpu]) {
+		fprintf(stderr, "%s: cpu %d is not in the snapshot\n", __func__, cpu);
+		return 0;
+	}
+	return 1;
+}
+
+int snapshot_close(uint8_t cpu) {
+	return 1;
+}
+
+int snapshot_rdmsr(uint8_t cpu, uint32_t addr, struct msr *val) {
+	unsigned int lo = 0, hi = snap.nmsrs, mid, i;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (snap.addrs[snap_sorted[mid]] < addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo < snap.nmsrs && snap.addrs[snap_sorted[lo]] == addr) {
+		i = snap_sorted[lo] * snap.ncpus + snap_col[cpu];
+		if (snap.valid[i]) {
+			*val = snap.vals[i];
+			return 1;
+		}
+	}
+	errno = EIO;
+	SYSERROR(rdmsr, addr);
+	return 0;
+}
+
+int snapshot_listcpus(uint8_t *cpus) {
+	memcpy(cpus, snap.cpus, snap.ncpus);
+	return snap.ncpus;
+}
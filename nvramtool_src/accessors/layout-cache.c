@@ -0,0 +1,458 @@
+/*****************************************************************************\
+ * layout-cache.c
+ *****************************************************************************
+ *  This file is part of nvramtool, a utility for reading/writing coreboot
+ *  parameters and displaying information from the coreboot table.
+ *  For details, see http://coreboot.org/nvramtool.
+ *
+ *  Please also read the file DISCLAIMER which is included in this software
+ *  distribution.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License (as published by the
+ *  Free Software Foundation) version 2, dated June 1991.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the terms and
+ *  conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+\*****************************************************************************/
+
+/* A compiled CMOS layout cache.  The cache file holds the entries, enums and
+ * checksum layout of the internal repository exactly as layout.c keeps them
+ * in memory, so a warm start is a matter of mapping the file and copying two
+ * sorted arrays.  The cache remembers the size and hash of the layout source
+ * it was built from (the text layout file or the CMOS option table in the
+ * coreboot table) and is rebuilt whenever they don't match any more.
+ *
+ * For the option table the physical address of the table is remembered as
+ * well.  A warm start then only maps the pages at that address and checks
+ * them instead of scanning low memory for the coreboot table.
+ */
+
+#ifndef __MINGW32__
+#include <sys/mman.h>
+#endif
+#include "common.h"
+#include "coreboot_tables.h"
+#include "lbtable.h"
+#include "layout.h"
+#include "cmos_lowlevel.h"
+#include "layout-text.h"
+#include "layout-cache.h"
+
+#define LAYOUT_CACHE_MAGIC "NVLAYOUT"
+#define LAYOUT_CACHE_VERSION 1
+
+/* Where the layout stored in the cache came from */
+#define LAYOUT_CACHE_SOURCE_TEXT 1
+#define LAYOUT_CACHE_SOURCE_OPT_TABLE 2
+
+/* Don't map more than this at the address found in a cache file */
+#define LAYOUT_CACHE_MAX_TABLE_SIZE 0x10000
+
+/* The cache file starts with this header.  The entries follow at offset
+ * 'header_size', the enums at the next multiple of 8 after the entries.
+ */
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t header_size;
+	uint32_t entry_size;
+	uint32_t enum_size;
+	uint32_t source;
+	uint32_t source_size;
+	uint64_t source_hash;
+	uint64_t source_addr;
+	uint32_t num_entries;
+	uint32_t num_enums;
+	uint32_t checksum_start;
+	uint32_t checksum_end;
+	uint32_t checksum_index;
+	uint32_t reserved;
+	uint64_t data_hash;	/* hash of everything after the header */
+} layout_cache_header_t;
+
+static const char *layout_cache_filename = NULL;
+
+static uint64_t hash_source(const void *data, size_t size);
+static uint64_t enums_offset(uint32_t num_entries);
+static int try_load_cache(uint32_t source, uint32_t source_size,
+			  uint64_t source_hash);
+static void write_cache(uint32_t source, uint32_t source_size,
+			uint64_t source_hash, uint64_t source_addr);
+static void *read_whole_file(const char filename[], size_t * size);
+
+/****************************************************************************
+ * set_layout_cache_filename
+ *
+ * Set the name of the file we will keep the compiled CMOS layout in.
+ ****************************************************************************/
+void set_layout_cache_filename(const char filename[])
+{
+	layout_cache_filename = filename;
+}
+
+/****************************************************************************
+ * get_layout_from_file_cached
+ *
+ * Obtain the CMOS layout from the cache if it was compiled from the current
+ * contents of the user-specified CMOS layout file.  Else parse the layout
+ * file and update the cache.
+ ****************************************************************************/
+void get_layout_from_file_cached(void)
+{
+	const char *filename;
+	uint64_t hash;
+	size_t size;
+	void *text;
+
+	assert(layout_cache_filename != NULL);
+	filename = get_layout_filename();
+	assert(filename != NULL);
+
+	if ((text = read_whole_file(filename, &size)) == NULL) {
+		fprintf(stderr,
+			"%s: Can not open CMOS layout file %s for reading: "
+			"%s\n", prog_name, filename, strerror(errno));
+		exit(1);
+	}
+
+	hash = hash_source(text, size);
+	free(text);
+
+	if (size <= UINT32_MAX &&
+	    try_load_cache(LAYOUT_CACHE_SOURCE_TEXT, size, hash))
+		return;
+
+	get_layout_from_file();
+
+	if (size <= UINT32_MAX)
+		write_cache(LAYOUT_CACHE_SOURCE_TEXT, size, hash, 0);
+}
+
+/****************************************************************************
+ * get_layout_from_cmos_table_cached
+ *
+ * Obtain the CMOS layout from the cache if it was compiled from the CMOS
+ * option table that is still found at the physical address recorded in the
+ * cache.  Else search for the coreboot table as usual, extract the layout
+ * from its CMOS option table and update the cache.
+ ****************************************************************************/
+void get_layout_from_cmos_table_cached(void)
+{
+	const struct cmos_option_table *table;
+	layout_cache_header_t header;
+	uint64_t addr;
+	int fd;
+
+	assert(layout_cache_filename != NULL);
+
+	/* Peek at the header to learn where the option table was last time
+	 * and how large it was.
+	 */
+	if ((fd = open(layout_cache_filename, O_RDONLY)) >= 0) {
+		if (read(fd, &header, sizeof(header)) == sizeof(header) &&
+		    header.source == LAYOUT_CACHE_SOURCE_OPT_TABLE &&
+		    header.source_size >= sizeof(*table) &&
+		    header.source_size <= LAYOUT_CACHE_MAX_TABLE_SIZE &&
+		    header.source_addr <=
+		    (unsigned long)-1 - header.source_size) {
+			table = map_phys_mem(header.source_addr,
+					     header.source_size);
+
+			/* The address is stale, e.g. after a firmware update
+			 * or on another machine.  Drop the cache and look for
+			 * the table the usual way.
+			 */
+			if (table == NULL) {
+				close(fd);
+				unlink(layout_cache_filename);
+				goto scan;
+			}
+
+			if (table->tag == LB_TAG_CMOS_OPTION_TABLE &&
+			    table->size == header.source_size &&
+			    try_load_cache(LAYOUT_CACHE_SOURCE_OPT_TABLE,
+					   table->size,
+					   hash_source(table, table->size))) {
+				close(fd);
+				return;
+			}
+		}
+
+		close(fd);
+	}
+
+      scan:
+	get_layout_from_cmos_table();
+
+	/* get_layout_from_cmos_table() exits if there is no option table. */
+	table = (const struct cmos_option_table *)
+	    find_lbrec(LB_TAG_CMOS_OPTION_TABLE);
+	addr = lbrec_phys_addr((const struct lb_record *)table);
+	write_cache(LAYOUT_CACHE_SOURCE_OPT_TABLE, table->size,
+		    hash_source(table, table->size), addr);
+}
+
+/****************************************************************************
+ * hash_source
+ *
+ * Return the 64 bit FNV-1a hash of 'size' bytes at 'data'.
+ ****************************************************************************/
+static uint64_t hash_source(const void *data, size_t size)
+{
+	const unsigned char *p = data;
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		hash ^= p[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+/****************************************************************************
+ * enums_offset
+ *
+ * Return the offset of the enums in a cache file holding 'num_entries'
+ * entries.
+ ****************************************************************************/
+static uint64_t enums_offset(uint32_t num_entries)
+{
+	uint64_t offset;
+
+	offset = sizeof(layout_cache_header_t) +
+	    (uint64_t) num_entries * sizeof(cmos_entry_t);
+	return (offset + 7) & ~(uint64_t) 7;
+}
+
+/****************************************************************************
+ * try_load_cache
+ *
+ * Map the cache file and check that it was compiled by this version of
+ * nvramtool from the given layout source.  If so, load its contents into
+ * our internal repository and return 1.  Else return 0.
+ ****************************************************************************/
+static int try_load_cache(uint32_t source, uint32_t source_size,
+			  uint64_t source_hash)
+{
+	const layout_cache_header_t *header;
+	struct stat cache_stat;
+	uint64_t offset;
+	void *cache;
+	int fd, result;
+
+	if ((fd = open(layout_cache_filename, O_RDONLY)) < 0)
+		return 0;
+
+	if (fstat(fd, &cache_stat) || cache_stat.st_size < (off_t) sizeof(*header)) {
+		close(fd);
+		return 0;
+	}
+
+	cache = mmap(NULL, cache_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (cache == MAP_FAILED)
+		return 0;
+
+	header = cache;
+	offset = enums_offset(header->num_entries);
+	result = 0;
+
+	if (memcmp(header->magic, LAYOUT_CACHE_MAGIC, sizeof(header->magic)) ||
+	    header->version != LAYOUT_CACHE_VERSION ||
+	    header->header_size != sizeof(*header) ||
+	    header->entry_size != sizeof(cmos_entry_t) ||
+	    header->enum_size != sizeof(cmos_enum_t) ||
+	    header->source != source ||
+	    header->source_size != source_size ||
+	    header->source_hash != source_hash ||
+	    offset + (uint64_t) header->num_enums * sizeof(cmos_enum_t) !=
+	    (uint64_t) cache_stat.st_size ||
+	    header->data_hash != hash_source(header + 1,
+					      cache_stat.st_size - sizeof(*header)))
+		goto out;
+
+	if (header->checksum_start > header->checksum_end ||
+	    header->checksum_end >= CMOS_SIZE ||
+	    header->checksum_index >= CMOS_SIZE - 1)
+		goto out;
+
+	/* load_cmos_layout() rejects entries and enums that are out of order
+	 * or overlap, so a damaged cache can't confuse the code using them.
+	 */
+	if (load_cmos_layout((const cmos_entry_t *)(header + 1),
+			     header->num_entries,
+			     (const cmos_enum_t *)((const char *)cache + offset),
+			     header->num_enums) != OK)
+		goto out;
+
+	cmos_checksum_start = header->checksum_start;
+	cmos_checksum_end = header->checksum_end;
+	cmos_checksum_index = header->checksum_index;
+	result = 1;
+
+      out:
+	munmap(cache, cache_stat.st_size);
+	return result;
+}
+
+/****************************************************************************
+ * write_cache
+ *
+ * Compile the contents of our internal repository into the cache file.  The
+ * new cache is written to a temporary file which then replaces the old one,
+ * so other instances of nvramtool never see a partially written cache.  A
+ * cache that can't be written is not fatal since it is only an optimization.
+ ****************************************************************************/
+static void write_cache(uint32_t source, uint32_t source_size,
+			uint64_t source_hash, uint64_t source_addr)
+{
+	layout_cache_header_t header;
+	const cmos_entry_t *e;
+	const cmos_enum_t *q;
+	char *tmp_filename;
+	size_t len, data_size;
+	cmos_entry_t *entries;
+	cmos_enum_t *enums;
+	char *data = NULL;
+	FILE *f;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, LAYOUT_CACHE_MAGIC, sizeof(header.magic));
+	header.version = LAYOUT_CACHE_VERSION;
+	header.header_size = sizeof(header);
+	header.entry_size = sizeof(cmos_entry_t);
+	header.enum_size = sizeof(cmos_enum_t);
+	header.source = source;
+	header.source_size = source_size;
+	header.source_hash = source_hash;
+	header.source_addr = source_addr;
+	header.checksum_start = cmos_checksum_start;
+	header.checksum_end = cmos_checksum_end;
+	header.checksum_index = cmos_checksum_index;
+
+	for (e = first_cmos_entry(); e != NULL; e = next_cmos_entry(e))
+		header.num_entries++;
+
+	for (q = first_cmos_enum(); q != NULL; q = next_cmos_enum(q))
+		header.num_enums++;
+
+	len = strlen(layout_cache_filename);
+
+	if ((tmp_filename = malloc(len + 5)) == NULL)
+		out_of_memory();
+
+	sprintf(tmp_filename, "%s.tmp", layout_cache_filename);
+
+	if ((f = fopen(tmp_filename, "wb")) == NULL)
+		goto err;
+
+	/* Lay out the entries and enums in memory first so the header can
+	 * carry their hash.
+	 */
+	data_size = enums_offset(header.num_entries) - sizeof(header) +
+	    header.num_enums * sizeof(*q);
+
+	if ((data = calloc(1, data_size ? data_size : 1)) == NULL)
+		out_of_memory();
+
+	/* Copy field by field so padding and the bytes after the terminating
+	 * zero of names stay zero and equal layouts give equal caches.
+	 */
+	entries = (cmos_entry_t *) data;
+
+	for (e = first_cmos_entry(); e != NULL; e = next_cmos_entry(e)) {
+		entries->bit = e->bit;
+		entries->length = e->length;
+		entries->config = e->config;
+		entries->config_id = e->config_id;
+		strcpy(entries->name, e->name);
+		entries++;
+	}
+
+	enums = (cmos_enum_t *) (data + enums_offset(header.num_entries) -
+				 sizeof(header));
+
+	for (q = first_cmos_enum(); q != NULL; q = next_cmos_enum(q)) {
+		enums->config_id = q->config_id;
+		enums->value = q->value;
+		strcpy(enums->text, q->text);
+		enums++;
+	}
+
+	header.data_hash = hash_source(data, data_size);
+
+	if (fwrite(&header, sizeof(header), 1, f) != 1 ||
+	    (data_size && fwrite(data, data_size, 1, f) != 1))
+		goto err_close;
+
+	if (fclose(f))
+		goto err_remove;
+
+	if (rename(tmp_filename, layout_cache_filename))
+		goto err_remove;
+
+	free(data);
+	free(tmp_filename);
+	return;
+
+      err_close:
+	fclose(f);
+      err_remove:
+	unlink(tmp_filename);
+      err:
+	fprintf(stderr, "%s: Warning: Can not write CMOS layout cache %s: %s\n",
+		prog_name, layout_cache_filename, strerror(errno));
+	free(data);
+	free(tmp_filename);
+}
+
+/****************************************************************************
+ * read_whole_file
+ *
+ * Read the file 'filename' into a newly allocated buffer and return it.  The
+ * size of the file is returned in '*size'.  Return NULL if the file can't be
+ * read.
+ ****************************************************************************/
+static void *read_whole_file(const char filename[], size_t * size)
+{
+	size_t max = 4096, len = 0, n;
+	char *buf;
+	FILE *f;
+
+	if ((f = fopen(filename, "rb")) == NULL)
+		return NULL;
+
+	if ((buf = malloc(max)) == NULL)
+		out_of_memory();
+
+	while ((n = fread(buf + len, 1, max - len, f)) > 0) {
+		len += n;
+
+		if (len == max) {
+			max *= 2;
+
+			if ((buf = realloc(buf, max)) == NULL)
+				out_of_memory();
+		}
+	}
+
+	if (ferror(f)) {
+		fclose(f);
+		free(buf);
+		return NULL;
+	}
+
+	fclose(f);
+	*size = len;
+	return buf;
+}
@@ -202,6 +202,16 @@ void set_layout_filename(const char filename[])
 	layout_filename = filename;
 }
 
+/****************************************************************************
+ * get_layout_filename
+ *
+ * Return the name of the file we obtain CMOS layout information from.
+ ****************************************************************************/
+const char *get_layout_filename(void)
+{
+	return layout_filename;
+}
+
 /****************************************************************************
  * get_layout_from_file
  *
@@ -35,6 +35,7 @@
 #include "coreboot_tables.h"
 
 void set_layout_filename(const char filename[]);
+const char *get_layout_filename(void);
 void get_layout_from_file(void);
 void write_cmos_layout(FILE * f);
 void write_cmos_output_bin(const char *binary_filename);
@@ -75,23 +75,55 @@ static struct cbfs_header *cbfs_master_header(void)
 	return header;
 }
 
-struct cbfs_file *cbfs_find(const char *name)
+/* The files of the CBFS image sorted by name, so that cbfs_find() doesn't
+ * have to walk the chain of files for every lookup.  Files with the same
+ * name are kept in chain order, so the first one in the image is found.
+ */
+struct cbfs_index_entry {
+	const char *name;
+	struct cbfs_file *file;
+	int seq;
+};
+
+static struct cbfs_index_entry *cbfs_index;
+static int cbfs_index_size = -1;	/* not built yet */
+
+static int cbfs_index_cmp(const void *a, const void *b)
+{
+	const struct cbfs_index_entry *x = a, *y = b;
+	int result = strcmp(x->name, y->name);
+
+	return result ? result : x->seq - y->seq;
+}
+
+static void cbfs_build_index(void)
 {
 	struct cbfs_header *header = cbfs_master_header();
 	void *offset;
+	int max = 0;
 
+	cbfs_index_size = 0;
 	if (header == NULL)
-		return NULL;
+		return;
 	offset = virt_to_phys(0 - ntohl(header->romsize) + ntohl(header->offset));
 
 	int align= ntohl(header->align);
 
 	while(1) {
 		struct cbfs_file *file = (struct cbfs_file *) offset;
-		if (!cbfs_check_magic(file)) return NULL;
-		debug("Check %s\n", CBFS_NAME(file));
-		if (!strcmp(CBFS_NAME(file), name))
-			return file;
+		if (!cbfs_check_magic(file)) break;
+		debug("Index %s\n", CBFS_NAME(file));
+
+		if (cbfs_index_size == max) {
+			max = max ? 2 * max : 32;
+			cbfs_index = realloc(cbfs_index, max * sizeof(*cbfs_index));
+			if (cbfs_index == NULL)
+				out_of_memory();
+		}
+		cbfs_index[cbfs_index_size].name = CBFS_NAME(file);
+		cbfs_index[cbfs_index_size].file = file;
+		cbfs_index[cbfs_index_size].seq = cbfs_index_size;
+		cbfs_index_size++;
 
 		int flen = ntohl(file->len);
 		int foffset = ntohl(file->offset);
@@ -100,11 +132,36 @@ struct cbfs_file *cbfs_find(const char *name)
 		void *oldoffset = offset;
 		offset = (void*)ALIGN((uintptr_t)(offset + foffset + flen), align);
 		debug("%p\n", (void *)offset);
-		if (offset <= oldoffset) return NULL;
+		if (offset <= oldoffset) break;
 
 		if (offset < virt_to_phys(0xFFFFFFFF - ntohl(header->romsize)))
-			return NULL;
+			break;
 	}
+
+	qsort(cbfs_index, cbfs_index_size, sizeof(*cbfs_index), cbfs_index_cmp);
+}
+
+struct cbfs_file *cbfs_find(const char *name)
+{
+	int lo, hi, mid;
+
+	if (cbfs_index_size < 0)
+		cbfs_build_index();
+
+	/* Find the first file whose name is not less than 'name'. */
+	lo = 0;
+	hi = cbfs_index_size;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (strcmp(cbfs_index[mid].name, name) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < cbfs_index_size && !strcmp(cbfs_index[lo].name, name))
+		return cbfs_index[lo].file;
+	return NULL;
 }
 
 void *cbfs_find_file(const char *name, unsigned int type, unsigned int *len)
@@ -149,5 +206,10 @@ void open_cbfs(const char *filename)
 		exit(-1);
 	}
 	cbfs_offset = cbfs_mapped-(0xffffffff-cbfs_stat.st_size+1);
+
+	/* A different image needs a new index. */
+	free(cbfs_index);
+	cbfs_index = NULL;
+	cbfs_index_size = -1;
 }
 
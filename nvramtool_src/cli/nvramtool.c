@@ -39,6 +39,7 @@
 #include "lbtable.h"
 #include "layout.h"
 #include "accessors/layout-text.h"
+#include "accessors/layout-cache.h"
 #include "input_file.h"
 #include "cmos_ops.h"
 #include "cmos_lowlevel.h"
@@ -146,6 +147,19 @@ int main(int argc, char *argv[])
 		fn = get_layout_from_cmos_table;
 	}
 
+	/* Keep the compiled layout in a cache file if the user asked for it.
+	 * Layouts read from a CBFS file are not cached. */
+	if (nvramtool_op_modifiers[NVRAMTOOL_MOD_USE_LAYOUT_CACHE].found) {
+		set_layout_cache_filename(nvramtool_op_modifiers[NVRAMTOOL_MOD_USE_LAYOUT_CACHE].param);
+		if (fn == get_layout_from_file)
+			fn = get_layout_from_file_cached;
+		else if (fn == get_layout_from_cmos_table)
+			fn = get_layout_from_cmos_table_cached;
+	}
+
+	if (nvramtool_op_modifiers[NVRAMTOOL_MOD_USE_LBTABLE_HINT].found)
+		set_lbtable_hint_filename(nvramtool_op_modifiers[NVRAMTOOL_MOD_USE_LBTABLE_HINT].param);
+
 	/* Allow the user to use a file for the CMOS contents, possibly
 	 * overriding a previously opened "cmos.default" file from the CBFS. */
 	if (nvramtool_op_modifiers[NVRAMTOOL_MOD_USE_CMOS_FILE].found) {
@@ -275,10 +289,12 @@ static void op_cmos_show_one_param(void)
 	int result;
 
 	get_cmos_layout();
+	cmos_snapshot_begin();
 	result = list_one_param(nvramtool_op.param,
 				!nvramtool_op_modifiers
 				[NVRAMTOOL_MOD_SHOW_VALUE_ONLY].found);
 	cmos_checksum_verify();
+	cmos_snapshot_discard();
 
 	if (result)
 		exit(1);
@@ -296,8 +312,10 @@ static void op_cmos_show_all_params(void)
 	int result;
 
 	get_cmos_layout();
+	cmos_snapshot_begin();
 	result = list_all_params();
 	cmos_checksum_verify();
+	cmos_snapshot_discard();
 
 	if (result)
 		exit(1);
@@ -687,10 +705,10 @@ static void set_one_param(const char name[], const char value[])
 	}
 
 	/* write the value to nonvolatile RAM */
-	set_iopl(3);
+	cmos_snapshot_begin();
 	cmos_write(e, n);
 	cmos_checksum_write(cmos_checksum_compute());
-	set_iopl(0);
+	cmos_snapshot_commit();
 	return;
 
       fail:
@@ -41,7 +41,7 @@ static void register_op_modifier(nvramtool_op_modifier_t mod, char mod_param[]);
 static void resolve_op_modifiers(void);
 static void sanity_check_args(void);
 
-static const char getopt_string[] = "-ab:B:c::C:dD:e:hH:iL:l::np:r:tvw:xX:y:Y";
+static const char getopt_string[] = "-ab:B:c::C:dD:e:hH:ik:K:L:l::np:r:tvw:xX:y:Y";
 
 /****************************************************************************
  * parse_nvramtool_args
@@ -107,6 +107,14 @@ void parse_nvramtool_args(int argc, char *argv[])
 			register_op(&op_found,
 				    NVRAMTOOL_OP_CMOS_SET_PARAMS_STDIN, NULL);
 			break;
+		case 'k':
+			register_op_modifier(NVRAMTOOL_MOD_USE_LAYOUT_CACHE,
+					     optarg);
+			break;
+		case 'K':
+			register_op_modifier(NVRAMTOOL_MOD_USE_LBTABLE_HINT,
+					     optarg);
+			break;
 		case 'l':
 			register_op(&op_found, NVRAMTOOL_OP_LBTABLE_SHOW_INFO,
 				    handle_optional_arg(argc, argv));
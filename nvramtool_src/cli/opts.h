@@ -63,6 +63,8 @@ typedef enum { NVRAMTOOL_MOD_SHOW_VALUE_ONLY = 0,
 	NVRAMTOOL_MOD_USE_CBFS_FILE,
 	NVRAMTOOL_MOD_USE_CMOS_FILE,
 	NVRAMTOOL_MOD_USE_CMOS_OPT_TABLE,
+	NVRAMTOOL_MOD_USE_LAYOUT_CACHE,
+	NVRAMTOOL_MOD_USE_LBTABLE_HINT,
 	NVRAMTOOL_NUM_OP_MODIFIERS	/* must always be last */
 } nvramtool_op_modifier_t;
 
@@ -62,6 +62,16 @@ void select_hal(hal_t hal, void *data)
 	current_access->init(data);
 }
 
+/* Snapshot of the CMOS bank.  While a snapshot is active, all byte accesses
+ * outside the real time clock area are served from 'data', and only the
+ * bytes that differ from 'orig' are written back when it is committed.
+ */
+static struct {
+	int active;
+	unsigned char orig[CMOS_SIZE];
+	unsigned char data[CMOS_SIZE];
+} snapshot;
+
 /* Bit-level access */
 typedef struct {
 	unsigned byte_index;
@@ -208,6 +218,9 @@ void cmos_write(const cmos_entry_t * e, unsigned long long value)
  ****************************************************************************/
 unsigned char cmos_read_byte(unsigned index)
 {
+	if (snapshot.active && !verify_cmos_byte_index(index))
+		return snapshot.data[index];
+
 	return current_access->read(index);
 }
 
@@ -223,6 +236,11 @@ unsigned char cmos_read_byte(unsigned index)
  ****************************************************************************/
 void cmos_write_byte(unsigned index, unsigned char value)
 {
+	if (snapshot.active && !verify_cmos_byte_index(index)) {
+		snapshot.data[index] = value;
+		return;
+	}
+
 	current_access->write(index, value);
 }
 
@@ -239,6 +257,11 @@ void cmos_read_all(unsigned char data[])
 	for (i = 0; i < CMOS_RTC_AREA_SIZE; i++)
 		data[i] = 0;
 
+	if (snapshot.active) {
+		memcpy(&data[i], &snapshot.data[i], CMOS_SIZE - i);
+		return;
+	}
+
 	for (; i < CMOS_SIZE; i++)
 		data[i] = cmos_read_byte(i);
 }
@@ -269,9 +292,63 @@ void cmos_write_all(unsigned char data[])
  ****************************************************************************/
 void set_iopl(int level)
 {
+	/* No I/O ports are touched while a snapshot is active. */
+	if (snapshot.active)
+		return;
+
 	current_access->set_iopl(level);
 }
 
+/****************************************************************************
+ * cmos_snapshot_begin
+ *
+ * Read all of CMOS memory outside the real time clock area once.  Until the
+ * snapshot is committed or discarded, all reads and writes of these bytes
+ * (including the checksum computation) operate on the copy in memory.
+ ****************************************************************************/
+void cmos_snapshot_begin(void)
+{
+	assert(!snapshot.active);
+
+	set_iopl(3);
+	cmos_read_all(snapshot.orig);
+	set_iopl(0);
+	memcpy(snapshot.data, snapshot.orig, CMOS_SIZE);
+	snapshot.active = 1;
+}
+
+/****************************************************************************
+ * cmos_snapshot_commit
+ *
+ * End the current snapshot, writing back only the bytes that were changed
+ * while it was active.
+ ****************************************************************************/
+void cmos_snapshot_commit(void)
+{
+	unsigned i;
+
+	assert(snapshot.active);
+	snapshot.active = 0;
+
+	set_iopl(3);
+	for (i = CMOS_RTC_AREA_SIZE; i < CMOS_SIZE; i++) {
+		if (snapshot.data[i] != snapshot.orig[i])
+			cmos_write_byte(i, snapshot.data[i]);
+	}
+	set_iopl(0);
+}
+
+/****************************************************************************
+ * cmos_snapshot_discard
+ *
+ * End the current snapshot without writing anything to CMOS memory.
+ ****************************************************************************/
+void cmos_snapshot_discard(void)
+{
+	assert(snapshot.active);
+	snapshot.active = 0;
+}
+
 /****************************************************************************
  * verify_cmos_op
  *
@@ -55,6 +55,9 @@ void cmos_write_byte(unsigned index, unsigned char value);
 void cmos_read_all(unsigned char data[]);
 void cmos_write_all(unsigned char data[]);
 void set_iopl(int level);
+void cmos_snapshot_begin(void);
+void cmos_snapshot_commit(void);
+void cmos_snapshot_discard(void);
 int verify_cmos_op(unsigned bit, unsigned length, cmos_entry_config_t config);
 
 #define CMOS_SIZE 256		/* size of CMOS memory in bytes */
@@ -75,13 +75,17 @@ void out_of_memory(void)
 void usage(FILE * outfile)
 {
 	fprintf(outfile,
-		"Usage: %s [-y LAYOUT_FILE | -t] PARAMETER ...\n\n"
+		"Usage: %s [-y LAYOUT_FILE | -t] [-k CACHE_FILE] [-K HINT_FILE] PARAMETER ...\n\n"
 		"       Read/write coreboot parameters or show info from "
 		"coreboot table.\n\n"
 		"       -y LAYOUT_FILE: Use CMOS layout specified by "
 		"LAYOUT_FILE.\n"
 		"       -t:             Use CMOS layout specified by CMOS option "
 		"table.\n"
+		"       -k CACHE_FILE:  Keep the compiled CMOS layout in "
+		"CACHE_FILE.\n"
+		"       -K HINT_FILE:   Remember where the coreboot table is in "
+		"HINT_FILE.\n"
 		"       -C CBFS_FILE:   Use CBFS file for layout and CMOS data.\n"
 		"       -D CMOS_FILE:   Use CMOS file for CMOS data (overrides CMOS of -C).\n"
 		"       [-n] -r NAME:   Show parameter NAME.  If -n is given, "
@@ -158,7 +158,7 @@ void do_cmos_writes(cmos_write_t * list)
 {
 	cmos_write_t *item;
 
-	set_iopl(3);
+	cmos_snapshot_begin();
 
 	while (list != NULL) {
 		cmos_entry_t e;
@@ -172,7 +172,7 @@ void do_cmos_writes(cmos_write_t * list)
 	}
 
 	cmos_checksum_write(cmos_checksum_compute());
-	set_iopl(0);
+	cmos_snapshot_commit();
 }
 
 /****************************************************************************
@@ -32,25 +32,15 @@
 #include "layout.h"
 #include "cmos_lowlevel.h"
 
-typedef struct cmos_entry_item_t cmos_entry_item_t;
-
-struct cmos_entry_item_t {
-	cmos_entry_t item;
-	cmos_entry_item_t *next;
-};
-
-typedef struct cmos_enum_item_t cmos_enum_item_t;
-
-struct cmos_enum_item_t {
-	cmos_enum_t item;
-	cmos_enum_item_t *next;
-};
-
 static void default_cmos_layout_get_fn(void);
 static int areas_overlap(unsigned area_0_start, unsigned area_0_length,
 			 unsigned area_1_start, unsigned area_1_length);
 static int entries_overlap(const cmos_entry_t * p, const cmos_entry_t * q);
-static const cmos_enum_item_t *find_first_cmos_enum_id(unsigned config_id);
+static unsigned find_cmos_entry_pos(unsigned bit);
+static unsigned find_cmos_enum_pos(unsigned config_id,
+				   unsigned long long value);
+static unsigned hash_name(const char name[]);
+static void build_cmos_name_index(void);
 
 const char checksum_param_name[] = "check_sum";
 
@@ -82,15 +72,28 @@ unsigned cmos_checksum_end = CMOS_CHECKSUM_END;
 /* index of first byte of CMOS checksum (a big-endian 16-bit value) */
 unsigned cmos_checksum_index = CMOS_CHECKSUM_INDEX;
 
-/* List is sorted in ascending order according to 'bit' field in
- * cmos_entry_t.
+/* Entries are kept in an array sorted in ascending order according to the
+ * 'bit' field in cmos_entry_t.  Since entries may not overlap, the position
+ * of a new entry and its possible conflicts are found by binary search.
  */
-static cmos_entry_item_t *cmos_entry_list = NULL;
+static cmos_entry_t *cmos_entries = NULL;
+static unsigned num_cmos_entries = 0;
+static unsigned max_cmos_entries = 0;
+
+/* Open addressing hash table on the 'name' field of the entries.  A slot
+ * holds the array index of an entry plus one, or zero if it is empty.  The
+ * table is rebuilt by the first lookup after entries were added, so it is
+ * built only once for a layout.
+ */
+static unsigned *cmos_name_index = NULL;
+static unsigned cmos_name_index_size = 0;
 
-/* List is sorted in ascending order: first by 'config_id' and then by
- * 'value'.
+/* Enums are kept in an array sorted in ascending order: first by
+ * 'config_id' and then by 'value'.  Lookups are done by binary search.
  */
-static cmos_enum_item_t *cmos_enum_list = NULL;
+static cmos_enum_t *cmos_enums = NULL;
+static unsigned num_cmos_enums = 0;
+static unsigned max_cmos_enums = 0;
 
 static cmos_layout_get_fn_t cmos_layout_get_fn = default_cmos_layout_get_fn;
 
@@ -106,33 +109,28 @@ static inline int entries_overlap(const cmos_entry_t * p,
 }
 
 /****************************************************************************
- * cmos_entry_to_const_item
+ * make_room
  *
- * Return a pointer to the cmos_entry_item_t that 'p' is embedded within.
+ * Make sure that the array at '*array' with '*max' elements of 'size' bytes
+ * has room for at least 'count' elements.
  ****************************************************************************/
-static inline const cmos_entry_item_t *cmos_entry_to_const_item
-    (const cmos_entry_t * p) {
-	static const cmos_entry_t *pos = &((cmos_entry_item_t *) 0)->item;
-	unsigned long offset, address;
-
-	offset = (unsigned long)pos;
-	address = ((unsigned long)p) - offset;
-	return (const cmos_entry_item_t *)address;
-}
+static void make_room(void **array, unsigned *max, unsigned count,
+		      size_t size)
+{
+	unsigned new_max;
+	void *p;
 
-/****************************************************************************
- * cmos_enum_to_const_item
- *
- * Return a pointer to the cmos_enum_item_t that 'p' is embedded within.
- ****************************************************************************/
-static inline const cmos_enum_item_t *cmos_enum_to_const_item
-    (const cmos_enum_t * p) {
-	static const cmos_enum_t *pos = &((cmos_enum_item_t *) 0)->item;
-	unsigned long offset, address;
-
-	offset = (unsigned long)pos;
-	address = ((unsigned long)p) - offset;
-	return (const cmos_enum_item_t *)address;
+	if (count <= *max)
+		return;
+
+	for (new_max = (*max == 0) ? 64 : *max; new_max < count;
+	     new_max *= 2) ;
+
+	if ((p = realloc(*array, new_max * size)) == NULL)
+		out_of_memory();
+
+	*array = p;
+	*max = new_max;
 }
 
 /****************************************************************************
@@ -166,60 +164,38 @@ void get_cmos_layout(void)
  ****************************************************************************/
 int add_cmos_entry(const cmos_entry_t * e, const cmos_entry_t ** conflict)
 {
-	cmos_entry_item_t *item, *prev, *new_entry;
+	unsigned i;
 
 	*conflict = NULL;
 
 	if (e->length < 1)
 		return LAYOUT_ENTRY_BAD_LENGTH;
 
-	if ((new_entry =
-	     (cmos_entry_item_t *) malloc(sizeof(*new_entry))) == NULL)
-		out_of_memory();
-
-	new_entry->item = *e;
-
-	if (cmos_entry_list == NULL) {
-		new_entry->next = NULL;
-		cmos_entry_list = new_entry;
-		return OK;
-	}
-
-	/* Find place in list to insert new entry.  List is sorted in ascending
-	 * order.
+	/* Only the entries just before and at the place of the new entry
+	 * can overlap it.
 	 */
-	for (item = cmos_entry_list, prev = NULL;
-	     (item != NULL) && (item->item.bit < e->bit);
-	     prev = item, item = item->next) ;
-
-	if (prev == NULL) {
-		if (entries_overlap(e, &cmos_entry_list->item)) {
-			*conflict = &cmos_entry_list->item;
-			goto fail;
-		}
+	i = find_cmos_entry_pos(e->bit);
 
-		new_entry->next = cmos_entry_list;
-		cmos_entry_list = new_entry;
-		return OK;
+	if ((i > 0) && entries_overlap(&cmos_entries[i - 1], e)) {
+		*conflict = &cmos_entries[i - 1];
+		return LAYOUT_ENTRY_OVERLAP;
 	}
 
-	if (entries_overlap(&prev->item, e)) {
-		*conflict = &prev->item;
-		goto fail;
+	if ((i < num_cmos_entries) && entries_overlap(e, &cmos_entries[i])) {
+		*conflict = &cmos_entries[i];
+		return LAYOUT_ENTRY_OVERLAP;
 	}
 
-	if ((item != NULL) && entries_overlap(e, &item->item)) {
-		*conflict = &item->item;
-		goto fail;
-	}
+	make_room((void **)&cmos_entries, &max_cmos_entries,
+		  num_cmos_entries + 1, sizeof(*cmos_entries));
+	memmove(&cmos_entries[i + 1], &cmos_entries[i],
+		(num_cmos_entries - i) * sizeof(*cmos_entries));
+	cmos_entries[i] = *e;
+	num_cmos_entries++;
 
-	new_entry->next = item;
-	prev->next = new_entry;
+	/* The array indices in the name index are stale now. */
+	cmos_name_index_size = 0;
 	return OK;
-
-      fail:
-	free(new_entry);
-	return LAYOUT_ENTRY_OVERLAP;
 }
 
 /****************************************************************************
@@ -230,11 +206,22 @@ int add_cmos_entry(const cmos_entry_t * e, const cmos_entry_t ** conflict)
  ****************************************************************************/
 const cmos_entry_t *find_cmos_entry(const char name[])
 {
-	cmos_entry_item_t *item;
+	unsigned mask, slot;
+
+	if (num_cmos_entries == 0)
+		return NULL;
+
+	if (cmos_name_index_size == 0)
+		build_cmos_name_index();
 
-	for (item = cmos_entry_list; item != NULL; item = item->next) {
-		if (!strcmp(item->item.name, name))
-			return &item->item;
+	mask = cmos_name_index_size - 1;
+
+	for (slot = hash_name(name) & mask; cmos_name_index[slot];
+	     slot = (slot + 1) & mask) {
+		const cmos_entry_t *e = &cmos_entries[cmos_name_index[slot] - 1];
+
+		if (!strcmp(e->name, name))
+			return e;
 	}
 
 	return NULL;
@@ -248,7 +235,7 @@ const cmos_entry_t *find_cmos_entry(const char name[])
  ****************************************************************************/
 const cmos_entry_t *first_cmos_entry(void)
 {
-	return (cmos_entry_list == NULL) ? NULL : &cmos_entry_list->item;
+	return (num_cmos_entries == 0) ? NULL : &cmos_entries[0];
 }
 
 /****************************************************************************
@@ -259,11 +246,8 @@ const cmos_entry_t *first_cmos_entry(void)
  ****************************************************************************/
 const cmos_entry_t *next_cmos_entry(const cmos_entry_t * last)
 {
-	const cmos_entry_item_t *last_item, *next_item;
-
-	last_item = cmos_entry_to_const_item(last);
-	next_item = last_item->next;
-	return (next_item == NULL) ? NULL : &next_item->item;
+	last++;
+	return (last == &cmos_entries[num_cmos_entries]) ? NULL : last;
 }
 
 /****************************************************************************
@@ -274,71 +258,21 @@ const cmos_entry_t *next_cmos_entry(const cmos_entry_t * last)
  ****************************************************************************/
 int add_cmos_enum(const cmos_enum_t * e)
 {
-	cmos_enum_item_t *item, *prev, *new_enum;
+	unsigned i;
 
-	if ((new_enum = (cmos_enum_item_t *) malloc(sizeof(*new_enum))) == NULL)
-		out_of_memory();
-
-	new_enum->item = *e;
-
-	if (cmos_enum_list == NULL) {
-		new_enum->next = NULL;
-		cmos_enum_list = new_enum;
-		return OK;
-	}
-
-	/* The list of enums is sorted in ascending order, first by
-	 * 'config_id' and then by 'value'.  Look for the first enum
-	 * whose 'config_id' field matches 'e'.
-	 */
-	for (item = cmos_enum_list, prev = NULL;
-	     (item != NULL) && (item->item.config_id < e->config_id);
-	     prev = item, item = item->next) ;
-
-	if (item == NULL) {
-		new_enum->next = NULL;
-		prev->next = new_enum;
-		return OK;
-	}
-
-	if (item->item.config_id > e->config_id) {
-		new_enum->next = item;
-
-		if (prev == NULL)
-			cmos_enum_list = new_enum;
-		else
-			prev->next = new_enum;
-
-		return OK;
-	}
-
-	/* List already contains at least one enum whose 'config_id'
-	 * matches 'e'.  Now find proper place to insert 'e' based on
-	 * 'value'.
-	 */
-	while (item->item.value < e->value) {
-		prev = item;
-		item = item->next;
-
-		if ((item == NULL) || (item->item.config_id != e->config_id)) {
-			new_enum->next = item;
-			prev->next = new_enum;
-			return OK;
-		}
-	}
+	i = find_cmos_enum_pos(e->config_id, e->value);
 
-	if (item->item.value == e->value) {
-		free(new_enum);
+	if ((i < num_cmos_enums) &&
+	    (cmos_enums[i].config_id == e->config_id) &&
+	    (cmos_enums[i].value == e->value))
 		return LAYOUT_DUPLICATE_ENUM;
-	}
-
-	new_enum->next = item;
-
-	if (prev == NULL)
-		cmos_enum_list = new_enum;
-	else
-		prev->next = new_enum;
 
+	make_room((void **)&cmos_enums, &max_cmos_enums, num_cmos_enums + 1,
+		  sizeof(*cmos_enums));
+	memmove(&cmos_enums[i + 1], &cmos_enums[i],
+		(num_cmos_enums - i) * sizeof(*cmos_enums));
+	cmos_enums[i] = *e;
+	num_cmos_enums++;
 	return OK;
 }
 
@@ -350,19 +284,15 @@ int add_cmos_enum(const cmos_enum_t * e)
  ****************************************************************************/
 const cmos_enum_t *find_cmos_enum(unsigned config_id, unsigned long long value)
 {
-	const cmos_enum_item_t *item;
-
-	if ((item = find_first_cmos_enum_id(config_id)) == NULL)
-		return NULL;
+	unsigned i;
 
-	while (item->item.value < value) {
-		item = item->next;
+	i = find_cmos_enum_pos(config_id, value);
 
-		if ((item == NULL) || (item->item.config_id != config_id))
-			return NULL;
-	}
+	if ((i == num_cmos_enums) || (cmos_enums[i].config_id != config_id) ||
+	    (cmos_enums[i].value != value))
+		return NULL;
 
-	return (item->item.value == value) ? &item->item : NULL;
+	return &cmos_enums[i];
 }
 
 /****************************************************************************
@@ -373,7 +303,7 @@ const cmos_enum_t *find_cmos_enum(unsigned config_id, unsigned long long value)
  ****************************************************************************/
 const cmos_enum_t *first_cmos_enum(void)
 {
-	return (cmos_enum_list == NULL) ? NULL : &cmos_enum_list->item;
+	return (num_cmos_enums == 0) ? NULL : &cmos_enums[0];
 }
 
 /****************************************************************************
@@ -384,11 +314,8 @@ const cmos_enum_t *first_cmos_enum(void)
  ****************************************************************************/
 const cmos_enum_t *next_cmos_enum(const cmos_enum_t * last)
 {
-	const cmos_enum_item_t *last_item, *next_item;
-
-	last_item = cmos_enum_to_const_item(last);
-	next_item = last_item->next;
-	return (next_item == NULL) ? NULL : &next_item->item;
+	last++;
+	return (last == &cmos_enums[num_cmos_enums]) ? NULL : last;
 }
 
 /****************************************************************************
@@ -399,10 +326,14 @@ const cmos_enum_t *next_cmos_enum(const cmos_enum_t * last)
  ****************************************************************************/
 const cmos_enum_t *first_cmos_enum_id(unsigned config_id)
 {
-	const cmos_enum_item_t *item;
+	unsigned i;
+
+	i = find_cmos_enum_pos(config_id, 0);
 
-	item = find_first_cmos_enum_id(config_id);
-	return (item == NULL) ? NULL : &item->item;
+	if ((i == num_cmos_enums) || (cmos_enums[i].config_id != config_id))
+		return NULL;
+
+	return &cmos_enums[i];
 }
 
 /****************************************************************************
@@ -413,11 +344,66 @@ const cmos_enum_t *first_cmos_enum_id(unsigned config_id)
  ****************************************************************************/
 const cmos_enum_t *next_cmos_enum_id(const cmos_enum_t * last)
 {
-	const cmos_enum_item_t *item;
+	const cmos_enum_t *next = last + 1;
 
-	item = cmos_enum_to_const_item(last)->next;
-	return ((item == NULL) || (item->item.config_id != last->config_id)) ?
-	    NULL : &item->item;
+	return ((next == &cmos_enums[num_cmos_enums]) ||
+		(next->config_id != last->config_id)) ? NULL : next;
+}
+
+/****************************************************************************
+ * load_cmos_layout
+ *
+ * Fill our empty internal repository with 'num_entries' entries and
+ * 'num_enums' enums that were stored in sorted order by a previous run, e.g.
+ * in a layout cache.  The arrays are checked to be sorted, to have no
+ * overlapping entries or duplicate enums, and to contain only terminated
+ * strings.  Return OK on success or LAYOUT_ENTRY_OVERLAP if a check fails,
+ * in which case the repository stays empty.
+ ****************************************************************************/
+int load_cmos_layout(const cmos_entry_t * entries, unsigned num_entries,
+		     const cmos_enum_t * enums, unsigned num_enums)
+{
+	unsigned i;
+
+	assert((num_cmos_entries == 0) && (num_cmos_enums == 0));
+
+	for (i = 0; i < num_entries; i++) {
+		if ((entries[i].length < 1) ||
+		    memchr(entries[i].name, '\0', sizeof(entries[i].name)) ==
+		    NULL)
+			return LAYOUT_ENTRY_OVERLAP;
+
+		if ((i > 0) && ((entries[i - 1].bit >= entries[i].bit) ||
+				entries_overlap(&entries[i - 1], &entries[i])))
+			return LAYOUT_ENTRY_OVERLAP;
+	}
+
+	for (i = 0; i < num_enums; i++) {
+		if (memchr(enums[i].text, '\0', sizeof(enums[i].text)) == NULL)
+			return LAYOUT_ENTRY_OVERLAP;
+
+		if ((i > 0) && ((enums[i - 1].config_id > enums[i].config_id) ||
+				((enums[i - 1].config_id == enums[i].config_id) &&
+				 (enums[i - 1].value >= enums[i].value))))
+			return LAYOUT_ENTRY_OVERLAP;
+	}
+
+	make_room((void **)&cmos_entries, &max_cmos_entries, num_entries,
+		  sizeof(*cmos_entries));
+	make_room((void **)&cmos_enums, &max_cmos_enums, num_enums,
+		  sizeof(*cmos_enums));
+
+	/* make_room() may return early with no array at all. */
+	if (num_entries)
+		memcpy(cmos_entries, entries, num_entries * sizeof(*entries));
+
+	if (num_enums)
+		memcpy(cmos_enums, enums, num_enums * sizeof(*enums));
+
+	num_cmos_entries = num_entries;
+	num_cmos_enums = num_enums;
+	cmos_name_index_size = 0;
+	return OK;
 }
 
 /****************************************************************************
@@ -521,19 +507,101 @@ static int areas_overlap(unsigned area_0_start, unsigned area_0_length,
 }
 
 /****************************************************************************
- * find_first_cmos_enum_id
+ * find_cmos_entry_pos
+ *
+ * Return the index of the first entry in our array whose 'bit' field is not
+ * less than 'bit', or the number of entries if there is none.
+ ****************************************************************************/
+static unsigned find_cmos_entry_pos(unsigned bit)
+{
+	unsigned lo = 0, hi = num_cmos_entries, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if (cmos_entries[mid].bit < bit)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/****************************************************************************
+ * find_cmos_enum_pos
  *
- * Return a pointer to the first item in our list of enums that matches
- * 'config_id'.  Return NULL if there is no matching enum.
+ * Return the index of the first enum in our array that does not sort before
+ * 'config_id' and 'value', or the number of enums if there is none.
  ****************************************************************************/
-static const cmos_enum_item_t *find_first_cmos_enum_id(unsigned config_id)
+static unsigned find_cmos_enum_pos(unsigned config_id,
+				   unsigned long long value)
 {
-	cmos_enum_item_t *item;
+	unsigned lo = 0, hi = num_cmos_enums, mid;
 
-	for (item = cmos_enum_list;
-	     (item != NULL) && (item->item.config_id < config_id);
-	     item = item->next) ;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
 
-	return ((item == NULL) || (item->item.config_id > config_id)) ?
-	    NULL : item;
+		if ((cmos_enums[mid].config_id < config_id) ||
+		    ((cmos_enums[mid].config_id == config_id) &&
+		     (cmos_enums[mid].value < value)))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/****************************************************************************
+ * hash_name
+ *
+ * Return a hash value (FNV-1a) for the CMOS parameter name 'name'.
+ ****************************************************************************/
+static unsigned hash_name(const char name[])
+{
+	unsigned h = 2166136261u;
+
+	while (*name) {
+		h ^= (unsigned char)*name++;
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+/****************************************************************************
+ * build_cmos_name_index
+ *
+ * Build the hash table used by find_cmos_entry().  The table is kept at most
+ * half full.  If several entries have the same name, the one with the lowest
+ * 'bit' is found.
+ ****************************************************************************/
+static void build_cmos_name_index(void)
+{
+	unsigned i, mask, slot;
+
+	for (cmos_name_index_size = 16;
+	     cmos_name_index_size < 2 * num_cmos_entries;
+	     cmos_name_index_size *= 2) ;
+
+	free(cmos_name_index);
+
+	if ((cmos_name_index = (unsigned *)calloc(cmos_name_index_size,
+				sizeof(*cmos_name_index))) == NULL)
+		out_of_memory();
+
+	mask = cmos_name_index_size - 1;
+
+	for (i = 0; i < num_cmos_entries; i++) {
+		for (slot = hash_name(cmos_entries[i].name) & mask;
+		     cmos_name_index[slot]; slot = (slot + 1) & mask) {
+			if (!strcmp(cmos_entries[cmos_name_index[slot] - 1].name,
+				    cmos_entries[i].name))
+				break;
+		}
+
+		if (!cmos_name_index[slot])
+			cmos_name_index[slot] = i + 1;
+	}
 }
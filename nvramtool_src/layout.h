@@ -102,6 +102,8 @@ const cmos_enum_t *first_cmos_enum(void);
 const cmos_enum_t *next_cmos_enum(const cmos_enum_t * last);
 const cmos_enum_t *first_cmos_enum_id(unsigned config_id);
 const cmos_enum_t *next_cmos_enum_id(const cmos_enum_t * last);
+int load_cmos_layout(const cmos_entry_t * entries, unsigned num_entries,
+		     const cmos_enum_t * enums, unsigned num_enums);
 int is_checksum_name(const char name[]);
 int checksum_layout_to_bytes(cmos_checksum_layout_t * layout);
 void checksum_layout_to_bits(cmos_checksum_layout_t * layout);
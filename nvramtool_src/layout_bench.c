@@ -0,0 +1,179 @@
+/*****************************************************************************\
+ * layout_bench.c
+ *****************************************************************************
+ *  This file is part of nvramtool, a utility for reading/writing coreboot
+ *  parameters and displaying information from the coreboot table.
+ *  For details, see http://coreboot.org/nvramtool.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License (as published by the
+ *  Free Software Foundation) version 2, dated June 1991.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the terms and
+ *  conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+\*****************************************************************************/
+
+/* Microbenchmark for the CMOS layout repository in layout.c.
+ *
+ * A synthetic layout with ENTRIES parameters (default 5000) is loaded the
+ * way the layout accessors do it, with four enum values per parameter.
+ * The layout is then checked, and every parameter and enum value is looked
+ * up ROUNDS times (default 100) the way -a, -r, -w and -p do.  With -s the
+ * entries are added in random order instead of ascending bit order.
+ *
+ * Example:
+ *   make layout_bench && ./layout_bench -n 10000 -r 50
+ */
+
+#include <getopt.h>
+#include <sys/time.h>
+
+#include "common.h"
+#include "layout.h"
+
+#define ENUMS_PER_ENTRY 4
+
+static double now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void make_entry(cmos_entry_t * e, unsigned i)
+{
+	/* Leave a gap of one bit between entries of varying length. */
+	e->bit = 10 * i;
+	e->length = 1 + (i % 8);
+	e->config = CMOS_ENTRY_ENUM;
+	e->config_id = i;
+	snprintf(e->name, sizeof(e->name), "option_%u", i);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned entries = 5000, rounds = 100, i, j, r, *order;
+	unsigned long long found = 0;
+	const cmos_entry_t *conflict, *e;
+	const cmos_enum_t *q;
+	cmos_entry_t entry;
+	cmos_enum_t cmos_enum;
+	int opt, shuffle = 0;
+	double t0, t1, t2;
+
+	while ((opt = getopt(argc, argv, "n:r:s")) != -1) {
+		switch (opt) {
+		case 'n':
+			entries = strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			rounds = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			shuffle = 1;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n ENTRIES] [-r ROUNDS] "
+				"[-s]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if ((order = malloc(entries * sizeof(*order))) == NULL)
+		out_of_memory();
+
+	for (i = 0; i < entries; i++)
+		order[i] = i;
+
+	if (shuffle) {
+		srand(1);
+
+		for (i = entries - 1; i > 0; i--) {
+			j = rand() % (i + 1);
+			r = order[i];
+			order[i] = order[j];
+			order[j] = r;
+		}
+	}
+
+	t0 = now();
+
+	for (i = 0; i < entries; i++) {
+		make_entry(&entry, order[i]);
+
+		if (add_cmos_entry(&entry, &conflict) != OK) {
+			fprintf(stderr, "%s: unexpected overlap\n", argv[0]);
+			return 1;
+		}
+
+		for (j = 0; j < ENUMS_PER_ENTRY; j++) {
+			cmos_enum.config_id = order[i];
+			cmos_enum.value = ENUMS_PER_ENTRY - 1 - j;
+			snprintf(cmos_enum.text, sizeof(cmos_enum.text),
+				 "value_%u", ENUMS_PER_ENTRY - 1 - j);
+
+			if (add_cmos_enum(&cmos_enum) != OK) {
+				fprintf(stderr, "%s: unexpected duplicate\n",
+					argv[0]);
+				return 1;
+			}
+		}
+	}
+
+	/* An entry starting at the last bit of another one must conflict. */
+	for (i = 0; i < entries; i++) {
+		make_entry(&entry, i);
+		entry.bit += entry.length - 1;
+
+		if (add_cmos_entry(&entry, &conflict) != LAYOUT_ENTRY_OVERLAP) {
+			fprintf(stderr, "%s: overlap not detected\n", argv[0]);
+			return 1;
+		}
+	}
+
+	t1 = now();
+
+	for (r = 0; r < rounds; r++) {
+		for (i = 0; i < entries; i++) {
+			make_entry(&entry, i);
+
+			if ((e = find_cmos_entry(entry.name)) == NULL ||
+			    e->bit != entry.bit) {
+				fprintf(stderr, "%s: %s not found\n", argv[0],
+					entry.name);
+				return 1;
+			}
+
+			for (q = first_cmos_enum_id(e->config_id); q != NULL;
+			     q = next_cmos_enum_id(q))
+				found++;
+
+			if (find_cmos_enum(e->config_id, i % ENUMS_PER_ENTRY))
+				found++;
+		}
+	}
+
+	t2 = now();
+
+	if (found != (unsigned long long)rounds * entries *
+	    (ENUMS_PER_ENTRY + 1)) {
+		fprintf(stderr, "%s: wrong number of enums found\n", argv[0]);
+		return 1;
+	}
+
+	printf("load:    %u entries, %u enums in %.3f ms\n", entries,
+	       entries * ENUMS_PER_ENTRY, (t1 - t0) * 1e3);
+	printf("lookup:  %u rounds in %.3f ms (%.1f ns per parameter)\n",
+	       rounds, (t2 - t1) * 1e3,
+	       (t2 - t1) * 1e9 / ((double)rounds * entries));
+
+	free(order);
+	return 0;
+}
@@ -35,6 +35,9 @@
 #ifndef __MINGW32__
 #include <sys/mman.h>
 #endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "common.h"
 #include "coreboot_tables.h"
 #include "ip_checksum.h"
@@ -112,6 +115,10 @@ static const struct lb_header *lbtable_scan(unsigned long start,
 					    unsigned long end,
 					    int *bad_header_count,
 					    int *bad_table_count);
+static unsigned long scan_signature(const char *mem, unsigned long len,
+				    uint32_t sig);
+static const struct lb_header *lbtable_from_hint(void);
+static void write_lbtable_hint(void);
 static const char *lbrec_tag_to_str(uint32_t tag);
 static void memory_print_fn(const struct lb_record *rec);
 static void mainboard_print_fn(const struct lb_record *rec);
@@ -268,6 +275,12 @@ unsigned int mapped_pages = 0;
 /* Pointer to coreboot table. */
 static const struct lb_header *lbtable = NULL;
 
+/* File remembering where the coreboot table was found last time */
+static const char *lbtable_hint_filename = NULL;
+
+/* Don't believe a hint file claiming a larger coreboot table than this */
+#define LBTABLE_HINT_MAX_BYTES 0x100000
+
 static const hexdump_format_t format =
 { 12, 4, "            ", " | ", " ", " | ", '.' };
 
@@ -294,12 +307,13 @@ static const hexdump_format_t format =
                         ((unsigned long) paddr) - low_phys_base)
 
 /****************************************************************************
- * map_pages
+ * try_map_pages
  *
  * Maps just enough pages to cover base_address + length
- * and updates affected variables
+ * and updates affected variables.  Return 0 on success or -1 if the pages
+ * can't be mapped.
  ****************************************************************************/
-static void map_pages(unsigned long base_address, unsigned long length)
+static int try_map_pages(unsigned long base_address, unsigned long length)
 {
 	unsigned long num_pages = (length +
 			(base_address & (getpagesize() - 1)) +
@@ -312,48 +326,83 @@ static void map_pages(unsigned long base_address, unsigned long length)
 
 	/* no need to do anything */
 	if ((low_phys_base == base_address) && (mapped_pages == num_pages)) {
-		return;
+		return 0;
 	}
 
 #ifdef __APPLE__
-	if (get_mmap(&low_phys_mem, &mapsize, &mapdescsize, fd) != EXIT_SUCCESS) {
-		fprintf(stderr,
-                "%s: Failed to mmap /dev/pmem at %lx: %s\n",
-                prog_name, base_address, strerror(errno));
-		exit(1);
-	}
+	if (get_mmap(&low_phys_mem, &mapsize, &mapdescsize, fd) != EXIT_SUCCESS)
+		return -1;
     low_phys_mem += base_address;
 #else
 	if (low_phys_mem) {
 		munmap((void *)low_phys_mem, mapped_pages << 12);
+		low_phys_mem = NULL;
+		low_phys_base = 0x1;
+		mapped_pages = 0;
 	}
 	if ((low_phys_mem = mmap(NULL, num_pages << 12, PROT_READ, MAP_SHARED, fd,
 		  (off_t) base_address)) == MAP_FAILED) {
+		low_phys_mem = NULL;
+		return -1;
+	}
+	mapped_pages = num_pages;
+#endif
+	low_phys_base = base_address;
+	return 0;
+}
+
+/****************************************************************************
+ * map_pages
+ *
+ * Like try_map_pages(), but exit if the pages can't be mapped.
+ ****************************************************************************/
+static void map_pages(unsigned long base_address, unsigned long length)
+{
+	if (try_map_pages(base_address, length)) {
+#ifdef __APPLE__
+		fprintf(stderr,
+                "%s: Failed to mmap /dev/pmem at %lx: %s\n",
+                prog_name, base_address, strerror(errno));
+#else
 		fprintf(stderr,
 			"%s: Failed to mmap /dev/mem at %lx: %s\n",
 			prog_name, base_address, strerror(errno));
+#endif
 		exit(1);
 	}
+}
+
+/****************************************************************************
+ * is_mapped
+ *
+ * Return nonzero if the 'length' bytes of physical memory at 'addr' are
+ * covered by the current mapping.
+ ****************************************************************************/
+static int is_mapped(unsigned long addr, unsigned long length)
+{
+#ifdef __APPLE__
+	/* map_pages() always maps all of memory here. */
+	return 1;
+#else
+	return low_phys_mem != NULL && addr >= low_phys_base &&
+	    length <= (mapped_pages << 12) &&
+	    addr - low_phys_base <= (mapped_pages << 12) - length;
 #endif
-	low_phys_base = base_address;
 }
 
 /****************************************************************************
- * get_lbtable
+ * open_phys_mem
  *
- * Find the coreboot table and set global variable lbtable to point to it.
+ * Open the device that gives us access to physical memory, unless this was
+ * done before.
  ****************************************************************************/
-void get_lbtable(void)
+static void open_phys_mem(void)
 {
-	int i, bad_header_count, bad_table_count, bad_headers, bad_tables;
+	static int is_open = 0;
 
-	if (lbtable != NULL)
+	if (is_open)
 		return;
 
-	/* The coreboot table is located in low physical memory, which may be
-	 * conveniently accessed by calling mmap() on /dev/mem.
-	 */
-
 #ifdef __APPLE__
 	if ((fd = open("/dev/pmem", O_RDONLY, 0)) < 0) {
 		fprintf(stderr, "%s: Can not open /dev/pmem for reading: %s\n",
@@ -367,6 +416,68 @@ void get_lbtable(void)
 		exit(1);
 	}
 #endif
+	is_open = 1;
+}
+
+/****************************************************************************
+ * map_phys_mem
+ *
+ * Map 'length' bytes of physical memory starting at 'addr' without looking
+ * for the coreboot table, and return a pointer to them, or NULL if they
+ * can't be mapped.  The mapping stays valid until the next call of this
+ * function or a scan for the coreboot table.
+ ****************************************************************************/
+const void *map_phys_mem(unsigned long addr, unsigned long length)
+{
+	open_phys_mem();
+
+	if (try_map_pages(addr, length))
+		return NULL;
+
+	return (const void *)phystov(addr);
+}
+
+/****************************************************************************
+ * lbrec_phys_addr
+ *
+ * Return the physical address of record 'rec' of the coreboot table.
+ ****************************************************************************/
+unsigned long lbrec_phys_addr(const struct lb_record *rec)
+{
+	return vtophys(rec);
+}
+
+/****************************************************************************
+ * set_lbtable_hint_filename
+ *
+ * Set the name of the file that remembers where the coreboot table was found
+ * last time.
+ ****************************************************************************/
+void set_lbtable_hint_filename(const char filename[])
+{
+	lbtable_hint_filename = filename;
+}
+
+/****************************************************************************
+ * get_lbtable
+ *
+ * Find the coreboot table and set global variable lbtable to point to it.
+ ****************************************************************************/
+void get_lbtable(void)
+{
+	int i, bad_header_count, bad_table_count, bad_headers, bad_tables;
+
+	if (lbtable != NULL)
+		return;
+
+	/* The coreboot table is located in low physical memory, which may be
+	 * conveniently accessed by calling mmap() on /dev/mem.
+	 */
+	open_phys_mem();
+
+	if (lbtable_hint_filename != NULL &&
+	    (lbtable = lbtable_from_hint()) != NULL)
+		return;
 
 	bad_header_count = 0;
 	bad_table_count = 0;
@@ -375,8 +486,12 @@ void get_lbtable(void)
 		lbtable = lbtable_scan(mem_ranges[i].start, mem_ranges[i].end,
 				       &bad_headers, &bad_tables);
 
-		if (lbtable != NULL)
-			return;	/* success: we found it! */
+		if (lbtable != NULL) {
+			/* success: we found it! */
+			if (lbtable_hint_filename != NULL)
+				write_lbtable_hint();
+			return;
+		}
 
 		bad_header_count += bad_headers;
 		bad_table_count += bad_tables;
@@ -548,33 +663,40 @@ static const struct lb_header *lbtable_scan(unsigned long start,
 	*bad_table_count = 0;
 
 	/* Look for signature.  Table is aligned on 16-byte boundary.  Therefore
-	 * only check every fourth 32-bit memory word.  As the loop is coded below,
-	 * this function will behave in a reasonable manner for ALL possible values
-	 * for 'start' and 'end': even weird boundary cases like 0x00000000 and
-	 * 0xffffffff on a 32-bit architecture.
+	 * only check every fourth 32-bit memory word.  The whole chunk is mapped
+	 * once and scanned by scan_signature().  It is only remapped if a
+	 * candidate table extends beyond it.
 	 */
 	map_pages(start, end - start);
 	for (p = start;
 	     (p <= end) &&
-	     (end - p >= (sizeof(uint32_t) - 1)); p += 4) {
-		if (*(uint32_t*)phystov(p) != sig)
-			continue;
+	     (end - p >= (sizeof(uint32_t) - 1)); p += 16) {
+		p += scan_signature((const char *)phystov(p), end - p + 1, sig);
+
+		if ((p > end) || (end - p < (sizeof(uint32_t) - 1)))
+			break;
 
 		/* We found a valid signature. */
 		table = (const struct lb_header *)phystov(p);
 
 		/* validate header checksum */
-		if (compute_ip_checksum((void *)table, sizeof(*table))) {
+		if (!is_mapped(p, sizeof(*table)) ||
+		    compute_ip_checksum((void *)table, sizeof(*table))) {
 			(*bad_header_count)++;
 			continue;
 		}
 
-		map_pages(p, table->table_bytes + sizeof(*table));
+		if (!is_mapped(p, table->table_bytes + sizeof(*table))) {
+			map_pages(p, table->table_bytes + sizeof(*table));
+			table = (const struct lb_header *)phystov(p);
+		}
+
 		/* validate table checksum */
 		if (table->table_checksum !=
 		    compute_ip_checksum(((char *)table) + sizeof(*table),
 					table->table_bytes)) {
 			(*bad_table_count)++;
+			map_pages(start, end - start);
 			continue;
 		}
 
@@ -595,6 +717,139 @@ static const struct lb_header *lbtable_scan(unsigned long start,
 	return NULL;
 }
 
+/****************************************************************************
+ * scan_signature
+ *
+ * Return the offset of the first 32-bit word at a multiple of 16 bytes into
+ * the 'len' bytes at 'mem' that equals 'sig', or 'len' if there is none.
+ ****************************************************************************/
+static unsigned long scan_signature(const char *mem, unsigned long len,
+				    uint32_t sig)
+{
+	unsigned long i = 0;
+	uint32_t word;
+#ifdef __SSE2__
+	const __m128i v = _mm_set1_epi32(sig);
+	__m128i lo, hi;
+	int mask;
+
+	/* Gather the first word of four 16-byte blocks into one vector and
+	 * compare them all at once.
+	 */
+	for (; len >= 64 && i <= len - 64; i += 64) {
+		lo = _mm_unpacklo_epi32(_mm_loadu_si128((const __m128i *)
+							(mem + i)),
+					_mm_loadu_si128((const __m128i *)
+							(mem + i + 16)));
+		hi = _mm_unpacklo_epi32(_mm_loadu_si128((const __m128i *)
+							(mem + i + 32)),
+					_mm_loadu_si128((const __m128i *)
+							(mem + i + 48)));
+		mask = _mm_movemask_epi8(_mm_cmpeq_epi32
+					 (_mm_unpacklo_epi64(lo, hi), v));
+
+		if (mask)
+			return i + 16 * (__builtin_ctz(mask) / 4);
+	}
+#endif
+
+	for (; len >= sizeof(word) && i <= len - sizeof(word); i += 16) {
+		memcpy(&word, mem + i, sizeof(word));
+
+		if (word == sig)
+			return i;
+	}
+
+	return len;
+}
+
+/****************************************************************************
+ * lbtable_from_hint
+ *
+ * Check whether the coreboot table is still where the hint file says it was
+ * found last time.  The hint holds the physical address of the table along
+ * with its size and checksum, so a single mapping is enough to verify it.
+ * Return a pointer to the table on success or NULL if the hint is missing
+ * or stale.
+ ****************************************************************************/
+static const struct lb_header *lbtable_from_hint(void)
+{
+	static const char signature[4] = { 'L', 'B', 'I', 'O' };
+	const struct lb_header *table;
+	unsigned long long addr;
+	unsigned bytes, checksum;
+	FILE *f;
+	int n;
+
+	if ((f = fopen(lbtable_hint_filename, "r")) == NULL)
+		return NULL;
+
+	n = fscanf(f, "%llx %x %x", &addr, &bytes, &checksum);
+	fclose(f);
+
+	if (n != 3 || bytes > LBTABLE_HINT_MAX_BYTES ||
+	    addr > (unsigned long)-1 - sizeof(*table) - bytes)
+		return NULL;
+
+	if (try_map_pages(addr, sizeof(*table) + bytes))
+		return NULL;
+
+	table = (const struct lb_header *)phystov(addr);
+
+	if (memcmp(table->signature, signature, sizeof(signature)) ||
+	    compute_ip_checksum((void *)table, sizeof(*table)) ||
+	    table->table_bytes != bytes || table->table_checksum != checksum ||
+	    compute_ip_checksum(((char *)table) + sizeof(*table),
+				table->table_bytes) != checksum)
+		return NULL;
+
+	/* The hint always names the final table, not a forwarder. */
+	lbtable = table;
+
+	if (find_lbrec(LB_TAG_FORWARD) != NULL)
+		table = NULL;
+
+	lbtable = NULL;
+	return table;
+}
+
+/****************************************************************************
+ * write_lbtable_hint
+ *
+ * Remember where the coreboot table was found in the hint file.  The hint
+ * is written to a temporary file which then replaces the old one.  A hint
+ * that can't be written is not fatal.
+ ****************************************************************************/
+static void write_lbtable_hint(void)
+{
+	char *tmp_filename;
+	FILE *f;
+
+	if ((tmp_filename = malloc(strlen(lbtable_hint_filename) + 5)) == NULL)
+		out_of_memory();
+
+	sprintf(tmp_filename, "%s.tmp", lbtable_hint_filename);
+
+	if ((f = fopen(tmp_filename, "w")) == NULL)
+		goto err;
+
+	fprintf(f, "0x%lx 0x%x 0x%x\n", vtophys(lbtable),
+		lbtable->table_bytes, lbtable->table_checksum);
+
+	if (fclose(f) || rename(tmp_filename, lbtable_hint_filename)) {
+		unlink(tmp_filename);
+		goto err;
+	}
+
+	free(tmp_filename);
+	return;
+
+      err:
+	fprintf(stderr, "%s: Warning: Can not write coreboot table hint %s: "
+		"%s\n", prog_name, lbtable_hint_filename, strerror(errno));
+	free(tmp_filename);
+}
+
 /****************************************************************************
  * find_lbrec
  *
@@ -33,6 +33,7 @@
 
 #include "common.h"
 
+void set_lbtable_hint_filename(const char filename[]);
 void get_lbtable(void);
 void get_layout_from_cmos_table(void);
 void get_layout_from_cbfs_file(void);
@@ -40,6 +41,8 @@ void dump_lbtable(void);
 void list_lbtable_choices(void);
 void list_lbtable_item(const char item[]);
 const struct lb_record *find_lbrec(uint32_t tag);
+const void *map_phys_mem(unsigned long addr, unsigned long length);
+unsigned long lbrec_phys_addr(const struct lb_record *rec);
 
 void process_layout(void);
 #endif				/* LBTABLE_H */
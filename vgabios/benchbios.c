@@ -0,0 +1,279 @@
+/*
+ * benchbios - measure x86emu throughput on option ROM images
+ *
+ * Every ROM given on the command line is run from its init entry point
+ * (C000:0003) over and over for a fixed amount of time, first with the
+ * plain fetch/dispatch loop and then with the block cache. Port I/O and
+ * software interrupts are stubbed out, so no hardware access, iopl or
+ * libpci is needed and the numbers only reflect emulator speed.
+ *
+ * -f selects how condition flags are computed: "lazy" (the default),
+ * "eager", or "check", which computes them both ways and reports every
+ * flag read where the two disagree.
+ *
+ * Example:
+ *   ./benchbios -t 5 ../i915tool/8086.0166.0000.0000.vga.rom \
+ *                    ../i915tool/1002.6779.8000.0200.vga.rom
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <string.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#define die(x) { perror(x); exit(1); }
+
+#include "test.h"
+
+/* The emulator's own header, for the block cache and flag mode controls */
+#include "x86emui.h"
+
+void X86EMU_setMemBase(void *base, size_t size);
+
+unsigned char biosmem[1024 * 1024];
+
+static volatile sig_atomic_t timed_out;
+static struct timeval deadline;
+
+/* Reads alternate between all zeroes and all ones, so that polling loops
+ * waiting for a status bit to go either way make progress.
+ */
+static u32 bench_in(void)
+{
+	static u32 val;
+
+	val = ~val;
+	return val;
+}
+
+static u8 bench_inb(X86EMU_pioAddr port)
+{
+	(void)port;
+	return bench_in();
+}
+
+static u16 bench_inw(X86EMU_pioAddr port)
+{
+	(void)port;
+	return bench_in();
+}
+
+static u32 bench_inl(X86EMU_pioAddr port)
+{
+	(void)port;
+	return bench_in();
+}
+
+static void bench_outb(X86EMU_pioAddr port, u8 val)
+{
+	(void)port;
+	(void)val;
+}
+
+static void bench_outw(X86EMU_pioAddr port, u16 val)
+{
+	(void)port;
+	(void)val;
+}
+
+static void bench_outl(X86EMU_pioAddr port, u32 val)
+{
+	(void)port;
+	(void)val;
+}
+
+static X86EMU_pioFuncs benchfuncs = {
+	bench_inb, bench_inw, bench_inl,
+	bench_outb, bench_outw, bench_outl
+};
+
+/* All software interrupts return immediately with the registers unchanged. */
+static void bench_int(int num)
+{
+	(void)num;
+}
+
+/* The interval timer keeps firing, so a halt that gets lost because
+ * X86EMU_exec clears the interrupt state on entry is simply repeated.
+ */
+static void bench_alarm(int sig)
+{
+	struct timeval now;
+
+	(void)sig;
+	gettimeofday(&now, 0);
+	if (timercmp(&now, &deadline, >=)) {
+		timed_out = 1;
+		X86EMU_halt_sys();
+	}
+}
+
+static void bench_push(u16 val)
+{
+	X86_SP -= 2;
+	wrw(((u32)X86_SS << 4) + X86_SP, val);
+}
+
+static double elapsed(struct timeval *start)
+{
+	struct timeval now;
+
+	gettimeofday(&now, 0);
+	return (now.tv_sec - start->tv_sec) +
+	    (now.tv_usec - start->tv_usec) / 1000000.0;
+}
+
+static void load_rom(unsigned char *rom, size_t size, u16 devfn)
+{
+	const char *date = "01/01/99";
+
+	memset(biosmem, 0, sizeof(biosmem));
+	memcpy(biosmem + 0xc0000, rom, size);
+	memcpy(biosmem + 0xffff5, date, strlen(date));
+	X86EMU_flushBlockCache();
+
+	memset(&M.x86, 0, sizeof(M.x86));
+	X86_AX = devfn;
+	X86_DX = 0x80;
+	X86_EIP = 0x0003;
+	X86_CS = 0xc000;
+	X86_SS = 0x0030;
+	X86_DS = 0x0040;
+	X86_SP = 0xfffe;
+	/* Same return path as testbios: a far return into hlt; hlt. */
+	bench_push(0xf4f4);
+	bench_push(X86_SS);
+	bench_push(X86_SP + 2);
+}
+
+static double run_rom(unsigned char *rom, size_t size, u16 devfn,
+		      double seconds, int cache, unsigned long *runs)
+{
+	struct itimerval it;
+	struct timeval start;
+	unsigned long long count;
+	double secs;
+
+	X86EMU_setBlockCache(cache);
+
+	gettimeofday(&start, 0);
+	deadline = start;
+	deadline.tv_sec += (long)seconds;
+	deadline.tv_usec += (long)((seconds - (long)seconds) * 1000000);
+	if (deadline.tv_usec >= 1000000) {
+		deadline.tv_sec++;
+		deadline.tv_usec -= 1000000;
+	}
+	timed_out = 0;
+
+	memset(&it, 0, sizeof(it));
+	it.it_interval.tv_usec = 10000;
+	it.it_value.tv_usec = 10000;
+	setitimer(ITIMER_REAL, &it, NULL);
+
+	count = X86EMU_getInstrCount();
+	*runs = 0;
+	while (!timed_out) {
+		load_rom(rom, size, devfn);
+		X86EMU_exec();
+		(*runs)++;
+	}
+	count = X86EMU_getInstrCount() - count;
+	secs = elapsed(&start);
+
+	memset(&it, 0, sizeof(it));
+	setitimer(ITIMER_REAL, &it, NULL);
+
+	return count / secs;
+}
+
+static void usage(char *name)
+{
+	printf("Usage: %s [-t seconds] [-d devfn] [-f eager|lazy|check] "
+	       "<romfile> ...\n", name);
+}
+
+int main(int argc, char **argv)
+{
+	X86EMU_intrFuncs intFuncs[256];
+	double seconds = 2.0, plain, cached;
+	unsigned long plain_runs, cached_runs;
+	unsigned char *rom;
+	struct stat st;
+	u16 devfn = 0x10;
+	int i, c, fd, flags = X86EMU_FLAGS_LAZY;
+
+	while ((c = getopt(argc, argv, "t:d:f:h")) != -1) {
+		switch (c) {
+		case 't':
+			seconds = strtod(optarg, 0);
+			break;
+		case 'd':
+			devfn = strtol(optarg, 0, 0);
+			break;
+		case 'f':
+			if (!strcmp(optarg, "eager"))
+				flags = X86EMU_FLAGS_EAGER;
+			else if (!strcmp(optarg, "lazy"))
+				flags = X86EMU_FLAGS_LAZY;
+			else if (!strcmp(optarg, "check"))
+				flags = X86EMU_FLAGS_CHECK;
+			else {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+	if (optind >= argc) {
+		printf("Filename missing.\n");
+		usage(argv[0]);
+		return 1;
+	}
+
+	X86EMU_setMemBase(biosmem, sizeof(biosmem));
+	X86EMU_setupPioFuncs(&benchfuncs);
+	for (i = 0; i < 256; i++)
+		intFuncs[i] = bench_int;
+	X86EMU_setupIntrFuncs(intFuncs);
+	X86EMU_setFlagMode(flags);
+	signal(SIGALRM, bench_alarm);
+
+	printf("%-40s %14s %14s %8s\n", "rom", "plain ips", "cached ips",
+	       "speedup");
+	for (; optind < argc; optind++) {
+		fd = open(argv[optind], O_RDONLY);
+		if (fd < 0 || fstat(fd, &st) < 0)
+			die(argv[optind]);
+		if (st.st_size > 0x30000)
+			st.st_size = 0x30000;
+		rom = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (rom == MAP_FAILED)
+			die("mmap");
+		close(fd);
+
+		plain = run_rom(rom, st.st_size, devfn, seconds, 0, &plain_runs);
+		cached = run_rom(rom, st.st_size, devfn, seconds, 1, &cached_runs);
+		printf("%-40s %14.0f %14.0f %7.2fx\n", argv[optind], plain,
+		       cached, cached / plain);
+		printf("%-40s %14lu %14lu\n", "  (runs)", plain_runs,
+		       cached_runs);
+
+		munmap(rom, st.st_size);
+	}
+	if (flags == X86EMU_FLAGS_CHECK) {
+		printf("%lu flag mismatches\n", X86EMU_getFlagErrors());
+		return X86EMU_getFlagErrors() != 0;
+	}
+	return 0;
+}
@@ -0,0 +1,214 @@
+/****************************************************************************
+*
+*                       Realmode X86 Emulator Library
+*
+*               Copyright (C) 1991-2004 SciTech Software, Inc.
+*                    Copyright (C) David Mosberger-Tang
+*                      Copyright (C) 1999 Egbert Eich
+*
+*  ========================================================================
+*
+*  Permission to use, copy, modify, distribute, and sell this software and
+*  its documentation for any purpose is hereby granted without fee,
+*  provided that the above copyright notice appear in all copies and that
+*  both that copyright notice and this permission notice appear in
+*  supporting documentation, and that the name of the authors not be used
+*  in advertising or publicity pertaining to distribution of the software
+*  without specific, written prior permission.  The authors makes no
+*  representations about the suitability of this software for any purpose.
+*  It is provided "as is" without express or implied warranty.
+*
+*  THE AUTHORS DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+*  INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+*  EVENT SHALL THE AUTHORS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+*  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+*  USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+*  OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+*  PERFORMANCE OF THIS SOFTWARE.
+*
+*  ========================================================================
+*
+* Language:     ANSI C
+* Environment:  Any
+* Developer:    Kendall Bennett
+*
+* Description:  This file implements the basic block translation cache.
+*               A block is a run of instructions starting at a given CS:IP,
+*               ending at the first control transfer that was taken. It is
+*               recorded by X86EMU_exec the first time the code runs: every
+*               instruction keeps its handler, the decoded ModR/M byte and
+*               the SIB byte, displacement and immediates in the order the
+*               handler fetched them. When the block runs again the fetch
+*               functions hand those back instead of reading guest memory.
+*
+*               X86EMU_exec checks after every instruction that CS:IP ended
+*               up where the block expects it, and falls back to a lookup
+*               otherwise. Writes to a page holding cached code bump that
+*               page's generation, which retires all blocks on it.
+*
+****************************************************************************/
+
+#include "x86emui.h"
+
+/*------------------------- Global Variables ------------------------------*/
+
+int     x86emu_blkcache_on = 1;
+u32     x86emu_code_gen;
+u8      x86emu_code_page[X86EMU_CODE_PAGES + 1];
+
+/*----------------------------- Implementation ----------------------------*/
+
+#define BLOCK_TAB_SIZE  2048
+#define BLOCK_HASH(lin) (((lin) ^ ((lin) >> 11)) & (BLOCK_TAB_SIZE - 1))
+
+/* Longest instruction the x86 allows */
+#define INSN_MAX_LEN    15
+
+static X86EMU_block block_tab[BLOCK_TAB_SIZE];
+static u32          page_gen[X86EMU_CODE_PAGES + 1];
+
+/****************************************************************************
+PARAMETERS:
+cs      - Code segment
+ip      - Instruction pointer
+
+RETURNS:
+The block starting at cs:ip, or NULL if there is none or code it was
+recorded from has been written since.
+****************************************************************************/
+X86EMU_block *x86emu_block_lookup(
+    u16 cs,
+    u16 ip)
+{
+    u32 lin = ((u32)cs << 4) + ip;
+    X86EMU_block *blk;
+
+    if (lin >= X86EMU_CODE_LIMIT)
+        return NULL;
+    blk = &block_tab[BLOCK_HASH(lin)];
+    if (blk->ninsn && blk->cs == cs && blk->ip == ip &&
+        blk->gen[0] == page_gen[blk->page[0]] &&
+        blk->gen[1] == page_gen[blk->page[1]])
+        return blk;
+    return NULL;
+}
+
+/****************************************************************************
+PARAMETERS:
+cs      - Code segment
+ip      - Instruction pointer
+
+RETURNS:
+An empty block for cs:ip, replacing whatever was cached in its slot, or
+NULL if code at cs:ip cannot be cached.
+****************************************************************************/
+X86EMU_block *x86emu_block_new(
+    u16 cs,
+    u16 ip)
+{
+    u32 lin = ((u32)cs << 4) + ip;
+    X86EMU_block *blk;
+
+    if (lin >= X86EMU_CODE_LIMIT)
+        return NULL;
+    blk = &block_tab[BLOCK_HASH(lin)];
+    blk->cs = cs;
+    blk->ip = ip;
+    blk->ninsn = 0;
+    blk->link[0] = blk->link[1] = NULL;
+    blk->page[0] = blk->page[1] = lin >> X86EMU_CODE_PAGE_SHIFT;
+    blk->gen[0] = blk->gen[1] = page_gen[blk->page[0]];
+    x86emu_code_page[blk->page[0]] = 1;
+    return blk;
+}
+
+/****************************************************************************
+PARAMETERS:
+blk     - Block being recorded
+lin     - Linear address of the next instruction
+
+RETURNS:
+Non-zero if the instruction at lin can be added to the block.
+
+REMARKS:
+Marks the pages the instruction may be fetched from as code pages before
+it runs, so that it cannot change its own bytes unnoticed. Only code on
+pages backed by host memory is cached, and a block spans at most two.
+****************************************************************************/
+int x86emu_block_code(
+    X86EMU_block *blk,
+    u32 lin)
+{
+    uint last = (lin + INSN_MAX_LEN - 1) >> X86EMU_CODE_PAGE_SHIFT;
+
+    if (blk->ninsn == X86EMU_BLOCK_INSNS ||
+        lin + INSN_MAX_LEN > X86EMU_CODE_LIMIT ||
+        last > (uint)blk->page[0] + 1 ||
+        !x86emu_mem_ptr(lin, 1) ||
+        !x86emu_mem_ptr(lin + INSN_MAX_LEN - 1, 1))
+        return 0;
+    if (blk->gen[0] != page_gen[blk->page[0]] ||
+        blk->gen[1] != page_gen[blk->page[1]])
+        return 0;
+    if (last != blk->page[1]) {
+        blk->page[1] = last;
+        blk->gen[1] = page_gen[last];
+        x86emu_code_page[last] = 1;
+    }
+    return 1;
+}
+
+/****************************************************************************
+PARAMETERS:
+addr    - Linear address written to
+size    - Size of the write in bytes
+
+REMARKS:
+Retires all blocks on the code pages touched by a guest memory write.
+****************************************************************************/
+void x86emu_code_written(
+    u32 addr,
+    int size)
+{
+    uint page = addr >> X86EMU_CODE_PAGE_SHIFT;
+    uint last = (addr + size - 1) >> X86EMU_CODE_PAGE_SHIFT;
+
+    for (; page <= last && page <= X86EMU_CODE_PAGES; page++) {
+        if (x86emu_code_page[page]) {
+            x86emu_code_page[page] = 0;
+            page_gen[page]++;
+            x86emu_code_gen++;
+        }
+    }
+}
+
+/****************************************************************************
+PARAMETERS:
+enable  - Non-zero to run guest code through the block cache
+
+REMARKS:
+Switches between the block cache and the plain fetch/dispatch loop. The
+change takes effect with the next call to X86EMU_exec.
+****************************************************************************/
+void X86EMU_setBlockCache(
+    int enable)
+{
+    x86emu_blkcache_on = enable;
+    X86EMU_flushBlockCache();
+}
+
+/****************************************************************************
+REMARKS:
+Drops all cached blocks. Must be called when guest memory is modified
+behind the emulator's back, e.g. when a ROM image is copied in directly.
+****************************************************************************/
+void X86EMU_flushBlockCache(void)
+{
+    uint page;
+
+    for (page = 0; page <= X86EMU_CODE_PAGES; page++) {
+        x86emu_code_page[page] = 0;
+        page_gen[page]++;
+    }
+    x86emu_code_gen++;
+}
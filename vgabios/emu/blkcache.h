@@ -0,0 +1,119 @@
+/****************************************************************************
+*
+*						Realmode X86 Emulator Library
+*
+*            	Copyright (C) 1996-1999 SciTech Software, Inc.
+* 				     Copyright (C) David Mosberger-Tang
+* 					   Copyright (C) 1999 Egbert Eich
+*
+*  ========================================================================
+*
+*  Permission to use, copy, modify, distribute, and sell this software and
+*  its documentation for any purpose is hereby granted without fee,
+*  provided that the above copyright notice appear in all copies and that
+*  both that copyright notice and this permission notice appear in
+*  supporting documentation, and that the name of the authors not be used
+*  in advertising or publicity pertaining to distribution of the software
+*  without specific, written prior permission.  The authors makes no
+*  representations about the suitability of this software for any purpose.
+*  It is provided "as is" without express or implied warranty.
+*
+*  THE AUTHORS DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+*  INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+*  EVENT SHALL THE AUTHORS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+*  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+*  USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+*  OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+*  PERFORMANCE OF THIS SOFTWARE.
+*
+*  ========================================================================
+*
+* Language:		ANSI C
+* Environment:	Any
+* Developer:    Kendall Bennett
+*
+* Description:  Header file for the basic block translation cache.
+*
+****************************************************************************/
+
+#ifndef __X86EMU_BLKCACHE_H
+#define __X86EMU_BLKCACHE_H
+
+/*---------------------- Macros and type definitions ----------------------*/
+
+/* Only code on pages of the guest memory map that are backed by host
+ * memory is cached.
+ */
+#define X86EMU_CODE_LIMIT		X86EMU_MAP_LIMIT
+#define X86EMU_CODE_PAGE_SHIFT	X86EMU_PAGE_SHIFT
+#define X86EMU_CODE_PAGES		(X86EMU_CODE_LIMIT >> X86EMU_CODE_PAGE_SHIFT)
+
+#define X86EMU_BLOCK_INSNS		16
+
+/* An instruction fetches at most a SIB byte, a displacement and an
+ * immediate, or the two parts of a far pointer or of ENTER's operands.
+ */
+#define X86EMU_INSN_IMMS		3
+
+/* Prefixes that change which operands an instruction fetches. Blocks are
+ * recorded without them, so they are only entered when none is pending.
+ */
+#define X86EMU_FETCH_PREFIXES	(SYSMODE_PREFIX_DATA | SYSMODE_PREFIX_ADDR)
+
+/* One pre-decoded instruction. Prefixes are instructions of their own,
+ * just like they are for the interpreter loop, and two byte opcodes go
+ * straight to their x86emu_optab2 handler.
+ */
+typedef struct {
+	void	(*op)(u8 op1);		/* handler from x86emu_optab or x86emu_optab2 */
+	u16		ip;					/* offset of the opcode byte */
+	u16		next;				/* offset of the following instruction */
+	u8		op1;
+	u8		mod, regh, regl;	/* decoded ModR/M byte, if there is one */
+	u8		nimm;
+	u32		imm[X86EMU_INSN_IMMS];	/* SIB, displacement and immediates */
+} X86EMU_insn;
+
+typedef struct X86EMU_block {
+	u16		cs;
+	u16		ip;
+	u16		page[2];			/* first and last code page used */
+	u32		gen[2];				/* page generations at translation */
+	int		ninsn;
+	struct X86EMU_block *link[2];	/* last two successor blocks */
+	u32		link_gen;			/* x86emu_code_gen when linked */
+	X86EMU_insn insn[X86EMU_BLOCK_INSNS];
+} X86EMU_block;
+
+/* Called from the memory write functions; cheap unless the write hits a
+ * page that holds cached code.
+ */
+#define X86EMU_CHECK_CODE_WRITE(addr,size)								\
+	if ((addr) < X86EMU_CODE_LIMIT &&									\
+		(x86emu_code_page[(addr) >> X86EMU_CODE_PAGE_SHIFT] |			\
+		 x86emu_code_page[((addr) + (size) - 1) >> X86EMU_CODE_PAGE_SHIFT])) \
+		x86emu_code_written(addr, size)
+
+/*-------------------------- Function Prototypes --------------------------*/
+
+#ifdef  __cplusplus
+extern "C" {            			/* Use "C" linkage when in C++ mode */
+#endif
+
+extern int	x86emu_blkcache_on;
+extern u32	x86emu_code_gen;
+extern u8	x86emu_code_page[X86EMU_CODE_PAGES + 1];
+
+X86EMU_block *x86emu_block_lookup(u16 cs, u16 ip);
+X86EMU_block *x86emu_block_new(u16 cs, u16 ip);
+int		x86emu_block_code(X86EMU_block *blk, u32 lin);
+void	x86emu_code_written(u32 addr, int size);
+
+void	X86EMU_setBlockCache(int enable);
+void	X86EMU_flushBlockCache(void);
+
+#ifdef  __cplusplus
+}                       			/* End of "C" linkage for C++   	*/
+#endif
+
+#endif /* __X86EMU_BLKCACHE_H */
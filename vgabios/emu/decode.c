@@ -41,6 +41,25 @@
 
 #include "x86emui.h"
 
+/*------------------------- Global Variables ------------------------------*/
+
+static unsigned long long x86emu_instr_count;
+
+/* Set while X86EMU_exec runs with the default memory functions. Operand
+ * fetches from flat pages then read host memory directly instead of going
+ * through (*sys_rdX).
+ */
+static int fetch_direct;
+
+/* While a block is recorded, the instruction being run collects its
+ * operands here. While a cached block runs, the fetch functions return
+ * the operands of its current instruction instead of reading memory.
+ */
+static X86EMU_insn *fetch_record;
+static const X86EMU_insn *fetch_replay;
+static const u32 *fetch_replay_imm;
+static int fetch_overflow;
+
 /*----------------------------- Implementation ----------------------------*/
 
 /****************************************************************************
@@ -53,6 +72,7 @@ static void x86emu_intr_handle(void)
 
     if (M.x86.intr & INTR_SYNCH) {
         intno = M.x86.intno;
+        x86emu_sync_flags(F_LAZY);
         if (_X86EMU_intrTab[intno]) {
             (*_X86EMU_intrTab[intno])(intno);
         } else {
@@ -85,6 +105,140 @@ void x86emu_intr_raise(
     M.x86.intr |= INTR_SYNCH;
 }
 
+/****************************************************************************
+PARAMETERS:
+val     - Operand just fetched from the instruction queue
+
+REMARKS:
+Adds an operand to the instruction being recorded. An instruction with more
+operands than fit is left out of its block.
+****************************************************************************/
+static void record_imm(
+    u32 val)
+{
+    if (fetch_record->nimm == X86EMU_INSN_IMMS)
+        fetch_overflow = 1;
+    else
+        fetch_record->imm[fetch_record->nimm++] = val;
+    fetch_record->next = M.x86.R_IP;
+}
+
+/****************************************************************************
+REMARKS:
+Records a new block at the current CS:IP while running it. We return as
+soon as control leaves the straight line code or an instruction cannot
+be cached; what was recorded up to that point is kept.
+****************************************************************************/
+static void x86emu_record_block(void)
+{
+    X86EMU_block *blk;
+    X86EMU_insn *insn;
+    u16 cs = M.x86.R_CS;
+    u32 lin;
+    u8 op1;
+
+    blk = x86emu_block_new(cs, M.x86.R_IP);
+    for (;;) {
+        lin = ((u32)cs << 4) + M.x86.R_IP;
+        if (!blk || !x86emu_block_code(blk, lin)) {
+            op1 = (*sys_rdb)(lin);
+            M.x86.R_IP++;
+            x86emu_instr_count++;
+            (*x86emu_optab[op1])(op1);
+            return;
+        }
+        insn = &blk->insn[blk->ninsn];
+        insn->ip = M.x86.R_IP;
+        insn->op1 = op1 = *x86emu_mem_ptr(lin, 1);
+        insn->op = x86emu_optab[op1];
+        insn->nimm = 0;
+        fetch_record = insn;
+        fetch_overflow = 0;
+        M.x86.R_IP++;
+        insn->next = M.x86.R_IP;
+        x86emu_instr_count++;
+        (*insn->op)(op1);
+        fetch_record = NULL;
+        if (fetch_overflow)
+            return;
+
+        /* The second opcode byte was recorded as an immediate */
+        if (op1 == 0x0f) {
+            insn->op1 = (u8)insn->imm[0];
+            insn->op = x86emu_optab2[insn->op1];
+            insn->nimm--;
+            memmove(insn->imm, insn->imm + 1,
+                    insn->nimm * sizeof(insn->imm[0]));
+        }
+        blk->ninsn++;
+        if (M.x86.intr || M.x86.R_CS != cs ||
+            M.x86.R_IP != insn->next || insn->next < insn->ip)
+            return;
+    }
+}
+
+/****************************************************************************
+REMARKS:
+Executes the cached block at the current CS:IP, or records one if there is
+none. We return to the main loop as soon as control leaves the block, guest
+code gets overwritten or an interrupt is pending.
+****************************************************************************/
+static void x86emu_exec_block(void)
+{
+    X86EMU_block *blk, *next;
+    const X86EMU_insn *insn, *end;
+    u32 gen = x86emu_code_gen;
+
+    blk = x86emu_block_lookup(M.x86.R_CS, M.x86.R_IP);
+    if (!blk) {
+        x86emu_record_block();
+        return;
+    }
+    for (;;) {
+        insn = blk->insn;
+        end = insn + blk->ninsn;
+        for (;;) {
+            fetch_replay = insn;
+            fetch_replay_imm = insn->imm;
+            M.x86.R_IP = insn->next;
+            x86emu_instr_count++;
+            (*insn->op)(insn->op1);
+            if (++insn == end)
+                break;
+            if (M.x86.intr || gen != x86emu_code_gen ||
+                M.x86.R_IP != insn->ip || M.x86.R_CS != blk->cs)
+                goto out;
+        }
+        if (M.x86.intr || gen != x86emu_code_gen ||
+            (M.x86.mode & X86EMU_FETCH_PREFIXES))
+            break;
+
+        /* Follow the links to the last two successors before falling
+         * back to the hash table. A link is only trusted as long as no
+         * code page has been written since it was made.
+         */
+        next = blk->link[0];
+        if (!next || blk->link_gen != gen ||
+            next->cs != M.x86.R_CS || next->ip != M.x86.R_IP) {
+            next = blk->link[1];
+            if (!next || blk->link_gen != gen ||
+                next->cs != M.x86.R_CS || next->ip != M.x86.R_IP) {
+                next = x86emu_block_lookup(M.x86.R_CS, M.x86.R_IP);
+                if (!next)
+                    break;
+                if (blk->link_gen != gen)
+                    blk->link[0] = NULL;
+                blk->link[1] = blk->link[0];
+                blk->link[0] = next;
+                blk->link_gen = gen;
+            }
+        }
+        blk = next;
+    }
+out:
+    fetch_replay = NULL;
+}
+
 /****************************************************************************
 REMARKS:
 Main execution loop for the emulator. We return from here when the system
@@ -94,10 +248,21 @@ original real mode call.
 void X86EMU_exec(void)
 {
     u8 op1;
+    int blocks;
 
     M.x86.intr = 0;
     DB(x86emu_end_instr();)
 
+    fetch_direct = sys_rdb == rdb && sys_rdw == rdw && sys_rdl == rdl;
+    DB( if (M.x86.debug)
+            fetch_direct = 0;)
+
+    /* Blocks are only invalidated by writes through the default memory
+     * functions.
+     */
+    blocks = x86emu_blkcache_on && fetch_direct &&
+             sys_wrb == wrb && sys_wrw == wrw && sys_wrl == wrl;
+
     for (;;) {
 DB(     if (CHECK_IP_FETCH())
             x86emu_check_ip_access();)
@@ -114,6 +279,7 @@ DB(             if (M.x86.R_SP != 0) {
                     if (M.x86.debug)
                         printf("Service completed successfully\n");
                     })
+                x86emu_sync_flags(F_LAZY);
                 return;
             }
             if (((M.x86.intr & INTR_SYNCH) && (M.x86.intno == 0 || M.x86.intno == 2)) ||
@@ -121,7 +287,12 @@ DB(             if (M.x86.R_SP != 0) {
                 x86emu_intr_handle();
             }
         }
+        if (blocks && !(M.x86.mode & X86EMU_FETCH_PREFIXES)) {
+            x86emu_exec_block();
+            continue;
+        }
         op1 = (*sys_rdb)(((u32)M.x86.R_CS << 4) + (M.x86.R_IP++));
+        x86emu_instr_count++;
         (*x86emu_optab[op1])(op1);
         //if (M.x86.debug & DEBUG_EXIT) {
         //    M.x86.debug &= ~DEBUG_EXIT;
@@ -130,6 +301,16 @@ DB(             if (M.x86.R_SP != 0) {
     }
 }
 
+/****************************************************************************
+RETURNS:
+Number of instructions executed since the emulator was started. Prefixes
+are counted as instructions of their own.
+****************************************************************************/
+unsigned long long X86EMU_getInstrCount(void)
+{
+    return x86emu_instr_count;
+}
+
 /****************************************************************************
 REMARKS:
 Halts the system by setting the halted system flag.
@@ -157,14 +338,31 @@ void fetch_decode_modrm(
     int *regl)
 {
     int fetched;
+    u32 addr;
 
+    if (fetch_replay) {
+        *mod  = fetch_replay->mod;
+        *regh = fetch_replay->regh;
+        *regl = fetch_replay->regl;
+        return;
+    }
 DB( if (CHECK_IP_FETCH())
         x86emu_check_ip_access();)
-    fetched = (*sys_rdb)(((u32)M.x86.R_CS << 4) + (M.x86.R_IP++));
+    addr = ((u32)M.x86.R_CS << 4) + (M.x86.R_IP++);
+    if (fetch_direct && X86EMU_MEM_FLAT(addr, 1))
+        fetched = *(u8 *)(M.mem_base + addr);
+    else
+        fetched = (*sys_rdb)(addr);
     INC_DECODED_INST_LEN(1);
     *mod  = (fetched >> 6) & 0x03;
     *regh = (fetched >> 3) & 0x07;
     *regl = (fetched >> 0) & 0x07;
+    if (fetch_record) {
+        fetch_record->mod  = *mod;
+        fetch_record->regh = *regh;
+        fetch_record->regl = *regl;
+        fetch_record->next = M.x86.R_IP;
+    }
 }
 
 /****************************************************************************
@@ -180,11 +378,20 @@ NOTE: Do not inline this function, as (*sys_rdb) is already inline!
 u8 fetch_byte_imm(void)
 {
     u8 fetched;
+    u32 addr;
 
+    if (fetch_replay)
+        return (u8)*fetch_replay_imm++;
 DB( if (CHECK_IP_FETCH())
         x86emu_check_ip_access();)
-    fetched = (*sys_rdb)(((u32)M.x86.R_CS << 4) + (M.x86.R_IP++));
+    addr = ((u32)M.x86.R_CS << 4) + (M.x86.R_IP++);
+    if (fetch_direct && X86EMU_MEM_FLAT(addr, 1))
+        fetched = *(u8 *)(M.mem_base + addr);
+    else
+        fetched = (*sys_rdb)(addr);
     INC_DECODED_INST_LEN(1);
+    if (fetch_record)
+        record_imm(fetched);
     return fetched;
 }
 
@@ -201,12 +408,21 @@ NOTE: Do not inline this function, as (*sys_rdw) is already inline!
 u16 fetch_word_imm(void)
 {
     u16 fetched;
+    u32 addr;
 
+    if (fetch_replay)
+        return (u16)*fetch_replay_imm++;
 DB( if (CHECK_IP_FETCH())
         x86emu_check_ip_access();)
-    fetched = (*sys_rdw)(((u32)M.x86.R_CS << 4) + (M.x86.R_IP));
+    addr = ((u32)M.x86.R_CS << 4) + (M.x86.R_IP);
+    if (fetch_direct && X86EMU_MEM_FLAT(addr, 2))
+        fetched = *(u16 *)(M.mem_base + addr);
+    else
+        fetched = (*sys_rdw)(addr);
     M.x86.R_IP += 2;
     INC_DECODED_INST_LEN(2);
+    if (fetch_record)
+        record_imm(fetched);
     return fetched;
 }
 
@@ -223,12 +439,21 @@ NOTE: Do not inline this function, as (*sys_rdw) is already inline!
 u32 fetch_long_imm(void)
 {
     u32 fetched;
+    u32 addr;
 
+    if (fetch_replay)
+        return (u32)*fetch_replay_imm++;
 DB( if (CHECK_IP_FETCH())
         x86emu_check_ip_access();)
-    fetched = (*sys_rdl)(((u32)M.x86.R_CS << 4) + (M.x86.R_IP));
+    addr = ((u32)M.x86.R_CS << 4) + (M.x86.R_IP);
+    if (fetch_direct && X86EMU_MEM_FLAT(addr, 4))
+        fetched = *(u32 *)(M.mem_base + addr);
+    else
+        fetched = (*sys_rdl)(addr);
     M.x86.R_IP += 4;
     INC_DECODED_INST_LEN(4);
+    if (fetch_record)
+        record_imm(fetched);
     return fetched;
 }
 
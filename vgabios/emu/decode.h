@@ -56,6 +56,7 @@ extern "C" {            			/* Use "C" linkage when in C++ mode */
 #endif
 
 void 	x86emu_intr_raise (u8 type);
+unsigned long long X86EMU_getInstrCount (void);
 void    fetch_decode_modrm (int *mod,int *regh,int *regl);
 u8      fetch_byte_imm (void);
 u16     fetch_word_imm (void);
@@ -0,0 +1,107 @@
+/****************************************************************************
+*
+*						Realmode X86 Emulator Library
+*
+*            	Copyright (C) 1996-1999 SciTech Software, Inc.
+* 				     Copyright (C) David Mosberger-Tang
+* 					   Copyright (C) 1999 Egbert Eich
+*
+*  ========================================================================
+*
+*  Permission to use, copy, modify, distribute, and sell this software and
+*  its documentation for any purpose is hereby granted without fee,
+*  provided that the above copyright notice appear in all copies and that
+*  both that copyright notice and this permission notice appear in
+*  supporting documentation, and that the name of the authors not be used
+*  in advertising or publicity pertaining to distribution of the software
+*  without specific, written prior permission.  The authors makes no
+*  representations about the suitability of this software for any purpose.
+*  It is provided "as is" without express or implied warranty.
+*
+*  THE AUTHORS DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+*  INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+*  EVENT SHALL THE AUTHORS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+*  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+*  USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+*  OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+*  PERFORMANCE OF THIS SOFTWARE.
+*
+*  ========================================================================
+*
+* Language:		ANSI C
+* Environment:	Any
+* Developer:    Kendall Bennett
+*
+* Description:  Header file for the page granular guest memory map.
+*
+****************************************************************************/
+
+#ifndef __X86EMU_MEMMAP_H
+#define __X86EMU_MEMMAP_H
+
+/*---------------------- Macros and type definitions ----------------------*/
+
+#define X86EMU_PAGE_SHIFT		12
+#define X86EMU_PAGE_SIZE		(1 << X86EMU_PAGE_SHIFT)
+#define X86EMU_PAGE_MASK		(X86EMU_PAGE_SIZE - 1)
+
+/* The map covers everything real mode can reach, including the HMA.
+ * Accesses above it always take the flat M.mem_base path.
+ */
+#define X86EMU_MAP_LIMIT		0x110000
+#define X86EMU_MAP_PAGES		(X86EMU_MAP_LIMIT >> X86EMU_PAGE_SHIFT)
+
+/* A page is either backed by host memory, handled by callbacks, or, with
+ * both fields NULL, falls back to the flat M.mem_base buffer.
+ */
+typedef struct {
+	u8				*host;		/* host address of the page */
+	X86EMU_memFuncs	*mmio;		/* handlers, called with guest addresses */
+} X86EMU_memPage;
+
+/*-------------------------- Function Prototypes --------------------------*/
+
+#ifdef  __cplusplus
+extern "C" {            			/* Use "C" linkage when in C++ mode */
+#endif
+
+extern X86EMU_memPage x86emu_mem_map[X86EMU_MAP_PAGES];
+extern u8	x86emu_mem_flat[X86EMU_MAP_PAGES];
+
+void	X86EMU_mapMemory(u32 base, u32 size, void *host);
+void	X86EMU_mapMMIO(u32 base, u32 size, X86EMU_memFuncs *funcs);
+void	X86EMU_unmapMemory(u32 base, u32 size);
+
+/* True if size bytes at addr are on one page that sits at its usual place
+ * in the flat buffer at M.mem_base. This only costs a well predicted branch
+ * on x86emu_mem_flat, so the load itself does not have to wait for the
+ * table lookup.
+ */
+#define X86EMU_MEM_FLAT(addr,size)											\
+	((addr) < X86EMU_MAP_LIMIT &&											\
+	 ((addr) & X86EMU_PAGE_MASK) <= (u32)(X86EMU_PAGE_SIZE - (size)) &&		\
+	 x86emu_mem_flat[(addr) >> X86EMU_PAGE_SHIFT])
+
+/* Returns the host address of size bytes at addr, or NULL if they are not
+ * all on one page backed by host memory.
+ */
+static inline u8 *x86emu_mem_ptr(u32 addr, int size)
+{
+	u8 *host;
+
+	if (X86EMU_MEM_FLAT(addr, size))
+		return (u8 *)M.mem_base + addr;
+	if (addr >= X86EMU_MAP_LIMIT ||
+		(addr & X86EMU_PAGE_MASK) > (u32)(X86EMU_PAGE_SIZE - size))
+		return NULL;
+	host = x86emu_mem_map[addr >> X86EMU_PAGE_SHIFT].host;
+	if (!host)
+		return NULL;
+	return host + (addr & X86EMU_PAGE_MASK);
+}
+
+#ifdef  __cplusplus
+}                       			/* End of "C" linkage for C++   	*/
+#endif
+
+#endif /* __X86EMU_MEMMAP_H */
@@ -498,8 +498,7 @@ Handles opcode 0x0f. Escape for two-byte opcode (286 or better)
 ****************************************************************************/
 static void x86emuOp_two_byte(u8 X86EMU_UNUSED(op1))
 {
-    u8 op2 = (*sys_rdb)(((u32)M.x86.R_CS << 4) + (M.x86.R_IP++));
-    INC_DECODED_INST_LEN(1);
+    u8 op2 = fetch_byte_imm();
     (*x86emu_optab2[op2])(op2);
 }
 
@@ -2360,6 +2359,7 @@ static void x86emuOp_pushf_word(u8 X86EMU_UNUSED(op1))
     }
     TRACE_AND_STEP();
 
+    x86emu_sync_flags(F_LAZY);
     /* clear out *all* bits not representing flags, and turn on real bits */
     flags = (M.x86.R_EFLG & F_MSK) | F_ALWAYS_ON;
     if (M.x86.mode & SYSMODE_PREFIX_DATA) {
@@ -2384,6 +2384,7 @@ static void x86emuOp_popf_word(u8 X86EMU_UNUSED(op1))
         DECODE_PRINTF("POPF\n");
     }
     TRACE_AND_STEP();
+    x86emu_sync_flags(F_LAZY);
     if (M.x86.mode & SYSMODE_PREFIX_DATA) {
         M.x86.R_EFLG = pop_long();
     } else {
@@ -2402,6 +2403,7 @@ static void x86emuOp_sahf(u8 X86EMU_UNUSED(op1))
     START_OF_INSTR();
     DECODE_PRINTF("SAHF\n");
     TRACE_AND_STEP();
+    x86emu_sync_flags(F_LAZY);
     /* clear the lower bits of the flag register */
     M.x86.R_FLG &= 0xffffff00;
     /* or in the AH register into the flags register */
@@ -2419,6 +2421,7 @@ static void x86emuOp_lahf(u8 X86EMU_UNUSED(op1))
     START_OF_INSTR();
     DECODE_PRINTF("LAHF\n");
     TRACE_AND_STEP();
+    x86emu_sync_flags(F_LAZY);
 	M.x86.R_AH = (u8)(M.x86.R_FLG & 0xff);
     /*undocumented TC++ behavior??? Nope.  It's documented, but
        you have too look real hard to notice it. */
@@ -3582,6 +3585,7 @@ static void x86emuOp_int3(u8 X86EMU_UNUSED(op1))
     tmp = (u16) mem_access_word(3 * 4 + 2);
     /* access the segment register */
     TRACE_AND_STEP();
+    x86emu_sync_flags(F_LAZY);
 	if (_X86EMU_intrTab[3]) {
 		(*_X86EMU_intrTab[3])(3);
     } else {
@@ -3612,6 +3616,7 @@ static void x86emuOp_int_IMM(u8 X86EMU_UNUSED(op1))
     DECODE_PRINTF2("%x\n", intnum);
     tmp = mem_access_word(intnum * 4 + 2);
     TRACE_AND_STEP();
+    x86emu_sync_flags(F_LAZY);
 	if (_X86EMU_intrTab[intnum]) {
 		(*_X86EMU_intrTab[intnum])(intnum);
     } else {
@@ -3640,6 +3645,7 @@ static void x86emuOp_into(u8 X86EMU_UNUSED(op1))
     TRACE_AND_STEP();
     if (ACCESS_FLAG(F_OF)) {
         tmp = mem_access_word(4 * 4 + 2);
+        x86emu_sync_flags(F_LAZY);
 		if (_X86EMU_intrTab[4]) {
 			(*_X86EMU_intrTab[4])(4);
         } else {
@@ -3669,6 +3675,7 @@ static void x86emuOp_iret(u8 X86EMU_UNUSED(op1))
 
     M.x86.R_IP = pop_word();
     M.x86.R_CS = pop_word();
+    x86emu_sync_flags(F_LAZY);
     M.x86.R_FLG = pop_word();
     DECODE_CLEAR_SEGOVR();
     END_OF_INSTR();
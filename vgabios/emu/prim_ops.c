@@ -129,8 +129,153 @@ static u32 x86emu_parity_tab[8] =
 #define PARITY(x)   (((x86emu_parity_tab[(x) / 32] >> ((x) % 32)) & 1) == 0)
 #define XOR2(x)     (((x) ^ ((x)>>1)) & 0x1)
 
+/* Kinds of operations recorded for lazy flag evaluation. The operand
+ * size in bits is or'ed into the low byte.
+ */
+#define LAZY_ADD    0x100       /* carry chain */
+#define LAZY_SUB    0x200       /* borrow chain */
+#define LAZY_LOGIC  0x300       /* CF, OF and AF cleared */
+#define LAZY_KIND   0xff00
+#define LAZY_SIZE   0x00ff
+
+X86EMU_lazyFlags x86emu_lazy;
+#ifdef __HAVE_INLINE_ASSEMBLER__
+int x86emu_flag_mode = X86EMU_FLAGS_EAGER;
+#else
+int x86emu_flag_mode = X86EMU_FLAGS_LAZY;
+#endif
+static unsigned long x86emu_flag_errors;
+
 /*----------------------------- Implementation ----------------------------*/
 
+/****************************************************************************
+PARAMETERS:
+mask    - Flags that are about to be read
+
+REMARKS:
+If any of the flags in mask is pending, computes all pending flags from the
+operation recorded by the last lazy primitive, using the same carry and
+borrow chains as the eager code. A Jcc that reads several flags thus only
+pays once. In check mode R_FLG already holds the eager result, which is
+compared with the lazy one instead of being overwritten.
+****************************************************************************/
+void x86emu_sync_flags(u32 mask)
+{
+    u32 bits, msb, d, s, res;
+    u32 cc, val, flags = 0;
+
+    /* Nothing recorded means no operand size either, so check first */
+    if (!(mask & x86emu_lazy.pending))
+        return;
+    bits = x86emu_lazy.op & LAZY_SIZE;
+    msb = 1 << (bits - 1);
+    d = x86emu_lazy.d;
+    s = x86emu_lazy.s;
+    res = x86emu_lazy.res;
+    mask = x86emu_lazy.pending;
+    x86emu_lazy.pending = 0;
+
+    if (res & msb)
+        flags |= F_SF;
+    if (!(res & (msb | (msb - 1))))
+        flags |= F_ZF;
+    if ((mask & F_PF) && PARITY(res & 0xFF))
+        flags |= F_PF;
+    if (mask & (F_CF | F_OF | F_AF)) {
+        switch (x86emu_lazy.op & LAZY_KIND) {
+          case LAZY_ADD:
+            cc = (s & d) | ((~res) & (s | d));
+            break;
+          case LAZY_SUB:
+            cc = (res & (~d | s)) | (~d & s);
+            break;
+          default:
+            cc = 0;
+            break;
+        }
+        if (cc & msb)
+            flags |= F_CF;
+        if (XOR2(cc >> (bits - 2)))
+            flags |= F_OF;
+        if (cc & 0x8)
+            flags |= F_AF;
+    }
+
+    /* Flags that are no longer pending were set since, e.g. by CLC, and
+     * must be left alone even though they were computed above.
+     */
+    val = (M.x86.R_FLG & ~mask) | (flags & mask);
+    if (x86emu_flag_mode == X86EMU_FLAGS_CHECK) {
+        if (val != M.x86.R_FLG) {
+            x86emu_flag_errors++;
+            printf("%04x:%04x: lazy flags %04x != eager %04x (op %03x, %x, %x -> %x)\n",
+                   M.x86.R_CS, M.x86.R_IP, val, M.x86.R_FLG,
+                   x86emu_lazy.op, d, s, res);
+        }
+        return;
+    }
+    M.x86.R_FLG = val;
+}
+
+/****************************************************************************
+PARAMETERS:
+mode    - X86EMU_FLAGS_EAGER, X86EMU_FLAGS_LAZY or X86EMU_FLAGS_CHECK
+
+REMARKS:
+Selects how the arithmetic primitives compute the condition flags. The
+check mode runs the eager and the lazy code side by side and reports every
+flag read where they disagree.
+****************************************************************************/
+void X86EMU_setFlagMode(
+    int mode)
+{
+    x86emu_sync_flags(F_LAZY);
+    x86emu_flag_mode = mode;
+}
+
+/****************************************************************************
+RETURNS:
+Number of mismatches between eager and lazy flags seen in check mode.
+****************************************************************************/
+unsigned long X86EMU_getFlagErrors(void)
+{
+    return x86emu_flag_errors;
+}
+
+/****************************************************************************
+REMARKS:
+Records an operation for lazy flag evaluation. Anything still pending from
+the previous operation that this one does not replace is computed first.
+****************************************************************************/
+static void set_lazy_flags(u32 op, u32 d, u32 s, u32 res, u32 mask)
+{
+    if (x86emu_lazy.pending & ~mask)
+        x86emu_sync_flags(x86emu_lazy.pending & ~mask);
+    x86emu_lazy.pending = mask;
+    x86emu_lazy.op = op;
+    x86emu_lazy.d = d;
+    x86emu_lazy.s = s;
+    x86emu_lazy.res = res;
+}
+
+/* In lazy mode a primitive only records what it did and returns. In check
+ * mode the eager code runs first and the record is made afterwards, so that
+ * the flags are computed both ways.
+ */
+static inline int lazy_flags(u32 op, u32 d, u32 s, u32 res, u32 mask)
+{
+    if (x86emu_flag_mode != X86EMU_FLAGS_LAZY)
+        return 0;
+    set_lazy_flags(op, d, s, res, mask);
+    return 1;
+}
+
+static inline void check_flags(u32 op, u32 d, u32 s, u32 res, u32 mask)
+{
+    if (x86emu_flag_mode == X86EMU_FLAGS_CHECK)
+        set_lazy_flags(op, d, s, res, mask);
+}
+
 
 /*--------- Side effects helper functions -------*/
 
@@ -299,8 +444,11 @@ u8 adc_byte(u8 d, u8 s)
     res = d + s;
     if (ACCESS_FLAG(F_CF)) res++;
 
+    if (lazy_flags(LAZY_ADD | 8, d, s, res, F_LAZY))
+        return (u8)res;
     set_szp_flags_8(res);
     calc_carry_chain(8,s,d,res,1);
+    check_flags(LAZY_ADD | 8, d, s, res, F_LAZY);
 
     return (u8)res;
 }
@@ -317,8 +465,11 @@ u16 adc_word(u16 d, u16 s)
     if (ACCESS_FLAG(F_CF))
         res++;
 
+    if (lazy_flags(LAZY_ADD | 16, d, s, res, F_LAZY))
+        return (u16)res;
     set_szp_flags_16((u16)res);
     calc_carry_chain(16,s,d,res,1);
+    check_flags(LAZY_ADD | 16, d, s, res, F_LAZY);
 
     return (u16)res;
 }
@@ -343,10 +494,13 @@ u32 adc_long(u32 d, u32 s)
 
     hi = (lo >> 16) + (d >> 16) + (s >> 16);
 
+    if (lazy_flags(LAZY_ADD | 32, d, s, res, F_LAZY))
+        return res;
     set_szp_flags_32(res);
     calc_carry_chain(32,s,d,res,0);
 
     CONDITIONAL_SET_FLAG(hi & 0x10000, F_CF);
+    check_flags(LAZY_ADD | 32, d, s, res, F_LAZY);
 
     return res;
 }
@@ -360,8 +514,11 @@ u8 add_byte(u8 d, u8 s)
     u32 res;   /* all operands in native machine order */
 
     res = d + s;
+    if (lazy_flags(LAZY_ADD | 8, d, s, res, F_LAZY))
+        return (u8)res;
     set_szp_flags_8((u8)res);
     calc_carry_chain(8,s,d,res,1);
+    check_flags(LAZY_ADD | 8, d, s, res, F_LAZY);
 
     return (u8)res;
 }
@@ -375,8 +532,11 @@ u16 add_word(u16 d, u16 s)
     u32 res;   /* all operands in native machine order */
 
     res = d + s;
+    if (lazy_flags(LAZY_ADD | 16, d, s, res, F_LAZY))
+        return (u16)res;
     set_szp_flags_16((u16)res);
     calc_carry_chain(16,s,d,res,1);
+    check_flags(LAZY_ADD | 16, d, s, res, F_LAZY);
 
     return (u16)res;
 }
@@ -390,10 +550,13 @@ u32 add_long(u32 d, u32 s)
     u32 res;
 
     res = d + s;
+    if (lazy_flags(LAZY_ADD | 32, d, s, res, F_LAZY))
+        return res;
     set_szp_flags_32(res);
     calc_carry_chain(32,s,d,res,0);
 
     CONDITIONAL_SET_FLAG(res < d || res < s, F_CF);
+    check_flags(LAZY_ADD | 32, d, s, res, F_LAZY);
 
     return res;
 }
@@ -408,7 +571,10 @@ u8 and_byte(u8 d, u8 s)
 
     res = d & s;
 
+    if (lazy_flags(LAZY_LOGIC | 8, d, s, res, F_LAZY))
+        return res;
     no_carry_byte_side_eff(res);
+    check_flags(LAZY_LOGIC | 8, d, s, res, F_LAZY);
     return res;
 }
 
@@ -422,7 +588,10 @@ u16 and_word(u16 d, u16 s)
 
     res = d & s;
 
+    if (lazy_flags(LAZY_LOGIC | 16, d, s, res, F_LAZY))
+        return res;
     no_carry_word_side_eff(res);
+    check_flags(LAZY_LOGIC | 16, d, s, res, F_LAZY);
     return res;
 }
 
@@ -435,7 +604,10 @@ u32 and_long(u32 d, u32 s)
     u32 res;   /* all operands in native machine order */
 
     res = d & s;
+    if (lazy_flags(LAZY_LOGIC | 32, d, s, res, F_LAZY))
+        return res;
     no_carry_long_side_eff(res);
+    check_flags(LAZY_LOGIC | 32, d, s, res, F_LAZY);
     return res;
 }
 
@@ -448,8 +620,11 @@ u8 cmp_byte(u8 d, u8 s)
     u32 res;   /* all operands in native machine order */
 
     res = d - s;
+    if (lazy_flags(LAZY_SUB | 8, d, s, res, F_LAZY))
+        return d;
     set_szp_flags_8((u8)res);
     calc_borrow_chain(8, d, s, res, 1);
+    check_flags(LAZY_SUB | 8, d, s, res, F_LAZY);
 
     return d;
 }
@@ -463,8 +638,11 @@ u16 cmp_word(u16 d, u16 s)
     u32 res;   /* all operands in native machine order */
 
     res = d - s;
+    if (lazy_flags(LAZY_SUB | 16, d, s, res, F_LAZY))
+        return d;
     set_szp_flags_16((u16)res);
     calc_borrow_chain(16, d, s, res, 1);
+    check_flags(LAZY_SUB | 16, d, s, res, F_LAZY);
 
     return d;
 }
@@ -478,8 +656,11 @@ u32 cmp_long(u32 d, u32 s)
     u32 res;   /* all operands in native machine order */
 
     res = d - s;
+    if (lazy_flags(LAZY_SUB | 32, d, s, res, F_LAZY))
+        return d;
     set_szp_flags_32(res);
     calc_borrow_chain(32, d, s, res, 1);
+    check_flags(LAZY_SUB | 32, d, s, res, F_LAZY);
 
     return d;
 }
@@ -530,8 +711,11 @@ u8 dec_byte(u8 d)
     u32 res;   /* all operands in native machine order */
 
     res = d - 1;
+    if (lazy_flags(LAZY_SUB | 8, d, 1, res, F_LAZY & ~F_CF))
+        return (u8)res;
     set_szp_flags_8((u8)res);
     calc_borrow_chain(8, d, 1, res, 0);
+    check_flags(LAZY_SUB | 8, d, 1, res, F_LAZY & ~F_CF);
 
     return (u8)res;
 }
@@ -545,8 +729,11 @@ u16 dec_word(u16 d)
     u32 res;   /* all operands in native machine order */
 
     res = d - 1;
+    if (lazy_flags(LAZY_SUB | 16, d, 1, res, F_LAZY & ~F_CF))
+        return (u16)res;
     set_szp_flags_16((u16)res);
     calc_borrow_chain(16, d, 1, res, 0);
+    check_flags(LAZY_SUB | 16, d, 1, res, F_LAZY & ~F_CF);
 
     return (u16)res;
 }
@@ -561,8 +748,11 @@ u32 dec_long(u32 d)
 
     res = d - 1;
 
+    if (lazy_flags(LAZY_SUB | 32, d, 1, res, F_LAZY & ~F_CF))
+        return res;
     set_szp_flags_32(res);
     calc_borrow_chain(32, d, 1, res, 0);
+    check_flags(LAZY_SUB | 32, d, 1, res, F_LAZY & ~F_CF);
 
     return res;
 }
@@ -576,8 +766,11 @@ u8 inc_byte(u8 d)
     u32 res;   /* all operands in native machine order */
 
     res = d + 1;
+    if (lazy_flags(LAZY_ADD | 8, d, 1, res, F_LAZY & ~F_CF))
+        return (u8)res;
     set_szp_flags_8((u8)res);
     calc_carry_chain(8, d, 1, res, 0);
+    check_flags(LAZY_ADD | 8, d, 1, res, F_LAZY & ~F_CF);
 
     return (u8)res;
 }
@@ -591,8 +784,11 @@ u16 inc_word(u16 d)
     u32 res;   /* all operands in native machine order */
 
     res = d + 1;
+    if (lazy_flags(LAZY_ADD | 16, d, 1, res, F_LAZY & ~F_CF))
+        return (u16)res;
     set_szp_flags_16((u16)res);
     calc_carry_chain(16, d, 1, res, 0);
+    check_flags(LAZY_ADD | 16, d, 1, res, F_LAZY & ~F_CF);
 
     return (u16)res;
 }
@@ -606,8 +802,11 @@ u32 inc_long(u32 d)
     u32 res;   /* all operands in native machine order */
 
     res = d + 1;
+    if (lazy_flags(LAZY_ADD | 32, d, 1, res, F_LAZY & ~F_CF))
+        return res;
     set_szp_flags_32(res);
     calc_carry_chain(32, d, 1, res, 0);
+    check_flags(LAZY_ADD | 32, d, 1, res, F_LAZY & ~F_CF);
 
     return res;
 }
@@ -621,7 +820,10 @@ u8 or_byte(u8 d, u8 s)
     u8 res;    /* all operands in native machine order */
 
     res = d | s;
+    if (lazy_flags(LAZY_LOGIC | 8, d, s, res, F_LAZY))
+        return res;
     no_carry_byte_side_eff(res);
+    check_flags(LAZY_LOGIC | 8, d, s, res, F_LAZY);
 
     return res;
 }
@@ -635,7 +837,10 @@ u16 or_word(u16 d, u16 s)
     u16 res;   /* all operands in native machine order */
 
     res = d | s;
+    if (lazy_flags(LAZY_LOGIC | 16, d, s, res, F_LAZY))
+        return res;
     no_carry_word_side_eff(res);
+    check_flags(LAZY_LOGIC | 16, d, s, res, F_LAZY);
     return res;
 }
 
@@ -648,7 +853,10 @@ u32 or_long(u32 d, u32 s)
     u32 res;   /* all operands in native machine order */
 
     res = d | s;
+    if (lazy_flags(LAZY_LOGIC | 32, d, s, res, F_LAZY))
+        return res;
     no_carry_long_side_eff(res);
+    check_flags(LAZY_LOGIC | 32, d, s, res, F_LAZY);
     return res;
 }
 
@@ -660,10 +868,13 @@ u8 neg_byte(u8 s)
 {
     u8 res;
 
-    CONDITIONAL_SET_FLAG(s != 0, F_CF);
     res = (u8)-s;
+    if (lazy_flags(LAZY_SUB | 8, 0, s, res, F_LAZY))
+        return res;
+    CONDITIONAL_SET_FLAG(s != 0, F_CF);
     set_szp_flags_8(res);
     calc_borrow_chain(8, 0, s, res, 0);
+    check_flags(LAZY_SUB | 8, 0, s, res, F_LAZY);
 
     return res;
 }
@@ -676,10 +887,13 @@ u16 neg_word(u16 s)
 {
     u16 res;
 
-    CONDITIONAL_SET_FLAG(s != 0, F_CF);
     res = (u16)-s;
+    if (lazy_flags(LAZY_SUB | 16, 0, s, res, F_LAZY))
+        return res;
+    CONDITIONAL_SET_FLAG(s != 0, F_CF);
     set_szp_flags_16((u16)res);
     calc_borrow_chain(16, 0, s, res, 0);
+    check_flags(LAZY_SUB | 16, 0, s, res, F_LAZY);
 
     return res;
 }
@@ -692,10 +906,13 @@ u32 neg_long(u32 s)
 {
     u32 res;
 
-    CONDITIONAL_SET_FLAG(s != 0, F_CF);
     res = (u32)-s;
+    if (lazy_flags(LAZY_SUB | 32, 0, s, res, F_LAZY))
+        return res;
+    CONDITIONAL_SET_FLAG(s != 0, F_CF);
     set_szp_flags_32(res);
     calc_borrow_chain(32, 0, s, res, 0);
+    check_flags(LAZY_SUB | 32, 0, s, res, F_LAZY);
 
     return res;
 }
@@ -1673,6 +1890,8 @@ u8 sbb_byte(u8 d, u8 s)
         res = d - s - 1;
     else
         res = d - s;
+    if (lazy_flags(LAZY_SUB | 8, d, s, res, F_LAZY))
+        return (u8)res;
     set_szp_flags_8((u8)res);
 
     /* calculate the borrow chain.  See note at top */
@@ -1680,6 +1899,7 @@ u8 sbb_byte(u8 d, u8 s)
     CONDITIONAL_SET_FLAG(bc & 0x80, F_CF);
     CONDITIONAL_SET_FLAG(XOR2(bc >> 6), F_OF);
     CONDITIONAL_SET_FLAG(bc & 0x8, F_AF);
+    check_flags(LAZY_SUB | 8, d, s, res, F_LAZY);
     return (u8)res;
 }
 
@@ -1696,6 +1916,8 @@ u16 sbb_word(u16 d, u16 s)
         res = d - s - 1;
     else
         res = d - s;
+    if (lazy_flags(LAZY_SUB | 16, d, s, res, F_LAZY))
+        return (u16)res;
     set_szp_flags_16((u16)res);
 
     /* calculate the borrow chain.  See note at top */
@@ -1703,6 +1925,7 @@ u16 sbb_word(u16 d, u16 s)
     CONDITIONAL_SET_FLAG(bc & 0x8000, F_CF);
     CONDITIONAL_SET_FLAG(XOR2(bc >> 14), F_OF);
     CONDITIONAL_SET_FLAG(bc & 0x8, F_AF);
+    check_flags(LAZY_SUB | 16, d, s, res, F_LAZY);
     return (u16)res;
 }
 
@@ -1720,6 +1943,8 @@ u32 sbb_long(u32 d, u32 s)
     else
         res = d - s;
 
+    if (lazy_flags(LAZY_SUB | 32, d, s, res, F_LAZY))
+        return res;
     set_szp_flags_32(res);
 
     /* calculate the borrow chain.  See note at top */
@@ -1727,6 +1952,7 @@ u32 sbb_long(u32 d, u32 s)
     CONDITIONAL_SET_FLAG(bc & 0x80000000, F_CF);
     CONDITIONAL_SET_FLAG(XOR2(bc >> 30), F_OF);
     CONDITIONAL_SET_FLAG(bc & 0x8, F_AF);
+    check_flags(LAZY_SUB | 32, d, s, res, F_LAZY);
     return res;
 }
 
@@ -1740,6 +1966,8 @@ u8 sub_byte(u8 d, u8 s)
     u32 bc;
 
     res = d - s;
+    if (lazy_flags(LAZY_SUB | 8, d, s, res, F_LAZY))
+        return (u8)res;
     set_szp_flags_8((u8)res);
 
     /* calculate the borrow chain.  See note at top */
@@ -1747,6 +1975,7 @@ u8 sub_byte(u8 d, u8 s)
     CONDITIONAL_SET_FLAG(bc & 0x80, F_CF);
     CONDITIONAL_SET_FLAG(XOR2(bc >> 6), F_OF);
     CONDITIONAL_SET_FLAG(bc & 0x8, F_AF);
+    check_flags(LAZY_SUB | 8, d, s, res, F_LAZY);
     return (u8)res;
 }
 
@@ -1760,6 +1989,8 @@ u16 sub_word(u16 d, u16 s)
     u32 bc;
 
     res = d - s;
+    if (lazy_flags(LAZY_SUB | 16, d, s, res, F_LAZY))
+        return (u16)res;
     set_szp_flags_16((u16)res);
 
     /* calculate the borrow chain.  See note at top */
@@ -1767,6 +1998,7 @@ u16 sub_word(u16 d, u16 s)
     CONDITIONAL_SET_FLAG(bc & 0x8000, F_CF);
     CONDITIONAL_SET_FLAG(XOR2(bc >> 14), F_OF);
     CONDITIONAL_SET_FLAG(bc & 0x8, F_AF);
+    check_flags(LAZY_SUB | 16, d, s, res, F_LAZY);
     return (u16)res;
 }
 
@@ -1780,6 +2012,8 @@ u32 sub_long(u32 d, u32 s)
     u32 bc;
 
     res = d - s;
+    if (lazy_flags(LAZY_SUB | 32, d, s, res, F_LAZY))
+        return res;
     set_szp_flags_32(res);
 
     /* calculate the borrow chain.  See note at top */
@@ -1787,6 +2021,7 @@ u32 sub_long(u32 d, u32 s)
     CONDITIONAL_SET_FLAG(bc & 0x80000000, F_CF);
     CONDITIONAL_SET_FLAG(XOR2(bc >> 30), F_OF);
     CONDITIONAL_SET_FLAG(bc & 0x8, F_AF);
+    check_flags(LAZY_SUB | 32, d, s, res, F_LAZY);
     return res;
 }
 
@@ -1800,10 +2035,13 @@ void test_byte(u8 d, u8 s)
 
     res = d & s;
 
+    if (lazy_flags(LAZY_LOGIC | 8, d, s, res, F_LAZY & ~F_AF))
+        return;
     CLEAR_FLAG(F_OF);
     set_szp_flags_8((u8)res);
     /* AF == don't care */
     CLEAR_FLAG(F_CF);
+    check_flags(LAZY_LOGIC | 8, d, s, res, F_LAZY & ~F_AF);
 }
 
 /****************************************************************************
@@ -1816,10 +2054,13 @@ void test_word(u16 d, u16 s)
 
     res = d & s;
 
+    if (lazy_flags(LAZY_LOGIC | 16, d, s, res, F_LAZY & ~F_AF))
+        return;
     CLEAR_FLAG(F_OF);
     set_szp_flags_16((u16)res);
     /* AF == don't care */
     CLEAR_FLAG(F_CF);
+    check_flags(LAZY_LOGIC | 16, d, s, res, F_LAZY & ~F_AF);
 }
 
 /****************************************************************************
@@ -1832,10 +2073,13 @@ void test_long(u32 d, u32 s)
 
     res = d & s;
 
+    if (lazy_flags(LAZY_LOGIC | 32, d, s, res, F_LAZY & ~F_AF))
+        return;
     CLEAR_FLAG(F_OF);
     set_szp_flags_32(res);
     /* AF == don't care */
     CLEAR_FLAG(F_CF);
+    check_flags(LAZY_LOGIC | 32, d, s, res, F_LAZY & ~F_AF);
 }
 
 /****************************************************************************
@@ -1847,7 +2091,10 @@ u8 xor_byte(u8 d, u8 s)
     u8 res;    /* all operands in native machine order */
 
     res = d ^ s;
+    if (lazy_flags(LAZY_LOGIC | 8, d, s, res, F_LAZY))
+        return res;
     no_carry_byte_side_eff(res);
+    check_flags(LAZY_LOGIC | 8, d, s, res, F_LAZY);
     return res;
 }
 
@@ -1860,7 +2107,10 @@ u16 xor_word(u16 d, u16 s)
     u16 res;   /* all operands in native machine order */
 
     res = d ^ s;
+    if (lazy_flags(LAZY_LOGIC | 16, d, s, res, F_LAZY))
+        return res;
     no_carry_word_side_eff(res);
+    check_flags(LAZY_LOGIC | 16, d, s, res, F_LAZY);
     return res;
 }
 
@@ -1873,7 +2123,10 @@ u32 xor_long(u32 d, u32 s)
     u32 res;   /* all operands in native machine order */
 
     res = d ^ s;
+    if (lazy_flags(LAZY_LOGIC | 32, d, s, res, F_LAZY))
+        return res;
     no_carry_long_side_eff(res);
+    check_flags(LAZY_LOGIC | 32, d, s, res, F_LAZY);
     return res;
 }
 
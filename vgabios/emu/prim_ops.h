@@ -41,6 +41,24 @@
 
 #include "prim_asm.h"
 
+/* Condition flags that the arithmetic primitives may leave to be worked
+ * out later by x86emu_sync_flags().
+ */
+#define F_LAZY	(F_CF | F_PF | F_AF | F_ZF | F_SF | F_OF)
+
+/* Values for X86EMU_setFlagMode() */
+#define X86EMU_FLAGS_EAGER	0	/* compute all flags right away */
+#define X86EMU_FLAGS_LAZY	1	/* compute flags when they are read */
+#define X86EMU_FLAGS_CHECK	2	/* do both and compare on every read */
+
+typedef struct {
+	u32		pending;	/* flags still to be computed from the rest */
+	u32		op;			/* kind of operation and operand size */
+	u32		d;
+	u32		s;
+	u32		res;
+} X86EMU_lazyFlags;
+
 #ifdef  __cplusplus
 extern "C" {            			/* Use "C" linkage when in C++ mode */
 #endif
@@ -137,6 +155,13 @@ u16     pop_word (void);
 u32	pop_long (void);
 void	x86emu_cpuid (void);
 
+extern X86EMU_lazyFlags x86emu_lazy;
+extern int	x86emu_flag_mode;
+
+void	x86emu_sync_flags (u32 mask);
+void	X86EMU_setFlagMode (int mode);
+unsigned long X86EMU_getFlagErrors (void);
+
 #if  defined(__HAVE_INLINE_ASSEMBLER__) && !defined(PRIM_OPS_NO_REDEFINE_ASM)
 
 #define	aaa_word(d)		aaa_word_asm(&M.x86.R_EFLG,d)
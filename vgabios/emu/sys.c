@@ -51,6 +51,8 @@
 
 #include "debug.h"
 #include "prim_ops.h"
+#include "memmap.h"
+#include "blkcache.h"
 
 #ifdef IN_MODULE
 #include "xf86_ansic.h"
@@ -61,6 +63,8 @@
 
 X86EMU_sysEnv _X86EMU_env;	/* Global emulator machine state */
 X86EMU_intrFuncs _X86EMU_intrTab[256];
+X86EMU_memPage x86emu_mem_map[X86EMU_MAP_PAGES];	/* Guest memory map */
+u8 x86emu_mem_flat[X86EMU_MAP_PAGES];	/* Page is at M.mem_base + addr */
 
 /*----------------------------- Implementation ----------------------------*/
 
@@ -72,6 +76,7 @@ static u8 *mem_ptr(u32 addr, int size)
 	if (addr > M.mem_size - size) {
 		DB(printf("mem_ptr: address %#x out of range!\n", addr);)
 		    HALT_SYS();
+		return NULL;
 	}
 	if (addr < 0x200) {
 		//printf("%x:%x updating int vector 0x%x\n",
@@ -82,6 +87,108 @@ static u8 *mem_ptr(u32 addr, int size)
 	return retaddr;
 }
 
+/* Handlers for a page of the memory map, or NULL if the access goes to
+ * host memory or the flat buffer.
+ */
+static X86EMU_memFuncs *mem_mmio(u32 addr)
+{
+	if (addr >= X86EMU_MAP_LIMIT)
+		return NULL;
+	return x86emu_mem_map[addr >> X86EMU_PAGE_SHIFT].mmio;
+}
+
+/* True if an access of size bytes at addr touches two pages of the map. */
+static int mem_split(u32 addr, int size)
+{
+	return addr < X86EMU_MAP_LIMIT &&
+	    (addr & X86EMU_PAGE_MASK) > (u32)(X86EMU_PAGE_SIZE - size);
+}
+
+/* Slow path of the read functions, for everything but flat pages. */
+static u32 mem_read(u32 addr, int size)
+{
+	X86EMU_memFuncs *mmio;
+	u8 *ptr;
+
+	if (mem_split(addr, size)) {
+		if (size == 2)
+			return rdb(addr) | (rdb(addr + 1) << 8);
+		return rdw(addr) | ((u32) rdw(addr + 2) << 16);
+	}
+	ptr = x86emu_mem_ptr(addr, size);
+	if (!ptr && (mmio = mem_mmio(addr)) != NULL) {
+		switch (size) {
+		case 1:
+			return (*mmio->rdb) (addr);
+		case 2:
+			return (*mmio->rdw) (addr);
+		default:
+			return (*mmio->rdl) (addr);
+		}
+	}
+	if (!ptr)
+		ptr = mem_ptr(addr, size);
+	if (!ptr)
+		return 0xffffffff >> (32 - 8 * size);
+	switch (size) {
+	case 1:
+		return *ptr;
+	case 2:
+		return *(u16 *) (ptr);
+	default:
+		return *(u32 *) (ptr);
+	}
+}
+
+/* Slow path of the write functions, for everything but flat pages. */
+static void mem_write(u32 addr, u32 val, int size)
+{
+	X86EMU_memFuncs *mmio;
+	u8 *ptr;
+
+	if (mem_split(addr, size)) {
+		if (size == 2) {
+			wrb(addr, val);
+			wrb(addr + 1, val >> 8);
+		} else {
+			wrw(addr, val);
+			wrw(addr + 2, val >> 16);
+		}
+		return;
+	}
+	ptr = x86emu_mem_ptr(addr, size);
+	if (!ptr && (mmio = mem_mmio(addr)) != NULL) {
+		switch (size) {
+		case 1:
+			(*mmio->wrb) (addr, val);
+			break;
+		case 2:
+			(*mmio->wrw) (addr, val);
+			break;
+		default:
+			(*mmio->wrl) (addr, val);
+			break;
+		}
+		return;
+	}
+	if (!ptr)
+		ptr = mem_ptr(addr, size);
+	if (!ptr)
+		return;
+	switch (size) {
+	case 1:
+		*ptr = val;
+		break;
+	case 2:
+		*(u16 *) (ptr) = val;
+		break;
+	default:
+		*(u32 *) (ptr) = val;
+		break;
+	}
+	X86EMU_CHECK_CODE_WRITE(addr, size);
+}
+
 /****************************************************************************
 PARAMETERS:
 addr	- Emulator memory address to read
@@ -95,11 +202,12 @@ Reads a byte value from the emulator memory.
 u8 X86API rdb(u32 addr)
 {
 	u8 val;
-	u8 *ptr;
 
-	ptr = mem_ptr(addr, 1);
+	if (X86EMU_MEM_FLAT(addr, 1))
+		val = *(u8 *) (M.mem_base + addr);
+	else
+		val = mem_read(addr, 1);
 
-	val = *ptr;
 	DB(if (DEBUG_MEM_TRACE())
 	   printf("%#08x 1 -> %#x\n", addr, val);)
 		return val;
@@ -118,10 +226,11 @@ Reads a word value from the emulator memory.
 u16 X86API rdw(u32 addr)
 {
 	u16 val = 0;
-	u8 *ptr;
 
-	ptr = mem_ptr(addr, 2);
-	val = *(u16 *) (ptr);
+	if (X86EMU_MEM_FLAT(addr, 2))
+		val = *(u16 *) (M.mem_base + addr);
+	else
+		val = mem_read(addr, 2);
 
 	DB(if (DEBUG_MEM_TRACE())
 	   printf("%#08x 2 -> %#x\n", addr, val);)
@@ -140,10 +249,11 @@ Reads a long value from the emulator memory.
 u32 X86API rdl(u32 addr)
 {
 	u32 val = 0;
-	u8 *ptr;
 
-	ptr = mem_ptr(addr, 4);
-       	val = *(u32 *) (ptr);
+	if (X86EMU_MEM_FLAT(addr, 4))
+		val = *(u32 *) (M.mem_base + addr);
+	else
+		val = mem_read(addr, 4);
 
 	DB(if (DEBUG_MEM_TRACE())
 	   printf("%#08x 4 -> %#x\n", addr, val);)
@@ -160,10 +270,11 @@ Writes a byte value to emulator memory.
 ****************************************************************************/
 void X86API wrb(u32 addr, u8 val)
 {
-	u8 *ptr;
-
-	ptr = mem_ptr(addr, 1);
-	*(u8 *) (ptr) = val;
+	if (X86EMU_MEM_FLAT(addr, 1)) {
+		*(u8 *) (M.mem_base + addr) = val;
+		X86EMU_CHECK_CODE_WRITE(addr, 1);
+	} else
+		mem_write(addr, val, 1);
 
 	DB(if (DEBUG_MEM_TRACE())
 	   printf("%#08x 1 <- %#x\n", addr, val);)
@@ -179,10 +290,11 @@ Writes a word value to emulator memory.
 ****************************************************************************/
 void X86API wrw(u32 addr, u16 val)
 {
-	u8 *ptr;
-
-	ptr = mem_ptr(addr, 2);
-	*(u16 *) (ptr) = val;
+	if (X86EMU_MEM_FLAT(addr, 2)) {
+		*(u16 *) (M.mem_base + addr) = val;
+		X86EMU_CHECK_CODE_WRITE(addr, 2);
+	} else
+		mem_write(addr, val, 2);
 
 	DB(if (DEBUG_MEM_TRACE())
 	   printf("%#08x 2 <- %#x\n", addr, val);)
@@ -198,10 +310,11 @@ Writes a long value to emulator memory.
 ****************************************************************************/
 void X86API wrl(u32 addr, u32 val)
 {
-	u8 *ptr;
-
-	ptr = mem_ptr(addr, 4);
-	*(u32 *) (ptr) = val;
+	if (X86EMU_MEM_FLAT(addr, 4)) {
+		*(u32 *) (M.mem_base + addr) = val;
+		X86EMU_CHECK_CODE_WRITE(addr, 4);
+	} else
+		mem_write(addr, val, 4);
 
 	DB(if (DEBUG_MEM_TRACE())
 	   printf("%#08x 4 <- %#x\n", addr, val);)
@@ -394,6 +507,7 @@ hook and handle certain software interrupts as necessary.
 ****************************************************************************/
 void X86EMU_prepareForInt(int num)
 {
+	x86emu_sync_flags(F_LAZY);
 	push_word((u16) M.x86.R_FLG);
 	CLEAR_FLAG(F_IF);
 	CLEAR_FLAG(F_TF);
@@ -404,8 +518,81 @@ void X86EMU_prepareForInt(int num)
 	M.x86.intr = 0;
 }
 
+/* Fills in the map for a page aligned region. */
+static void map_pages(u32 base, u32 size, u8 *host, X86EMU_memFuncs *funcs)
+{
+	u32 off;
+
+	for (off = 0; off < size && base + off < X86EMU_MAP_LIMIT;
+	     off += X86EMU_PAGE_SIZE) {
+		x86emu_mem_map[(base + off) >> X86EMU_PAGE_SHIFT].host =
+		    host ? host + off : NULL;
+		x86emu_mem_map[(base + off) >> X86EMU_PAGE_SHIFT].mmio = funcs;
+		x86emu_mem_flat[(base + off) >> X86EMU_PAGE_SHIFT] =
+		    host && host + off == (u8 *) M.mem_base + base + off;
+	}
+	X86EMU_flushBlockCache();
+}
+
+/****************************************************************************
+PARAMETERS:
+base	- Emulator memory address of the region, page aligned
+size	- Size of the region in bytes, rounded up to whole pages
+host	- Host memory backing the region
+
+REMARKS:
+Maps a region of guest memory straight onto host memory. Accesses to it
+become a table lookup and a load or store. This is how the legacy VGA
+aperture of a real card is plugged in.
+****************************************************************************/
+void X86EMU_mapMemory(u32 base, u32 size, void *host)
+{
+	map_pages(base, size, host, NULL);
+}
+
+/****************************************************************************
+PARAMETERS:
+base	- Emulator memory address of the region, page aligned
+size	- Size of the region in bytes, rounded up to whole pages
+funcs	- Handlers for the region
+
+REMARKS:
+Routes all accesses to a region of guest memory to the given handlers. They
+get the full emulator address. Code in such a region is never cached.
+****************************************************************************/
+void X86EMU_mapMMIO(u32 base, u32 size, X86EMU_memFuncs *funcs)
+{
+	map_pages(base, size, NULL, funcs);
+}
+
+/****************************************************************************
+PARAMETERS:
+base	- Emulator memory address of the region, page aligned
+size	- Size of the region in bytes, rounded up to whole pages
+
+REMARKS:
+Drops the mapping of a region. Accesses to it go to the flat buffer set up
+with X86EMU_setMemBase again, with the usual range check.
+****************************************************************************/
+void X86EMU_unmapMemory(u32 base, u32 size)
+{
+	map_pages(base, size, NULL, NULL);
+}
+
+/****************************************************************************
+PARAMETERS:
+base	- Host address of the flat guest memory buffer
+size	- Size of the buffer in bytes
+
+REMARKS:
+Sets up the flat guest memory and maps all whole pages of it, dropping any
+other mappings.
+****************************************************************************/
 void X86EMU_setMemBase(void *base, size_t size)
 {
 	M.mem_base = (unsigned long) base;
 	M.mem_size = size;
+	memset(x86emu_mem_map, 0, sizeof(x86emu_mem_map));
+	memset(x86emu_mem_flat, 0, sizeof(x86emu_mem_flat));
+	X86EMU_mapMemory(0, size & ~X86EMU_PAGE_MASK, base);
 }
@@ -69,6 +69,8 @@
 #include "ops.h"
 #include "prim_ops.h"
 #include "fpu.h"
+#include "memmap.h"
+#include "blkcache.h"
 #include "x86emu/fpu_regs.h"
 
 #ifdef IN_MODULE
@@ -76,6 +78,28 @@
 #else
 #include <string.h>
 #endif
+
+/* With lazy flags the condition codes of the last arithmetic operation
+ * may not be in R_FLG yet. Reading a flag computes it first, setting or
+ * clearing one drops whatever was pending for it. Code that reads or
+ * writes R_FLG as a whole must call x86emu_sync_flags(F_LAZY) first.
+ */
+#undef	ACCESS_FLAG
+#undef	SET_FLAG
+#undef	CLEAR_FLAG
+#undef	TOGGLE_FLAG
+
+#define ACCESS_FLAG(flag)	((x86emu_lazy.pending & (flag) ?			\
+								x86emu_sync_flags(flag) : (void)0),		\
+							 M.x86.R_FLG & (flag))
+#define SET_FLAG(flag)		(x86emu_lazy.pending &= ~(flag),			\
+							 M.x86.R_FLG |= (flag))
+#define CLEAR_FLAG(flag)	(x86emu_lazy.pending &= ~(flag),			\
+							 M.x86.R_FLG &= ~(flag))
+#define TOGGLE_FLAG(flag)	((x86emu_lazy.pending & (flag) ?			\
+								x86emu_sync_flags(flag) : (void)0),		\
+							 M.x86.R_FLG ^= (flag))
+
 /*--------------------------- Inline Functions ----------------------------*/
 
 #ifdef  __cplusplus
@@ -0,0 +1,111 @@
+/*
+ * flagtest - regression tests for the lazy condition flags of x86emu
+ *
+ * Each test is a short piece of real mode code that leaves an arithmetic
+ * result pending, changes some flags directly and then reads them all back
+ * with pushf. It is run with eager, lazy and check mode flags, and the
+ * flags read back must match the expected ones in every mode.
+ *
+ * Run from "make check".
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+
+/* The emulator's own header, for the block cache and flag modes */
+#include "x86emui.h"
+
+void X86EMU_setMemBase(void *base, size_t size);
+
+/* Arithmetic flags, the ones that can be left pending */
+#define ARITH_FLAGS	(F_CF | F_PF | F_AF | F_ZF | F_SF | F_OF)
+
+#define CODE_SEG	0x1000
+#define STACK_SEG	0x2000
+
+struct flagtest {
+	const char *name;
+	u8 code[16];		/* ends with pushf; pop bx; hlt */
+	u16 flags;		/* expected arithmetic flags in bx */
+};
+
+static const struct flagtest tests[] = {
+	/* 1 - 2 borrows and overflows nothing: CF AF SF PF pending */
+	{ "sub; clc",
+	  { 0xb8, 0x01, 0x00, 0x2d, 0x02, 0x00, 0xf8, 0x9c, 0x5b, 0xf4 },
+	  F_AF | F_SF | F_PF },
+	{ "sub; stc",
+	  { 0xb8, 0x01, 0x00, 0x2d, 0x02, 0x00, 0xf9, 0x9c, 0x5b, 0xf4 },
+	  F_CF | F_AF | F_SF | F_PF },
+	{ "sub; cmc",
+	  { 0xb8, 0x01, 0x00, 0x2d, 0x02, 0x00, 0xf5, 0x9c, 0x5b, 0xf4 },
+	  F_AF | F_SF | F_PF },
+	/* 0xffff + 1 carries into zero: CF AF ZF PF pending */
+	{ "add; clc",
+	  { 0xb8, 0xff, 0xff, 0x05, 0x01, 0x00, 0xf8, 0x9c, 0x5b, 0xf4 },
+	  F_AF | F_ZF | F_PF },
+	{ "add; stc",
+	  { 0xb8, 0xff, 0xff, 0x05, 0x01, 0x00, 0xf9, 0x9c, 0x5b, 0xf4 },
+	  F_CF | F_AF | F_ZF | F_PF },
+	{ "add; cmc",
+	  { 0xb8, 0xff, 0xff, 0x05, 0x01, 0x00, 0xf5, 0x9c, 0x5b, 0xf4 },
+	  F_AF | F_ZF | F_PF },
+	/* 1 + 1 carries nothing, so STC must not be lost either */
+	{ "add no carry; stc",
+	  { 0xb8, 0x01, 0x00, 0x05, 0x01, 0x00, 0xf9, 0x9c, 0x5b, 0xf4 },
+	  F_CF },
+	/* 0x7fff + 1 overflows; CLC leaves OF pending */
+	{ "add overflow; clc",
+	  { 0xb8, 0xff, 0x7f, 0x05, 0x01, 0x00, 0xf8, 0x9c, 0x5b, 0xf4 },
+	  F_OF | F_AF | F_SF | F_PF },
+};
+
+static const char *modes[] = { "eager", "lazy", "check" };
+
+unsigned char biosmem[1024 * 1024];
+
+static u16 run_test(const struct flagtest *t)
+{
+	memset(biosmem, 0, sizeof(biosmem));
+	memcpy(biosmem + (CODE_SEG << 4), t->code, sizeof(t->code));
+	X86EMU_flushBlockCache();
+
+	memset(&M.x86, 0, sizeof(M.x86));
+	X86_CS = CODE_SEG;
+	X86_IP = 0;
+	X86_SS = STACK_SEG;
+	X86_SP = 0xfffe;
+	X86EMU_exec();
+	return X86_BX;
+}
+
+int main(void)
+{
+	unsigned int i;
+	u16 flags;
+	int mode, rc = 0;
+
+	X86EMU_setMemBase(biosmem, sizeof(biosmem));
+
+	for (mode = X86EMU_FLAGS_EAGER; mode <= X86EMU_FLAGS_CHECK; mode++) {
+		X86EMU_setFlagMode(mode);
+		for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+			flags = run_test(&tests[i]) & ARITH_FLAGS;
+			if (flags != tests[i].flags) {
+				printf("%s, %s: flags %04x, expected %04x\n",
+				       modes[mode], tests[i].name, flags,
+				       tests[i].flags);
+				rc = 1;
+			}
+		}
+	}
+	if (X86EMU_getFlagErrors()) {
+		printf("%lu flag mismatches in check mode\n",
+		       X86EMU_getFlagErrors());
+		rc = 1;
+	}
+	printf("%s\n", rc ? "FAIL" : "PASS");
+	return rc;
+}
@@ -18,6 +18,7 @@
 
 #include <x86emu/x86emu.h>
 #include "helper_exec.h"
+#include "trace.h"
 
 #ifndef __APPLE__
 #include <sys/io.h>
@@ -53,6 +54,8 @@ void x_outl(u16 port, u32 val);
 u32 getIntVect(int num);
 void pushw(u16 val);
 
+struct io_stats io_stats;
+
 /* general software interrupt handler */
 u32 getIntVect(int num)
 {
@@ -152,7 +155,13 @@ u8 x_inb(u16 port)
 {
 	u8 val;
 
-	val = inb(port);
+	io_stats.in8++;
+	if (trace_mode == TRACE_REPLAY)
+		val = trace_replay(TRACE_IN | 1, port, 0, 0);
+	else
+		val = inb(port);
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_IN | 1, port, 0, val);
 
 	printf("inb(0x%04x) = 0x%02x\n", port, val);
 
@@ -163,7 +172,13 @@ u16 x_inw(u16 port)
 {
 	u16 val;
 
-	val = inw(port);
+	io_stats.in16++;
+	if (trace_mode == TRACE_REPLAY)
+		val = trace_replay(TRACE_IN | 2, port, 0, 0);
+	else
+		val = inw(port);
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_IN | 2, port, 0, val);
 
 	printf("inw(0x%04x) = 0x%04x\n", port, val);
 	return val;
@@ -173,7 +188,13 @@ u32 x_inl(u16 port)
 {
 	u32 val;
 
-	val = inl(port);
+	io_stats.in32++;
+	if (trace_mode == TRACE_REPLAY)
+		val = trace_replay(TRACE_IN | 4, port, 0, 0);
+	else
+		val = inl(port);
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_IN | 4, port, 0, val);
 
 	printf("inl(0x%04x) = 0x%08x\n", port, val);
 	return val;
@@ -181,20 +202,41 @@ u32 x_inl(u16 port)
 
 void x_outb(u16 port, u8 val)
 {
+	io_stats.out8++;
 	printf("outb(0x%02x, 0x%04x)\n",
 		 val, port);
+	if (trace_mode == TRACE_REPLAY) {
+		trace_replay(TRACE_OUT | 1, port, 0, val);
+		return;
+	}
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_OUT | 1, port, 0, val);
 	outb(val, port);
 }
 
 void x_outw(u16 port, u16 val)
 {
+	io_stats.out16++;
 	printf("outw(0x%04x, 0x%04x)\n", val, port);
+	if (trace_mode == TRACE_REPLAY) {
+		trace_replay(TRACE_OUT | 2, port, 0, val);
+		return;
+	}
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_OUT | 2, port, 0, val);
 	outw(val, port);
 }
 
 void x_outl(u16 port, u32 val)
 {
+	io_stats.out32++;
 	printf("outl(0x%08x, 0x%04x)\n", val, port);
+	if (trace_mode == TRACE_REPLAY) {
+		trace_replay(TRACE_OUT | 4, port, 0, val);
+		return;
+	}
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_OUT | 4, port, 0, val);
 	outl(val, port);
 }
 
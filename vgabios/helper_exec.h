@@ -1,2 +1,10 @@
 u32 getIntVect(int num);
 int run_bios_int(int num);
+
+/* Port accesses made through the x_in / x_out functions. */
+struct io_stats {
+	unsigned long in8, in16, in32;
+	unsigned long out8, out16, out32;
+};
+
+extern struct io_stats io_stats;
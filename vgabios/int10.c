@@ -15,6 +15,9 @@ extern int verbose;
  * Implemented" denotes functionality that can be implemented should the need
  * arise.  What are "Not Implemented" throughout are video memory accesses.
  * Also, very little input validity checking is done here.
+ *
+ * Port writes go through x_outb(), like those of the ROM itself, so they
+ * are counted and are recorded to or replayed from a trace.
  */
 int int42_handler(void);
 
@@ -121,14 +124,14 @@ int int42_handler(void)
 			MEM_WB(0x0484, (25 - 1));
 
 			/* Programme the mode */
-			outb(ioport + 4, cgamode & 0x37);	/* Turn off screen */
+			x_outb(ioport + 4, cgamode & 0x37);	/* Turn off screen */
 			for (i = 0; i < 0x10; i++) {
 				tmp = MEM_RB(regvals + i);
-				outb(ioport, i);
-				outb(ioport + 1, tmp);
+				x_outb(ioport, i);
+				x_outb(ioport + 1, tmp);
 			}
-			outb(ioport + 5, cgacolour);	/* Select colour mode */
-			outb(ioport + 4, cgamode);	/* Turn on screen */
+			x_outb(ioport + 5, cgacolour);	/* Select colour mode */
+			x_outb(ioport + 4, cgamode);	/* Turn on screen */
 		}
 		break;
 
@@ -144,10 +147,10 @@ int int42_handler(void)
 			MEM_WB(0x0460, X86_CL);
 			MEM_WB(0x0461, X86_CH);
 
-			outb(ioport, 0x0A);
-			outb(ioport + 1, X86_CH);
-			outb(ioport, 0x0B);
-			outb(ioport + 1, X86_CL);
+			x_outb(ioport, 0x0A);
+			x_outb(ioport + 1, X86_CH);
+			x_outb(ioport, 0x0B);
+			x_outb(ioport + 1, X86_CL);
 		}
 		break;
 
@@ -171,10 +174,10 @@ int int42_handler(void)
 			offset += MEM_RW(0x044E) << 1;
 
 			ioport = MEM_RW(0x0463);
-			outb(ioport, 0x0E);
-			outb(ioport + 1, offset >> 8);
-			outb(ioport, 0x0F);
-			outb(ioport + 1, offset & 0xFF);
+			x_outb(ioport, 0x0E);
+			x_outb(ioport + 1, offset >> 8);
+			x_outb(ioport, 0x0F);
+			x_outb(ioport + 1, offset & 0xFF);
 		}
 		break;
 
@@ -227,10 +230,10 @@ int int42_handler(void)
 			start <<= 1;
 
 			/* Update start address */
-			outb(ioport, 0x0C);
-			outb(ioport + 1, start >> 8);
-			outb(ioport, 0x0D);
-			outb(ioport + 1, start & 0xFF);
+			x_outb(ioport, 0x0C);
+			x_outb(ioport + 1, start >> 8);
+			x_outb(ioport, 0x0D);
+			x_outb(ioport + 1, start & 0xFF);
 
 			/* Switch cursor position */
 			y = MEM_RB((X86_AL << 1) + 0x0450);
@@ -238,10 +241,10 @@ int int42_handler(void)
 			start += (y * MEM_RW(0x044A)) + x;
 
 			/* Update cursor position */
-			outb(ioport, 0x0E);
-			outb(ioport + 1, start >> 8);
-			outb(ioport, 0x0F);
-			outb(ioport + 1, start & 0xFF);
+			x_outb(ioport, 0x0E);
+			x_outb(ioport + 1, start >> 8);
+			x_outb(ioport, 0x0F);
+			x_outb(ioport + 1, start & 0xFF);
 		}
 		break;
 
@@ -348,7 +351,7 @@ int int42_handler(void)
 			}
 
 			MEM_WB(0x0466, cgacolour);
-			outb(ioport, cgacolour);
+			x_outb(ioport, cgacolour);
 		}
 		break;
 
@@ -1,6 +1,8 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <pci/pci.h>
 #include "pci.h"
+#include "trace.h"
 
 #ifdef PCI_LIB_VERSION
 #define LIBPCI_CHECK_VERSION(major,minor,micro) \
@@ -33,29 +35,182 @@ void pciWriteLong(PCITAG tag, u32 idx, u32 data);
 void pciWriteWord(PCITAG tag, u32 idx, u16 data);
 void pciWriteByte(PCITAG tag, u32 idx, u8 data);
 
+/* Bytes of config space cached per device, 0, 256 or 4096. */
+int pci_cache_size = 0;
+
 int pciNumBuses = 0;
 
+/* Every device found by pciInit(), indexed by bus and devfn. Holding on
+ * to the handles from the bus scan saves a pci_get_dev(), and with it
+ * the allocation of a new struct pci_dev, on every config access.
+ */
+struct pci_slot {
+	struct pci_dev *dev;
+	u8 *cache;		/* pci_cache_size bytes of config space */
+	u8 *valid;		/* one flag per cached byte */
+};
+
+static struct pci_slot *pci_bus[256];
+
 int pciInit(void)
 {
+	struct pci_slot *s;
+
+	/* A replayed trace answers all config space accesses. */
+	if (trace_mode == TRACE_REPLAY)
+		return 0;
+
 	pacc = pci_alloc();
 
 	pci_init(pacc);
 	pci_scan_bus(pacc);
 	for (dev = pacc->devices; dev; dev = dev->next) {
 		pci_fill_info(dev, PCI_FILL_IDENT | PCI_FILL_BASES);
+#if LIBPCI_CHECK_VERSION(2,1,99)
+		if (dev->domain)
+			continue;
+#endif
+		if (!pci_bus[dev->bus]) {
+			pci_bus[dev->bus] = calloc(256, sizeof(struct pci_slot));
+			if (!pci_bus[dev->bus])
+				return -1;
+		}
+		s = &pci_bus[dev->bus][(dev->dev << 3) | dev->func];
+		s->dev = dev;
+		if (pci_cache_size) {
+			s->cache = malloc(pci_cache_size);
+			s->valid = calloc(pci_cache_size, 1);
+			if (!s->cache || !s->valid)
+				return -1;
+		}
 	}
 	return 0;
 }
 
 int pciExit(void)
 {
-	pci_cleanup(pacc);
+	int bus, i;
+
+	for (bus = 0; bus < 256; bus++) {
+		if (!pci_bus[bus])
+			continue;
+		for (i = 0; i < 256; i++) {
+			free(pci_bus[bus][i].cache);
+			free(pci_bus[bus][i].valid);
+		}
+		free(pci_bus[bus]);
+		pci_bus[bus] = NULL;
+	}
+	if (pacc)
+		pci_cleanup(pacc);
+	pacc = NULL;
 	return 0;
 }
 
+static struct pci_slot *pciFindSlot(PCITAG tag)
+{
+	struct pci_slot *s;
+
+	if (tag->bus < 0 || tag->bus > 255 || !pci_bus[tag->bus])
+		return NULL;
+	s = &pci_bus[tag->bus][((tag->slot & 0x1f) << 3) | (tag->func & 7)];
+	return s->dev ? s : NULL;
+}
+
+/* Config space reads go through the cache, except for the status
+ * register, whose bits are set by the hardware.
+ */
+static int pciCacheable(struct pci_slot *s, u32 idx, int size)
+{
+	return s->cache && idx + size <= (u32)pci_cache_size &&
+	    (idx >= 8 || idx + size <= 6);
+}
+
+static u32 pciRead(PCITAG tag, u32 idx, int size, const char *what)
+{
+	struct pci_slot *s = pciFindSlot(tag);
+	u32 val = 0;
+	int i, cached;
+
+	if (!s) {
+#ifdef DEBUG_PCI
+		printf("PCI: device not found while read %s (%x:%x.%x)\n",
+		       what, tag->bus, tag->slot, tag->func);
+#endif
+		return 0;
+	}
+
+	cached = pciCacheable(s, idx, size);
+	if (cached) {
+		for (i = 0; i < size && s->valid[idx + i]; i++)
+			;
+		if (i == size) {
+			while (i--)
+				val = val << 8 | s->cache[idx + i];
+			return val;
+		}
+	}
+
+	switch (size) {
+	case 1:
+		val = pci_read_byte(s->dev, idx);
+		break;
+	case 2:
+		val = pci_read_word(s->dev, idx);
+		break;
+	default:
+		val = pci_read_long(s->dev, idx);
+		break;
+	}
+
+	if (cached) {
+		for (i = 0; i < size; i++) {
+			s->cache[idx + i] = val >> (8 * i);
+			s->valid[idx + i] = 1;
+		}
+	}
+	return val;
+}
+
+/* Writes always go to the device. They drop the bytes written from the
+ * cache, so the next read returns what the device made of the write,
+ * e.g. the size mask after writing all ones to a BAR.
+ */
+static void pciWrite(PCITAG tag, u32 idx, u32 data, int size,
+		     const char *what)
+{
+	struct pci_slot *s = pciFindSlot(tag);
+	int i;
+
+	if (!s) {
+#ifdef DEBUG_PCI
+		printf("PCI: device not found while write %s (%x:%x.%x)\n",
+		       what, tag->bus, tag->slot, tag->func);
+#endif
+		return;
+	}
+
+	switch (size) {
+	case 1:
+		pci_write_byte(s->dev, idx, data);
+		break;
+	case 2:
+		pci_write_word(s->dev, idx, data);
+		break;
+	default:
+		pci_write_long(s->dev, idx, data);
+		break;
+	}
+
+	if (s->cache)
+		for (i = 0; i < size && idx + i < (u32)pci_cache_size; i++)
+			s->valid[idx + i] = 0;
+}
+
 PCITAG findPci(unsigned short bx)
 {
 	PCITAG tag = &ltag;
+	int present;
 
 	int bus = (bx >> 8) & 0xFF;
 	int slot = (bx >> 3) & 0x1F;
@@ -65,14 +220,14 @@ PCITAG findPci(unsigned short bx)
 	tag->slot = slot;
 	tag->func = func;
 
-#if LIBPCI_CHECK_VERSION(2,1,99)
-	if (pci_get_dev(pacc, 0, bus, slot, func))
-#else
-	if (pci_get_dev(pacc, bus, slot, func))
-#endif
-		return tag;
+	if (trace_mode == TRACE_REPLAY)
+		return trace_replay(TRACE_FIND | 1, bx, 0, 0) ? tag : NULL;
 
-	return NULL;
+	present = pciFindSlot(tag) != NULL;
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_FIND | 1, bx, 0, present);
+
+	return present ? tag : NULL;
 }
 
 u32 pciSlotBX(PCITAG tag)
@@ -82,98 +237,69 @@ u32 pciSlotBX(PCITAG tag)
 
 u8 pciReadByte(PCITAG tag, u32 idx)
 {
-	struct pci_dev *d;
-#if LIBPCI_CHECK_VERSION(2,1,99)
-	if ((d = pci_get_dev(pacc, 0, tag->bus, tag->slot, tag->func)))
-#else
-	if ((d = pci_get_dev(pacc, tag->bus, tag->slot, tag->func)))
-#endif
-		return pci_read_byte(d, idx);
-#ifdef DEBUG_PCI
-	printf("PCI: device not found while read byte (%x:%x.%x)\n",
-	       tag->bus, tag->slot, tag->func);
-#endif
-	return 0;
+	u8 val;
+
+	if (trace_mode == TRACE_REPLAY)
+		return trace_replay(TRACE_CFG_RD | 1, pciSlotBX(tag), idx, 0);
+	val = pciRead(tag, idx, 1, "byte");
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_CFG_RD | 1, pciSlotBX(tag), idx, val);
+	return val;
 }
 
 u16 pciReadWord(PCITAG tag, u32 idx)
 {
-	struct pci_dev *d;
-#if LIBPCI_CHECK_VERSION(2,1,99)
-	if ((d = pci_get_dev(pacc, 0, tag->bus, tag->slot, tag->func)))
-#else
-	if ((d = pci_get_dev(pacc, tag->bus, tag->slot, tag->func)))
-#endif
-		return pci_read_word(d, idx);
-#ifdef DEBUG_PCI
-	printf("PCI: device not found while read word (%x:%x.%x)\n",
-	       tag->bus, tag->slot, tag->func);
-#endif
-	return 0;
+	u16 val;
+
+	if (trace_mode == TRACE_REPLAY)
+		return trace_replay(TRACE_CFG_RD | 2, pciSlotBX(tag), idx, 0);
+	val = pciRead(tag, idx, 2, "word");
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_CFG_RD | 2, pciSlotBX(tag), idx, val);
+	return val;
 }
 
 u32 pciReadLong(PCITAG tag, u32 idx)
 {
-	struct pci_dev *d;
-#if LIBPCI_CHECK_VERSION(2,1,99)
-	if ((d = pci_get_dev(pacc, 0, tag->bus, tag->slot, tag->func)))
-#else
-	if ((d = pci_get_dev(pacc, tag->bus, tag->slot, tag->func)))
-#endif
-		return pci_read_long(d, idx);
-#ifdef DEBUG_PCI
-	printf("PCI: device not found while read long (%x:%x.%x)\n",
-	       tag->bus, tag->slot, tag->func);
-#endif
-	return 0;
-}
+	u32 val;
 
+	if (trace_mode == TRACE_REPLAY)
+		return trace_replay(TRACE_CFG_RD | 4, pciSlotBX(tag), idx, 0);
+	val = pciRead(tag, idx, 4, "long");
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_CFG_RD | 4, pciSlotBX(tag), idx, val);
+	return val;
+}
 
 void pciWriteLong(PCITAG tag, u32 idx, u32 data)
 {
-	struct pci_dev *d;
-#if LIBPCI_CHECK_VERSION(2,1,99)
-	if ((d = pci_get_dev(pacc, 0, tag->bus, tag->slot, tag->func)))
-#else
-	if ((d = pci_get_dev(pacc, tag->bus, tag->slot, tag->func)))
-#endif
-		pci_write_long(d, idx, data);
-#ifdef DEBUG_PCI
-	else
-		printf("PCI: device not found while write long (%x:%x.%x)\n",
-		       tag->bus, tag->slot, tag->func);
-#endif
+	if (trace_mode == TRACE_REPLAY) {
+		trace_replay(TRACE_CFG_WR | 4, pciSlotBX(tag), idx, data);
+		return;
+	}
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_CFG_WR | 4, pciSlotBX(tag), idx, data);
+	pciWrite(tag, idx, data, 4, "long");
 }
 
 void pciWriteWord(PCITAG tag, u32 idx, u16 data)
 {
-	struct pci_dev *d;
-#if LIBPCI_CHECK_VERSION(2,1,99)
-	if ((d = pci_get_dev(pacc, 0, tag->bus, tag->slot, tag->func)))
-#else
-	if ((d = pci_get_dev(pacc, tag->bus, tag->slot, tag->func)))
-#endif
-		pci_write_word(d, idx, data);
-#ifdef DEBUG_PCI
-	else
-		printf("PCI: device not found while write word (%x:%x.%x)\n",
-		       tag->bus, tag->slot, tag->func);
-#endif
-
+	if (trace_mode == TRACE_REPLAY) {
+		trace_replay(TRACE_CFG_WR | 2, pciSlotBX(tag), idx, data);
+		return;
+	}
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_CFG_WR | 2, pciSlotBX(tag), idx, data);
+	pciWrite(tag, idx, data, 2, "word");
 }
 
 void pciWriteByte(PCITAG tag, u32 idx, u8 data)
 {
-	struct pci_dev *d;
-#if LIBPCI_CHECK_VERSION(2,1,99)
-	if ((d = pci_get_dev(pacc, 0, tag->bus, tag->slot, tag->func)))
-#else
-	if ((d = pci_get_dev(pacc, tag->bus, tag->slot, tag->func)))
-#endif
-		pci_write_long(d, idx, data);
-#ifdef DEBUG_PCI
-	else
-		printf("PCI: device not found while write long (%x:%x.%x)\n",
-		       tag->bus, tag->slot, tag->func);
-#endif
+	if (trace_mode == TRACE_REPLAY) {
+		trace_replay(TRACE_CFG_WR | 1, pciSlotBX(tag), idx, data);
+		return;
+	}
+	if (trace_mode == TRACE_RECORD)
+		trace_record(TRACE_CFG_WR | 1, pciSlotBX(tag), idx, data);
+	pciWrite(tag, idx, data, 1, "byte");
 }
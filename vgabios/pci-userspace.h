@@ -38,6 +38,7 @@ struct pci_filter {
 #define pciVideoPtr struct pci_dev *
 
 extern int pciNumBuses;
+extern int pci_cache_size;
 
 int pciInit(void);
 int pciExit(void);
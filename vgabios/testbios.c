@@ -9,9 +9,17 @@
 #endif
 
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
 #include <fcntl.h>
 #include <getopt.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <dirent.h>
+#include <signal.h>
+#include <stdarg.h>
 
 #define die(x) { perror(x); exit(1); }
 #define warn(x) { perror(x);  }
@@ -21,6 +29,7 @@
 #include <x86emu/x86emu.h>
 #include "helper_exec.h"
 #include "pci-userspace.h"
+#include "trace.h"
 
 void x86emu_dump_xregs(void);
 int int15_handler(void);
@@ -35,6 +44,9 @@ void pushw(u16 val);
 
 unsigned short get_device(char *arg_val);
 
+void X86EMU_flushBlockCache(void);
+unsigned long long X86EMU_getInstrCount(void);
+
 extern int teststart, testend;
 
 _ptr p;
@@ -43,6 +55,34 @@ unsigned char biosmem[1024 * 1024];
 
 int verbose = 0;
 
+/* Batch mode runs every ROM from the same clean guest state. It is saved
+ * once after setup and copied back before each ROM is loaded.
+ */
+static unsigned char *snapmem;
+static X86EMU_regs snapregs;
+static u16 ret_cs, ret_ip;	/* just past the hlt we return to */
+
+static unsigned long int_count[256];
+static volatile sig_atomic_t timed_out;
+
+/* One record per ROM. Records go out in writes of at most PIPE_BUF bytes,
+ * which a pipe or O_APPEND file never interleaves with other writers, so
+ * the records of parallel workers stay whole as long as they fit. Only a
+ * longer one, from a very long path or many distinct interrupts, can be
+ * split by another worker's record.
+ */
+static char recbuf[8192];
+static size_t reclen;
+
+static char **roms;
+static int nroms, romalloc;
+
+/* The trace to record or replay. In batch mode this is a directory with
+ * one <rom name>.trace per ROM.
+ */
+static char *tracename;
+static int tracemode = TRACE_OFF;
+
 void do_int(int num);
 unsigned char *mapitin(char *file, off_t where, size_t size);
 void usage(char *name);
@@ -57,6 +97,7 @@ void do_int(int num)
 
 	/* This is a pInt leftover */
 	current->num = num;
+	int_count[num & 0xff]++;
 
 	switch (num) {
 #ifndef _PC
@@ -130,6 +171,359 @@ void usage(char *name)
 	printf
 	    ("Usage: %s [-c codesegment] [-s size] [-b base] [-i ip] [-t] <filename> ... \n",
 	     name);
+	printf
+	    ("       %s --batch [-j jobs] [-o records] [-T timeout] [-L listfile] <file|dir> ...\n",
+	     name);
+	printf
+	    ("       --record <trace> / --replay <trace> log or answer port and PCI accesses\n");
+	printf
+	    ("       --pci-cache <0|256|4096> cache that much config space per device\n");
+}
+
+/* Lays out the guest memory and registers every ROM starts with: the
+ * F segment, the return stub on the stack and the entry point.
+ */
+static void setup_guest(char *fsegname, u16 devfn, u16 cs, u16 ip)
+{
+	unsigned char *fsegptr;
+
+	if (fsegname) {
+		fsegptr = mapitin(fsegname, (off_t) 0, 0x10000);
+		memcpy(biosmem + 0xf0000, fsegptr, 0x10000);
+		munmap(fsegptr, 0x10000);
+	} else {
+		const char *date = "01/01/99";
+		memcpy(biosmem + 0xffff5, date, strlen(date));
+	}
+	X86EMU_flushBlockCache();
+
+	/* cpu setup */
+	X86_AX = devfn ? devfn : 0xff;
+	X86_DX = 0x80;
+	X86_EIP = ip;
+	X86_CS = cs;
+
+	/* Initialize stack and data segment */
+	X86_SS = 0x0030;
+	X86_DS = 0x0040;
+	X86_SP = 0xfffe;
+	/* We need a sane way to return from bios
+	 * execution. A hlt instruction and a pointer
+	 * to it, both kept on the stack, will do.
+	 */
+	pushw(0xf4f4);		/* hlt; hlt */
+	ret_cs = X86_SS;
+	ret_ip = X86_SP + 1;
+	pushw(X86_SS);
+	pushw(X86_SP + 2);
+
+	X86_ES = 0x0000;
+}
+
+static void batch_alarm(int sig)
+{
+	(void)sig;
+	timed_out = 1;
+	X86EMU_halt_sys();
+}
+
+/* Runs the emulator until the ROM halts or, if timeout is non-zero, for
+ * at most that many seconds. The timer keeps firing after it expired in
+ * case X86EMU_exec cleared the halt request on entry.
+ */
+static void run_guest(int timeout)
+{
+	struct itimerval it;
+
+	timed_out = 0;
+	if (timeout > 0) {
+		memset(&it, 0, sizeof(it));
+		it.it_value.tv_sec = timeout;
+		it.it_interval.tv_usec = 10000;
+		signal(SIGALRM, batch_alarm);
+		setitimer(ITIMER_REAL, &it, NULL);
+	}
+	X86EMU_exec();
+	if (timeout > 0) {
+		memset(&it, 0, sizeof(it));
+		setitimer(ITIMER_REAL, &it, NULL);
+	}
+}
+
+static void rec_printf(const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+
+	va_start(ap, fmt);
+	n = vsnprintf(recbuf + reclen, sizeof(recbuf) - reclen, fmt, ap);
+	va_end(ap);
+	if (n > 0)
+		reclen += n;
+	if (reclen >= sizeof(recbuf))
+		reclen = sizeof(recbuf) - 1;
+}
+
+static void rec_string(const char *name, const char *val)
+{
+	rec_printf("%s\"%s\": \"", reclen > 1 ? ", " : "", name);
+	for (; *val; val++) {
+		if (*val == '"' || *val == '\\')
+			rec_printf("\\%c", *val);
+		else if ((unsigned char)*val < 0x20)
+			rec_printf("\\u%04x", *val);
+		else
+			rec_printf("%c", *val);
+	}
+	rec_printf("\"");
+}
+
+static void rec_write(int fd)
+{
+	size_t done, len;
+	ssize_t n;
+
+	rec_printf("}\n");
+	fflush(stdout);
+	for (done = 0; done < reclen; done += n) {
+		len = reclen - done;
+		if (len > PIPE_BUF)
+			len = PIPE_BUF;
+		n = write(fd, recbuf + done, len);
+		if (n < 0 && errno == EINTR) {
+			n = 0;
+			continue;
+		}
+		if (n <= 0) {
+			warn("record");
+			break;
+		}
+	}
+	reclen = 0;
+}
+
+/* Reads up to size bytes of file to base, or the whole file if size is
+ * 0, stopping at the end of guest memory. Returns the number of bytes
+ * loaded or -1 with errno set.
+ */
+static int load_rom(const char *file, int base, size_t size)
+{
+	size_t len, max = sizeof(biosmem) - base;
+	struct stat st;
+	ssize_t n;
+	int fd, i;
+
+	fd = open(file, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return -1;
+	}
+	len = size ? size : (size_t)st.st_size;
+	if (len > max)
+		len = max;
+	for (i = 0; i < (int)len; i += n) {
+		n = read(fd, biosmem + base + i, len - i);
+		if (n <= 0)
+			break;
+	}
+	close(fd);
+	X86EMU_flushBlockCache();
+
+	return i;
+}
+
+/* Restores the clean guest state, loads one ROM, runs it and writes its
+ * record. Only the ROM and a memcpy of guest memory are touched per run;
+ * PCI and the interrupt handlers are set up once for the whole batch.
+ */
+static void batch_run(const char *file, int base, size_t size, int timeout,
+		      int recfd)
+{
+	struct timeval start, end;
+	unsigned long long insns;
+	const char *exit_state, *name;
+	char tracefile[PATH_MAX];
+	long trace_errors = 0;
+	int i, len, sep;
+
+	rec_printf("{");
+	rec_string("rom", file);
+
+	memcpy(biosmem, snapmem, sizeof(biosmem));
+	M.x86 = snapregs;
+	len = load_rom(file, base, size);
+	if (len < 0) {
+		rec_string("exit", "error");
+		rec_string("error", strerror(errno));
+		rec_write(recfd);
+		return;
+	}
+	if (tracemode != TRACE_OFF) {
+		name = strrchr(file, '/');
+		snprintf(tracefile, sizeof(tracefile), "%s/%s.trace",
+			 tracename, name ? name + 1 : file);
+		if (trace_open(tracefile, tracemode) < 0) {
+			rec_string("exit", "error");
+			rec_string("error", "trace not usable");
+			rec_write(recfd);
+			return;
+		}
+	}
+
+	printf("running file %s\n", file);
+	memset(int_count, 0, sizeof(int_count));
+	memset(&io_stats, 0, sizeof(io_stats));
+	insns = X86EMU_getInstrCount();
+	gettimeofday(&start, 0);
+	run_guest(timeout);
+	gettimeofday(&end, 0);
+	insns = X86EMU_getInstrCount() - insns;
+	if (tracemode != TRACE_OFF)
+		trace_errors = trace_close();
+
+	if (X86_CS == ret_cs && X86_IP == ret_ip)
+		exit_state = "return";
+	else if (timed_out)
+		exit_state = "timeout";
+	else
+		exit_state = "halt";
+
+	rec_printf(", \"bytes\": %d", len);
+	rec_string("exit", exit_state);
+	rec_printf(", \"insns\": %llu, \"usecs\": %ld", insns,
+		   (long)(end.tv_sec - start.tv_sec) * 1000000 +
+		   (end.tv_usec - start.tv_usec));
+	rec_printf(", \"inb\": %lu, \"inw\": %lu, \"inl\": %lu",
+		   io_stats.in8, io_stats.in16, io_stats.in32);
+	rec_printf(", \"outb\": %lu, \"outw\": %lu, \"outl\": %lu",
+		   io_stats.out8, io_stats.out16, io_stats.out32);
+	rec_printf(", \"ints\": {");
+	for (i = 0, sep = 0; i < 256; i++) {
+		if (!int_count[i])
+			continue;
+		rec_printf("%s\"0x%02x\": %lu", sep ? ", " : "", i,
+			   int_count[i]);
+		sep = 1;
+	}
+	rec_printf("}, \"cs\": \"0x%04x\", \"ip\": \"0x%04x\", \"ax\": \"0x%04x\"",
+		   X86_CS, X86_IP, X86_AX);
+	if (tracemode == TRACE_REPLAY)
+		rec_printf(", \"trace_errors\": %ld", trace_errors);
+	rec_write(recfd);
+}
+
+static void add_rom(const char *name)
+{
+	if (nroms == romalloc) {
+		romalloc = romalloc ? romalloc * 2 : 64;
+		roms = realloc(roms, romalloc * sizeof(*roms));
+		if (!roms)
+			die("realloc");
+	}
+	roms[nroms] = strdup(name);
+	if (!roms[nroms])
+		die("strdup");
+	nroms++;
+}
+
+static int cmp_rom(const void *a, const void *b)
+{
+	return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/* A directory adds the regular files in it, sorted by name. Anything
+ * else is added as is; if it can't be read, its record says so.
+ */
+static void add_path(const char *path)
+{
+	char name[PATH_MAX];
+	struct dirent *de;
+	struct stat st;
+	DIR *dir;
+	int first = nroms;
+
+	if (stat(path, &st) < 0 || !S_ISDIR(st.st_mode)) {
+		add_rom(path);
+		return;
+	}
+	dir = opendir(path);
+	if (!dir)
+		die(path);
+	while ((de = readdir(dir))) {
+		if (de->d_name[0] == '.')
+			continue;
+		snprintf(name, sizeof(name), "%s/%s", path, de->d_name);
+		if (stat(name, &st) == 0 && S_ISREG(st.st_mode))
+			add_rom(name);
+	}
+	closedir(dir);
+	qsort(roms + first, nroms - first, sizeof(*roms), cmp_rom);
+}
+
+/* One file or directory per line, "-" reads the list from stdin. Empty
+ * lines and lines starting with '#' are skipped.
+ */
+static void add_list(const char *listname)
+{
+	char line[PATH_MAX];
+	FILE *f;
+	size_t n;
+
+	f = strcmp(listname, "-") ? fopen(listname, "r") : stdin;
+	if (!f)
+		die(listname);
+	while (fgets(line, sizeof(line), f)) {
+		n = strcspn(line, "\r\n");
+		line[n] = 0;
+		if (n && line[0] != '#')
+			add_path(line);
+	}
+	if (f != stdin)
+		fclose(f);
+}
+
+/* Saves the clean guest state and runs all ROMs, either here or split
+ * over jobs worker processes. Worker w takes ROMs w, w + jobs, ... and
+ * inherits the snapshot, PCI access and interrupt setup from us.
+ */
+static int run_batch(int jobs, int base, size_t size, int timeout, int recfd)
+{
+	int i, w, status, ret = 0;
+	pid_t pid;
+
+	snapmem = malloc(sizeof(biosmem));
+	if (!snapmem)
+		die("malloc");
+	memcpy(snapmem, biosmem, sizeof(biosmem));
+	snapregs = M.x86;
+
+	if (jobs <= 1) {
+		for (i = 0; i < nroms; i++)
+			batch_run(roms[i], base, size, timeout, recfd);
+		return 0;
+	}
+
+	fflush(stdout);
+	for (w = 0; w < jobs && w < nroms; w++) {
+		pid = fork();
+		if (pid < 0)
+			die("fork");
+		if (pid == 0) {
+			for (i = w; i < nroms; i += jobs)
+				batch_run(roms[i], base, size, timeout, recfd);
+			fflush(stdout);
+			_exit(0);
+		}
+	}
+	while (wait(&status) > 0) {
+		if (!WIFEXITED(status) || WEXITSTATUS(status)) {
+			fprintf(stderr, "batch worker died, some ROMs have no record\n");
+			ret = 1;
+		}
+	}
+	return ret;
 }
 
 int main(int argc, char **argv)
@@ -137,23 +531,26 @@ int main(int argc, char **argv)
 	char *absegname = 0;
 	void *abseg = 0;
 	int i, c, trace = 0;
-	unsigned char *cp;
-	char *filename;
+	char *filename = 0;
+	int batch = 0, jobs = 1, timeout = -1, recfd, ret = 0;
+	long trace_errors;
+	struct stat st;
+	char *recname = 0;
 	size_t size = 0;
 	int base = 0;
 	int have_size = 0, have_base = 0, have_ip = 0, have_cs = 0;
 	int have_devfn = 0;
 	int parse_rom = 0;
 	char *fsegname = 0;
-	unsigned char *fsegptr;
 	unsigned short initialip = 0, initialcs = 0, devfn = 0;
 	X86EMU_intrFuncs intFuncs[256];
 	void X86EMU_setMemBase(void *base, size_t size);
+	void X86EMU_mapMemory(u32 base, u32 size, void *host);
 	void x86emu_dump_xregs(void);
 	int X86EMU_set_debug(int debug);
 	int debugflag = 0;
 
-	const char *optstring = "vh?b:i:c:s:tpd:";
+	const char *optstring = "vh?b:i:c:s:tpd:BL:j:o:T:";
 	while (1) {
 		int option_index = 0;
 		static struct option long_options[] = {
@@ -169,6 +566,14 @@ int main(int argc, char **argv)
 			{"parserom", 0, 0, 'p'},
 			{"device", 1, 0, 'd'},
 			{"debug", 1, 0, 'D'},
+			{"batch", 0, 0, 'B'},
+			{"list", 1, 0, 'L'},
+			{"jobs", 1, 0, 'j'},
+			{"output", 1, 0, 'o'},
+			{"timeout", 1, 0, 'T'},
+			{"record", 1, 0, 'R'},
+			{"replay", 1, 0, 'P'},
+			{"pci-cache", 1, 0, 'C'},
 			{0, 0, 0, 0}
 		};
 		c = getopt_long(argc, argv, optstring, long_options, &option_index);
@@ -218,6 +623,38 @@ int main(int argc, char **argv)
 		case 'D':
 			debugflag = strtol(optarg, 0, 0);
 			break;
+		case 'B':
+			batch = 1;
+			break;
+		case 'L':
+			add_list(optarg);
+			batch = 1;
+			break;
+		case 'j':
+			jobs = strtol(optarg, 0, 0);
+			break;
+		case 'o':
+			recname = optarg;
+			break;
+		case 'T':
+			timeout = strtol(optarg, 0, 0);
+			break;
+		case 'R':
+			tracename = optarg;
+			tracemode = TRACE_RECORD;
+			break;
+		case 'P':
+			tracename = optarg;
+			tracemode = TRACE_REPLAY;
+			break;
+		case 'C':
+			pci_cache_size = strtol(optarg, 0, 0);
+			if (pci_cache_size != 0 && pci_cache_size != 256 &&
+			    pci_cache_size != 4096) {
+				printf("PCI config cache size must be 0, 256 or 4096\n");
+				return 1;
+			}
+			break;
 		default:
 			printf("Unknown option \n");
 			usage(argv[0]);
@@ -225,24 +662,28 @@ int main(int argc, char **argv)
 		}
 	}
 
-	if (optind >= argc) {
+	if (optind >= argc && !nroms) {
 		printf("Filename missing.\n");
 		usage(argv[0]);
 		return 1;
 	}
 
-	while (optind < argc) {
+	if (batch) {
+		while (optind < argc)
+			add_path(argv[optind++]);
+		if (timeout < 0)
+			timeout = 10;
+	} else {
 		printf("running file %s\n", argv[optind]);
 		filename = argv[optind];
-		optind++;
-		/* normally we would do continue, but for
-		 * now only one filename is supported.
-		 */
-		/* continue; */
-		break;
+		if (optind + 1 < argc)
+			printf("Only the first file is run, use --batch for more.\n");
+		if (timeout < 0)
+			timeout = 0;
 	}
 
-	if (!have_size) {
+	/* In batch mode each ROM is loaded whole unless a size is given. */
+	if (!have_size && !batch) {
 		printf("No size specified. defaulting to 32k\n");
 		size = 32 * 1024;
 	}
@@ -259,6 +700,11 @@ int main(int argc, char **argv)
 		    ("No initial instruction pointer specified. defaulting to 0x0003\n");
 		initialip = 0x0003;
 	}
+	if (base < 0 || base >= (int)sizeof(biosmem) ||
+	    size > sizeof(biosmem) - base) {
+		printf("ROM at 0x%x does not fit below 1MB\n", base);
+		return 1;
+	}
 
 	//printf("Point 1 int%x vector at %x\n", 0x42, getIntVect(0x42));
 
@@ -287,14 +733,32 @@ int main(int argc, char **argv)
 	current = &p;
 	X86EMU_setMemBase(biosmem, sizeof(biosmem));
 	M.abseg = (unsigned long)abseg;
+	if (abseg)
+		X86EMU_mapMemory(0xa0000, 0x20000, abseg);
 	X86EMU_setupPioFuncs(&myfuncs);
 
+	if (tracename && batch) {
+		if (stat(tracename, &st) < 0 || !S_ISDIR(st.st_mode)) {
+			printf("%s: batch mode needs a trace directory\n",
+			       tracename);
+			return 1;
+		}
+		/* Tells pciInit() whether libpci will be needed. */
+		trace_mode = tracemode;
+	} else if (tracename) {
+		if (trace_open(tracename, tracemode) < 0)
+			return 1;
+	}
+
+	/* A replayed trace answers all port accesses. */
+	if (tracemode != TRACE_REPLAY) {
 #ifndef __APPLE__
-	ioperm(0, 0x400, 1);
+		ioperm(0, 0x400, 1);
 #endif
 
-	if (iopl(3) < 0) {
-		warn("iopl failed, continuing anyway");
+		if (iopl(3) < 0) {
+			warn("iopl failed, continuing anyway");
+		}
 	}
 
 	/* Emergency sync ;-) */
@@ -310,7 +774,6 @@ int main(int argc, char **argv)
 	for (i = 0; i < 256; i++)
 		intFuncs[i] = do_int;
 	X86EMU_setupIntrFuncs(intFuncs);
-	cp = mapitin(filename, (off_t) 0, size);
 
 	if (devfn) {
 		printf("Loading ax with BusDevFn = %x\n",devfn);
@@ -319,39 +782,28 @@ int main(int argc, char **argv)
 	current->ax = devfn   ? devfn : 0xff;
 	current->dx = 0x80;
 	//      current->ip = 0;
-	for (i = 0; i < (int)size; i++)
-		wrb(base + i, cp[i]);
-
-	if (fsegname) {
-		fsegptr = mapitin(fsegname, (off_t) 0, 0x10000);
-		for (i = 0; i < 0x10000; i++)
-			wrb(0xf0000 + i, fsegptr[i]);
-	} else {
-		const char *date = "01/01/99";
-		for (i = 0; date[i]; i++)
-			wrb(0xffff5 + i, date[i]);
-		wrb(0xffff7, '/');
-		wrb(0xffffa, '/');
+	setup_guest(fsegname, devfn, initialcs, initialip);
+
+	if (batch) {
+		if (recname)
+			recfd = open(recname, O_WRONLY | O_CREAT | O_TRUNC |
+				     O_APPEND, 0644);
+		else
+			recfd = dup(1);
+		if (recfd < 0)
+			die(recname ? recname : "dup");
+		/* Emulator chatter would bury the records. */
+		if (!verbose && !freopen("/dev/null", "w", stdout))
+			die("/dev/null");
+		ret = run_batch(jobs, base, have_size ? size : 0, timeout,
+				recfd);
+		close(recfd);
+		pciExit();
+		return ret;
 	}
-	/* cpu setup */
-	X86_AX = devfn ? devfn : 0xff;
-	X86_DX = 0x80;
-	X86_EIP = initialip;
-	X86_CS = initialcs;
 
-	/* Initialize stack and data segment */
-	X86_SS = 0x0030;
-	X86_DS = 0x0040;
-	X86_SP = 0xfffe;
-	/* We need a sane way to return from bios
-	 * execution. A hlt instruction and a pointer
-	 * to it, both kept on the stack, will do.
-	 */
-	pushw(0xf4f4);		/* hlt; hlt */
-	pushw(X86_SS);
-	pushw(X86_SP + 2);
-
-	X86_ES = 0x0000;
+	if (load_rom(filename, base, size) < 0)
+		die(filename);
 
 	if (trace) {
 		printf("Switching to single step mode.\n");
@@ -360,11 +812,18 @@ int main(int argc, char **argv)
 	if (debugflag) {
 		//X86EMU_set_debug(debugflag);
 	}
-	X86EMU_exec();
+	run_guest(timeout);
+	if (tracename) {
+		trace_errors = trace_close();
+		if (tracemode == TRACE_REPLAY)
+			printf("Replayed %s: %ld mismatches\n", tracename,
+			       trace_errors);
+		ret = trace_errors != 0;
+	}
 	/* Cleaning up */
 	pciExit();
 
-	return 0;
+	return ret;
 }
 
 unsigned short get_device(char *arg_val)
@@ -0,0 +1,206 @@
+/*
+ * trace.c - record and replay port I/O and PCI config space accesses
+ *
+ * When recording, every access made through the x_in/x_out helpers and
+ * the pciRead/pciWrite functions is appended to a trace file together
+ * with its value. When replaying, neither the hardware nor libpci is
+ * touched: reads are answered from the trace and writes are only
+ * checked against it. So a ROM can be run again on any machine and
+ * takes exactly the path it took when the trace was made, as long as
+ * the emulator still behaves the same. The first access that doesn't
+ * match the trace is reported. Reads that don't match return all ones,
+ * which is what reading an absent device gives.
+ *
+ * The file starts with TRACE_MAGIC, followed by records of
+ *   u8  type
+ *   u16 port, or bus/devfn for PCI
+ *   u16 config space register, TRACE_CFG_RD and TRACE_CFG_WR only
+ *   value, TRACE_SIZE(type) bytes
+ * all little endian.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "test.h"
+#include "trace.h"
+
+#define TRACE_MAGIC	"VGATRC01"
+#define TRACE_MAGIC_LEN	8
+
+int trace_mode = TRACE_OFF;
+
+static FILE *trace_file;		/* recording */
+static unsigned char *trace_buf;	/* replaying */
+static size_t trace_len, trace_pos;
+static unsigned long trace_count;
+static long trace_errors;
+
+static int trace_hdr(int type)
+{
+	type &= 0xf0;
+	return type == TRACE_CFG_RD || type == TRACE_CFG_WR ? 5 : 3;
+}
+
+static const char *trace_name(int type)
+{
+	switch (type & 0xf0) {
+	case TRACE_IN:
+		return "in";
+	case TRACE_OUT:
+		return "out";
+	case TRACE_CFG_RD:
+		return "cfg read";
+	case TRACE_CFG_WR:
+		return "cfg write";
+	case TRACE_FIND:
+		return "find";
+	}
+	return "?";
+}
+
+/* Opens file for recording or replaying and sets trace_mode. A trace
+ * being replayed is read into memory as a whole. Returns 0 on success,
+ * -1 if the file can't be used.
+ */
+int trace_open(const char *file, int mode)
+{
+	struct stat st;
+	ssize_t n;
+	int fd;
+
+	trace_pos = trace_len = 0;
+	trace_count = 0;
+	trace_errors = 0;
+
+	if (mode == TRACE_RECORD) {
+		trace_file = fopen(file, "wb");
+		if (!trace_file ||
+		    fwrite(TRACE_MAGIC, TRACE_MAGIC_LEN, 1, trace_file) != 1) {
+			perror(file);
+			return -1;
+		}
+		trace_mode = mode;
+		return 0;
+	}
+
+	fd = open(file, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		perror(file);
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+	trace_buf = malloc(st.st_size + 1);
+	if (!trace_buf) {
+		perror("malloc");
+		close(fd);
+		return -1;
+	}
+	while (trace_len < (size_t)st.st_size) {
+		n = read(fd, trace_buf + trace_len, st.st_size - trace_len);
+		if (n <= 0)
+			break;
+		trace_len += n;
+	}
+	close(fd);
+	if (trace_len < TRACE_MAGIC_LEN ||
+	    memcmp(trace_buf, TRACE_MAGIC, TRACE_MAGIC_LEN)) {
+		fprintf(stderr, "%s: not a trace file\n", file);
+		free(trace_buf);
+		trace_buf = NULL;
+		return -1;
+	}
+	trace_pos = TRACE_MAGIC_LEN;
+	trace_mode = mode;
+	return 0;
+}
+
+/* Ends recording or replaying. Returns the number of accesses that
+ * didn't match the trace, counting unused records at the end of the
+ * trace as one more, or -1 if the recording couldn't be written.
+ */
+long trace_close(void)
+{
+	long ret = 0;
+
+	if (trace_mode == TRACE_RECORD) {
+		if (fclose(trace_file)) {
+			perror("trace");
+			ret = -1;
+		}
+		trace_file = NULL;
+	} else if (trace_mode == TRACE_REPLAY) {
+		if (trace_pos < trace_len) {
+			fprintf(stderr, "trace: %lu bytes left after %lu "
+				"records\n", (unsigned long)(trace_len - trace_pos),
+				trace_count);
+			trace_errors++;
+		}
+		ret = trace_errors;
+		free(trace_buf);
+		trace_buf = NULL;
+	}
+	trace_mode = TRACE_OFF;
+	return ret;
+}
+
+void trace_record(int type, u16 addr, u16 reg, u32 val)
+{
+	unsigned char rec[9];
+	int i, len = trace_hdr(type);
+
+	rec[0] = type;
+	rec[1] = addr;
+	rec[2] = addr >> 8;
+	rec[3] = reg;
+	rec[4] = reg >> 8;
+	for (i = 0; i < TRACE_SIZE(type); i++)
+		rec[len++] = val >> (8 * i);
+	fwrite(rec, len, 1, trace_file);
+	trace_count++;
+}
+
+static void trace_mismatch(int type, u16 addr, u16 reg, u32 val)
+{
+	if (trace_errors++)
+		return;
+	fprintf(stderr, "trace: record %lu does not match %s%d 0x%04x",
+		trace_count, trace_name(type), TRACE_SIZE(type) * 8, addr);
+	if (trace_hdr(type) == 5)
+		fprintf(stderr, " reg 0x%02x", reg);
+	if ((type & 0xf0) == TRACE_OUT || (type & 0xf0) == TRACE_CFG_WR)
+		fprintf(stderr, " = 0x%x", val);
+	fprintf(stderr, "\n");
+}
+
+/* Returns the value the next record holds for this access and moves on
+ * to the record after it. For writes, val is compared with the recorded
+ * value.
+ */
+u32 trace_replay(int type, u16 addr, u16 reg, u32 val)
+{
+	unsigned char *p = trace_buf + trace_pos;
+	int i, hdr = trace_hdr(type), size = TRACE_SIZE(type);
+	u32 mask = size == 4 ? 0xffffffff : (1U << (8 * size)) - 1;
+	u32 rec_val = 0;
+
+	if (trace_pos + hdr + size > trace_len || p[0] != type ||
+	    (p[1] | p[2] << 8) != addr ||
+	    (hdr == 5 && (p[3] | p[4] << 8) != reg)) {
+		trace_mismatch(type, addr, reg, val);
+		return (type & 0xf0) == TRACE_FIND ? 0 : mask;
+	}
+	for (i = size; i--;)
+		rec_val = rec_val << 8 | p[hdr + i];
+	trace_pos += hdr + size;
+	trace_count++;
+
+	if (((type & 0xf0) == TRACE_OUT || (type & 0xf0) == TRACE_CFG_WR) &&
+	    rec_val != (val & mask))
+		trace_mismatch(type, addr, reg, val);
+	return rec_val;
+}
@@ -0,0 +1,29 @@
+/*
+ * Port I/O and PCI config space trace, see trace.c
+ *
+ * Users have to provide u8, u16 and u32 before including this.
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#define TRACE_OFF	0
+#define TRACE_RECORD	1
+#define TRACE_REPLAY	2
+
+/* Record types. The low three bits hold the access size in bytes. */
+#define TRACE_IN	0x10	/* port read */
+#define TRACE_OUT	0x20	/* port write */
+#define TRACE_CFG_RD	0x30	/* config space read */
+#define TRACE_CFG_WR	0x40	/* config space write */
+#define TRACE_FIND	0x50	/* device lookup, value is 1 if present */
+
+#define TRACE_SIZE(type)	((type) & 7)
+
+extern int trace_mode;
+
+int trace_open(const char *file, int mode);
+long trace_close(void);
+void trace_record(int type, u16 addr, u16 reg, u32 val);
+u32 trace_replay(int type, u16 addr, u16 reg, u32 val);
+
+#endif